@@ -8,30 +8,83 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "utils/files.h"
-#include "frontend/lexer.h"
+#include "frontend/lexer_stream.h"
+#include "backend/image.h"
+#include "backend/compiler.h"
+#include "backend/build.h"
 
-#define CASK_APPNAME "Cask 0.1.0\nBy: Derek Tan"
+#define CASK_APPNAME "Cask " CASK_COMPILER_VERSION "\nBy: Derek Tan"
 
 #define CASK_OPTION_HELP "-h"
 #define CASK_OPTION_VERSION "-v"
 #define CASK_OPTION_FILE "-f"
+#define CASK_OPTION_DISASSEMBLE "-d"
+#define CASK_OPTION_PEEPHOLE "-p"
+#define CASK_OPTION_OUTPUT "-o"
+#define CASK_OPTION_CACHE "-c"
+#define CASK_OPTION_JOBS "-j"
+#define CASK_OPTION_STREAM "-s"
+
+/**
+ * @brief Streams a file through the lexer in constant memory, checking that every byte lexes.
+ * @return bool False if the file cannot be read or has a bad token.
+ */
+static bool caskc_stream_lex(const char *program_name, const char *file_path)
+{
+    LexerStream stream;
+    StreamToken token;
+    uint64_t token_count = 0U;
+    int fd = open(file_path, O_RDONLY);
+
+    if (fd < 0 || !lexer_stream_init(&stream, fd, CASK_LEXER_STREAM_WINDOW))
+    {
+        fprintf(stderr, "%s [Error]: %s: could not read file.\n", program_name, file_path);
+
+        if (fd >= 0)
+            close(fd);
+
+        return false;
+    }
+
+    do
+    {
+        token = lexer_stream_yield(&stream);
+        token_count += (token.type != CASK_SPACING_TOKEN && token.type != CASK_COMMENT_TOKEN) ? 1U : 0U;
+    } while (token.type != CASK_EOF_TOKEN && token.type != CASK_UNKNOWN_TOKEN);
+
+    bool ok = token.type == CASK_EOF_TOKEN;
+
+    if (ok)
+        printf("%s: %llu tokens\n", file_path, (unsigned long long)token_count);
+    else if (stream.error == CASK_LEXER_STREAM_ERR_NONE)
+        fprintf(stderr, "%s [Error]: %s: unknown token at byte %llu.\n", program_name, file_path, (unsigned long long)token.begin);
+    else
+        fprintf(stderr, "%s [Error]: %s: lex error %i at byte %llu.\n", program_name, file_path, stream.error, (unsigned long long)token.begin);
+
+    lexer_stream_dispose(&stream);
+    close(fd);
+
+    return ok;
+}
 
 int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        fprintf(stderr, "Usage: %s -[h|v|f] <file?> \n", argv[0]);
+        fprintf(stderr, "Usage: %s -[h|v|f|d|p|o|c|j|s] <file or dir?>... \n", argv[0]);
         return 1;
     }
 
     if (!strcmp(argv[1], CASK_OPTION_HELP))
     {
-        printf("Cask Options:\nFor help, use -h\nFor version, use -v\nFor file usage, use -f\n");
+        printf("Cask Options:\nFor help, use -h\nFor version, use -v\nFor file usage, use -f <file or dir>, repeatable, or list files and dirs after the options\nTo print bytecode, add -d\nTo print peephole pattern hits, add -p\nTo save a precompiled " CASK_IMAGE_EXTENSION " image, add -o <file>, or -o <dir> for several files\nTo reuse compiled images of unchanged sources, add -c <cache dir>\nTo set the worker count (default: one per core), add -j <n>\nTo only check tokens, streaming files in constant memory, add -s\n");
         return 0;
     }
 
@@ -45,63 +98,89 @@ int main(int argc, char *argv[])
     opterr = 0;
     int temp_option = -1;
     bool invalid_option = false;
-    char file_path[128];
-    memset(file_path, '\0', 128);
-
-    while (!invalid_option && (temp_option = getopt(argc, argv, "f:")) != -1)
+    bool stream_only = false;
+    BuildOptions options = {
+        .program_name = argv[0],
+        .cache_dir = NULL,
+        .image_path = NULL,
+        .worker_count = 0U,
+        .disassemble = false,
+        .peephole_report = false
+    };
+    Build build;
+    build_init(&build, &options);
+
+    while (!invalid_option && (temp_option = getopt(argc, argv, "f:dpo:c:j:s")) != -1)
     {
         switch (temp_option)
         {
         case 'f':
-            if (strlen(optarg) <= 128)
+            if (!build_add_path(&build, optarg))
             {
-                strncpy(file_path, optarg, 128);
-            }
-            else
-            {
-                invalid_option = true;
+                fprintf(stderr, "%s [Error]: could not read %s.\n", argv[0], optarg);
+                build_dispose(&build);
+                return 1;
             }
             break;
+        case 'd':
+            build.options.disassemble = true;
+            break;
+        case 'p':
+            build.options.peephole_report = true;
+            break;
+        case 'o':
+            build.options.image_path = optarg;
+            break;
+        case 'c':
+            build.options.cache_dir = optarg;
+            break;
+        case 's':
+            stream_only = true;
+            break;
+        case 'j':
+            build.options.worker_count = (uint32_t)strtoul(optarg, NULL, 10);
+            invalid_option = build.options.worker_count == 0U;
+            break;
         default:
             invalid_option = true;
             break;
         }
     }
 
-    if (invalid_option)
+    /// @note Arguments after the options are more files or directories.
+    for (; !invalid_option && optind < argc; optind++)
     {
-        fprintf(stderr, "Usage: %s -[h|v|f] <file?>\n", argv[0]);
-        return 1;
+        if (!build_add_path(&build, argv[optind]))
+        {
+            fprintf(stderr, "%s [Error]: could not read %s.\n", argv[0], argv[optind]);
+            build_dispose(&build);
+            return 1;
+        }
     }
 
-    /// @note Test file loading for now.
-    char *source_buffer = file_load(file_path);
-    char *lexeme = NULL;
-
-    if (!source_buffer)
+    if (invalid_option || build.count == 0U)
     {
-        fprintf(stderr, "%s [Error]: could not read file.\n", argv[0]);
+        fprintf(stderr, "Usage: %s -[h|v|f|d|p|o|c|j|s] <file or dir?>... \n", argv[0]);
+        build_dispose(&build);
         return 1;
     }
 
-    /// @note Test lexer for now!
-    Token temp_token;
-    Lexer lexer;
-    lexer_init(&lexer, source_buffer);
-
-    do
+    /// @note Stream lexing only checks the inputs' tokens, for data files too big to hold in memory.
+    if (stream_only)
     {
-        temp_token = lexer_yield_token(&lexer);
-        lexeme = token_stringify(&temp_token, source_buffer);
+        bool stream_ok = true;
 
-        if (lexeme != NULL)
-        {
-            printf("{type: %i, lexeme: %s}\n", temp_token.type, lexeme);
-            free(lexeme);
-        }
-    } while (temp_token.type != CASK_EOF_TOKEN);
+        for (uint32_t index = 0; index < build.count; index++)
+            stream_ok = caskc_stream_lex(argv[0], build.inputs[index].path) && stream_ok;
+
+        build_dispose(&build);
+        return stream_ok ? 0 : 1;
+    }
+
+    bool ok = build_run(&build);
 
-    free(source_buffer);
+    build_print(&build, stdout, stderr);
+    build_dispose(&build);
 
-    return 0;
+    return ok ? 0 : 1;
 }
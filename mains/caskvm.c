@@ -0,0 +1,199 @@
+/**
+ * @file caskvm.c
+ * @author Derek Tan
+ * @brief Implements the runner program for Cask: compiles a source file, or maps a precompiled image, and runs it on the VM.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frontend/parser.h"
+#include "backend/compiler.h"
+#include "backend/image.h"
+#include "runtime/vm.h"
+
+#define CASK_APPNAME "Cask VM 0.1.0\nBy: Derek Tan"
+
+#define CASK_OPTION_HELP "-h"
+#define CASK_OPTION_VERSION "-v"
+
+static Module *caskvm_compile_file(const char *program_name, const char *file_path)
+{
+    Parser parser;
+    ParserErrorCode parse_code = CASK_PARSER_ERR_NONE;
+    parser_init(&parser);
+
+    if (!parser_use_file(&parser, file_path))
+    {
+        fprintf(stderr, "%s [Error]: could not read file.\n", program_name);
+        return NULL;
+    }
+
+    ProgramUnit *prog_unit = parser_parse(&parser, &parse_code);
+
+    if (!prog_unit)
+    {
+        fprintf(stderr, "%s [Error]: parse error %i at line %u.\n", program_name, parse_code, parser.error_line);
+        return NULL;
+    }
+
+    Compiler compiler;
+    CompileErrorCode compile_code = CASK_COMPILE_ERR_NONE;
+    compiler_init(&compiler);
+
+    Module *module = compiler_compile(&compiler, prog_unit, &compile_code);
+
+    if (!module)
+    {
+        uint32_t name_length = 0U;
+        const char *name = symbol_table_view(&prog_unit->symbols, compiler.error_name, &name_length);
+
+        fprintf(stderr, "%s [Error]: compile error %i near '%.*s'.\n", program_name, compile_code, (int)name_length, (name != NULL) ? name : "");
+    }
+
+    program_unit_dispose(prog_unit);
+    free(prog_unit);
+
+    return module;
+}
+
+static bool caskvm_is_image(const char *file_path)
+{
+    size_t path_length = strlen(file_path);
+    size_t extension_length = strlen(CASK_IMAGE_EXTENSION);
+
+    return path_length > extension_length && !strcmp(file_path + path_length - extension_length, CASK_IMAGE_EXTENSION);
+}
+
+/**
+ * @brief Frees a module from `caskvm_compile_file`, or the image it was loaded from when `image` is not NULL.
+ */
+static void caskvm_release(Module *module, Image *image)
+{
+    if (image != NULL)
+    {
+        image_dispose(image);
+        return;
+    }
+
+    module_dispose(module);
+    free(module);
+}
+
+static void caskvm_report(const char *program_name, const VM *vm, const Module *module)
+{
+    uint32_t name_length = 0U;
+    const char *name = "?";
+
+    if (vm->error_function < module->functions.count)
+        name = module_view_string(module, vector_ref_CodeObject(&module->functions, vm->error_function)->name, &name_length);
+    else
+        name_length = 1U;
+
+    fprintf(stderr, "%s [Error]: runtime error %i in %.*s at %04u.\n", program_name, vm->error, (int)name_length, name, vm->error_offset);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s -[h|v|f] <file?>\n", argv[0]);
+        return 1;
+    }
+
+    if (!strcmp(argv[1], CASK_OPTION_HELP))
+    {
+        printf("Cask VM Options:\nFor help, use -h\nFor version, use -v\nTo run a file, use -f\nFiles ending in " CASK_IMAGE_EXTENSION " run as precompiled images from caskc -o\n");
+        return 0;
+    }
+
+    if (!strcmp(argv[1], CASK_OPTION_VERSION))
+    {
+        printf("%s\n", CASK_APPNAME);
+        return 0;
+    }
+
+    /// @note Omit `getopt()` error messages and replace missing arg values with '?'.
+    opterr = 0;
+    int temp_option = -1;
+    const char *file_path = NULL;
+
+    while ((temp_option = getopt(argc, argv, "f:")) != -1)
+    {
+        if (temp_option != 'f')
+        {
+            fprintf(stderr, "Usage: %s -[h|v|f] <file?>\n", argv[0]);
+            return 1;
+        }
+
+        file_path = optarg;
+    }
+
+    if (!file_path)
+    {
+        fprintf(stderr, "Usage: %s -[h|v|f] <file?>\n", argv[0]);
+        return 1;
+    }
+
+    /// @note Images run straight from their mapping, while sources are compiled first.
+    Image image;
+    bool from_image = caskvm_is_image(file_path);
+    Module *module = NULL;
+
+    if (from_image)
+    {
+        ImageErrorCode image_code = image_load(&image, file_path);
+
+        if (image_code != CASK_IMAGE_ERR_NONE)
+        {
+            fprintf(stderr, "%s [Error]: could not load image, error %i.\n", argv[0], image_code);
+            return 1;
+        }
+
+        module = &image.module;
+    }
+    else if (!(module = caskvm_compile_file(argv[0], file_path)))
+    {
+        return 1;
+    }
+
+    VM vm;
+    Value result = value_nil();
+    int exit_code = 0;
+
+    if (!vm_init(&vm, module))
+    {
+        fprintf(stderr, "%s [Error]: could not set up the VM.\n", argv[0]);
+        caskvm_release(module, from_image ? &image : NULL);
+        return 1;
+    }
+
+    if (module->main_function == CASK_MODULE_NO_FUNCTION)
+    {
+        fprintf(stderr, "%s [Error]: no main function.\n", argv[0]);
+        exit_code = 1;
+    }
+    else if (vm_run(&vm, module->init_function, &result) != CASK_VM_ERR_NONE || vm_run(&vm, module->main_function, &result) != CASK_VM_ERR_NONE)
+    {
+        caskvm_report(argv[0], &vm, module);
+        exit_code = 1;
+    }
+    else if (value_is_int(result))
+    {
+        /// @note `main` returning an int becomes the exit status.
+        exit_code = value_as_int(result);
+    }
+
+    fflush(stdout);
+    vm_dispose(&vm);
+    caskvm_release(module, from_image ? &image : NULL);
+
+    return exit_code;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file test_build.c
+ * @author Derek Tan
+ * @brief Checks that builds compile inputs after their imports, report import cycles, and print the same text for any worker count.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "backend/build.h"
+#include "test_support.h"
+
+#define TEST_MAIN "func main() : int\n    return 0\nend\n"
+
+/**
+ * @brief One source of the test build. `a` fails to compile, so its importers `b` and `c` can only report that if they wait for it. `x` and `y` import each other, and `z` waits behind them.
+ */
+static const struct
+{
+    const char *module;
+    const char *text;
+    const char *error;              // expected in the input's messages, or NULL for a clean compile
+} test_inputs[] = {
+    {"a", "func main() : int\n    return \"not an int\"\nend\n", "compile error 6"},
+    {"b", "from \"a\" import *\n" TEST_MAIN, "an imported module failed to build"},
+    {"c", "from \"b\" import *\n" TEST_MAIN, "an imported module failed to build"},
+    {"v", "func twice(n : int) : int\n    return n * 2\nend\n" TEST_MAIN, NULL},
+    {"w", "from \"io\" import putf\n" TEST_MAIN, NULL},
+    {"x", "from \"y\" import *\n" TEST_MAIN, "import cycle"},
+    {"y", "from \"x\" import *\n" TEST_MAIN, "import cycle"},
+    {"z", "from \"x\" import *\n" TEST_MAIN, "import cycle"}
+};
+
+#define TEST_INPUT_COUNT (sizeof(test_inputs) / sizeof(test_inputs[0]))
+
+static bool test_write_inputs(const char *dir)
+{
+    char path[128];
+    bool ok = true;
+
+    for (size_t index = 0; ok && index < TEST_INPUT_COUNT; index++)
+    {
+        snprintf(path, sizeof(path), "%s/%s%s", dir, test_inputs[index].module, CASK_SOURCE_EXTENSION);
+        ok = file_putblob(path, (const uint8_t *)test_inputs[index].text, strlen(test_inputs[index].text));
+    }
+
+    return ok;
+}
+
+static void test_remove_inputs(const char *dir)
+{
+    char path[128];
+
+    for (size_t index = 0; index < TEST_INPUT_COUNT; index++)
+    {
+        snprintf(path, sizeof(path), "%s/%s%s", dir, test_inputs[index].module, CASK_SOURCE_EXTENSION);
+        remove(path);
+    }
+
+    rmdir(dir);
+}
+
+/**
+ * @brief Checks each input's outcome against its expected error.
+ */
+static bool test_outcomes(const Build *build)
+{
+    bool ok = build->count == TEST_INPUT_COUNT;
+
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        const BuildInput *input = &build->inputs[index];
+        const char *error = NULL;
+        bool found = false;
+
+        for (size_t expected = 0; expected < TEST_INPUT_COUNT; expected++)
+        {
+            if (strlen(test_inputs[expected].module) == input->module_length && !memcmp(test_inputs[expected].module, input->module_name, input->module_length))
+            {
+                error = test_inputs[expected].error;
+                found = true;
+            }
+        }
+
+        bool input_ok = found && ((error != NULL) ? (!input->ok && input->err_text != NULL && strstr(input->err_text, error) != NULL)
+            : (input->ok && input->err_length == 0U));
+
+        printf("%s %.*s: %s\n", input_ok ? "PASS" : "FAIL", (int)input->module_length, input->module_name, (error != NULL) ? error : "compiles");
+
+        if (!input_ok && input->err_text != NULL)
+            fprintf(stderr, "test_build: %s", input->err_text);
+
+        ok = input_ok && ok;
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Builds the directory on some workers with disassembly on, capturing what the build prints.
+ * @return char* The printed text, stdout's then stderr's, or NULL on failure.
+ */
+static char *test_build(const char *dir, uint32_t worker_count, bool check_outcomes, bool *outcomes_ok)
+{
+    BuildOptions options = {.program_name = "test_build", .cache_dir = NULL, .image_path = NULL, .worker_count = worker_count, .disassemble = true, .peephole_report = false};
+    Build build;
+    char *text = NULL;
+    size_t length = 0U;
+    FILE *capture = open_memstream(&text, &length);
+
+    build_init(&build, &options);
+
+    // Some inputs are meant to fail, so the build as a whole does.
+    bool ok = capture != NULL && build_add_path(&build, dir) && !build_run(&build);
+
+    if (ok)
+    {
+        build_print(&build, capture, capture);
+
+        if (check_outcomes)
+            *outcomes_ok = test_outcomes(&build);
+    }
+
+    build_dispose(&build);
+
+    if (capture != NULL)
+        fclose(capture);
+
+    if (!ok)
+    {
+        free(text);
+        return NULL;
+    }
+
+    return text;
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/test_build_XXXXXX";
+    bool outcomes_ok = false;
+    bool ok = mkdtemp(dir) != NULL && test_write_inputs(dir);
+    char *expected = ok ? test_build(dir, 1U, true, &outcomes_ok) : NULL;
+
+    ok = expected != NULL && outcomes_ok;
+
+    // Run each worker count a few times, so different schedules get a chance to show up.
+    for (uint32_t worker_count = 2U; expected != NULL && worker_count <= 8U; worker_count *= 2U)
+    {
+        bool same = true;
+
+        for (uint32_t round = 0; same && round < 5U; round++)
+        {
+            char *actual = test_build(dir, worker_count, false, NULL);
+
+            same = actual != NULL && !strcmp(actual, expected);
+            free(actual);
+        }
+
+        printf("%s same output on %u workers\n", same ? "PASS" : "FAIL", worker_count);
+        ok = same && ok;
+    }
+
+    free(expected);
+    test_remove_inputs(dir);
+
+    return ok ? 0 : 1;
+}
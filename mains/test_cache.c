@@ -0,0 +1,140 @@
+/**
+ * @file test_cache.c
+ * @author Derek Tan
+ * @brief Checks that the compile cache hits on stored entries, misses on new sources, and treats corrupt or truncated entries as misses.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "backend/cache.h"
+#include "test_support.h"
+
+static const char *test_source =
+    "func main() : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < 7)\n"
+    "        s = s + i\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s + 21\n"
+    "end\n";
+
+/// @brief Differs from `test_source` only in its last byte.
+static const char *test_edited_source =
+    "func main() : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < 7)\n"
+    "        s = s + i\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s + 21\n"
+    "end \n";
+
+typedef struct test_cache_t
+{
+    char root[32];
+    char dir[64];                   // made by the first store
+    char entry[128];
+    uint64_t key;
+    int32_t expected;               // what the compiled module's main returns
+} TestCache;
+
+static bool test_report(bool ok, const char *name)
+{
+    printf("%s %s\n", ok ? "PASS" : "FAIL", name);
+
+    return ok;
+}
+
+/**
+ * @brief Loads the entry for a key, telling if it hit and, on a hit, if the cached module runs to the expected result.
+ */
+static bool test_load(const TestCache *cache, uint64_t key, bool *runs_ok)
+{
+    Image image;
+    int32_t result = 0;
+
+    if (!cache_load(cache->dir, key, &image))
+        return false;
+
+    *runs_ok = test_run(&image.module, &result) == CASK_VM_ERR_NONE && result == cache->expected;
+    image_dispose(&image);
+
+    return true;
+}
+
+/**
+ * @brief Flips one byte in the middle of the stored entry, or with `truncate_it`, cuts the entry in half.
+ */
+static bool test_damage(const TestCache *cache, bool truncate_it)
+{
+    FILE *file = fopen(cache->entry, "r+b");
+    bool ok = file != NULL && fseek(file, 0, SEEK_END) == 0;
+    long size = ok ? ftell(file) : -1;
+    int byte = EOF;
+
+    ok = ok && size > 0;
+
+    if (ok && truncate_it)
+        ok = ftruncate(fileno(file), size / 2) == 0;
+    else if (ok)
+    {
+        ok = fseek(file, size / 2, SEEK_SET) == 0 && (byte = fgetc(file)) != EOF && fseek(file, size / 2, SEEK_SET) == 0
+            && fputc(byte ^ 0x10, file) != EOF;
+    }
+
+    if (file != NULL)
+        ok = fclose(file) == 0 && ok;
+
+    return ok;
+}
+
+int main(void)
+{
+    TestCache cache = {.root = "/tmp/test_cache_XXXXXX"};
+    Module *module = test_compile("test_cache", test_source, NULL);
+    bool runs_ok = false;
+    bool ok = module != NULL && mkdtemp(cache.root) != NULL && test_run(module, &cache.expected) == CASK_VM_ERR_NONE;
+
+    if (!ok)
+    {
+        fprintf(stderr, "test_cache: could not set up.\n");
+        return 1;
+    }
+
+    cache.key = cache_key(test_source, strlen(test_source));
+    snprintf(cache.dir, sizeof(cache.dir), "%s/entries", cache.root);
+    snprintf(cache.entry, sizeof(cache.entry), "%s/%016llx%s", cache.dir, (unsigned long long)cache.key, CASK_IMAGE_EXTENSION);
+
+    ok = test_report(!test_load(&cache, cache.key, &runs_ok), "empty cache misses") && ok;
+    ok = test_report(cache_store(cache.dir, cache.key, module) == CASK_IMAGE_ERR_NONE && access(cache.entry, R_OK) == 0, "store makes its directory and entry") && ok;
+
+    runs_ok = false;
+    ok = test_report(test_load(&cache, cache.key, &runs_ok) && runs_ok, "stored entry hits and runs like the compiled module") && ok;
+
+    uint64_t edited_key = cache_key(test_edited_source, strlen(test_edited_source));
+
+    ok = test_report(edited_key != cache.key && !test_load(&cache, edited_key, &runs_ok), "edited source misses") && ok;
+    ok = test_report(test_damage(&cache, false) && !test_load(&cache, cache.key, &runs_ok), "corrupt entry misses") && ok;
+    ok = test_report(cache_store(cache.dir, cache.key, module) == CASK_IMAGE_ERR_NONE && test_load(&cache, cache.key, &runs_ok) && runs_ok,
+        "storing again replaces a corrupt entry") && ok;
+    ok = test_report(test_damage(&cache, true) && !test_load(&cache, cache.key, &runs_ok), "truncated entry misses") && ok;
+
+    remove(cache.entry);
+    rmdir(cache.dir);
+    rmdir(cache.root);
+    module_dispose(module);
+    free(module);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_consteval.c
+ * @author Derek Tan
+ * @brief Checks which pure calls are evaluated ahead of time, and that calls exhausting the step budget or failing stay for the VM to run.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+/// @brief Prepends helpers to `main`. Each helper calls itself on some path, so the inliner leaves calls that were not evaluated countable.
+#define TEST_MAIN(body) \
+    "counter : int = 0\n" \
+    "func fact(n : int) : int\n" \
+    "    if (n < 2)\n" \
+    "        return 1\n" \
+    "    end\n" \
+    "    return n * fact(n - 1)\n" \
+    "end\n" \
+    "func spin(n : int) : int\n" \
+    "    if (n < 0)\n" \
+    "        return spin(0 - n)\n" \
+    "    end\n" \
+    "    i : int = 0\n" \
+    "    while (i < n)\n" \
+    "        i = i + 1\n" \
+    "    end\n" \
+    "    return i\n" \
+    "end\n" \
+    "func divide(a : int, b : int) : int\n" \
+    "    if (a < 0)\n" \
+    "        return divide(0 - a, b)\n" \
+    "    end\n" \
+    "    return a / b\n" \
+    "end\n" \
+    "func half(x : float) : float\n" \
+    "    if (x < 0.0)\n" \
+    "        return half(0.0 - x)\n" \
+    "    end\n" \
+    "    return x / 2.0\n" \
+    "end\n" \
+    "func bump(n : int) : int\n" \
+    "    if (n < 0)\n" \
+    "        return bump(0 - n)\n" \
+    "    end\n" \
+    "    counter = counter + n\n" \
+    "    return counter\n" \
+    "end\n" \
+    "func main() : int\n" body "end\n"
+
+/**
+ * @brief Runs one case, checking main's result or run error and how many calls main kept.
+ */
+static bool test_expect(const char *name, const char *text, int calls, VMErrorCode error, int32_t result)
+{
+    Module *module = test_compile("test_consteval", text, NULL);
+    int32_t actual = 0;
+    int actual_calls = (module != NULL) ? test_count_opcode(module, "main", CASK_BC_CALL) : -1;
+    VMErrorCode run_code = (module != NULL) ? test_run(module, &actual) : CASK_VM_ERR_NONE;
+    bool ok = module != NULL && actual_calls == calls && run_code == error && (error != CASK_VM_ERR_NONE || actual == result);
+
+    printf("%s %s: %i calls kept, run error %i, result %i\n", ok ? "PASS" : "FAIL", name, actual_calls, run_code, actual);
+
+    if (module != NULL)
+    {
+        module_dispose(module);
+        free(module);
+    }
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        const char *text;
+        int calls;
+        VMErrorCode error;
+        int32_t result;
+    } tests[] = {
+        {"recursive call on a literal", TEST_MAIN("    return fact(5)\n"), 0, CASK_VM_ERR_NONE, 120},
+        {"call on a constant local", TEST_MAIN("    n : int = 3 + 3\n    return fact(n)\n"), 0, CASK_VM_ERR_NONE, 720},
+        {"nested calls", TEST_MAIN("    return fact(fact(3))\n"), 0, CASK_VM_ERR_NONE, 720},
+        {"float result", TEST_MAIN("    if (half(-3.0) == 1.5)\n        return 1\n    end\n    return 0\n"), 0, CASK_VM_ERR_NONE, 1},
+        {"loop within the budget", TEST_MAIN("    return spin(1000)\n"), 0, CASK_VM_ERR_NONE, 1000},
+        {"loop past the budget", TEST_MAIN("    return spin(200000) - 199999\n"), 1, CASK_VM_ERR_NONE, 1},
+        {"runtime error left to the VM", TEST_MAIN("    return divide(1, 0)\n"), 1, CASK_VM_ERR_DIVIDE, 0},
+        {"reassigned local", TEST_MAIN("    n : int = 3\n    n = counter + 4\n    return fact(n)\n"), 1, CASK_VM_ERR_NONE, 24},
+        {"impure call", TEST_MAIN("    return bump(2) + bump(3)\n"), 2, CASK_VM_ERR_NONE, 7}
+    };
+    uint32_t failures = 0U;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        if (!test_expect(tests[index].name, tests[index].text, tests[index].calls, tests[index].error, tests[index].result))
+            failures++;
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
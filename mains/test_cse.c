@@ -0,0 +1,107 @@
+/**
+ * @file test_cse.c
+ * @author Derek Tan
+ * @brief Checks that common subexpression elimination merges repeated pure calls and arithmetic, but never impure calls, global reads or array accesses.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+/// @brief `fact` and `bump` call themselves, so the inliner keeps their calls countable. Each `*_twice` function repeats one subexpression in a statement.
+static const char *test_source =
+    "counter : int = 0\n"
+    "func fact(n : int) : int\n"
+    "    if (n < 2)\n"
+    "        return 1\n"
+    "    end\n"
+    "    return n * fact(n - 1)\n"
+    "end\n"
+    "func bump(n : int) : int\n"
+    "    if (n < 0)\n"
+    "        return bump(0 - n)\n"
+    "    end\n"
+    "    counter = counter + 1\n"
+    "    return counter * 10 + n\n"
+    "end\n"
+    "func poke(xs : int[], v : int) : int\n"
+    "    xs[0] = v\n"
+    "    return 0\n"
+    "end\n"
+    "func pure_twice(x : int) : int\n"
+    "    return fact(x) + fact(x)\n"
+    "end\n"
+    "func arith_twice(x : int, y : int) : int\n"
+    "    return (x * y + 3) * (x * y + 3)\n"
+    "end\n"
+    "func impure_twice(x : int) : int\n"
+    "    return bump(x) - bump(x)\n"
+    "end\n"
+    "func global_twice(x : int) : int\n"
+    "    return counter * 3 + bump(x) + counter * 3\n"
+    "end\n"
+    "func access_twice(xs : int[]) : int\n"
+    "    return xs[0] + poke(xs, 5) + xs[0]\n"
+    "end\n"
+    "func main() : int\n"
+    "    if (impure_twice(1) == -10 && global_twice(1) == 46 && access_twice([1]) == 6 && pure_twice(3) == 12 && arith_twice(2, 3) == 81)\n"
+    "        return 1\n"
+    "    end\n"
+    "    return 0\n"
+    "end\n";
+
+/**
+ * @brief Checks how many `opcode` instructions a function kept.
+ */
+static bool test_expect(const Module *module, const char *function, uint8_t opcode, int count)
+{
+    int actual = test_count_opcode(module, function, opcode);
+    bool ok = actual == count;
+
+    printf("%s %s: %i %s, expected %i\n", ok ? "PASS" : "FAIL", function, actual, bytecode_names[opcode], count);
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *function;
+        uint8_t opcode;
+        int count;
+    } tests[] = {
+        {"pure_twice", CASK_BC_CALL, 1},
+        {"arith_twice", CASK_BC_MUL_I32, 2},
+        {"impure_twice", CASK_BC_CALL, 2},
+        {"global_twice", CASK_BC_LOAD_GLOBAL, 2},
+        {"access_twice", CASK_BC_INDEX, 2}
+    };
+    Module *module = test_compile("test_cse", test_source, NULL);
+    uint32_t failures = 0U;
+    int32_t result = 0;
+
+    if (!module)
+        return 1;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        if (!test_expect(module, tests[index].function, tests[index].opcode, tests[index].count))
+            failures++;
+    }
+
+    VMErrorCode error = test_run(module, &result);
+    bool ok = error == CASK_VM_ERR_NONE && result == 1;
+
+    printf("%s results match unmerged evaluation: run error %i, result %i\n", ok ? "PASS" : "FAIL", error, result);
+    failures += ok ? 0U : 1U;
+
+    module_dispose(module);
+    free(module);
+
+    return (failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_fold.c
+ * @author Derek Tan
+ * @brief Checks the results and emitted opcodes of folded constants, dropped identities and the shift rewrites of int factors, edge cases included.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+/// @brief Wraps a body into `main`. Reads of the globals are never folded, so they stand for values known only at runtime.
+#define TEST_MAIN(body) "g : int = -7\nmin : int = 0 - 2147483647 - 1\nh : float = 0.0\nfunc main() : int\n" body "end\n"
+
+/**
+ * @brief Runs one case, checking main's result or run error and how many `opcode` instructions main has.
+ */
+static bool test_expect(const char *name, const char *text, uint8_t opcode, int count, VMErrorCode error, int32_t result)
+{
+    Module *module = test_compile("test_fold", text, NULL);
+    int32_t actual = 0;
+    int actual_count = (module != NULL) ? test_count_opcode(module, "main", opcode) : -1;
+    VMErrorCode run_code = (module != NULL) ? test_run(module, &actual) : CASK_VM_ERR_NONE;
+    bool ok = module != NULL && actual_count == count && run_code == error && (error != CASK_VM_ERR_NONE || actual == result);
+
+    printf("%s %s: %i %s, run error %i, result %i\n", ok ? "PASS" : "FAIL", name, actual_count, bytecode_names[opcode], run_code, actual);
+
+    if (module != NULL)
+    {
+        module_dispose(module);
+        free(module);
+    }
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        const char *text;
+        uint8_t opcode;
+        int count;
+        VMErrorCode error;
+        int32_t result;
+    } tests[] = {
+        {"literal arithmetic", TEST_MAIN("    return 6 * 7 - 2 / 2\n"), CASK_BC_MUL_I32, 0, CASK_VM_ERR_NONE, 41},
+        {"literal overflow wraps", TEST_MAIN("    if (2147483647 + 1 == min)\n        return 1\n    end\n    return 0\n"), CASK_BC_ADD_I32, 0,
+            CASK_VM_ERR_NONE, 1},
+        {"literal INT32_MIN / -1", TEST_MAIN("    if ((0 - 2147483647 - 1) / -1 == min)\n        return 1\n    end\n    return 0\n"), CASK_BC_DIV_I32, 0,
+            CASK_VM_ERR_NONE, 1},
+        {"runtime INT32_MIN / -1", TEST_MAIN("    if (min / -1 == min)\n        return 1\n    end\n    return 0\n"), CASK_BC_DIV_I32, 1, CASK_VM_ERR_NONE, 1},
+        {"literal negative divide", TEST_MAIN("    return -7 / 4\n"), CASK_BC_DIV_I32, 0, CASK_VM_ERR_NONE, -1},
+        {"negative SHR rounds toward zero", TEST_MAIN("    return g / 4\n"), CASK_BC_SHR_I32, 1, CASK_VM_ERR_NONE, -1},
+        {"negative divide keeps no DIV", TEST_MAIN("    return g / 4\n"), CASK_BC_DIV_I32, 0, CASK_VM_ERR_NONE, -1},
+        {"INT32_MIN SHR", TEST_MAIN("    return min / 65536\n"), CASK_BC_SHR_I32, 1, CASK_VM_ERR_NONE, -32768},
+        {"multiply to SHL", TEST_MAIN("    return g * 8\n"), CASK_BC_SHL_I32, 1, CASK_VM_ERR_NONE, -56},
+        {"power on the left to SHL", TEST_MAIN("    return 8 * g\n"), CASK_BC_MUL_I32, 0, CASK_VM_ERR_NONE, -56},
+        {"non-power keeps MUL", TEST_MAIN("    return g * 6\n"), CASK_BC_MUL_I32, 1, CASK_VM_ERR_NONE, -42},
+        {"int identities dropped", TEST_MAIN("    return (g * 1 + 0) / 1 - 0\n"), CASK_BC_ADD_I32, 0, CASK_VM_ERR_NONE, -7},
+        {"float + 0 kept", TEST_MAIN("    x : float = h + 0.0\n    return 0\n"), CASK_BC_ADD_F32, 1, CASK_VM_ERR_NONE, 0},
+        {"divide by zero left to the VM", TEST_MAIN("    return g / 0\n"), CASK_BC_DIV_I32, 1, CASK_VM_ERR_DIVIDE, 0},
+        {"literal divide by zero left to the VM", TEST_MAIN("    return 1 / 0\n"), CASK_BC_DIV_I32, 1, CASK_VM_ERR_DIVIDE, 0}
+    };
+    uint32_t failures = 0U;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        if (!test_expect(tests[index].name, tests[index].text, tests[index].opcode, tests[index].count, tests[index].error, tests[index].result))
+            failures++;
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file test_image.c
+ * @author Derek Tan
+ * @brief Checks that image loading refuses truncated and corrupted images instead of running them, by their checksum and, with the checksum recomputed, by their structure.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "backend/image.h"
+#include "utils/hash.h"
+#include "test_support.h"
+
+/// @brief Uses globals, constants of each kind, natives, calls, shifts and loops, so the image holds every checked kind of operand.
+static const char *test_source =
+    "from \"io\" import putf\n"
+    "total : int = 0\n"
+    "func halve(n : int) : int\n"
+    "    return n / 2\n"
+    "end\n"
+    "func sum(xs : int[]) : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func main() : int\n"
+    "    data : int[] = [4, 8, 15, 16, 23, 42]\n"
+    "    scale : float = 1.5\n"
+    "    total = sum(data) + 100000\n"
+    "    if (total > halve(total))\n"
+    "        putf(\"%i %f\\n\", total, scale)\n"
+    "    end\n"
+    "    return 0\n"
+    "end\n";
+
+typedef struct test_image_t
+{
+    uint8_t *bytes;                 // scratch copy, restored after each corruption
+    const uint8_t *pristine;
+    uint32_t size;
+    ImageHeader header;
+    char path[32];
+} TestImage;
+
+/**
+ * @brief Recomputes the checksum over the first `size` bytes of the scratch image, as the writer would, so only the structural checks are left to refuse it.
+ */
+static void test_seal(TestImage *image, uint32_t size)
+{
+    if (size < sizeof(ImageHeader))
+        return;
+
+    uint64_t checksum = hash_bytes(image->bytes, offsetof(ImageHeader, checksum), CASK_IMAGE_VERSION);
+
+    checksum = hash_bytes(image->bytes + sizeof(ImageHeader), size - sizeof(ImageHeader), checksum);
+    memcpy(image->bytes + offsetof(ImageHeader, checksum), &checksum, sizeof(checksum));
+}
+
+/**
+ * @brief Writes the first `size` bytes of the scratch image and loads them back.
+ */
+static ImageErrorCode test_load(const TestImage *image, uint32_t size)
+{
+    Image loaded;
+
+    if (!file_putblob(image->path, image->bytes, size))
+        return CASK_IMAGE_ERR_IO;
+
+    ImageErrorCode error = image_load(&loaded, image->path);
+
+    if (error == CASK_IMAGE_ERR_NONE)
+        image_dispose(&loaded);
+
+    return error;
+}
+
+/**
+ * @brief Seals and loads the scratch image expecting a structural refusal, then restores it.
+ */
+static bool test_rejects(TestImage *image, uint32_t size, const char *what, uint32_t where)
+{
+    test_seal(image, size);
+
+    ImageErrorCode error = test_load(image, size);
+    bool ok = error != CASK_IMAGE_ERR_NONE && error != CASK_IMAGE_ERR_IO && error != CASK_IMAGE_ERR_CHECKSUM;
+
+    memcpy(image->bytes, image->pristine, image->size);
+
+    if (!ok)
+        fprintf(stderr, "test_image: %s at %u gave error %i.\n", what, where, error);
+
+    return ok;
+}
+
+static void test_flip(TestImage *image, uint32_t offset, uint8_t bit)
+{
+    image->bytes[offset] ^= (uint8_t)(1U << bit);
+}
+
+static ImageFunction test_function(const TestImage *image, uint32_t index)
+{
+    ImageFunction record;
+
+    memcpy(&record, image->pristine + image->header.function_offset + index * sizeof(ImageFunction), sizeof(ImageFunction));
+
+    return record;
+}
+
+/* Corruptions: each group reports how many images it tried, so a group that found nothing to corrupt fails too. */
+
+static uint32_t test_truncate(TestImage *image, bool *ok)
+{
+    const uint32_t sizes[] = {
+        0U, 4U, sizeof(ImageHeader) - 1U, sizeof(ImageHeader), image->header.constant_offset, image->header.code_offset,
+        image->header.code_offset + 1U, image->size / 2U, image->size - 1U
+    };
+    uint32_t tried = 0U;
+
+    for (size_t index = 0; index < sizeof(sizes) / sizeof(sizes[0]); index++, tried += 2U)
+    {
+        *ok = test_rejects(image, sizes[index], "truncation", sizes[index]) && *ok;
+
+        // Again with the size field agreeing, so only the section checks can catch it.
+        if (sizes[index] >= sizeof(ImageHeader))
+            memcpy(image->bytes + offsetof(ImageHeader, size), &sizes[index], sizeof(uint32_t));
+
+        *ok = test_rejects(image, sizes[index], "truncation with its size", sizes[index]) && *ok;
+    }
+
+    return tried;
+}
+
+static uint32_t test_header(TestImage *image, bool *ok)
+{
+    uint32_t tried = 0U;
+
+    // Setting the top bit of any field before the checksum makes a count, offset or index past the image, a wrong magic, version or byte order, or a nonzero reserved word.
+    for (uint32_t offset = 0; offset < offsetof(ImageHeader, checksum); offset += sizeof(uint32_t), tried++)
+    {
+        test_flip(image, offset + 3U, 7U);
+        *ok = test_rejects(image, image->size, "header bit flip", offset) && *ok;
+    }
+
+    const uint32_t offsets[] = {
+        offsetof(ImageHeader, function_offset), offsetof(ImageHeader, constant_offset), offsetof(ImageHeader, string_offset),
+        offsetof(ImageHeader, string_bytes_offset), offsetof(ImageHeader, code_offset)
+    };
+
+    for (size_t index = 0; index < sizeof(offsets) / sizeof(offsets[0]); index++, tried++)
+    {
+        test_flip(image, offsets[index], 0U);
+        *ok = test_rejects(image, image->size, "misaligned section", offsets[index]) && *ok;
+    }
+
+    return tried;
+}
+
+/**
+ * @brief Gives the operand bytes of an instruction that the loader must range check, as a bit mask over the instruction bytes.
+ */
+static uint8_t test_checked_operands(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case CASK_BC_LOAD_LOCAL:
+    case CASK_BC_STORE_LOCAL:
+    case CASK_BC_TEE_LOCAL:
+    case CASK_BC_INC_LOCAL_I32:
+    case CASK_BC_SHL_I32:
+    case CASK_BC_SHR_I32:
+    case CASK_BC_CALL_NATIVE:
+        return 1U << 1;
+    case CASK_BC_LOAD_LOCAL_PAIR:
+    case CASK_BC_PUSH_CONST:
+    case CASK_BC_LOAD_GLOBAL:
+    case CASK_BC_STORE_GLOBAL:
+        return 1U << 2;
+    case CASK_BC_CALL:
+        return (1U << 2) | (1U << 3);
+    default:
+        return 0U;
+    }
+}
+
+/**
+ * @brief Flips a high bit of every checked operand and of every jump offset, one at a time. Small modules keep every index and jump target well below the flipped values.
+ */
+static uint32_t test_code(TestImage *image, bool *ok, uint32_t *jumps)
+{
+    uint32_t tried = 0U;
+
+    for (uint32_t function = 0; function < image->header.function_count; function++)
+    {
+        ImageFunction record = test_function(image, function);
+        uint32_t base = image->header.code_offset + record.code_offset;
+
+        for (uint32_t offset = 0; offset < record.code_size; offset += bytecode_instr_length(image->pristine[base + offset]))
+        {
+            uint8_t opcode = image->pristine[base + offset];
+            uint8_t operands = test_checked_operands(opcode);
+
+            for (uint32_t byte = 1U; byte < 4U; byte++)
+            {
+                if (!(operands & (1U << byte)))
+                    continue;
+
+                // A call's argument count is flipped in its low bit, so it no longer matches the callee's arity.
+                test_flip(image, base + offset + byte, (opcode == CASK_BC_CALL && byte == 3U) ? 0U : 7U);
+                *ok = test_rejects(image, image->size, bytecode_names[opcode], offset) && *ok;
+                tried++;
+            }
+
+            if (bytecode_is_jump(opcode))
+            {
+                test_flip(image, base + offset + 2U, 6U);
+                *ok = test_rejects(image, image->size, bytecode_names[opcode], offset) && *ok;
+                (*jumps)++;
+            }
+        }
+    }
+
+    return tried;
+}
+
+/**
+ * @brief Shrinks each function's slot count to its highest used slot, so that slot is out of range.
+ */
+static uint32_t test_slots(TestImage *image, bool *ok)
+{
+    uint32_t tried = 0U;
+
+    for (uint32_t function = 0; function < image->header.function_count; function++)
+    {
+        ImageFunction record = test_function(image, function);
+        uint32_t base = image->header.code_offset + record.code_offset;
+        int highest = -1;
+
+        for (uint32_t offset = 0; offset < record.code_size; offset += bytecode_instr_length(image->pristine[base + offset]))
+        {
+            uint8_t opcode = image->pristine[base + offset];
+            const uint8_t *operand = image->pristine + base + offset + 1U;
+
+            if (opcode == CASK_BC_LOAD_LOCAL || opcode == CASK_BC_STORE_LOCAL || opcode == CASK_BC_TEE_LOCAL || opcode == CASK_BC_INC_LOCAL_I32
+                || opcode == CASK_BC_LOAD_LOCAL_PAIR)
+                highest = (operand[0] > highest) ? operand[0] : highest;
+
+            if (opcode == CASK_BC_LOAD_LOCAL_PAIR)
+                highest = (operand[1] > highest) ? operand[1] : highest;
+        }
+
+        if (highest < 0)
+            continue;
+
+        image->bytes[image->header.function_offset + function * sizeof(ImageFunction) + offsetof(ImageFunction, slot_count)] = (uint8_t)highest;
+        *ok = test_rejects(image, image->size, "slot count", function) && *ok;
+        tried++;
+    }
+
+    return tried;
+}
+
+/**
+ * @brief Flips one bit in every few bytes from the checksum to the image end without resealing, each of which only the checksum can catch.
+ */
+static uint32_t test_checksum(TestImage *image, bool *ok)
+{
+    uint32_t tried = 0U;
+
+    for (uint32_t offset = offsetof(ImageHeader, checksum); offset < image->size; offset += 5U, tried++)
+    {
+        test_flip(image, offset, (uint8_t)(offset % 8U));
+
+        ImageErrorCode error = test_load(image, image->size);
+
+        memcpy(image->bytes, image->pristine, image->size);
+
+        if (error != CASK_IMAGE_ERR_CHECKSUM)
+        {
+            fprintf(stderr, "test_image: unsealed bit flip at %u gave error %i.\n", offset, error);
+            *ok = false;
+        }
+    }
+
+    return tried;
+}
+
+int main(void)
+{
+    Module *module = test_compile("test_image", test_source, NULL);
+    ByteVector bytes;
+    TestImage image = {.bytes = NULL, .pristine = NULL, .size = 0U, .path = "/tmp/test_image_XXXXXX"};
+    bool ok = module != NULL;
+    int fd = -1;
+
+    vector_init_Byte(&bytes);
+    ok = ok && image_serialize(module, &bytes);
+
+    if (ok)
+    {
+        image.pristine = vector_ref_Byte(&bytes, 0);
+        image.size = bytes.count;
+        image.bytes = malloc(image.size);
+        fd = mkstemp(image.path);
+        ok = image.bytes != NULL && fd >= 0;
+    }
+
+    if (ok)
+    {
+        memcpy(image.bytes, image.pristine, image.size);
+        memcpy(&image.header, image.pristine, sizeof(ImageHeader));
+        ok = test_load(&image, image.size) == CASK_IMAGE_ERR_NONE;
+        printf("%s intact image loads\n", ok ? "PASS" : "FAIL");
+    }
+
+    if (ok)
+    {
+        bool group_ok = true;
+        uint32_t jumps = 0U;
+        uint32_t tried = test_truncate(&image, &group_ok);
+
+        printf("%s truncations (%u images)\n", group_ok ? "PASS" : "FAIL", tried);
+        ok = group_ok;
+
+        group_ok = true;
+        tried = test_checksum(&image, &group_ok);
+        printf("%s stale checksums (%u images)\n", group_ok ? "PASS" : "FAIL", tried);
+        ok = group_ok && ok;
+
+        group_ok = true;
+        tried = test_header(&image, &group_ok);
+        printf("%s header bit flips (%u images)\n", group_ok ? "PASS" : "FAIL", tried);
+        ok = group_ok && ok;
+
+        group_ok = true;
+        tried = test_code(&image, &group_ok, &jumps);
+        group_ok = group_ok && tried > 0U && jumps > 0U;
+        printf("%s operand and jump bit flips (%u operands, %u jumps)\n", group_ok ? "PASS" : "FAIL", tried, jumps);
+        ok = group_ok && ok;
+
+        group_ok = true;
+        tried = test_slots(&image, &group_ok);
+        group_ok = group_ok && tried > 0U;
+        printf("%s slot counts (%u images)\n", group_ok ? "PASS" : "FAIL", tried);
+        ok = group_ok && ok;
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+        unlink(image.path);
+    }
+
+    free(image.bytes);
+    vector_dispose_Byte(&bytes, NULL);
+
+    if (module != NULL)
+    {
+        module_dispose(module);
+        free(module);
+    }
+
+    return ok ? 0 : 1;
+}
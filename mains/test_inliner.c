@@ -0,0 +1,170 @@
+/**
+ * @file test_inliner.c
+ * @author Derek Tan
+ * @brief Checks that inlined calls give the same results as the calls they replaced, over a sweep of arguments.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+#define TEST_ARG_MIN -20
+#define TEST_ARG_MAX 20
+
+/// @brief Each `probe_` function calls small helpers with values under the copy on the operand stack, locals live across it, several returns, no return value, or two copies in one expression.
+static const char *test_source =
+    "g : int = 0\n"
+    "func add_mul(a : int, b : int, c : int) : int\n"
+    "    return a + b * c\n"
+    "end\n"
+    "func clamp(x : int, lo : int, hi : int) : int\n"
+    "    if (x < lo)\n"
+    "        return lo\n"
+    "    end\n"
+    "    if (x > hi)\n"
+    "        return hi\n"
+    "    end\n"
+    "    return x\n"
+    "end\n"
+    "func swap_diff(a : int, b : int) : int\n"
+    "    t : int = a\n"
+    "    a = b\n"
+    "    b = t\n"
+    "    return a - b\n"
+    "end\n"
+    "func set_g(v : int)\n"
+    "    g = v\n"
+    "end\n"
+    "func probe_add_mul(a : int, b : int) : int\n"
+    "    return a + add_mul(a, b, a - b)\n"
+    "end\n"
+    "func probe_clamp(a : int, b : int) : int\n"
+    "    return b * 100 + clamp(a, 0 - b, b)\n"
+    "end\n"
+    "func probe_swap(a : int, b : int) : int\n"
+    "    t : int = a + b\n"
+    "    d : int = swap_diff(a, b)\n"
+    "    return d * 1000 + t + a\n"
+    "end\n"
+    "func probe_global(a : int, b : int) : int\n"
+    "    set_g(a)\n"
+    "    return g + b\n"
+    "end\n"
+    "func probe_twice(a : int, b : int) : int\n"
+    "    return clamp(a, 0, 9) * 10 + clamp(b, 0, 9)\n"
+    "end\n"
+    "func main() : int\n"
+    "    return 0\n"
+    "end\n";
+
+/* Reference results, as the uninlined calls compute them. */
+
+static int32_t test_clamp(int32_t x, int32_t lo, int32_t hi)
+{
+    return (x < lo) ? lo : ((x > hi) ? hi : x);
+}
+
+static int32_t test_probe_add_mul(int32_t a, int32_t b)
+{
+    return a + (a + b * (a - b));
+}
+
+static int32_t test_probe_clamp(int32_t a, int32_t b)
+{
+    return b * 100 + test_clamp(a, -b, b);
+}
+
+static int32_t test_probe_swap(int32_t a, int32_t b)
+{
+    return (b - a) * 1000 + (a + b) + a;
+}
+
+static int32_t test_probe_global(int32_t a, int32_t b)
+{
+    return a + b;
+}
+
+static int32_t test_probe_twice(int32_t a, int32_t b)
+{
+    return test_clamp(a, 0, 9) * 10 + test_clamp(b, 0, 9);
+}
+
+typedef int32_t (*TestReferenceFn)(int32_t a, int32_t b);
+
+/**
+ * @brief Checks that a probe has no calls left and matches its reference on every pair of arguments in range.
+ */
+static bool test_expect(VM *vm, const Module *module, const char *function, TestReferenceFn reference)
+{
+    uint32_t index = test_function_index(module, function);
+    int calls = test_count_opcode(module, function, CASK_BC_CALL);
+    uint32_t mismatches = 0U;
+    bool ok = index != CASK_MODULE_NO_FUNCTION && calls == 0;
+
+    for (int32_t a = TEST_ARG_MIN; ok && a <= TEST_ARG_MAX; a++)
+    {
+        for (int32_t b = TEST_ARG_MIN; b <= TEST_ARG_MAX; b++)
+        {
+            Value args[] = {value_int(a), value_int(b)};
+            Value result = value_nil();
+            VMErrorCode error = vm_call(vm, index, args, 2U, &result);
+
+            if (error != CASK_VM_ERR_NONE || !value_is_int(result) || value_as_int(result) != reference(a, b))
+            {
+                if (mismatches++ == 0U)
+                    fprintf(stderr, "test_inliner: %s(%i, %i) gave error %i, expected %i.\n", function, a, b, error, reference(a, b));
+            }
+        }
+    }
+
+    ok = ok && mismatches == 0U;
+    printf("%s %s: %i calls left, %u mismatches\n", ok ? "PASS" : "FAIL", function, calls, mismatches);
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *function;
+        TestReferenceFn reference;
+    } tests[] = {
+        {"probe_add_mul", test_probe_add_mul},
+        {"probe_clamp", test_probe_clamp},
+        {"probe_swap", test_probe_swap},
+        {"probe_global", test_probe_global},
+        {"probe_twice", test_probe_twice}
+    };
+    Module *module = test_compile("test_inliner", test_source, NULL);
+    Value ignored = value_nil();
+    uint32_t failures = 1U;
+    VM vm;
+
+    if (!module)
+        return 1;
+
+    if (vm_init(&vm, module))
+    {
+        bool ready = vm_run(&vm, module->init_function, &ignored) == CASK_VM_ERR_NONE;
+
+        failures = ready ? 0U : 1U;
+
+        for (size_t index = 0; ready && index < sizeof(tests) / sizeof(tests[0]); index++)
+        {
+            if (!test_expect(&vm, module, tests[index].function, tests[index].reference))
+                failures++;
+        }
+
+        vm_dispose(&vm);
+    }
+
+    module_dispose(module);
+    free(module);
+
+    return (failures == 0U) ? 0 : 1;
+}
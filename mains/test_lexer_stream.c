@@ -0,0 +1,182 @@
+/**
+ * @file test_lexer_stream.c
+ * @author Derek Tan
+ * @brief Checks that the streaming lexer gives the same tokens as the lexer over the whole buffer, with a window small enough that lexemes cross its edge.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "frontend/lexer_stream.h"
+#include "test_support.h"
+
+#define TEST_WINDOW CASK_LEXER_STREAM_WINDOW_MIN
+
+/**
+ * @brief Appends `count` copies of one byte.
+ */
+static bool test_text_repeat(TestText *text, char byte, uint32_t count)
+{
+    bool ok = true;
+
+    for (uint32_t index = 0; ok && index < count; index++)
+        ok = test_text_append(text, &byte, 1U);
+
+    return ok;
+}
+
+/**
+ * @brief Streams the text from a file through a small window, comparing each token with the whole-buffer lexer's. With `too_long`, the stream must instead stop with `CASK_LEXER_STREAM_ERR_TOO_LONG` at the start of a lexeme longer than the window.
+ */
+static bool test_compare(const char *name, const TestText *text, bool too_long)
+{
+    char path[] = "/tmp/test_lexer_stream_XXXXXX";
+    int fd = mkstemp(path);
+    bool ok = fd >= 0 && write(fd, text->data, text->length) == (ssize_t)text->length && lseek(fd, 0, SEEK_SET) == 0;
+    bool stopped = false;
+    uint32_t count = 0U;
+    LexerStream stream = {.window = NULL};
+    Lexer lexer;
+
+    ok = ok && lexer_stream_init(&stream, fd, TEST_WINDOW);
+    lexer_init_view(&lexer, text->data, text->length);
+
+    while (ok)
+    {
+        Token expected = lexer_yield_token(&lexer);
+        StreamToken actual = lexer_stream_yield(&stream);
+
+        if (stream.error != CASK_LEXER_STREAM_ERR_NONE)
+        {
+            // The stream stops where the lexeme's bytes start, which for a string is its opening quote.
+            uint32_t start = expected.begin - ((expected.type == CASK_STRING_TOKEN) ? 1U : 0U);
+
+            stopped = stream.error == CASK_LEXER_STREAM_ERR_TOO_LONG && actual.type == CASK_UNKNOWN_TOKEN && actual.begin == start
+                && expected.length >= TEST_WINDOW - 2U;
+            ok = stopped;
+            break;
+        }
+
+        // Only spacing and comments too long for the window come without their text.
+        bool text_ok = (actual.lexeme != NULL) ? memcmp(actual.lexeme, text->data + expected.begin, expected.length) == 0
+            : (expected.type == CASK_EOF_TOKEN || ((expected.type == CASK_SPACING_TOKEN || expected.type == CASK_COMMENT_TOKEN) && expected.length >= TEST_WINDOW - 2U));
+
+        ok = actual.type == expected.type && actual.begin == expected.begin && actual.length == expected.length && text_ok;
+
+        if (!ok)
+            fprintf(stderr, "test_lexer_stream: %s: token %u differs: type %i/%i, begin %u/%llu, length %u/%llu.\n", name, count, expected.type, actual.type,
+                expected.begin, (unsigned long long)actual.begin, expected.length, (unsigned long long)actual.length);
+
+        count++;
+
+        if (expected.type == CASK_EOF_TOKEN)
+            break;
+    }
+
+    ok = ok && stopped == too_long;
+
+    if (fd >= 0)
+    {
+        lexer_stream_dispose(&stream);
+        close(fd);
+        unlink(path);
+    }
+
+    printf("%s %s (%u tokens%s)\n", ok ? "PASS" : "FAIL", name, count, stopped ? ", then too long" : "");
+
+    return ok;
+}
+
+/* Test sources. */
+
+/**
+ * @brief Identifiers, digits and strings of every length that fits the window, so each one lands across its edge somewhere.
+ */
+static bool test_edges(TestText *text)
+{
+    bool ok = true;
+
+    for (uint32_t length = 1U; ok && length < TEST_WINDOW; length++)
+    {
+        ok = test_text_repeat(text, 'a' + (char)(length % 26U), length) && test_text_put(text, " = ")
+            && test_text_repeat(text, '7', length) && test_text_put(text, " + \"")
+            && test_text_repeat(text, 's', (length < TEST_WINDOW - 2U) ? length : TEST_WINDOW - 2U) && test_text_put(text, "\"\n");
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Comments and spacing from shorter than the window to many windows long, code between them.
+ */
+static bool test_long_skips(TestText *text)
+{
+    bool ok = true;
+
+    for (uint32_t length = TEST_WINDOW - 4U; ok && length < 8U * TEST_WINDOW; length += 13U)
+    {
+        ok = test_text_put(text, "x = (1)#") && test_text_repeat(text, 'c', length) && test_text_put(text, "#y")
+            && test_text_repeat(text, (length % 2U) ? ' ' : '\n', length) && test_text_put(text, "\"z\"");
+    }
+
+    return ok;
+}
+
+static bool test_open_comment(TestText *text)
+{
+    return test_text_put(text, "func f() end #") && test_text_repeat(text, 'c', 5U * TEST_WINDOW);
+}
+
+static bool test_long_identifier(TestText *text)
+{
+    return test_text_put(text, "x : int = 1\nreturn ") && test_text_repeat(text, 'q', 3U * TEST_WINDOW) && test_text_put(text, " + 2\n");
+}
+
+static bool test_long_string(TestText *text)
+{
+    return test_text_put(text, "s : string = \"") && test_text_repeat(text, 's', 2U * TEST_WINDOW) && test_text_put(text, "\"\n");
+}
+
+static bool test_open_string(TestText *text)
+{
+    return test_text_put(text, "s : string = \"") && test_text_repeat(text, 's', TEST_WINDOW);
+}
+
+typedef bool (*TestSourceFn)(TestText *text);
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        TestSourceFn make;
+        bool too_long;
+    } tests[] = {
+        {"lexemes across the window edge", test_edges, false},
+        {"comments and spacing longer than the window", test_long_skips, false},
+        {"long comment open at EOF", test_open_comment, false},
+        {"identifier longer than the window", test_long_identifier, true},
+        {"string longer than the window", test_long_string, true},
+        {"long string open at EOF", test_open_string, true}
+    };
+    uint32_t failures = 0U;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        TestText text = {.data = NULL, .length = 0U, .capacity = 0U};
+
+        if (!tests[index].make(&text) || !test_compare(tests[index].name, &text, tests[index].too_long))
+            failures++;
+
+        free(text.data);
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file test_loops.c
+ * @author Derek Tan
+ * @brief Checks which array accesses in while loops the compiler emits without bounds checks.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+/// @brief Each function indexes `xs` in one loop. Only the `safe_` ones keep their index provably in range.
+static const char *test_source =
+    "func safe_read(xs : int[]) : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func safe_write(xs : int[], v : int)\n"
+    "    i : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        xs[i] = v + i\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "end\n"
+    "func safe_count(xs : int[], k : int) : int\n"
+    "    n : int = length(xs)\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < n && i < k)\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func reassigned_array(xs : int[]) : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        xs = [1]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func variable_start(xs : int[], k : int) : int\n"
+    "    i : int = k\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func negative_start(xs : int[]) : int\n"
+    "    i : int = -1\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func stored_twice(xs : int[]) : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        i = i + 1\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func nested_increment(xs : int[]) : int\n"
+    "    i : int = 0\n"
+    "    s : int = 0\n"
+    "    while (i < length(xs))\n"
+    "        s = s + xs[i]\n"
+    "        if (s > 0)\n"
+    "            i = i + 1\n"
+    "        end\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func main() : int\n"
+    "    return 0\n"
+    "end\n";
+
+/**
+ * @brief Checks that a function's loop got only unchecked accesses when `safe`, or else only checked ones.
+ */
+static bool test_expect(const Module *module, const char *function, bool safe, bool writes)
+{
+    uint8_t checked = writes ? CASK_BC_SET_INDEX : CASK_BC_INDEX;
+    uint8_t unchecked = writes ? CASK_BC_SET_INDEX_UNCHECKED : CASK_BC_INDEX_UNCHECKED;
+    int checked_count = test_count_opcode(module, function, checked);
+    int unchecked_count = test_count_opcode(module, function, unchecked);
+    bool ok = checked_count >= 0 && (safe ? (checked_count == 0 && unchecked_count > 0) : (checked_count > 0 && unchecked_count == 0));
+
+    printf("%s %s: %i %s, %i %s\n", ok ? "PASS" : "FAIL", function, checked_count, bytecode_names[checked], unchecked_count, bytecode_names[unchecked]);
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *function;
+        bool safe;
+        bool writes;
+    } tests[] = {
+        {"safe_read", true, false},
+        {"safe_write", true, true},
+        {"safe_count", true, false},
+        {"reassigned_array", false, false},
+        {"variable_start", false, false},
+        {"negative_start", false, false},
+        {"stored_twice", false, false},
+        {"nested_increment", false, false}
+    };
+    Module *module = test_compile("test_loops", test_source, NULL);
+    uint32_t failures = 0U;
+
+    if (!module)
+        return 1;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        if (!test_expect(module, tests[index].function, tests[index].safe, tests[index].writes))
+            failures++;
+    }
+
+    module_dispose(module);
+    free(module);
+
+    return (failures == 0U) ? 0 : 1;
+}
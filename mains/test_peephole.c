@@ -0,0 +1,180 @@
+/**
+ * @file test_peephole.c
+ * @author Derek Tan
+ * @brief Checks that int comparisons fused into their branches give the same results as the unfused pair, and that no fusion happens where a jump lands between the two.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+#define TEST_ARG_MIN -20
+#define TEST_ARG_MAX 20
+
+#define TEST_COMPARE(name, op) \
+    "func " name "(a : int, b : int) : int\n" \
+    "    if (a " op " b)\n" \
+    "        return 1\n" \
+    "    end\n" \
+    "    return 0\n" \
+    "end\n"
+
+/// @brief `count_up` fuses its loop condition. In `either`, the `||` jumps onto the second comparison's branch, so that pair must stay apart.
+static const char *test_source =
+    TEST_COMPARE("lt", "<")
+    TEST_COMPARE("lte", "<=")
+    TEST_COMPARE("gt", ">")
+    TEST_COMPARE("gte", ">=")
+    TEST_COMPARE("eq", "==")
+    TEST_COMPARE("neq", "!=")
+    "func count_up(a : int, b : int) : int\n"
+    "    i : int = a\n"
+    "    s : int = 0\n"
+    "    while (i <= b)\n"
+    "        s = s + 1\n"
+    "        i = i + 1\n"
+    "    end\n"
+    "    return s\n"
+    "end\n"
+    "func either(a : int, b : int) : int\n"
+    "    if (a == b || a > b + 3)\n"
+    "        return a - b\n"
+    "    end\n"
+    "    if (true)\n"
+    "        return b\n"
+    "    end\n"
+    "    return 0\n"
+    "end\n"
+    "func main() : int\n"
+    "    return 0\n"
+    "end\n";
+
+/* Reference results. */
+
+static int32_t test_lt(int32_t a, int32_t b)
+{
+    return a < b;
+}
+
+static int32_t test_lte(int32_t a, int32_t b)
+{
+    return a <= b;
+}
+
+static int32_t test_gt(int32_t a, int32_t b)
+{
+    return a > b;
+}
+
+static int32_t test_gte(int32_t a, int32_t b)
+{
+    return a >= b;
+}
+
+static int32_t test_eq(int32_t a, int32_t b)
+{
+    return a == b;
+}
+
+static int32_t test_neq(int32_t a, int32_t b)
+{
+    return a != b;
+}
+
+static int32_t test_count_up(int32_t a, int32_t b)
+{
+    return (a <= b) ? b - a + 1 : 0;
+}
+
+static int32_t test_either(int32_t a, int32_t b)
+{
+    return (a == b || a > b + 3) ? a - b : b;
+}
+
+typedef int32_t (*TestReferenceFn)(int32_t a, int32_t b);
+
+/**
+ * @brief Checks how many `opcode` instructions a function has, and that it matches its reference on every pair of arguments in range.
+ */
+static bool test_expect(VM *vm, const Module *module, const char *function, uint8_t opcode, int count, TestReferenceFn reference)
+{
+    uint32_t index = test_function_index(module, function);
+    int actual_count = test_count_opcode(module, function, opcode);
+    uint32_t mismatches = 0U;
+    bool ok = index != CASK_MODULE_NO_FUNCTION && actual_count == count;
+
+    for (int32_t a = TEST_ARG_MIN; index != CASK_MODULE_NO_FUNCTION && a <= TEST_ARG_MAX; a++)
+    {
+        for (int32_t b = TEST_ARG_MIN; b <= TEST_ARG_MAX; b++)
+        {
+            Value args[] = {value_int(a), value_int(b)};
+            Value result = value_nil();
+            VMErrorCode error = vm_call(vm, index, args, 2U, &result);
+
+            if (error != CASK_VM_ERR_NONE || !value_is_int(result) || value_as_int(result) != reference(a, b))
+            {
+                if (mismatches++ == 0U)
+                    fprintf(stderr, "test_peephole: %s(%i, %i) gave error %i, expected %i.\n", function, a, b, error, reference(a, b));
+            }
+        }
+    }
+
+    ok = ok && mismatches == 0U;
+    printf("%s %s: %i %s, %u mismatches\n", ok ? "PASS" : "FAIL", function, actual_count, bytecode_names[opcode], mismatches);
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *function;
+        uint8_t opcode;
+        int count;
+        TestReferenceFn reference;
+    } tests[] = {
+        {"lt", CASK_BC_JUMP_UNLESS_LT_I32, 1, test_lt},
+        {"lte", CASK_BC_JUMP_UNLESS_LTE_I32, 1, test_lte},
+        {"gt", CASK_BC_JUMP_UNLESS_GT_I32, 1, test_gt},
+        {"gte", CASK_BC_JUMP_UNLESS_GTE_I32, 1, test_gte},
+        {"eq", CASK_BC_JUMP_UNLESS_EQ_I32, 1, test_eq},
+        {"neq", CASK_BC_JUMP_UNLESS_NEQ_I32, 1, test_neq},
+        {"lt", CASK_BC_JUMP_IF_FALSE, 0, test_lt},
+        {"count_up", CASK_BC_JUMP_UNLESS_LTE_I32, 1, test_count_up},
+        {"count_up", CASK_BC_LTE_I32, 0, test_count_up},
+        {"either", CASK_BC_GT_I32, 1, test_either},
+        {"either", CASK_BC_PUSH_TRUE, 0, test_either}
+    };
+    Module *module = test_compile("test_peephole", test_source, NULL);
+    Value ignored = value_nil();
+    uint32_t failures = 1U;
+    VM vm;
+
+    if (!module)
+        return 1;
+
+    if (vm_init(&vm, module))
+    {
+        bool ready = vm_run(&vm, module->init_function, &ignored) == CASK_VM_ERR_NONE;
+
+        failures = ready ? 0U : 1U;
+
+        for (size_t index = 0; ready && index < sizeof(tests) / sizeof(tests[0]); index++)
+        {
+            if (!test_expect(&vm, module, tests[index].function, tests[index].opcode, tests[index].count, tests[index].reference))
+                failures++;
+        }
+
+        vm_dispose(&vm);
+    }
+
+    module_dispose(module);
+    free(module);
+
+    return (failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file test_support.c
+ * @author Derek Tan
+ * @brief Implements the helpers shared by the test drivers.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frontend/parser.h"
+#include "test_support.h"
+
+Module *test_compile(const char *name, const char *text, CompileErrorCode *code_out)
+{
+    size_t length = strlen(text);
+    char *copy = malloc(length);
+
+    if (code_out)
+        *code_out = CASK_COMPILE_ERR_NONE;
+
+    if (!copy)
+        return NULL;
+
+    memcpy(copy, text, length);
+
+    SourceFile source = {.data = copy, .length = length, .storage = CASK_SOURCE_HEAP};
+    Parser parser;
+    ParserErrorCode parse_code = CASK_PARSER_ERR_NONE;
+    parser_init(&parser);
+
+    if (!parser_use_source(&parser, &source, name, 1U))
+        return NULL;
+
+    ProgramUnit *unit = parser_parse(&parser, &parse_code);
+
+    if (!unit)
+    {
+        fprintf(stderr, "%s: parse error %i at line %u.\n", name, parse_code, parser.error_line);
+        return NULL;
+    }
+
+    Compiler compiler;
+    CompileErrorCode compile_code = CASK_COMPILE_ERR_NONE;
+    compiler_init(&compiler);
+
+    Module *module = compiler_compile(&compiler, unit, &compile_code);
+
+    if (code_out)
+        *code_out = compile_code;
+    else if (!module)
+        fprintf(stderr, "%s: compile error %i.\n", name, compile_code);
+
+    program_unit_dispose(unit);
+    free(unit);
+
+    return module;
+}
+
+uint32_t test_function_index(const Module *module, const char *function)
+{
+    for (uint32_t index = 0; index < module->functions.count; index++)
+    {
+        uint32_t name_length = 0U;
+        const char *name = module_view_string(module, vector_ref_CodeObject(&module->functions, index)->name, &name_length);
+
+        if (name_length == strlen(function) && memcmp(name, function, name_length) == 0)
+            return index;
+    }
+
+    return CASK_MODULE_NO_FUNCTION;
+}
+
+int test_count_opcode(const Module *module, const char *function, uint8_t opcode)
+{
+    uint32_t index = test_function_index(module, function);
+
+    if (index == CASK_MODULE_NO_FUNCTION)
+        return -1;
+
+    const CodeObject *code = vector_ref_CodeObject(&module->functions, index);
+    const uint8_t *bytes = vector_ref_Byte(&code->code, 0);
+    int count = 0;
+
+    for (uint32_t offset = 0; offset < code->code.count; offset += bytecode_instr_length(bytes[offset]))
+        count += (bytes[offset] == opcode) ? 1 : 0;
+
+    return count;
+}
+
+VMErrorCode test_run(const Module *module, int32_t *result_out)
+{
+    VM vm;
+    Value result = value_nil();
+
+    if (!vm_init(&vm, module))
+        return CASK_VM_ERR_MEMORY;
+
+    VMErrorCode error = vm_run(&vm, module->init_function, &result);
+
+    if (error == CASK_VM_ERR_NONE)
+        error = vm_run(&vm, module->main_function, &result);
+
+    if (error == CASK_VM_ERR_NONE && !value_is_int(result))
+        error = CASK_VM_ERR_TYPE;
+
+    if (error == CASK_VM_ERR_NONE)
+        *result_out = value_as_int(result);
+
+    vm_dispose(&vm);
+
+    return error;
+}
+
+bool test_text_append(TestText *text, const char *part, uint32_t length)
+{
+    if (text->length + length > text->capacity)
+    {
+        uint32_t capacity = (text->capacity > 0U) ? text->capacity : 4096U;
+
+        while (text->length + length > capacity)
+            capacity *= 2U;
+
+        char *data = realloc(text->data, capacity);
+
+        if (!data)
+            return false;
+
+        text->data = data;
+        text->capacity = capacity;
+    }
+
+    memcpy(text->data + text->length, part, length);
+    text->length += length;
+
+    return true;
+}
+
+bool test_text_put(TestText *text, const char *part)
+{
+    return test_text_append(text, part, (uint32_t)strlen(part));
+}
@@ -0,0 +1,48 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "backend/compiler.h"
+#include "runtime/vm.h"
+
+/* Test helper decls, shared by the test drivers. */
+
+/// @brief Growable source text for generated test inputs.
+typedef struct test_text_t
+{
+    char *data;
+    uint32_t length;
+    uint32_t capacity;
+} TestText;
+
+/**
+ * @brief Parses and compiles a source held in memory. Errors are reported under `name`, except compile errors when `code_out` is given to receive them.
+ */
+Module *test_compile(const char *name, const char *text, CompileErrorCode *code_out);
+
+/**
+ * @brief Finds a function by name, or gives `CASK_MODULE_NO_FUNCTION`.
+ */
+uint32_t test_function_index(const Module *module, const char *function);
+
+/**
+ * @brief Counts the instructions with `opcode` in the named function, or gives -1 if there is no such function.
+ */
+int test_count_opcode(const Module *module, const char *function, uint8_t opcode);
+
+/**
+ * @brief Runs a module's init and main functions in a fresh VM.
+ *
+ * @param module
+ * @param result_out Receives what main returned, which must be an int.
+ * @return VMErrorCode The run's error, or `CASK_VM_ERR_TYPE` when main gave no int.
+ */
+VMErrorCode test_run(const Module *module, int32_t *result_out);
+
+bool test_text_append(TestText *text, const char *part, uint32_t length);
+
+bool test_text_put(TestText *text, const char *part);
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file test_token_stream.c
+ * @author Derek Tan
+ * @brief Checks that lexing a large source in parallel chunks gives the same token stream as lexing it in one pass.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frontend/token_stream.h"
+#include "test_support.h"
+
+/// @brief Generated sources reach past the parallel cutoff by this much, so each one is split into several chunks.
+#define TEST_SOURCE_SIZE (4U * CASK_TOKEN_STREAM_PARALLEL_MIN)
+
+/**
+ * @brief Repeats `line` until `size` more bytes were added.
+ */
+static bool test_text_fill(TestText *text, const char *line, uint32_t size)
+{
+    uint32_t target = text->length + size;
+    bool ok = true;
+
+    while (ok && text->length < target)
+        ok = test_text_put(text, line);
+
+    return ok;
+}
+
+/**
+ * @brief Lexes the text once in one pass and once in chunks for several worker counts, and compares the streams token by token.
+ */
+static bool test_compare(const char *name, const TestText *text)
+{
+    Lexer lexer;
+    TokenStream expected;
+    bool ok = token_stream_init(&expected, text->length / 4U);
+
+    lexer_init_view(&lexer, text->data, text->length);
+    ok = ok && token_stream_lex(&expected, &lexer);
+
+    for (uint32_t worker_count = 2U; ok && worker_count <= 8U; worker_count *= 2U)
+    {
+        TokenStream actual;
+
+        lexer_init_view(&lexer, text->data, text->length);
+        ok = token_stream_init(&actual, text->length / 4U) && token_stream_lex_parallel(&actual, &lexer, worker_count);
+        ok = ok && actual.count == expected.count;
+        ok = ok && memcmp(actual.types, expected.types, expected.count * sizeof(uint8_t)) == 0;
+        ok = ok && memcmp(actual.begins, expected.begins, expected.count * sizeof(uint32_t)) == 0;
+        ok = ok && memcmp(actual.lengths, expected.lengths, expected.count * sizeof(uint32_t)) == 0;
+        token_stream_dispose(&actual);
+
+        if (!ok)
+            fprintf(stderr, "test_token_stream: %s: streams differ with %u workers.\n", name, worker_count);
+    }
+
+    token_stream_dispose(&expected);
+    printf("%s %s (%u bytes)\n", ok ? "PASS" : "FAIL", name, text->length);
+
+    return ok;
+}
+
+/* Test sources: the text inside comments and strings would lex as other tokens, or as unknown ones, if a chunk were started in the wrong state. */
+
+static const char *test_code_line = "count : int = total + 42 * (step - 7) # tally #\n";
+static const char *test_comment_line = "say \"hi\" to x @ y, then 123 more\n";
+static const char *test_string_line = "text # not a comment @ nor ( code )\n";
+
+static bool test_plain(TestText *text)
+{
+    return test_text_fill(text, test_code_line, TEST_SOURCE_SIZE);
+}
+
+static bool test_long_comment(TestText *text)
+{
+    return test_text_fill(text, test_code_line, CASK_TOKEN_STREAM_CHUNK_MIN) && test_text_put(text, "#") && test_text_fill(text, test_comment_line, 3U * CASK_TOKEN_STREAM_PARALLEL_MIN / 2U) && test_text_put(text, "#\n") && test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U);
+}
+
+static bool test_long_string(TestText *text)
+{
+    return test_text_fill(text, test_code_line, CASK_TOKEN_STREAM_CHUNK_MIN) && test_text_put(text, "note : string = \"") && test_text_fill(text, test_string_line, 3U * CASK_TOKEN_STREAM_PARALLEL_MIN / 2U) && test_text_put(text, "\"\n") && test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U);
+}
+
+static bool test_open_string(TestText *text)
+{
+    return test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U) && test_text_put(text, "note : string = \"") && test_text_fill(text, test_string_line, TEST_SOURCE_SIZE / 2U);
+}
+
+static bool test_open_comment(TestText *text)
+{
+    return test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U) && test_text_put(text, "#") && test_text_fill(text, test_comment_line, TEST_SOURCE_SIZE / 2U);
+}
+
+static bool test_unknown_late(TestText *text)
+{
+    return test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U) && test_text_put(text, "count = @\n") && test_text_fill(text, test_code_line, TEST_SOURCE_SIZE / 2U);
+}
+
+/**
+ * @brief Mixes short comments and strings, some holding bytes that are unknown outside them, so that chunk starts land in every state.
+ */
+static bool test_mixed(TestText *text)
+{
+    static const char *lines[] = {
+        "x : int = 1 # short #\n",
+        "#\n@ spans @\nlines #\n",
+        "s : string = \"one\nand @ two\"\n",
+        "f(a, b) [1] {2} < <= = == !=\n",
+        "\"#\" # \" #\n"
+    };
+    uint32_t state = 12345U;
+    bool ok = true;
+
+    while (ok && text->length < TEST_SOURCE_SIZE)
+    {
+        state = state * 1103515245U + 12345U;
+        ok = test_text_put(text, lines[(state >> 16) % (sizeof(lines) / sizeof(lines[0]))]);
+    }
+
+    return ok;
+}
+
+typedef bool (*TestSourceFn)(TestText *text);
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        TestSourceFn make;
+    } tests[] = {
+        {"plain code", test_plain},
+        {"comment across chunks", test_long_comment},
+        {"string across chunks", test_long_string},
+        {"unterminated string at EOF", test_open_string},
+        {"unterminated comment at EOF", test_open_comment},
+        {"unknown token after chunk bounds", test_unknown_late},
+        {"mixed comments and strings", test_mixed}
+    };
+    uint32_t failures = 0U;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        TestText text = {.data = NULL, .length = 0U, .capacity = 0U};
+
+        if (!tests[index].make(&text) || !test_compare(tests[index].name, &text))
+            failures++;
+
+        free(text.data);
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
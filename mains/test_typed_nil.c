@@ -0,0 +1,136 @@
+/**
+ * @file test_typed_nil.c
+ * @author Derek Tan
+ * @brief Checks that nil never reaches a typed opcode as its declared type: typed functions may not fall off their end, and string concatenation tests its operands.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "test_support.h"
+
+/* Test sources: each main returns an int, so results need no output. */
+
+static const char *test_nil_concat =
+    "func main() : int\n"
+    "    s : string = nil\n"
+    "    t : string = s + \"a\"\n"
+    "    return 0\n"
+    "end\n";
+
+static const char *test_string_fall_through =
+    "func f(n : string) : string\n"
+    "    if (n == \"x\")\n"
+    "        return \"y\"\n"
+    "    end\n"
+    "end\n"
+    "func main() : int\n"
+    "    t : string = f(\"z\") + \"!\"\n"
+    "    return 0\n"
+    "end\n";
+
+static const char *test_int_fall_through =
+    "func f(n : int) : int\n"
+    "    if (n > 0)\n"
+    "        return n\n"
+    "    end\n"
+    "end\n"
+    "func main() : int\n"
+    "    return f(-1) + 1\n"
+    "end\n";
+
+static const char *test_loop_fall_through =
+    "func f(n : int) : int\n"
+    "    while (n > 0)\n"
+    "        return n\n"
+    "    end\n"
+    "end\n"
+    "func main() : int\n"
+    "    return f(1)\n"
+    "end\n";
+
+static const char *test_both_branches =
+    "func f(n : int) : int\n"
+    "    if (n > 0)\n"
+    "        return n\n"
+    "    else\n"
+    "        return 0 - n\n"
+    "    end\n"
+    "end\n"
+    "func g(n : int)\n"
+    "    if (n > 0)\n"
+    "        return\n"
+    "    end\n"
+    "end\n"
+    "func main() : int\n"
+    "    g(1)\n"
+    "    return f(-1) + 1\n"
+    "end\n";
+
+static const char *test_nil_compare =
+    "func main() : int\n"
+    "    s : string = nil\n"
+    "    if (s == \"a\" || s != \"b\")\n"
+    "        return 3\n"
+    "    end\n"
+    "    return 4\n"
+    "end\n";
+
+/**
+ * @brief Compiles and runs a source, expecting either a compile error, or else a run ending with `error` and, when it succeeds, `result` from main.
+ */
+static bool test_expect(const char *name, const char *text, CompileErrorCode compile_error, VMErrorCode error, int32_t result)
+{
+    CompileErrorCode compile_code = CASK_COMPILE_ERR_NONE;
+    Module *module = test_compile("test_typed_nil", text, &compile_code);
+    VMErrorCode run_code = CASK_VM_ERR_NONE;
+    int32_t actual = 0;
+    bool ok = compile_code == compile_error && (module != NULL) == (compile_error == CASK_COMPILE_ERR_NONE);
+
+    if (ok && module != NULL)
+    {
+        run_code = test_run(module, &actual);
+        ok = run_code == error && (error != CASK_VM_ERR_NONE || actual == result);
+    }
+
+    printf("%s %s: compile error %i, run error %i, result %i\n", ok ? "PASS" : "FAIL", name, compile_code, run_code, actual);
+
+    if (module != NULL)
+    {
+        module_dispose(module);
+        free(module);
+    }
+
+    return ok;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        const char **text;
+        CompileErrorCode compile_error;
+        VMErrorCode error;
+        int32_t result;
+    } tests[] = {
+        {"nil string concatenation", &test_nil_concat, CASK_COMPILE_ERR_NONE, CASK_VM_ERR_TYPE, 0},
+        {"string function falls off its end", &test_string_fall_through, CASK_COMPILE_ERR_MISSING_RETURN, CASK_VM_ERR_NONE, 0},
+        {"int function falls off its end", &test_int_fall_through, CASK_COMPILE_ERR_MISSING_RETURN, CASK_VM_ERR_NONE, 0},
+        {"return only inside a loop", &test_loop_fall_through, CASK_COMPILE_ERR_MISSING_RETURN, CASK_VM_ERR_NONE, 0},
+        {"both branches return", &test_both_branches, CASK_COMPILE_ERR_NONE, CASK_VM_ERR_NONE, 2},
+        {"nil string comparison", &test_nil_compare, CASK_COMPILE_ERR_NONE, CASK_VM_ERR_NONE, 3}
+    };
+    uint32_t failures = 0U;
+
+    for (size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index++)
+    {
+        if (!test_expect(tests[index].name, *tests[index].text, tests[index].compile_error, tests[index].error, tests[index].result))
+            failures++;
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
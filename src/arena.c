@@ -0,0 +1,133 @@
+/**
+ * @file arena.c
+ * @author Derek Tan
+ * @brief Implements the bump allocator used for AST and other front-end memory.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/arena.h"
+
+static size_t arena_align_size(size_t size)
+{
+    return (size + CASK_ARENA_ALIGNMENT - 1) & ~(CASK_ARENA_ALIGNMENT - 1);
+}
+
+static ArenaBlock *arena_block_create(size_t capacity)
+{
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+
+    if (block != NULL)
+    {
+        block->next = NULL;
+        block->used = 0;
+        block->capacity = capacity;
+    }
+
+    return block;
+}
+
+void arena_init(Arena *arena, size_t block_size)
+{
+    arena->head = NULL;
+    arena->block_size = arena_align_size(block_size);
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size_t aligned_size = arena_align_size(size);
+    ArenaBlock *head = arena->head;
+
+    if (head != NULL && head->capacity - head->used >= aligned_size)
+    {
+        void *result = (char *)head->data + head->used;
+        head->used += aligned_size;
+        return result;
+    }
+
+    /// @note Oversized requests get a dedicated block behind the head so the current bump block keeps its free space.
+    if (head != NULL && aligned_size > arena->block_size / 2)
+    {
+        ArenaBlock *solo = arena_block_create(aligned_size);
+
+        if (!solo)
+            return NULL;
+
+        solo->used = aligned_size;
+        solo->next = head->next;
+        head->next = solo;
+
+        return solo->data;
+    }
+
+    size_t capacity = (aligned_size > arena->block_size) ? aligned_size : arena->block_size;
+    ArenaBlock *fresh = arena_block_create(capacity);
+
+    if (!fresh)
+        return NULL;
+
+    fresh->used = aligned_size;
+    fresh->next = head;
+    arena->head = fresh;
+
+    return fresh->data;
+}
+
+void *arena_grow(Arena *arena, void *old_ptr, size_t old_size, size_t new_size)
+{
+    if (!old_ptr)
+        return arena_alloc(arena, new_size);
+
+    if (new_size <= old_size)
+        return old_ptr;
+
+    ArenaBlock *head = arena->head;
+    size_t old_aligned = arena_align_size(old_size);
+    size_t new_aligned = arena_align_size(new_size);
+
+    // Extend in place when the old allocation is the last one bumped from the head block.
+    if (head != NULL && (char *)old_ptr + old_aligned == (char *)head->data + head->used
+        && head->capacity - (head->used - old_aligned) >= new_aligned)
+    {
+        head->used += new_aligned - old_aligned;
+        return old_ptr;
+    }
+
+    void *new_ptr = arena_alloc(arena, new_size);
+
+    if (new_ptr != NULL)
+        memcpy(new_ptr, old_ptr, old_size);
+
+    return new_ptr;
+}
+
+char *arena_strndup(Arena *arena, const char *source, size_t length)
+{
+    char *copy = arena_alloc(arena, length + 1);
+
+    if (copy != NULL)
+    {
+        memcpy(copy, source, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+void arena_dispose(Arena *arena)
+{
+    ArenaBlock *cursor = arena->head;
+
+    while (cursor != NULL)
+    {
+        ArenaBlock *next = cursor->next;
+        free(cursor);
+        cursor = next;
+    }
+
+    arena->head = NULL;
+}
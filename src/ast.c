@@ -2,42 +2,32 @@
  * @file ast.c
  * @author Derek Tan
  * @brief Implements AST interface and helper functions.
- * @todo Implement import AST node.
- * @todo Implement ProgramUnit funcs.
  * @date 2023-12-27
  * 
  * @copyright Copyright (c) 2023
  * 
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "syntax/ast.h"
 
-/* AST Vector impls. */
-
-CASK_FN_VECTOR_INIT(Expression)
-
-CASK_FN_VECTOR_GET_PTR(Expression)
-
-CASK_FN_VECTOR_APPEND(Expression)
-
-CASK_FN_VECTOR_DISPOSE(Expression)
-
-CASK_FN_VECTOR_INIT(Statement)
-
-CASK_FN_VECTOR_GET_PTR(Statement)
-
-CASK_FN_VECTOR_APPEND(Statement)
-
-CASK_FN_VECTOR_DISPOSE(Statement)
-
 /* Expression impls. */
 
+static void expression_clear_annotations(Expression *expr)
+{
+    expr->type_mask = CASK_TYPE_MASK(CASK_COMPTYPE_UNKNOWN, CASK_DATATYPE_UNKNOWN);
+    expr->type_name = CASK_SYMBOL_NONE;
+    expr->temp_def = 0U;
+}
+
 void expression_init_special_ltrl(Expression *expr, bool is_nil, bool bool_flag)
 {
     expr->contents.special.boolean = bool_flag;
     expr->contents.special.is_nil = is_nil;
     expr->type = CASK_EXPR_LITERAL_SPECIAL;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
 void expression_init_integer_ltrl(Expression *expr, int32_t value)
@@ -45,6 +35,7 @@ void expression_init_integer_ltrl(Expression *expr, int32_t value)
     expr->contents.integer.value = value;
     expr->type = CASK_EXPR_LITERAL_INTEGER;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
 void expression_init_realnum_ltrl(Expression *expr, float value)
@@ -52,6 +43,7 @@ void expression_init_realnum_ltrl(Expression *expr, float value)
     expr->contents.realnum.value = value;
     expr->type = CASK_EXPR_LITERAL_FLOAT;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
 void expression_init_array_ltrl(Expression *expr)
@@ -59,6 +51,7 @@ void expression_init_array_ltrl(Expression *expr)
     vector_init_Expression(&expr->contents.array.values);
     expr->type = CASK_EXPR_LITERAL_ARRAY;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
 void expression_init_aggr_ltrl(Expression *expr)
@@ -66,12 +59,32 @@ void expression_init_aggr_ltrl(Expression *expr)
     vector_init_Expression(&expr->contents.aggregate.literals);
     expr->type = CASK_EXPR_LITERAL_AGGREGATE;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_identifier_ltrl(Expression *expr, char *name)
+void expression_init_string_ltrl(Expression *expr, SymbolID value)
+{
+    expr->contents.string.value = value;
+    expr->type = CASK_EXPR_LITERAL_STRING;
+    expr->is_lvalue = false;
+    expression_clear_annotations(expr);
+}
+
+void expression_init_identifier_ltrl(Expression *expr, SymbolID name)
 {
     expr->contents.identifier.name = name;
     expr->type = CASK_EXPR_IDENTIFIER;
+    expr->is_lvalue = true;
+    expression_clear_annotations(expr);
+}
+
+void expression_init_call(Expression *expr, SymbolID name)
+{
+    vector_init_Expression(&expr->contents.call.args);
+    expr->contents.call.name = name;
+    expr->type = CASK_EXPR_CALL;
+    expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
 void expression_init_access(Expression *expr, Expression *target, Expression *key, bool has_aggr)
@@ -79,152 +92,142 @@ void expression_init_access(Expression *expr, Expression *target, Expression *ke
     expr->contents.access.target = target;
     expr->contents.access.key = key;
     expr->contents.access.has_aggr = has_aggr;
+    expr->contents.access.in_bounds = false;
     expr->type = CASK_EXPR_ACCESS;
+    expr->is_lvalue = true;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_term(Expression *expr, Expression *left, Expression *right, char op)
+void expression_init_term(Expression *expr, Expression *left, Expression *right, OperatorType op)
 {
     expr->contents.term.left = left;
     expr->contents.term.right = right;
     expr->contents.term.op = op;
     expr->type = CASK_EXPR_TERM;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_factor(Expression *expr, Expression *left, Expression *right, char op)
+void expression_init_factor(Expression *expr, Expression *left, Expression *right, OperatorType op)
 {
     expr->contents.factor.left = left;
     expr->contents.factor.right = right;
     expr->contents.factor.op = op;
     expr->type = CASK_EXPR_FACTOR;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_comparison(Expression *expr, Expression *left, Expression *right, char op)
+void expression_init_comparison(Expression *expr, Expression *left, Expression *right, OperatorType op)
 {
     expr->contents.comparison.left = left;
     expr->contents.comparison.right = right;
     expr->contents.comparison.op = op;
     expr->type = CASK_EXPR_COMPARISON;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_equality(Expression *expr, Expression *left, Expression *right, char op)
+void expression_init_equality(Expression *expr, Expression *left, Expression *right, OperatorType op)
 {
     expr->contents.equality.left = left;
     expr->contents.equality.right = right;
     expr->contents.equality.op = op;
     expr->type = CASK_EXPR_EQUALITY;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-void expression_init_conditional(Expression *expr, Expression *left, Expression *right, char op)
+void expression_init_conditional(Expression *expr, Expression *left, Expression *right, OperatorType op)
 {
     expr->contents.conditional.left = left;
     expr->contents.conditional.right = right;
     expr->contents.conditional.op = op;
     expr->type = CASK_EXPR_CONDITIONAL;
     expr->is_lvalue = false;
+    expression_clear_annotations(expr);
+}
+
+void expression_init_temp(Expression *expr, uint8_t index)
+{
+    expr->contents.temp.index = index;
+    expr->type = CASK_EXPR_TEMP;
+    expr->is_lvalue = false;
+    expression_clear_annotations(expr);
+}
+
+void expression_init_binary(Expression *expr, ExpressionType type, Expression *left, Expression *right, OperatorType op)
+{
+    expr->contents.term.left = left;
+    expr->contents.term.right = right;
+    expr->contents.term.op = op;
+    expr->type = type;
+    expr->is_lvalue = false;
+    expression_clear_annotations(expr);
 }
 
-bool expression_append_child(Expression *expr, ExpressionType type, Expression *child)
+bool expression_append_child(Expression *expr, Arena *arena, ExpressionType type, Expression *child)
 {
     if (type == CASK_EXPR_LITERAL_ARRAY)
-        return vector_append_Expression(&expr->contents.array.values, child);
+        return vector_append_Expression(&expr->contents.array.values, arena, child);
 
     if (type == CASK_EXPR_LITERAL_AGGREGATE)
-        return vector_append_Expression(&expr->contents.aggregate.literals, child);
+        return vector_append_Expression(&expr->contents.aggregate.literals, arena, child);
 
-    return false;
-}
+    if (type == CASK_EXPR_CALL)
+        return vector_append_Expression(&expr->contents.call.args, arena, child);
 
-void expression_dispose(Expression *expr)
-{
-    switch (expr->type)
-    {
-    case CASK_EXPR_LITERAL_SPECIAL:
-    case CASK_EXPR_LITERAL_INTEGER:
-    case CASK_EXPR_LITERAL_FLOAT:
-    case CASK_EXPR_LITERAL_STRING:
-        free(expr);
-        break;
-    case CASK_EXPR_LITERAL_ARRAY:
-        vector_dispose_Expression(&expr->contents.array.values, expression_dispose); /// @note Ignore inner memory since it will be reclaimed by the Cask VM.
-        break;
-    case CASK_EXPR_LITERAL_AGGREGATE:
-        vector_dispose_Expression(&expr->contents.aggregate.literals, expression_dispose);
-        break;
-    case CASK_EXPR_ACCESS:
-        expression_dispose(expr->contents.access.key);
-        expression_dispose(expr->contents.access.target);
-        break;
-    case CASK_EXPR_TERM:
-        expression_dispose(expr->contents.term.left);
-        expression_dispose(expr->contents.term.right);
-        break;
-    case CASK_EXPR_FACTOR:
-        expression_dispose(expr->contents.factor.left);
-        expression_dispose(expr->contents.factor.right);
-        break;
-    case CASK_EXPR_COMPARISON:
-        expression_dispose(expr->contents.comparison.left);
-        expression_dispose(expr->contents.comparison.right);
-        break;
-    case CASK_EXPR_EQUALITY:
-        expression_dispose(expr->contents.equality.left);
-        expression_dispose(expr->contents.equality.right);
-        break;
-    case CASK_EXPR_CONDITIONAL:
-        expression_dispose(expr->contents.conditional.left);
-        expression_dispose(expr->contents.conditional.right);
-        break;
-    default:
-        break;
-    }
+    return false;
 }
 
 /* Statement impl. */
 
-void statement_init_import(Statement *stmt, char *module_name)
+void statement_init_import(Statement *stmt, SymbolID module_name)
 {
     vector_init_Expression(&stmt->contents.import.items);
+    stmt->contents.import.name = module_name;
     stmt->type = CASK_STMT_IMPORT;
 }
 
-void statement_init_prim_decl(Statement *stmt, char *name, Expression *value, CompositeType high_type, DataType low_type)
+void statement_init_prim_decl(Statement *stmt, SymbolID name, Expression *value, CompositeType high_type, DataType low_type, SymbolID type_name)
 {
     stmt->contents.prim_decl.name = name;
     stmt->contents.prim_decl.value = value;
-    stmt->contents.prim_decl.type_mask = (high_type << 8) + low_type;
+    stmt->contents.prim_decl.type_mask = CASK_TYPE_MASK(high_type, low_type);
+    stmt->contents.prim_decl.type_name = type_name;
     stmt->type = CASK_STMT_PRIMITIVE_DECL;
 }
 
-void statement_init_field_decl(Statement *stmt, char *name, CompositeType high_type, DataType lower_type)
+void statement_init_field_decl(Statement *stmt, SymbolID name, CompositeType high_type, DataType lower_type, SymbolID type_name)
 {
     stmt->contents.field_decl.name = name;
-    stmt->contents.field_decl.type_mask = (high_type << 8) + lower_type;
+    stmt->contents.field_decl.type_mask = CASK_TYPE_MASK(high_type, lower_type);
+    stmt->contents.field_decl.type_name = type_name;
     stmt->type = CASK_STMT_FIELD_DECL;
 }
 
-void statement_init_aggr_decl(Statement *stmt, char *name)
+void statement_init_aggr_decl(Statement *stmt, SymbolID name)
 {
     vector_init_Statement(&stmt->contents.aggr_decl.members);
     stmt->contents.aggr_decl.name = name;
     stmt->type = CASK_STMT_AGGREGATE_DECL;
 }
 
-void statement_init_func_decl(Statement *stmt, char *name, Statement *block)
+void statement_init_func_decl(Statement *stmt, SymbolID name, Statement *block)
 {
     vector_init_Statement(&stmt->contents.func_decl.params);
     stmt->contents.func_decl.block = block;
     stmt->contents.func_decl.name = name;
+    stmt->contents.func_decl.type_mask = CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_NIL);
+    stmt->contents.func_decl.type_name = CASK_SYMBOL_NONE;
     stmt->type = CASK_STMT_FUNCTION_DECL;
 }
 
-void statement_init_param_decl(Statement *stmt, char *name, CompositeType high_type, DataType low_type)
+void statement_init_param_decl(Statement *stmt, SymbolID name, CompositeType high_type, DataType low_type, SymbolID type_name)
 {
     stmt->contents.param_decl.name = name;
-    stmt->contents.param_decl.type_mask = (high_type << 8) + low_type;
+    stmt->contents.param_decl.type_mask = CASK_TYPE_MASK(high_type, low_type);
+    stmt->contents.param_decl.type_name = type_name;
     stmt->type = CASK_STMT_PARAMETER_DECL;
 }
 
@@ -235,9 +238,10 @@ void statement_init_while_ctrl(Statement *stmt, Expression *conditional, Stateme
     stmt->type = CASK_STMT_WHILE;
 }
 
-void statement_init_if_ctrl(Statement *stmt, Expression *conditional, Statement *block)
+void statement_init_if_ctrl(Statement *stmt, Expression *conditional, Statement *block, Statement *other)
 {
     stmt->contents.if_ctrl.block = block;
+    stmt->contents.if_ctrl.other = other;
     stmt->contents.if_ctrl.condition = conditional;
     stmt->type = CASK_STMT_IF;
 }
@@ -245,7 +249,6 @@ void statement_init_if_ctrl(Statement *stmt, Expression *conditional, Statement
 void statement_init_else_ctrl(Statement *stmt, Statement *block)
 {
     stmt->contents.else_ctrl.block = block;
-    vector_init_Statement(stmt->contents.else_ctrl.block);
     stmt->type = CASK_STMT_ELSE;
 }
 
@@ -255,91 +258,119 @@ void statement_init_block(Statement *stmt)
     stmt->type = CASK_STMT_BLOCK;
 }
 
-bool statement_append_child(Statement *stmt, Statement *child)
+void statement_init_return(Statement *stmt, Expression *value)
+{
+    stmt->contents.return_stmt.value = value;
+    stmt->type = CASK_STMT_RETURN;
+}
+
+void statement_init_reassign(Statement *stmt, Expression *target, Expression *value)
+{
+    stmt->contents.reassign.target = target;
+    stmt->contents.reassign.value = value;
+    stmt->type = CASK_STMT_REASSIGN;
+}
+
+void statement_init_expr_stmt(Statement *stmt, Expression *expr)
+{
+    stmt->contents.expr_stmt.expr = expr;
+    stmt->type = CASK_STMT_EXPR;
+}
+
+bool statement_append_child(Statement *stmt, Arena *arena, Statement *child)
 {
     if (stmt->type == CASK_STMT_AGGREGATE_DECL)
-        return vector_append_Statement(&stmt->contents.aggr_decl.members, child);
+        return vector_append_Statement(&stmt->contents.aggr_decl.members, arena, child);
 
     if (stmt->type == CASK_STMT_FUNCTION_DECL && child->type == CASK_STMT_PARAMETER_DECL)
-        return vector_append_Statement(&stmt->contents.func_decl.params, child);
+        return vector_append_Statement(&stmt->contents.func_decl.params, arena, child);
     
     if (stmt->type == CASK_STMT_BLOCK)
-        return vector_append_Statement(&stmt->contents.block.stmts, child);
+        return vector_append_Statement(&stmt->contents.block.stmts, arena, child);
 
     return false;
 }
 
-uint8_t statement_decode_comptype(const Statement *stmt)
+bool statement_append_import(Statement *stmt, Arena *arena, Expression *item)
 {
-    if (stmt->type == CASK_STMT_PRIMITIVE_DECL)
-    {
-        return (stmt->contents.prim_decl.type_mask & (0xff << 8)) >> 8;
-    }
-
-    if (stmt->type == CASK_STMT_PARAMETER_DECL)
-    {
-        return (stmt->contents.param_decl.type_mask & (0xff << 8)) >> 8;
-    }
+    if (stmt->type != CASK_STMT_IMPORT)
+        return false;
 
-    return CASK_COMPTYPE_UNKNOWN;
+    return vector_append_Expression(&stmt->contents.import.items, arena, item);
 }
 
-uint8_t statement_decode_datatype(const Statement *stmt)
+/**
+ * @brief Fetches the packed declared type of a declaration statement, or false for statements without one.
+ */
+static bool statement_get_type_mask(const Statement *stmt, uint16_t *type_mask)
 {
-    if (stmt->type == CASK_STMT_PRIMITIVE_DECL)
+    switch (stmt->type)
     {
-        return (stmt->contents.prim_decl.type_mask & 0xff);
+    case CASK_STMT_PRIMITIVE_DECL:
+        *type_mask = stmt->contents.prim_decl.type_mask;
+        return true;
+    case CASK_STMT_FIELD_DECL:
+        *type_mask = stmt->contents.field_decl.type_mask;
+        return true;
+    case CASK_STMT_FUNCTION_DECL:
+        *type_mask = stmt->contents.func_decl.type_mask;
+        return true;
+    case CASK_STMT_PARAMETER_DECL:
+        *type_mask = stmt->contents.param_decl.type_mask;
+        return true;
+    default:
+        return false;
     }
+}
 
-    if (stmt->type == CASK_STMT_PARAMETER_DECL)
+uint8_t statement_decode_comptype(const Statement *stmt)
+{
+    uint16_t type_mask = 0;
+
+    if (statement_get_type_mask(stmt, &type_mask))
     {
-        return (stmt->contents.param_decl.type_mask & 0xff);
+        return (type_mask & (0xff << 8)) >> 8;
     }
 
     return CASK_COMPTYPE_UNKNOWN;
 }
 
-void statement_dispose(Statement *stmt)
+uint8_t statement_decode_datatype(const Statement *stmt)
 {
-    /// @note Only free outer container memory rather than deepest nested data since the VM will own them!
-    switch (stmt->type)
+    uint16_t type_mask = 0;
+
+    if (statement_get_type_mask(stmt, &type_mask))
     {
-    case CASK_STMT_PRIMITIVE_DECL:
-    case CASK_STMT_FIELD_DECL:
-    case CASK_STMT_PARAMETER_DECL:
-        break;
-    case CASK_STMT_AGGREGATE_DECL:
-        vector_dispose_Statement(&stmt->contents.aggr_decl.members, NULL);
-        break;
-    case CASK_STMT_FUNCTION_DECL:
-        vector_dispose_Statement(&stmt->contents.func_decl.params, NULL);
-        statement_dispose(stmt->contents.func_decl.block);
-        break;
-    case CASK_STMT_WHILE:
-        statement_dispose(stmt->contents.while_ctrl.block);
-        expression_dispose(stmt->contents.while_ctrl.condition);
-        break;
-    case CASK_STMT_IF:
-        statement_dispose(stmt->contents.if_ctrl.block);
-        expression_dispose(stmt->contents.if_ctrl.condition);
-        break;
-    case CASK_STMT_ELSE:
-        statement_dispose(stmt->contents.else_ctrl.block);
-        break;
-    case CASK_STMT_BLOCK:
-        vector_dispose_Statement(&stmt->contents.block.stmts, NULL);
-        break;
-    default:
-        break;
+        return (type_mask & 0xff);
     }
+
+    return CASK_DATATYPE_UNKNOWN;
 }
 
 /* ProgramUnit impl. */
 
-void program_unit_init(ProgramUnit *prog_unit, char *name)
+void program_unit_init(ProgramUnit *prog_unit, const char *name)
 {
+    arena_init(&prog_unit->arena, CASK_ARENA_DEFAULT_BLOCK_SIZE);
+    symbol_table_init(&prog_unit->symbols);
     vector_init_Statement(&prog_unit->statements);
-    prog_unit->name = name;
+    prog_unit->name = (name != NULL) ? arena_strndup(&prog_unit->arena, name, strlen(name)) : NULL;
+    prog_unit->source = (SourceFile){.data = NULL, .length = 0, .storage = CASK_SOURCE_EMPTY};
+}
+
+Expression *program_unit_new_expr(ProgramUnit *prog_unit)
+{
+    return arena_alloc(&prog_unit->arena, sizeof(Expression));
+}
+
+Statement *program_unit_new_stmt(ProgramUnit *prog_unit)
+{
+    return arena_alloc(&prog_unit->arena, sizeof(Statement));
+}
+
+SymbolID program_unit_intern(ProgramUnit *prog_unit, const char *begin, uint32_t length)
+{
+    return symbol_table_intern(&prog_unit->symbols, begin, length);
 }
 
 const char *program_unit_view_name(const ProgramUnit *prog_unit)
@@ -347,18 +378,22 @@ const char *program_unit_view_name(const ProgramUnit *prog_unit)
     return prog_unit->name;
 }
 
+void program_unit_adopt_source(ProgramUnit *prog_unit, SourceFile *source)
+{
+    prog_unit->source = *source;
+    *source = (SourceFile){.data = NULL, .length = 0, .storage = CASK_SOURCE_EMPTY};
+}
+
 bool program_unit_append(ProgramUnit *prog_unit, Statement *stmt_ptr)
 {
-    return vector_append_Statement(&prog_unit->statements, stmt_ptr);
+    return vector_append_Statement(&prog_unit->statements, &prog_unit->arena, stmt_ptr);
 }
 
 void program_unit_dispose(ProgramUnit *prog_unit)
 {
-    vector_dispose_Statement(&prog_unit->statements, statement_dispose);
-
-    if (prog_unit->name != NULL)
-    {
-        free(prog_unit->name);
-        prog_unit->name = NULL;
-    }
+    arena_dispose(&prog_unit->arena);
+    symbol_table_dispose(&prog_unit->symbols);
+    file_unmap(&prog_unit->source);
+    vector_init_Statement(&prog_unit->statements);
+    prog_unit->name = NULL;
 }
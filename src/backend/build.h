@@ -0,0 +1,89 @@
+#ifndef BUILD_H
+#define BUILD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "syntax/ast.h"
+
+/// @brief Extension of source files picked up when scanning directories.
+#define CASK_SOURCE_EXTENSION ".cask"
+
+/**
+ * @brief What a build does with each input, same as the `caskc` options.
+ */
+typedef struct cask_build_options_t
+{
+    const char *program_name;       // prefixes messages
+    const char *cache_dir;          // NULL for no cache
+    const char *image_path;         // NULL for no images, else the image of a lone input or the directory for those of several
+    uint32_t worker_count;          // 0 for one per core
+    bool disassemble;
+    bool peephole_report;
+} BuildOptions;
+
+/**
+ * @brief One source file of a build. Its module name is the file name without directories or `.cask`, and `import` statements naming it order this file's compile before the importer's.
+ * @note Output meant for stdout and stderr is kept in memory while workers run, so a build prints the same text in input order however its work was scheduled.
+ */
+typedef struct cask_build_input_t
+{
+    char *path;
+    const char *module_name;        // view into `path`
+    uint32_t module_length;
+    ProgramUnit *unit;              // set between parsing and compiling
+    uint32_t *dependents;           // inputs importing this one
+    uint32_t dependent_count;
+    uint32_t import_count;          // imports naming other inputs
+    uint64_t key;
+    char *out_text;
+    size_t out_length;
+    char *err_text;
+    size_t err_length;
+    FILE *out;
+    FILE *err;
+    bool compiled;                  // ready for the compile phase: parsed, not cached, and not in a cycle
+    bool ok;
+} BuildInput;
+
+typedef struct cask_build_t
+{
+    BuildOptions options;
+    BuildInput *inputs;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t lex_worker_count;      // threads lexing each input: 1 unless the build itself runs on one worker
+} Build;
+
+void build_init(Build *build, const BuildOptions *options);
+
+/**
+ * @brief Adds a source file, or every `.cask` file under a directory in name order.
+ *
+ * @param build
+ * @param path
+ * @return bool False if the path cannot be read or memory runs out.
+ */
+bool build_add_path(Build *build, const char *path);
+
+/**
+ * @brief Lexes and parses every input, then compiles them with each one after the inputs it imports. Both phases spread their inputs over a work-stealing pool.
+ *
+ * @param build
+ * @return bool True if every input compiled, or came from the cache, and was saved as asked.
+ */
+bool build_run(Build *build);
+
+/**
+ * @brief Prints each input's buffered output in input order. With several inputs, each one's output follows a `== <path>` header line.
+ *
+ * @param build
+ * @param out
+ * @param err
+ */
+void build_print(const Build *build, FILE *out, FILE *err);
+
+void build_dispose(Build *build);
+
+#endif
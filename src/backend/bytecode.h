@@ -0,0 +1,316 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "collection/vectors.h"
+
+/* Opcodes */
+
+/**
+ * @brief Stack machine opcodes. Each instruction is one opcode byte followed by the operands given in `bytecode_formats`. Multi-byte operands are little endian, and jump offsets are relative to the end of the jump instruction.
+ */
+typedef enum cask_opcode_e
+{
+    CASK_BC_NOP,
+    CASK_BC_PUSH_NIL,
+    CASK_BC_PUSH_TRUE,
+    CASK_BC_PUSH_FALSE,
+    CASK_BC_PUSH_INT16,          // i16 immediate
+    CASK_BC_PUSH_CONST,          // u16 constant index
+    CASK_BC_POP,
+    CASK_BC_LOAD_LOCAL,          // u8 slot
+    CASK_BC_STORE_LOCAL,         // u8 slot, pops
+    CASK_BC_TEE_LOCAL,           // u8 slot, keeps the value
+    CASK_BC_LOAD_LOCAL_PAIR,     // u8 slot, u8 slot, fused from two LOAD_LOCALs
+    CASK_BC_INC_LOCAL_I32,       // u8 slot, i8 step, fused from `x = x + k` on an int local
+    CASK_BC_LOAD_GLOBAL,         // u16 global
+    CASK_BC_STORE_GLOBAL,        // u16 global, pops
+    CASK_BC_ADD,
+    CASK_BC_SUB,
+    CASK_BC_MUL,
+    CASK_BC_DIV,
+    CASK_BC_LT,
+    CASK_BC_LTE,
+    CASK_BC_GT,
+    CASK_BC_GTE,
+    CASK_BC_EQ,
+    CASK_BC_NEQ,
+    // Typed forms of the ops above, picked from checked operand types. They skip the runtime type tests.
+    CASK_BC_ADD_I32,
+    CASK_BC_SUB_I32,
+    CASK_BC_MUL_I32,
+    CASK_BC_DIV_I32,
+    CASK_BC_ADD_F32,
+    CASK_BC_SUB_F32,
+    CASK_BC_MUL_F32,
+    CASK_BC_DIV_F32,
+    CASK_BC_CONCAT_STR,          // still tests tags, as string typed values may be nil
+    CASK_BC_LT_I32,
+    CASK_BC_LTE_I32,
+    CASK_BC_GT_I32,
+    CASK_BC_GTE_I32,
+    CASK_BC_LT_F32,
+    CASK_BC_LTE_F32,
+    CASK_BC_GT_F32,
+    CASK_BC_GTE_F32,
+    CASK_BC_EQ_I32,
+    CASK_BC_NEQ_I32,
+    CASK_BC_EQ_F32,
+    CASK_BC_NEQ_F32,
+    CASK_BC_EQ_STR,              // compares by value, so nil operands are fine
+    CASK_BC_NEQ_STR,
+    CASK_BC_SHL_I32,             // u8 shift, replaces a multiply by a power of two
+    CASK_BC_SHR_I32,             // u8 shift, replaces a divide by a power of two and rounds toward zero like it
+    CASK_BC_JUMP,                // i16 offset
+    CASK_BC_JUMP_IF_FALSE,       // i16 offset, pops the condition
+    CASK_BC_JUMP_IF_FALSE_OR_POP,// i16 offset, keeps a false condition for `&&`
+    CASK_BC_JUMP_IF_TRUE_OR_POP, // i16 offset, keeps a true condition for `||`
+    // Fused forms of a typed int comparison then JUMP_IF_FALSE: i16 offset, pops both operands and jumps unless the comparison holds.
+    CASK_BC_JUMP_UNLESS_LT_I32,
+    CASK_BC_JUMP_UNLESS_LTE_I32,
+    CASK_BC_JUMP_UNLESS_GT_I32,
+    CASK_BC_JUMP_UNLESS_GTE_I32,
+    CASK_BC_JUMP_UNLESS_EQ_I32,
+    CASK_BC_JUMP_UNLESS_NEQ_I32,
+    CASK_BC_MAKE_ARRAY,          // u16 item count
+    CASK_BC_MAKE_AGGR,           // u16 field count
+    CASK_BC_INDEX,               // array, key -> item
+    CASK_BC_SET_INDEX,           // array, key, value ->
+    CASK_BC_INDEX_UNCHECKED,     // INDEX on a key the compiler proved in range for an array, so no checks
+    CASK_BC_SET_INDEX_UNCHECKED, // SET_INDEX likewise
+    CASK_BC_GET_FIELD,           // u8 field
+    CASK_BC_SET_FIELD,           // u8 field: aggregate, value ->
+    CASK_BC_CALL,                // u16 function, u8 argc
+    CASK_BC_CALL_NATIVE,         // u8 native, u8 argc
+    CASK_BC_RETURN,
+    CASK_BC_RETURN_NIL,
+    CASK_BC_COUNT
+} Opcode;
+
+/**
+ * @brief Operand layouts of instructions.
+ */
+typedef enum cask_bc_format_e
+{
+    CASK_BC_FMT_NONE,
+    CASK_BC_FMT_U8,
+    CASK_BC_FMT_U16,
+    CASK_BC_FMT_I16,
+    CASK_BC_FMT_U8_U8,
+    CASK_BC_FMT_U16_U8
+} BytecodeFormat;
+
+extern const uint8_t bytecode_formats[CASK_BC_COUNT];
+
+extern const char *const bytecode_names[CASK_BC_COUNT];
+
+/**
+ * @brief Net operand stack change of each opcode. For MAKE_ARRAY, MAKE_AGGR, CALL and CALL_NATIVE it excludes the popped items or arguments, which the operand counts give.
+ */
+extern const int8_t bytecode_stack_effects[CASK_BC_COUNT];
+
+/**
+ * @brief Gives an instruction's byte length, opcode included.
+ */
+static inline uint32_t bytecode_instr_length(uint8_t opcode)
+{
+    static const uint8_t format_lengths[] = {1U, 2U, 3U, 3U, 3U, 4U};
+
+    return format_lengths[bytecode_formats[opcode]];
+}
+
+static inline uint16_t bytecode_read_u16(const uint8_t *operand)
+{
+    return (uint16_t)(operand[0] | (operand[1] << 8));
+}
+
+static inline int16_t bytecode_read_i16(const uint8_t *operand)
+{
+    return (int16_t)bytecode_read_u16(operand);
+}
+
+static inline bool bytecode_is_jump(uint8_t opcode)
+{
+    return opcode >= CASK_BC_JUMP && opcode <= CASK_BC_JUMP_UNLESS_NEQ_I32;
+}
+
+/* Natives */
+
+typedef enum cask_native_e
+{
+    CASK_NATIVE_PUTS,
+    CASK_NATIVE_PUTF,
+    CASK_NATIVE_LENGTH,
+    CASK_NATIVE_COUNT
+} NativeID;
+
+/// @brief Arity of natives taking any number of arguments after the first.
+#define CASK_NATIVE_VARIADIC -1
+
+/**
+ * @brief Compile time description of a native function. `module` is the module importing it, or NULL for builtins visible everywhere.
+ */
+typedef struct cask_native_info_t
+{
+    const char *module;
+    const char *name;
+    int8_t arity;
+    uint16_t return_mask;
+    bool pure;                   // no side effects, so calls with equal arguments may be merged
+} NativeInfo;
+
+extern const NativeInfo bytecode_natives[CASK_NATIVE_COUNT];
+
+/* Module */
+
+typedef enum cask_constant_type_e
+{
+    CASK_CONST_INTEGER,
+    CASK_CONST_FLOAT,
+    CASK_CONST_STRING
+} ConstantType;
+
+/**
+ * @brief A constant pool entry. String constants refer to the module string table.
+ */
+typedef struct cask_constant_t
+{
+    union
+    {
+        int32_t integer;
+        float realnum;
+        uint32_t string;
+    } as;
+
+    ConstantType type;
+} Constant;
+
+/**
+ * @brief Location of one string in a module's `string_bytes`.
+ */
+typedef struct cask_string_ref_t
+{
+    uint32_t offset;
+    uint32_t length;
+} StringRef;
+
+CASK_VECTOR_DECL(Byte, uint8_t)
+CASK_VECTOR_DECL(Constant, Constant)
+CASK_VECTOR_DECL(StringRef, StringRef)
+
+/**
+ * @brief Bytecode of one function. Parameters take the first `arity` frame slots, and locals follow up to `slot_count`. The operand stack above them never holds more than `max_stack` values.
+ */
+typedef struct cask_code_object_t
+{
+    ByteVector code;
+    uint32_t name;          // string table index
+    uint32_t max_stack;
+    uint16_t return_mask;   // packed like `CASK_TYPE_MASK`
+    uint8_t arity;
+    uint8_t slot_count;
+} CodeObject;
+
+CASK_VECTOR_DECL(CodeObject, CodeObject)
+
+#define CASK_MODULE_NO_FUNCTION UINT32_MAX
+
+/**
+ * @brief Compiled form of one ProgramUnit. Global initializers and other top-level statements live in the `init_function` code object, which runs before `main_function`.
+ * @note All storage is heap backed and owned by the module.
+ */
+typedef struct cask_module_t
+{
+    CodeObjectVector functions;
+    ConstantVector constants;
+    StringRefVector strings;
+    ByteVector string_bytes;
+    uint32_t init_function;
+    uint32_t main_function;
+    uint16_t global_count;
+} Module;
+
+void module_init(Module *module);
+
+/**
+ * @brief Adds a constant to the pool.
+ *
+ * @param module
+ * @param constant
+ * @return uint32_t The constant's index, or UINT32_MAX on allocation failure.
+ */
+uint32_t module_add_constant(Module *module, Constant constant);
+
+/**
+ * @brief Copies a string into the string table.
+ *
+ * @param module
+ * @param text
+ * @param length
+ * @return uint32_t The string's index, or UINT32_MAX on allocation failure.
+ */
+uint32_t module_add_string(Module *module, const char *text, uint32_t length);
+
+/**
+ * @brief Views a string of the table. It is NOT NUL terminated.
+ */
+const char *module_view_string(const Module *module, uint32_t index, uint32_t *length_out);
+
+/**
+ * @brief Adds an empty function.
+ *
+ * @param module
+ * @param name String table index of the function name.
+ * @return uint32_t The function's index, or UINT32_MAX on allocation failure.
+ */
+uint32_t module_add_function(Module *module, uint32_t name);
+
+CodeObject *module_get_function(Module *module, uint32_t index);
+
+/**
+ * @brief Prints every function's instructions in a readable form.
+ *
+ * @param module
+ * @param out
+ */
+void module_disassemble(const Module *module, FILE *out);
+
+void module_dispose(Module *module);
+
+/* Instruction lists */
+
+/**
+ * @brief One decoded instruction. Jumps hold the index of their target instruction instead of a byte offset, so passes may insert and remove instructions freely before re-encoding.
+ */
+typedef struct cask_instr_t
+{
+    uint32_t target;        // jumps only: target index, which may be the list's count for the end of code
+    uint16_t operand;       // first operand, with PUSH_INT16's immediate kept as its raw bits
+    uint8_t argc;           // second operand of CALL, CALL_NATIVE, LOAD_LOCAL_PAIR and INC_LOCAL_I32
+    uint8_t opcode;
+} Instr;
+
+CASK_VECTOR_DECL(Instr, Instr)
+
+/**
+ * @brief Decodes bytecode into an instruction list, appending to `instrs`.
+ *
+ * @param code
+ * @param instrs
+ * @return bool False on allocation failure or malformed code: an unknown opcode, a truncated instruction, or a jump off instruction boundaries.
+ */
+bool bytecode_decode(const ByteVector *code, InstrVector *instrs);
+
+/**
+ * @brief Encodes an instruction list as bytecode, appending to `code`.
+ *
+ * @param instrs
+ * @param code
+ * @return bool False on allocation failure or when a jump no longer fits its i16 offset.
+ */
+bool bytecode_encode(const InstrVector *instrs, ByteVector *code);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "backend/image.h"
+
+/// @brief Longest cache entry path, directory included.
+#define CASK_CACHE_PATH_MAX 1024U
+
+/**
+ * @brief Keys the compiled form of one source file: an XXH64 hash of its bytes, seeded by `CASK_COMPILER_VERSION` and `CASK_IMAGE_VERSION` so a new compiler never reuses an old one's output.
+ * @note Imports only name native modules for now, which are part of the compiler, so the source alone decides the output.
+ *
+ * @param source
+ * @param length
+ * @return uint64_t
+ */
+uint64_t cache_key(const char *source, size_t length);
+
+/**
+ * @brief Maps the cached image for a key, if there is a valid one.
+ *
+ * @param cache_dir
+ * @param key
+ * @param image Receives the image on a hit. Dispose it with `image_dispose`.
+ * @return bool False on a miss, including for entries that fail to load.
+ */
+bool cache_load(const char *cache_dir, uint64_t key, Image *image);
+
+/**
+ * @brief Saves a module as the image for a key, creating the cache directory if needed. The entry is written under a temporary name and renamed into place, so concurrent compiles never see half an image.
+ *
+ * @param cache_dir
+ * @param key
+ * @param module
+ * @return ImageErrorCode
+ */
+ImageErrorCode cache_store(const char *cache_dir, uint64_t key, const Module *module);
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "syntax/ast.h"
+#include "backend/bytecode.h"
+#include "backend/peephole.h"
+
+/// @note Bump this whenever the emitted code changes, as cached images are keyed by it (see `cache.h`).
+#define CASK_COMPILER_VERSION "0.1.0"
+
+/* Compiler type decls. */
+
+typedef enum compiler_error_code_t
+{
+    CASK_COMPILE_ERR_NONE,
+    CASK_COMPILE_ERR_UNKNOWN_NAME,
+    CASK_COMPILE_ERR_UNKNOWN_MODULE,
+    CASK_COMPILE_ERR_REDEFINED,
+    CASK_COMPILE_ERR_ARITY,
+    CASK_COMPILE_ERR_BAD_TARGET,
+    CASK_COMPILE_ERR_TYPE,
+    CASK_COMPILE_ERR_LIMIT,
+    CASK_COMPILE_ERR_GENERAL,
+    CASK_COMPILE_ERR_MISSING_RETURN     // a function with a return type may reach its end
+} CompileErrorCode;
+
+/**
+ * @brief A static type: a packed `CASK_TYPE_MASK` plus the aggregate name for aggregate types.
+ */
+typedef struct cask_type_info_t
+{
+    uint16_t mask;
+    SymbolID name;
+} TypeInfo;
+
+typedef enum cask_binding_kind_e
+{
+    CASK_BIND_NONE,
+    CASK_BIND_GLOBAL,
+    CASK_BIND_FUNCTION,
+    CASK_BIND_NATIVE,
+    CASK_BIND_AGGREGATE
+} BindingKind;
+
+/**
+ * @brief What a top-level name refers to. `index` is a global, function, native or aggregate index by `kind`.
+ */
+typedef struct cask_binding_t
+{
+    uint32_t index;
+    BindingKind kind;
+} Binding;
+
+/**
+ * @brief A local variable or parameter living in a frame slot. Slots are freed when the block declaring them ends.
+ */
+typedef struct cask_local_slot_t
+{
+    SymbolID name;
+    TypeInfo type;
+    uint32_t depth;
+} LocalSlot;
+
+/// @brief Frame slots are u8 operands and `CodeObject.slot_count` is a u8 count, so a function holds at most 255 locals, temps included.
+#define CASK_COMPILER_MAX_LOCALS 255U
+#define CASK_COMPILER_MAX_CONSTANTS 65536U
+#define CASK_COMPILER_MAX_TEMPS 255U
+
+/// @brief Temps from `CASK_COMPILER_MAX_TEMPS - CASK_COMPILER_MAX_HOISTS` up hold values hoisted out of a loop condition. CSE numbers its temps below them.
+#define CASK_COMPILER_MAX_HOISTS 8U
+
+/**
+ * @brief A loop-invariant subtree of a while condition, computed once before the loop. `value` is a shallow copy of the hoisted node with `temp_def` set, and the node itself now reloads that temp.
+ */
+typedef struct cask_loop_hoist_t
+{
+    const Statement *loop;
+    Expression value;
+} LoopHoist;
+
+CASK_VECTOR_DECL(LoopHoist, LoopHoist)
+
+/* Compiler decl. */
+
+/**
+ * @brief Lowers a ProgramUnit to a bytecode Module in three passes: the first binds every top-level name (imports, aggregates, functions, globals) so uses may precede declarations, the second type checks (see `typecheck.h`), and the third emits code. Between the last two, the tree is folded (`fold.h`), pure calls on constants are evaluated (`consteval.h`), while loops are optimized (`loops.h`) and repeated pure subexpressions are merged (`cse.h`). Calls to small functions in the emitted code are then inlined (`inliner.h`), and common instruction sequences fused (`peephole.h`).
+ * @note Locals are resolved to frame slots here, so the VM never looks names up at runtime.
+ */
+typedef struct compiler_t
+{
+    const ProgramUnit *unit;
+    Module *module;
+    Binding *bindings;              // indexed by SymbolID
+    uint32_t *string_constants;     // SymbolID -> constant index + 1, or 0 if not added yet
+    TypeInfo *global_types;
+    StatementVector aggregates;     // aggregate declarations by aggregate index
+    StatementVector functions;      // function declarations by function index, NULL for the init function
+    bool *pure_functions;           // by function index, see `purity.h`
+    LoopHoistVector hoists;         // in loop order, see `loops.h`
+    PeepholeStats peephole;         // pattern hits of the last compile, kept after it for reporting
+    LocalSlot locals[CASK_COMPILER_MAX_LOCALS];
+    uint8_t temp_slots[CASK_COMPILER_MAX_TEMPS]; // temp -> local slot, for the statement or loop being emitted
+    uint32_t local_count;
+    uint32_t scope_depth;
+    uint32_t function;              // index of the function being emitted
+    uint32_t stack_depth;           // operand stack depth after the last emitted instruction
+    CompileErrorCode error;
+    SymbolID error_name;
+} Compiler;
+
+void compiler_init(Compiler *compiler);
+
+/**
+ * @brief Finds a field of a named aggregate type.
+ *
+ * @param compiler
+ * @param aggregate_type
+ * @param field
+ * @param field_type Receives the field's declared type.
+ * @return int32_t The field index, or -1 if the type is not a known aggregate or lacks the field.
+ */
+int32_t compiler_find_field(const Compiler *compiler, TypeInfo aggregate_type, SymbolID field, TypeInfo *field_type);
+
+/**
+ * @brief Compiles a parsed unit.
+ *
+ * @param compiler
+ * @param prog_unit Must stay valid while compiling only. The module keeps copies of every name and string it needs. Its expressions get their checked types filled in.
+ * @param code_ptr Receives `CASK_COMPILE_ERR_NONE` or the first error. See `error_name` for the offending name, if any.
+ * @return Module* NULL on error. Otherwise release it with `module_dispose` and then `free`.
+ */
+Module *compiler_compile(Compiler *compiler, const ProgramUnit *prog_unit, CompileErrorCode *code_ptr);
+
+#endif
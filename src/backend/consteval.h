@@ -0,0 +1,26 @@
+#ifndef CONSTEVAL_H
+#define CONSTEVAL_H
+
+#include <stdbool.h>
+
+#include "backend/compiler.h"
+
+/**
+ * @brief Propagates constant locals into the expressions reading them, then refolds. A local is constant when its initializer folds to an int, float or bool literal and no statement of its function stores to its name.
+ * @note Needs `purity_analyze` to have run.
+ *
+ * @param compiler
+ * @return bool Whether some pure call now has only literal arguments, so that `consteval_unit` has work. Check the compiler's error on false, as allocation failures are reported.
+ */
+bool consteval_prepare(Compiler *compiler);
+
+/**
+ * @brief Evaluates pure calls on literal arguments ahead of time by running them in a VM over `snapshot`, a module compiled from the same unit, then replaces each with its int, float, bool or nil result and refolds.
+ * @note Every evaluation runs under a step budget. Calls that exhaust it or fail at runtime stay as they are, so the VM still reports their errors.
+ *
+ * @param compiler
+ * @param snapshot Compiled from the unit after `consteval_prepare`, with matching function indices.
+ */
+void consteval_unit(Compiler *compiler, const Module *snapshot);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef CSE_H
+#define CSE_H
+
+#include "backend/compiler.h"
+
+/**
+ * @brief Common subexpression elimination within each statement of every function body. A repeated pure call or arithmetic subtree is computed once: the first occurrence gets `temp_def` set, and the later ones become `CASK_EXPR_TEMP` reloads.
+ * @note Needs `purity_analyze` to have run. Only subtrees over literals, locals and pure calls are merged, since nothing inside one expression can change those. First occurrences on the right of `&&` or `||` may be skipped at runtime, so they never define a temp.
+ *
+ * @param compiler
+ */
+void cse_unit(Compiler *compiler);
+
+#endif
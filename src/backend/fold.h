@@ -0,0 +1,19 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "syntax/ast.h"
+
+/**
+ * @brief Folds literal subtrees and simplifies algebraic identities in every expression of the unit, rewriting the nodes in place.
+ * @note Runs after type checking: rewrites are only taken when the `type_mask` annotations prove them exact, and rewritten nodes keep their annotation. Int arithmetic wraps like the VM's, and a division by zero is left for the VM to report. Running it again on a folded tree is safe, so later passes refold what they expose.
+ *
+ * @param unit
+ */
+void fold_unit(const ProgramUnit *unit);
+
+/**
+ * @brief Folds one checked expression tree in place, as `fold_unit` does for each.
+ */
+void fold_expr(Expression *expr);
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "backend/bytecode.h"
+#include "utils/files.h"
+
+/* Image format */
+
+#define CASK_IMAGE_EXTENSION ".caskb"
+#define CASK_IMAGE_MAGIC "CSKB"
+
+/// @note Bump this whenever opcodes or the layout below change, so stale images are refused instead of misread.
+#define CASK_IMAGE_VERSION 2U
+
+/// @brief Every section starts at a multiple of this from the image start.
+#define CASK_IMAGE_ALIGN 8U
+
+/// @brief Written as a native `uint32_t`, so a host of the other byte order reads it swapped and refuses the image.
+#define CASK_IMAGE_BYTE_ORDER 0x01020304U
+
+/**
+ * @brief Leads a `.caskb` image, a compiled Module laid out so it runs straight from a read-only mapping. Sections are found by offsets from the image start, never by pointers, and hold in order: `ImageFunction` records, `ImageConstant` records, `StringRef` records, the string bytes, and all function code back to back.
+ * @note Fields are in the writer's byte order, which `byte_order` records.
+ * @note `checksum` is the XXH64 of every image byte but its own, seeded with the version, so a torn or bit-flipped file is refused before its code is checked.
+ */
+typedef struct cask_image_header_t
+{
+    uint8_t magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t size;                  // whole image in bytes
+    uint32_t function_count;
+    uint32_t function_offset;
+    uint32_t constant_count;
+    uint32_t constant_offset;
+    uint32_t string_count;
+    uint32_t string_offset;
+    uint32_t string_bytes_size;
+    uint32_t string_bytes_offset;
+    uint32_t code_size;
+    uint32_t code_offset;
+    uint32_t init_function;
+    uint32_t main_function;
+    uint32_t global_count;
+    uint32_t reserved;              // zero, so the checksum below is aligned with no padding before it
+    uint64_t checksum;
+} ImageHeader;
+
+/**
+ * @brief One function of an image. Its code is `code_size` bytes at `code_offset` into the code section.
+ */
+typedef struct cask_image_function_t
+{
+    uint32_t code_offset;
+    uint32_t code_size;
+    uint32_t name;
+    uint32_t max_stack;
+    uint16_t return_mask;
+    uint8_t arity;
+    uint8_t slot_count;
+} ImageFunction;
+
+/**
+ * @brief One constant of an image: the raw bits of `Constant.as` plus its `ConstantType`.
+ */
+typedef struct cask_image_constant_t
+{
+    uint32_t bits;
+    uint32_t type;
+} ImageConstant;
+
+typedef enum cask_image_error_e
+{
+    CASK_IMAGE_ERR_NONE,
+    CASK_IMAGE_ERR_IO,
+    CASK_IMAGE_ERR_MEMORY,
+    CASK_IMAGE_ERR_FORMAT,          // not an image, from a host of the other byte order, or with sections out of range
+    CASK_IMAGE_ERR_VERSION,
+    CASK_IMAGE_ERR_CODE,            // some function's code failed verification
+    CASK_IMAGE_ERR_CHECKSUM         // the bytes do not match the header's checksum
+} ImageErrorCode;
+
+/**
+ * @brief A module running from a mapped image. Its code, string records and string bytes are views into `file`, and only the function and constant tables are copied out.
+ * @note Release it with `image_dispose`, never `module_dispose`.
+ */
+typedef struct cask_image_t
+{
+    SourceFile file;
+    Module module;
+} Image;
+
+/**
+ * @brief Lays a module out as an image, appending to `out`.
+ *
+ * @param module
+ * @param out
+ * @return bool False on allocation failure or an image past 4 GiB.
+ */
+bool image_serialize(const Module *module, ByteVector *out);
+
+/**
+ * @brief Writes a module to a file as an image.
+ *
+ * @param module
+ * @param file_path
+ * @return ImageErrorCode
+ */
+ImageErrorCode image_save(const Module *module, const char *file_path);
+
+/**
+ * @brief Maps an image file and sets its module up to run in place.
+ * @note The checksum is checked first, so accidental damage never reaches the VM. As anyone can recompute it, every section is still range checked, and each function's code is decoded once to check its opcodes, jumps, operand indexes and stack depths, so a corrupt image cannot make the VM read outside its frames or the module. Images are still trusted like compiler output for operand types and the compiler's bounds proofs, which cannot be checked without the source.
+ *
+ * @param image
+ * @param file_path
+ * @return ImageErrorCode On error, `image` holds nothing to dispose.
+ */
+ImageErrorCode image_load(Image *image, const char *file_path);
+
+void image_dispose(Image *image);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <stdbool.h>
+
+#include "backend/bytecode.h"
+
+/**
+ * @brief Replaces calls to small functions with copies of their bytecode in every function of a finished module. Arguments are stored into fresh slots past the caller's locals, the callee's slots are shifted onto them, and its returns become jumps past the copy.
+ * @note Only callees of at most `CASK_INLINER_MAX_INSTRS` instructions that never call themselves qualify, and copies are always taken from the original code, so inlining goes one level deep. A runtime error inside a copy is reported in the caller.
+ *
+ * @param module
+ * @return bool False on allocation failure. A function whose grown code would not fit its jump offsets is left as it was.
+ */
+bool inliner_apply(Module *module);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include <stdbool.h>
+
+#include "backend/compiler.h"
+
+/**
+ * @brief Optimizes the while loops of every function body in two ways. Array reads and stores `a[i]` get `in_bounds` set when the loop condition proves `0 <= i < length(a)`, so they skip the VM's checks. Loop-invariant subtrees of each condition are hoisted into temps computed once before the loop (see `LoopHoist`).
+ * @note Needs `purity_analyze` to have run, and runs before `cse_unit`.
+ * @note An index counts as proven in range when the condition has `i < length(a)`, or `i < n` for some `n : int = length(a)`. Also, `i` starts at a non-negative int literal and its only store is `i = i + 1` as a statement of the loop body, and `a` is never stored. Only accesses in statements before that increment are marked. Every name involved must be declared once in its function, and not name a global.
+ * @note Only unconditional parts of a condition are hoisted, never the right of `&&` or `||`, and only subtrees over literals, pure calls and locals the loop never stores. The condition runs at least once, so hoisting never computes what the loop would not.
+ *
+ * @param compiler
+ * @return bool False after reporting an allocation failure.
+ */
+bool loops_unit(Compiler *compiler);
+
+#endif
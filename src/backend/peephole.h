@@ -0,0 +1,49 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "backend/bytecode.h"
+
+/**
+ * @brief Rewrites the peephole pass knows, in the order they are tried at each instruction.
+ */
+typedef enum cask_peephole_pattern_e
+{
+    CASK_PEEPHOLE_INC_LOCAL,        // LOAD_LOCAL x, PUSH_INT16 k, ADD_I32 or SUB_I32, STORE_LOCAL x -> INC_LOCAL_I32
+    CASK_PEEPHOLE_COMPARE_JUMP,     // an int comparison, JUMP_IF_FALSE -> JUMP_UNLESS_*_I32
+    CASK_PEEPHOLE_CONST_BRANCH,     // PUSH_TRUE or PUSH_FALSE, JUMP_IF_FALSE -> nothing or JUMP
+    CASK_PEEPHOLE_STORE_LOAD,       // STORE_LOCAL x, LOAD_LOCAL x -> TEE_LOCAL x
+    CASK_PEEPHOLE_TEE_POP,          // TEE_LOCAL x, POP -> STORE_LOCAL x
+    CASK_PEEPHOLE_PUSH_POP,         // a push without side effects, POP -> nothing
+    CASK_PEEPHOLE_JUMP_NEXT,        // a JUMP to the next instruction -> nothing
+    CASK_PEEPHOLE_JUMP_THREAD,      // a jump to a JUMP -> a jump to its target
+    CASK_PEEPHOLE_LOAD_PAIR,        // LOAD_LOCAL x, LOAD_LOCAL y -> LOAD_LOCAL_PAIR
+    CASK_PEEPHOLE_COUNT
+} PeepholePattern;
+
+extern const char *const peephole_names[CASK_PEEPHOLE_COUNT];
+
+/**
+ * @brief How many times each pattern fired.
+ */
+typedef struct cask_peephole_stats_t
+{
+    uint32_t hits[CASK_PEEPHOLE_COUNT];
+} PeepholeStats;
+
+void peephole_stats_init(PeepholeStats *stats);
+
+/**
+ * @brief Fuses common instruction sequences of every function in a finished module into superinstructions, and drops redundant pushes and jumps. Rounds of rewrites repeat until none applies, since one may expose another.
+ * @note A sequence is only rewritten when no jump lands inside it past its first instruction. Conditional jumps are only threaded forward, so every backward jump stays a JUMP for the VM's step budget.
+ * @note Runs after `inliner_apply`, whose slot remapping only knows the plain local opcodes.
+ *
+ * @param module
+ * @param stats Receives the hits of each pattern, added to its counts.
+ * @return bool False on allocation failure. A function whose code would not decode or re-encode is left as it was.
+ */
+bool peephole_apply(Module *module, PeepholeStats *stats);
+
+#endif
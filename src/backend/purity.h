@@ -0,0 +1,22 @@
+#ifndef PURITY_H
+#define PURITY_H
+
+#include <stdbool.h>
+
+#include "backend/compiler.h"
+
+/**
+ * @brief Finds which functions are pure: all parameters are single values, the body never reads or writes a global, and it only calls pure functions and natives. Any heap object such a function reaches is then made during the call, so two calls with equal arguments give equal results and leave no trace.
+ * @note Fills `compiler->pure_functions`. Recursion is assumed pure until shown otherwise, so self recursive functions like `dc_pow` qualify. A local shadowing a global counts as the global, which only errs towards impure.
+ *
+ * @param compiler
+ * @return bool False after reporting an allocation failure.
+ */
+bool purity_analyze(Compiler *compiler);
+
+/**
+ * @brief Tells whether a call expression targets a pure function or native.
+ */
+bool purity_call_is_pure(const Compiler *compiler, const Expression *call);
+
+#endif
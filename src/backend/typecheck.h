@@ -0,0 +1,17 @@
+#ifndef TYPECHECK_H
+#define TYPECHECK_H
+
+#include <stdbool.h>
+
+#include "backend/compiler.h"
+
+/**
+ * @brief Infers and checks the static type of every expression in the compiler's unit, storing it in `Expression.type_mask` and `type_name` for code generation.
+ * @note Runs after the compiler's declaring pass, since names resolve through its bindings. The compiler's local slot stack is borrowed for scopes and left empty.
+ *
+ * @param compiler
+ * @return bool False after reporting the first error into the compiler.
+ */
+bool typecheck_unit(Compiler *compiler);
+
+#endif
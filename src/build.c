@@ -0,0 +1,737 @@
+/**
+ * @file build.c
+ * @author Derek Tan
+ * @brief Implements builds of many source files at once.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "utils/files.h"
+#include "utils/pool.h"
+#include "frontend/lexer.h"
+#include "frontend/parser.h"
+#include "backend/compiler.h"
+#include "backend/image.h"
+#include "backend/cache.h"
+#include "backend/build.h"
+
+#define CASK_BUILD_MIN_CAPACITY 8U
+
+/**
+ * @brief State shared by the workers of the compile phase. `pending` counts each input's imports not compiled yet, and `import_failed` marks inputs with an import that failed.
+ */
+typedef struct cask_build_run_t
+{
+    Build *build;
+    atomic_uint *pending;
+    atomic_bool *import_failed;
+} BuildRun;
+
+/* Inputs. */
+
+static bool build_add_file(Build *build, const char *path)
+{
+    if (build->count == build->capacity)
+    {
+        uint32_t capacity = (build->capacity > 0U) ? build->capacity * 2U : CASK_BUILD_MIN_CAPACITY;
+        BuildInput *inputs = (capacity > build->capacity) ? realloc(build->inputs, capacity * sizeof(BuildInput)) : NULL;
+
+        if (!inputs)
+            return false;
+
+        build->inputs = inputs;
+        build->capacity = capacity;
+    }
+
+    size_t path_length = strlen(path);
+    char *path_copy = malloc(path_length + 1U);
+
+    if (!path_copy)
+        return false;
+
+    memcpy(path_copy, path, path_length + 1U);
+
+    const char *slash = strrchr(path_copy, '/');
+    const char *name = (slash != NULL) ? slash + 1 : path_copy;
+    size_t name_length = strlen(name);
+    size_t extension_length = sizeof(CASK_SOURCE_EXTENSION) - 1U;
+
+    if (name_length > extension_length && !strcmp(name + name_length - extension_length, CASK_SOURCE_EXTENSION))
+        name_length -= extension_length;
+
+    build->inputs[build->count++] = (BuildInput){
+        .path = path_copy,
+        .module_name = name,
+        .module_length = (uint32_t)name_length,
+        .unit = NULL,
+        .dependents = NULL,
+        .dependent_count = 0U,
+        .import_count = 0U,
+        .key = 0U,
+        .out_text = NULL,
+        .out_length = 0U,
+        .err_text = NULL,
+        .err_length = 0U,
+        .out = NULL,
+        .err = NULL,
+        .compiled = false,
+        .ok = false
+    };
+
+    return true;
+}
+
+static int build_compare_names(const void *lhs, const void *rhs)
+{
+    return strcmp(*(char *const *)lhs, *(char *const *)rhs);
+}
+
+/**
+ * @brief Adds the sources under a directory. Names are sorted first, so the inputs come out in the same order on every file system.
+ */
+static bool build_add_directory(Build *build, const char *path)
+{
+    DIR *dir = opendir(path);
+    char **names = NULL;
+    uint32_t name_count = 0U;
+    uint32_t name_capacity = 0U;
+    bool ok = dir != NULL;
+    struct dirent *entry = NULL;
+
+    while (ok && (entry = readdir(dir)) != NULL)
+    {
+        // Skip `.`, `..` and hidden entries such as a cache directory inside the tree.
+        if (entry->d_name[0] == '.')
+            continue;
+
+        if (name_count == name_capacity)
+        {
+            uint32_t capacity = (name_capacity > 0U) ? name_capacity * 2U : CASK_BUILD_MIN_CAPACITY;
+            char **grown = (capacity > name_capacity) ? realloc(names, capacity * sizeof(char *)) : NULL;
+
+            if (!(ok = grown != NULL))
+                break;
+
+            names = grown;
+            name_capacity = capacity;
+        }
+
+        size_t length = strlen(entry->d_name);
+
+        if ((ok = (names[name_count] = malloc(length + 1U)) != NULL))
+            memcpy(names[name_count++], entry->d_name, length + 1U);
+    }
+
+    if (dir != NULL)
+        closedir(dir);
+
+    if (ok && name_count > 1U)
+        qsort(names, name_count, sizeof(char *), build_compare_names);
+
+    size_t path_length = strlen(path);
+    size_t extension_length = sizeof(CASK_SOURCE_EXTENSION) - 1U;
+
+    for (uint32_t index = 0; ok && index < name_count; index++)
+    {
+        size_t name_length = strlen(names[index]);
+        char *child = malloc(path_length + name_length + 2U);
+        struct stat info;
+
+        if (!(ok = child != NULL))
+            break;
+
+        sprintf(child, "%s/%s", path, names[index]);
+
+        if (stat(child, &info) == 0)
+        {
+            if (S_ISDIR(info.st_mode))
+                ok = build_add_directory(build, child);
+            else if (S_ISREG(info.st_mode) && name_length > extension_length && !strcmp(names[index] + name_length - extension_length, CASK_SOURCE_EXTENSION))
+                ok = build_add_file(build, child);
+        }
+
+        free(child);
+    }
+
+    for (uint32_t index = 0; index < name_count; index++)
+        free(names[index]);
+
+    free(names);
+
+    return ok;
+}
+
+static bool build_add_dependent(BuildInput *input, uint32_t dependent)
+{
+    // An importer's edges are added together, so a repeated import shows up as the last dependent.
+    if (input->dependent_count > 0U && input->dependents[input->dependent_count - 1U] == dependent)
+        return true;
+
+    uint32_t *dependents = realloc(input->dependents, (input->dependent_count + 1U) * sizeof(uint32_t));
+
+    if (!dependents)
+        return false;
+
+    dependents[input->dependent_count++] = dependent;
+    input->dependents = dependents;
+
+    return true;
+}
+
+static void build_drop_unit(BuildInput *input)
+{
+    if (input->unit != NULL)
+    {
+        program_unit_dispose(input->unit);
+        free(input->unit);
+        input->unit = NULL;
+    }
+
+    input->compiled = false;
+}
+
+/* Output. */
+
+/**
+ * @brief Prints and saves a compiled module as the options ask.
+ * @return bool False if the image could not be saved.
+ */
+static bool build_emit(const Build *build, BuildInput *input, const Module *module)
+{
+    const char *image_path = build->options.image_path;
+    char module_image_path[CASK_CACHE_PATH_MAX];
+    ImageErrorCode image_code = CASK_IMAGE_ERR_NONE;
+
+    if (build->options.disassemble)
+        module_disassemble(module, input->out);
+
+    if (!image_path)
+        return true;
+
+    // Several inputs each get `<dir>/<module>.caskb`.
+    if (build->count > 1U)
+    {
+        int length = snprintf(module_image_path, CASK_CACHE_PATH_MAX, "%s/%.*s%s", image_path, (int)input->module_length, input->module_name, CASK_IMAGE_EXTENSION);
+
+        image_code = (length > 0 && (unsigned)length < CASK_CACHE_PATH_MAX) ? CASK_IMAGE_ERR_NONE : CASK_IMAGE_ERR_IO;
+        image_path = module_image_path;
+    }
+
+    if (image_code == CASK_IMAGE_ERR_NONE)
+        image_code = image_save(module, image_path);
+
+    if (image_code != CASK_IMAGE_ERR_NONE)
+    {
+        fprintf(input->err, "%s [Error]: %s: could not save image, error %i.\n", build->options.program_name, input->path, image_code);
+        return false;
+    }
+
+    return true;
+}
+
+/* Phases. */
+
+/**
+ * @brief Loads one input from the cache, or else lexes and parses it.
+ */
+static void build_front(Pool *pool, uint32_t worker, uint32_t task, void *context)
+{
+    (void)pool;
+    (void)worker;
+
+    Build *build = context;
+    BuildInput *input = &build->inputs[task];
+    const char *program_name = build->options.program_name;
+    SourceFile source_file;
+
+    if (!file_map(input->path, &source_file))
+    {
+        fprintf(input->err, "%s [Error]: %s: could not read file.\n", program_name, input->path);
+        return;
+    }
+
+    if (source_file.length > UINT32_MAX)
+    {
+        file_unmap(&source_file);
+        fprintf(input->err, "%s [Error]: %s: could not read file.\n", program_name, input->path);
+        return;
+    }
+
+    /// @note A cached image of the same source stands in for lexing, parsing and compiling. Pattern hits only come from a real compile, so `-p` skips the cache.
+    bool use_cache = build->options.cache_dir != NULL && !build->options.peephole_report;
+    Image cached;
+
+    input->key = use_cache ? cache_key(source_file.data, source_file.length) : 0U;
+
+    if (use_cache && cache_load(build->options.cache_dir, input->key, &cached))
+    {
+        file_unmap(&source_file);
+        input->ok = build_emit(build, input, &cached.module);
+        image_dispose(&cached);
+        return;
+    }
+
+    // Parse the same bytes that were hashed, so the cached image always matches its key.
+    Parser parser;
+    ParserErrorCode parse_code = CASK_PARSER_ERR_NONE;
+    parser_init(&parser);
+
+    if (!parser_use_source(&parser, &source_file, input->path, build->lex_worker_count))
+    {
+        fprintf(input->err, "%s [Error]: %s: could not read file.\n", program_name, input->path);
+        return;
+    }
+
+    input->unit = parser_parse(&parser, &parse_code);
+
+    if (!input->unit)
+    {
+        fprintf(input->err, "%s [Error]: %s: parse error %i at line %u.\n", program_name, input->path, parse_code, parser.error_line);
+        return;
+    }
+
+    input->compiled = true;
+}
+
+/**
+ * @brief Compiles one input whose imports are done, then hands its importers on once they have nothing left to wait for.
+ */
+static void build_back(Pool *pool, uint32_t worker, uint32_t task, void *context)
+{
+    BuildRun *run = context;
+    Build *build = run->build;
+    BuildInput *input = &build->inputs[task];
+    const char *program_name = build->options.program_name;
+
+    if (atomic_load(&run->import_failed[task]))
+    {
+        fprintf(input->err, "%s [Error]: %s: an imported module failed to build.\n", program_name, input->path);
+    }
+    else
+    {
+        Compiler compiler;
+        CompileErrorCode compile_code = CASK_COMPILE_ERR_NONE;
+        compiler_init(&compiler);
+
+        Module *module = compiler_compile(&compiler, input->unit, &compile_code);
+
+        if (!module)
+        {
+            uint32_t name_length = 0U;
+            const char *name = symbol_table_view(&input->unit->symbols, compiler.error_name, &name_length);
+
+            fprintf(input->err, "%s [Error]: %s: compile error %i near '%.*s'.\n", program_name, input->path, compile_code, (int)name_length, (name != NULL) ? name : "");
+        }
+        else
+        {
+            input->ok = build_emit(build, input, module);
+
+            if (build->options.cache_dir != NULL && !build->options.peephole_report && cache_store(build->options.cache_dir, input->key, module) != CASK_IMAGE_ERR_NONE)
+                fprintf(input->err, "%s [Warning]: %s: could not cache the compiled image.\n", program_name, input->path);
+
+            if (build->options.peephole_report)
+            {
+                for (uint32_t pattern = 0; pattern < CASK_PEEPHOLE_COUNT; pattern++)
+                    fprintf(input->out, "peephole %s: %u\n", peephole_names[pattern], compiler.peephole.hits[pattern]);
+            }
+
+            module_dispose(module);
+            free(module);
+        }
+    }
+
+    program_unit_dispose(input->unit);
+    free(input->unit);
+    input->unit = NULL;
+
+    for (uint32_t index = 0; index < input->dependent_count; index++)
+    {
+        uint32_t dependent = input->dependents[index];
+
+        if (!build->inputs[dependent].compiled)
+            continue;
+
+        if (!input->ok)
+            atomic_store(&run->import_failed[dependent], true);
+
+        if (atomic_fetch_sub(&run->pending[dependent], 1U) == 1U)
+            pool_submit(pool, worker, dependent);
+    }
+}
+
+/* Import graph. */
+
+static int build_compare_name(const char *name, uint32_t length, const BuildInput *input)
+{
+    uint32_t common = (length < input->module_length) ? length : input->module_length;
+    int order = memcmp(name, input->module_name, common);
+
+    if (order != 0 || length == input->module_length)
+        return order;
+
+    return (length < input->module_length) ? -1 : 1;
+}
+
+/**
+ * @brief Orders inputs by module name, then by position so the first of several same-named inputs sorts first.
+ */
+static int build_compare_modules(const void *lhs, const void *rhs)
+{
+    const BuildInput *left = *(const BuildInput *const *)lhs;
+    const BuildInput *right = *(const BuildInput *const *)rhs;
+    int order = build_compare_name(left->module_name, left->module_length, right);
+
+    if (order != 0)
+        return order;
+
+    return (left < right) ? -1 : (left > right);
+}
+
+/**
+ * @brief Finds the input of a module name among inputs sorted by name, one per name.
+ */
+static BuildInput *build_find_module(BuildInput *const *modules, uint32_t count, const char *name, uint32_t length)
+{
+    uint32_t low = 0U;
+    uint32_t high = count;
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2U;
+        int order = build_compare_name(name, length, modules[middle]);
+
+        if (order == 0)
+            return modules[middle];
+
+        if (order < 0)
+            high = middle;
+        else
+            low = middle + 1U;
+    }
+
+    return NULL;
+}
+
+static bool build_is_native_module(const char *name, uint32_t length)
+{
+    for (uint32_t native = 0; native < CASK_NATIVE_COUNT; native++)
+    {
+        const char *module = bytecode_natives[native].module;
+
+        if (module != NULL && strlen(module) == length && !memcmp(module, name, length))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Links each parsed input to the inputs it imports, rejecting inputs whose module name an earlier input already took.
+ * @note Imports of native modules, or of names no input has, are left for the compiler to resolve or report.
+ *
+ * @param build
+ * @param run Receives each input's pending import count, and marks importers of inputs that already failed.
+ * @return bool False if memory ran out.
+ */
+static bool build_link(Build *build, BuildRun *run)
+{
+    BuildInput **modules = malloc(build->count * sizeof(BuildInput *));
+    uint32_t module_count = 0U;
+
+    if (!modules)
+        return false;
+
+    for (uint32_t index = 0; index < build->count; index++)
+        modules[index] = &build->inputs[index];
+
+    qsort(modules, build->count, sizeof(BuildInput *), build_compare_modules);
+
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        BuildInput *input = modules[index];
+
+        if (module_count > 0U && build_compare_name(input->module_name, input->module_length, modules[module_count - 1U]) == 0)
+        {
+            fprintf(input->err, "%s [Error]: %s: module '%.*s' is also %s.\n", build->options.program_name, input->path, (int)input->module_length, input->module_name, modules[module_count - 1U]->path);
+            input->ok = false;
+            build_drop_unit(input);
+            continue;
+        }
+
+        modules[module_count++] = input;
+    }
+
+    bool ok = true;
+
+    for (uint32_t index = 0; ok && index < build->count; index++)
+    {
+        const ProgramUnit *unit = build->inputs[index].unit;
+
+        for (uint32_t stmt_index = 0; ok && unit != NULL && stmt_index < unit->statements.count; stmt_index++)
+        {
+            const Statement *stmt = vector_at_Statement(&unit->statements, stmt_index);
+            uint32_t name_length = 0U;
+            const char *name = NULL;
+
+            if (stmt->type != CASK_STMT_IMPORT)
+                continue;
+
+            name = symbol_table_view(&unit->symbols, stmt->contents.import.name, &name_length);
+
+            if (!name || build_is_native_module(name, name_length))
+                continue;
+
+            BuildInput *target = build_find_module(modules, module_count, name, name_length);
+
+            if (!target)
+                continue;
+
+            uint32_t before = target->dependent_count;
+
+            if (target->compiled)
+            {
+                ok = build_add_dependent(target, index);
+                build->inputs[index].import_count += (target->dependent_count > before) ? 1U : 0U;
+            }
+            else if (!target->ok)
+            {
+                atomic_store(&run->import_failed[index], true);
+            }
+        }
+    }
+
+    free(modules);
+
+    return ok;
+}
+
+/**
+ * @brief Drops inputs that can never compile because their imports loop, or depend on a loop. This is Kahn's topological sort: whatever it cannot reach waits on a cycle.
+ *
+ * @param build
+ * @param ready Receives the inputs with no imports left to wait for.
+ * @param ready_count
+ * @return uint32_t The number of inputs left to compile, or `UINT32_MAX` if memory ran out.
+ */
+static uint32_t build_break_cycles(Build *build, uint32_t *ready, uint32_t *ready_count)
+{
+    uint32_t *waiting = malloc(build->count * sizeof(uint32_t));
+    uint32_t *order = malloc(build->count * sizeof(uint32_t));
+    uint32_t order_count = 0U;
+    uint32_t reached = 0U;
+    uint32_t total = 0U;
+
+    if (!waiting || !order)
+    {
+        free(waiting);
+        free(order);
+        return UINT32_MAX;
+    }
+
+    *ready_count = 0U;
+
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        waiting[index] = build->inputs[index].import_count;
+
+        if (build->inputs[index].compiled && waiting[index] == 0U)
+        {
+            order[order_count++] = index;
+            ready[(*ready_count)++] = index;
+        }
+    }
+
+    for (; reached < order_count; reached++)
+    {
+        const BuildInput *input = &build->inputs[order[reached]];
+
+        for (uint32_t edge = 0; edge < input->dependent_count; edge++)
+        {
+            if (--waiting[input->dependents[edge]] == 0U)
+                order[order_count++] = input->dependents[edge];
+        }
+    }
+
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        BuildInput *input = &build->inputs[index];
+
+        if (!input->compiled)
+            continue;
+
+        if (waiting[index] > 0U)
+        {
+            fprintf(input->err, "%s [Error]: %s: module '%.*s' is in or behind an import cycle.\n", build->options.program_name, input->path, (int)input->module_length, input->module_name);
+            build_drop_unit(input);
+            continue;
+        }
+
+        total++;
+    }
+
+    free(waiting);
+    free(order);
+
+    return total;
+}
+
+/* Build impl. */
+
+void build_init(Build *build, const BuildOptions *options)
+{
+    build->options = *options;
+    build->inputs = NULL;
+    build->count = 0U;
+    build->capacity = 0U;
+    build->lex_worker_count = 1U;
+}
+
+bool build_add_path(Build *build, const char *path)
+{
+    struct stat info;
+
+    if (stat(path, &info) != 0)
+        return false;
+
+    return S_ISDIR(info.st_mode) ? build_add_directory(build, path) : build_add_file(build, path);
+}
+
+bool build_run(Build *build)
+{
+    const char *program_name = build->options.program_name;
+    uint32_t worker_count = (build->options.worker_count > 0U) ? build->options.worker_count : pool_core_count();
+    BuildRun run = {.build = build, .pending = NULL, .import_failed = NULL};
+    uint32_t *tasks = NULL;
+    uint32_t task_count = 0U;
+    bool ok = build->count > 0U;
+
+    if (worker_count > build->count)
+        worker_count = build->count;
+
+    // Workers already spread the inputs, so each is lexed on its own thread. A lone worker may split a large input over the asked thread count instead.
+    build->lex_worker_count = (worker_count > 1U) ? 1U : ((build->options.worker_count > 0U) ? build->options.worker_count : pool_core_count());
+
+    for (uint32_t index = 0; ok && index < build->count; index++)
+    {
+        BuildInput *input = &build->inputs[index];
+
+        input->out = open_memstream(&input->out_text, &input->out_length);
+        input->err = open_memstream(&input->err_text, &input->err_length);
+        ok = input->out != NULL && input->err != NULL;
+    }
+
+    if (ok && build->options.image_path != NULL && build->count > 1U && mkdir(build->options.image_path, 0777) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "%s [Error]: could not make image directory %s.\n", program_name, build->options.image_path);
+        ok = false;
+    }
+
+    if (ok)
+    {
+        tasks = malloc(build->count * sizeof(uint32_t));
+        run.pending = malloc(build->count * sizeof(atomic_uint));
+        run.import_failed = malloc(build->count * sizeof(atomic_bool));
+        ok = tasks != NULL && run.pending != NULL && run.import_failed != NULL;
+    }
+
+    for (uint32_t index = 0; ok && index < build->count; index++)
+    {
+        tasks[index] = index;
+        atomic_init(&run.import_failed[index], false);
+    }
+
+    // Phase 1: every input is independent while being read and parsed.
+    ok = ok && pool_run(worker_count, build->count, tasks, build->count, build_front, build);
+
+    // Phase 2: compile along the import graph, each input once its imports are done.
+    ok = ok && build_link(build, &run);
+
+    uint32_t total = ok ? build_break_cycles(build, tasks, &task_count) : 0U;
+    ok = ok && total != UINT32_MAX;
+
+    for (uint32_t index = 0; ok && index < build->count; index++)
+        atomic_init(&run.pending[index], build->inputs[index].import_count);
+
+    ok = ok && pool_run(worker_count, total, tasks, task_count, build_back, &run);
+
+    if (!ok)
+        fprintf(stderr, "%s [Error]: could not run the build.\n", program_name);
+
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        BuildInput *input = &build->inputs[index];
+
+        build_drop_unit(input);
+
+        if (input->out != NULL)
+            fclose(input->out);
+
+        if (input->err != NULL)
+            fclose(input->err);
+
+        input->out = NULL;
+        input->err = NULL;
+        ok = ok && input->ok;
+    }
+
+    free(tasks);
+    free(run.pending);
+    free(run.import_failed);
+
+    return ok;
+}
+
+void build_print(const Build *build, FILE *out, FILE *err)
+{
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        const BuildInput *input = &build->inputs[index];
+
+        if (build->count > 1U)
+            fprintf(out, "== %s\n", input->path);
+
+        if (input->out_length > 0U)
+            fwrite(input->out_text, 1U, input->out_length, out);
+
+        fflush(out);
+
+        if (input->err_length > 0U)
+            fwrite(input->err_text, 1U, input->err_length, err);
+    }
+}
+
+void build_dispose(Build *build)
+{
+    for (uint32_t index = 0; index < build->count; index++)
+    {
+        BuildInput *input = &build->inputs[index];
+
+        build_drop_unit(input);
+
+        if (input->out != NULL)
+            fclose(input->out);
+
+        if (input->err != NULL)
+            fclose(input->err);
+
+        free(input->out_text);
+        free(input->err_text);
+        free(input->dependents);
+        free(input->path);
+    }
+
+    free(build->inputs);
+    build->inputs = NULL;
+    build->count = 0U;
+    build->capacity = 0U;
+}
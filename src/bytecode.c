@@ -0,0 +1,407 @@
+/**
+ * @file bytecode.c
+ * @author Derek Tan
+ * @brief Implements bytecode tables and the compiled module container.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "syntax/ast.h"
+#include "backend/bytecode.h"
+
+/* Opcode tables. */
+
+const uint8_t bytecode_formats[CASK_BC_COUNT] = {
+    [CASK_BC_PUSH_INT16] = CASK_BC_FMT_I16,
+    [CASK_BC_PUSH_CONST] = CASK_BC_FMT_U16,
+    [CASK_BC_LOAD_LOCAL] = CASK_BC_FMT_U8,
+    [CASK_BC_STORE_LOCAL] = CASK_BC_FMT_U8,
+    [CASK_BC_TEE_LOCAL] = CASK_BC_FMT_U8,
+    [CASK_BC_LOAD_LOCAL_PAIR] = CASK_BC_FMT_U8_U8,
+    [CASK_BC_INC_LOCAL_I32] = CASK_BC_FMT_U8_U8,
+    [CASK_BC_LOAD_GLOBAL] = CASK_BC_FMT_U16,
+    [CASK_BC_STORE_GLOBAL] = CASK_BC_FMT_U16,
+    [CASK_BC_SHL_I32] = CASK_BC_FMT_U8,
+    [CASK_BC_SHR_I32] = CASK_BC_FMT_U8,
+    [CASK_BC_JUMP] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_IF_FALSE] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_IF_FALSE_OR_POP] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_IF_TRUE_OR_POP] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_LT_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_LTE_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_GT_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_GTE_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_EQ_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_JUMP_UNLESS_NEQ_I32] = CASK_BC_FMT_I16,
+    [CASK_BC_MAKE_ARRAY] = CASK_BC_FMT_U16,
+    [CASK_BC_MAKE_AGGR] = CASK_BC_FMT_U16,
+    [CASK_BC_GET_FIELD] = CASK_BC_FMT_U8,
+    [CASK_BC_SET_FIELD] = CASK_BC_FMT_U8,
+    [CASK_BC_CALL] = CASK_BC_FMT_U16_U8,
+    [CASK_BC_CALL_NATIVE] = CASK_BC_FMT_U8_U8
+};
+
+const char *const bytecode_names[CASK_BC_COUNT] = {
+    "NOP", "PUSH_NIL", "PUSH_TRUE", "PUSH_FALSE", "PUSH_INT16", "PUSH_CONST", "POP",
+    "LOAD_LOCAL", "STORE_LOCAL", "TEE_LOCAL", "LOAD_LOCAL_PAIR", "INC_LOCAL_I32", "LOAD_GLOBAL", "STORE_GLOBAL",
+    "ADD", "SUB", "MUL", "DIV", "LT", "LTE", "GT", "GTE", "EQ", "NEQ",
+    "ADD_I32", "SUB_I32", "MUL_I32", "DIV_I32", "ADD_F32", "SUB_F32", "MUL_F32", "DIV_F32", "CONCAT_STR",
+    "LT_I32", "LTE_I32", "GT_I32", "GTE_I32", "LT_F32", "LTE_F32", "GT_F32", "GTE_F32",
+    "EQ_I32", "NEQ_I32", "EQ_F32", "NEQ_F32", "EQ_STR", "NEQ_STR",
+    "SHL_I32", "SHR_I32",
+    "JUMP", "JUMP_IF_FALSE", "JUMP_IF_FALSE_OR_POP", "JUMP_IF_TRUE_OR_POP",
+    "JUMP_UNLESS_LT_I32", "JUMP_UNLESS_LTE_I32", "JUMP_UNLESS_GT_I32", "JUMP_UNLESS_GTE_I32", "JUMP_UNLESS_EQ_I32", "JUMP_UNLESS_NEQ_I32",
+    "MAKE_ARRAY", "MAKE_AGGR", "INDEX", "SET_INDEX", "INDEX_UNCHECKED", "SET_INDEX_UNCHECKED", "GET_FIELD", "SET_FIELD",
+    "CALL", "CALL_NATIVE", "RETURN", "RETURN_NIL"
+};
+
+const int8_t bytecode_stack_effects[CASK_BC_COUNT] = {
+    [CASK_BC_PUSH_NIL] = 1, [CASK_BC_PUSH_TRUE] = 1, [CASK_BC_PUSH_FALSE] = 1, [CASK_BC_PUSH_INT16] = 1, [CASK_BC_PUSH_CONST] = 1,
+    [CASK_BC_POP] = -1,
+    [CASK_BC_LOAD_LOCAL] = 1, [CASK_BC_STORE_LOCAL] = -1, [CASK_BC_LOAD_LOCAL_PAIR] = 2, [CASK_BC_LOAD_GLOBAL] = 1, [CASK_BC_STORE_GLOBAL] = -1,
+    [CASK_BC_ADD] = -1, [CASK_BC_SUB] = -1, [CASK_BC_MUL] = -1, [CASK_BC_DIV] = -1,
+    [CASK_BC_LT] = -1, [CASK_BC_LTE] = -1, [CASK_BC_GT] = -1, [CASK_BC_GTE] = -1, [CASK_BC_EQ] = -1, [CASK_BC_NEQ] = -1,
+    [CASK_BC_ADD_I32] = -1, [CASK_BC_SUB_I32] = -1, [CASK_BC_MUL_I32] = -1, [CASK_BC_DIV_I32] = -1,
+    [CASK_BC_ADD_F32] = -1, [CASK_BC_SUB_F32] = -1, [CASK_BC_MUL_F32] = -1, [CASK_BC_DIV_F32] = -1, [CASK_BC_CONCAT_STR] = -1,
+    [CASK_BC_LT_I32] = -1, [CASK_BC_LTE_I32] = -1, [CASK_BC_GT_I32] = -1, [CASK_BC_GTE_I32] = -1,
+    [CASK_BC_LT_F32] = -1, [CASK_BC_LTE_F32] = -1, [CASK_BC_GT_F32] = -1, [CASK_BC_GTE_F32] = -1,
+    [CASK_BC_EQ_I32] = -1, [CASK_BC_NEQ_I32] = -1, [CASK_BC_EQ_F32] = -1, [CASK_BC_NEQ_F32] = -1, [CASK_BC_EQ_STR] = -1, [CASK_BC_NEQ_STR] = -1,
+    [CASK_BC_JUMP_IF_FALSE] = -1, [CASK_BC_JUMP_IF_FALSE_OR_POP] = -1, [CASK_BC_JUMP_IF_TRUE_OR_POP] = -1,
+    [CASK_BC_JUMP_UNLESS_LT_I32] = -2, [CASK_BC_JUMP_UNLESS_LTE_I32] = -2, [CASK_BC_JUMP_UNLESS_GT_I32] = -2, [CASK_BC_JUMP_UNLESS_GTE_I32] = -2,
+    [CASK_BC_JUMP_UNLESS_EQ_I32] = -2, [CASK_BC_JUMP_UNLESS_NEQ_I32] = -2,
+    [CASK_BC_MAKE_ARRAY] = 1, [CASK_BC_MAKE_AGGR] = 1,
+    [CASK_BC_INDEX] = -1, [CASK_BC_SET_INDEX] = -3,
+    [CASK_BC_INDEX_UNCHECKED] = -1, [CASK_BC_SET_INDEX_UNCHECKED] = -3, [CASK_BC_SET_FIELD] = -2,
+    [CASK_BC_CALL] = 1, [CASK_BC_CALL_NATIVE] = 1,
+    [CASK_BC_RETURN] = -1
+};
+
+const NativeInfo bytecode_natives[CASK_NATIVE_COUNT] = {
+    [CASK_NATIVE_PUTS] = {"io", "puts", 1, CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_NIL), false},
+    [CASK_NATIVE_PUTF] = {"io", "putf", CASK_NATIVE_VARIADIC, CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_NIL), false},
+    [CASK_NATIVE_LENGTH] = {NULL, "length", 1, CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_INTEGER), true}
+};
+
+/* Module impl. */
+
+void module_init(Module *module)
+{
+    vector_init_CodeObject(&module->functions);
+    vector_init_Constant(&module->constants);
+    vector_init_StringRef(&module->strings);
+    vector_init_Byte(&module->string_bytes);
+    module->init_function = CASK_MODULE_NO_FUNCTION;
+    module->main_function = CASK_MODULE_NO_FUNCTION;
+    module->global_count = 0U;
+}
+
+uint32_t module_add_constant(Module *module, Constant constant)
+{
+    uint32_t index = module->constants.count;
+
+    return vector_append_Constant(&module->constants, NULL, constant) ? index : UINT32_MAX;
+}
+
+uint32_t module_add_string(Module *module, const char *text, uint32_t length)
+{
+    uint32_t index = module->strings.count;
+    StringRef ref = {.offset = module->string_bytes.count, .length = length};
+
+    if (!vector_reserve_Byte(&module->string_bytes, NULL, module->string_bytes.count + length))
+        return UINT32_MAX;
+
+    memcpy(vector_items_Byte(&module->string_bytes) + ref.offset, text, length);
+    module->string_bytes.count += length;
+
+    return vector_append_StringRef(&module->strings, NULL, ref) ? index : UINT32_MAX;
+}
+
+const char *module_view_string(const Module *module, uint32_t index, uint32_t *length_out)
+{
+    if (index >= module->strings.count)
+    {
+        *length_out = 0U;
+        return NULL;
+    }
+
+    StringRef ref = vector_at_StringRef(&module->strings, index);
+    *length_out = ref.length;
+
+    /// @note An empty table has no storage pointer yet, so hand out an empty literal instead.
+    return (ref.length > 0U) ? (const char *)vector_ref_Byte(&module->string_bytes, ref.offset) : "";
+}
+
+uint32_t module_add_function(Module *module, uint32_t name)
+{
+    uint32_t index = module->functions.count;
+    CodeObject function = {.name = name, .max_stack = 0U, .return_mask = 0U, .arity = 0U, .slot_count = 0U};
+
+    vector_init_Byte(&function.code);
+
+    return vector_append_CodeObject(&module->functions, NULL, function) ? index : UINT32_MAX;
+}
+
+CodeObject *module_get_function(Module *module, uint32_t index)
+{
+    return vector_items_CodeObject(&module->functions) + index;
+}
+
+static void module_print_constant(const Module *module, uint32_t index, FILE *out)
+{
+    if (index >= module->constants.count)
+    {
+        fprintf(out, "<bad constant>");
+        return;
+    }
+
+    Constant constant = vector_at_Constant(&module->constants, index);
+    uint32_t length = 0U;
+    const char *text = NULL;
+
+    switch (constant.type)
+    {
+    case CASK_CONST_INTEGER:
+        fprintf(out, "%i", constant.as.integer);
+        break;
+    case CASK_CONST_FLOAT:
+        fprintf(out, "%g", constant.as.realnum);
+        break;
+    default:
+        text = module_view_string(module, constant.as.string, &length);
+        fprintf(out, "\"%.*s\"", (int)length, text);
+        break;
+    }
+}
+
+void module_disassemble(const Module *module, FILE *out)
+{
+    for (uint32_t function_index = 0; function_index < module->functions.count; function_index++)
+    {
+        const CodeObject *function = vector_ref_CodeObject(&module->functions, function_index);
+        uint32_t name_length = 0U;
+        const char *name = module_view_string(module, function->name, &name_length);
+
+        fprintf(out, "func #%u %.*s (arity %u, slots %u, stack %u)\n", function_index, (int)name_length, name, function->arity, function->slot_count,
+            function->max_stack);
+
+        for (uint32_t offset = 0; offset < function->code.count;)
+        {
+            const uint8_t *instr = vector_ref_Byte(&function->code, offset);
+            uint8_t opcode = instr[0];
+
+            if (opcode >= CASK_BC_COUNT)
+            {
+                fprintf(out, "  %04u  <bad opcode %u>\n", offset, opcode);
+                break;
+            }
+
+            fprintf(out, "  %04u  %s", offset, bytecode_names[opcode]);
+
+            switch (bytecode_formats[opcode])
+            {
+            case CASK_BC_FMT_U8:
+                fprintf(out, " %u", instr[1]);
+                break;
+            case CASK_BC_FMT_U16:
+                fprintf(out, " %u", bytecode_read_u16(instr + 1));
+                break;
+            case CASK_BC_FMT_I16:
+                if (opcode == CASK_BC_PUSH_INT16)
+                    fprintf(out, " %i", bytecode_read_i16(instr + 1));
+                else
+                    fprintf(out, " -> %04i", (int)(offset + 3U) + bytecode_read_i16(instr + 1));
+                break;
+            case CASK_BC_FMT_U8_U8:
+                if (opcode == CASK_BC_INC_LOCAL_I32)
+                    fprintf(out, " %u %i", instr[1], (int8_t)instr[2]);
+                else
+                    fprintf(out, " %u %u", instr[1], instr[2]);
+                break;
+            case CASK_BC_FMT_U16_U8:
+                fprintf(out, " %u %u", bytecode_read_u16(instr + 1), instr[3]);
+                break;
+            default:
+                break;
+            }
+
+            if (opcode == CASK_BC_PUSH_CONST)
+            {
+                fprintf(out, "  ; ");
+                module_print_constant(module, bytecode_read_u16(instr + 1), out);
+            }
+            else if (opcode == CASK_BC_CALL_NATIVE && instr[1] < CASK_NATIVE_COUNT)
+            {
+                fprintf(out, "  ; %s", bytecode_natives[instr[1]].name);
+            }
+
+            fputc('\n', out);
+            offset += bytecode_instr_length(opcode);
+        }
+    }
+}
+
+void module_dispose(Module *module)
+{
+    for (uint32_t index = 0; index < module->functions.count; index++)
+        vector_dispose_Byte(&module_get_function(module, index)->code, NULL);
+
+    vector_dispose_CodeObject(&module->functions, NULL);
+    vector_dispose_Constant(&module->constants, NULL);
+    vector_dispose_StringRef(&module->strings, NULL);
+    vector_dispose_Byte(&module->string_bytes, NULL);
+    module->init_function = CASK_MODULE_NO_FUNCTION;
+    module->main_function = CASK_MODULE_NO_FUNCTION;
+    module->global_count = 0U;
+}
+
+/* Instruction list impl. */
+
+bool bytecode_decode(const ByteVector *code, InstrVector *instrs)
+{
+    uint32_t size = code->count;
+    uint32_t first = instrs->count;
+    // Maps each byte offset to the instruction starting there, for resolving jumps.
+    uint32_t *offset_instrs = malloc((size + 1U) * sizeof(uint32_t));
+    bool ok = offset_instrs != NULL;
+
+    for (uint32_t offset = 0; ok && offset <= size; offset++)
+        offset_instrs[offset] = UINT32_MAX;
+
+    for (uint32_t offset = 0; ok && offset < size;)
+    {
+        const uint8_t *bytes = vector_ref_Byte(code, offset);
+        Instr instr = {.target = 0U, .operand = 0U, .argc = 0U, .opcode = bytes[0]};
+
+        if (instr.opcode >= CASK_BC_COUNT || size - offset < bytecode_instr_length(instr.opcode))
+        {
+            ok = false;
+            break;
+        }
+
+        switch (bytecode_formats[instr.opcode])
+        {
+        case CASK_BC_FMT_U8:
+            instr.operand = bytes[1];
+            break;
+        case CASK_BC_FMT_U16:
+        case CASK_BC_FMT_I16:
+            instr.operand = bytecode_read_u16(bytes + 1);
+            break;
+        case CASK_BC_FMT_U8_U8:
+            instr.operand = bytes[1];
+            instr.argc = bytes[2];
+            break;
+        case CASK_BC_FMT_U16_U8:
+            instr.operand = bytecode_read_u16(bytes + 1);
+            instr.argc = bytes[3];
+            break;
+        default:
+            break;
+        }
+
+        // Keep the jump's end offset in `target` until every instruction start is known.
+        offset += bytecode_instr_length(instr.opcode);
+        instr.target = offset;
+        offset_instrs[offset - bytecode_instr_length(instr.opcode)] = instrs->count;
+        ok = vector_append_Instr(instrs, NULL, instr);
+    }
+
+    if (ok)
+        offset_instrs[size] = instrs->count;
+
+    for (uint32_t index = first; ok && index < instrs->count; index++)
+    {
+        Instr *instr = vector_items_Instr(instrs) + index;
+
+        if (!bytecode_is_jump(instr->opcode))
+        {
+            instr->target = 0U;
+            continue;
+        }
+
+        int64_t dest = (int64_t)instr->target + (int16_t)instr->operand;
+
+        ok = dest >= 0 && dest <= (int64_t)size && offset_instrs[dest] != UINT32_MAX;
+
+        if (ok)
+            instr->target = offset_instrs[dest] - first;
+
+        instr->operand = 0U;
+    }
+
+    free(offset_instrs);
+
+    return ok;
+}
+
+bool bytecode_encode(const InstrVector *instrs, ByteVector *code)
+{
+    uint32_t base = code->count;
+    // Byte offsets of each instruction, with one more for the end of code.
+    uint32_t *offsets = malloc((instrs->count + 1U) * sizeof(uint32_t));
+    uint32_t offset = base;
+
+    if (offsets == NULL)
+        return false;
+
+    for (uint32_t index = 0; index < instrs->count; index++)
+    {
+        offsets[index] = offset;
+        offset += bytecode_instr_length(vector_ref_Instr(instrs, index)->opcode);
+    }
+
+    offsets[instrs->count] = offset;
+
+    bool ok = vector_reserve_Byte(code, NULL, offset);
+
+    for (uint32_t index = 0; ok && index < instrs->count; index++)
+    {
+        const Instr *instr = vector_ref_Instr(instrs, index);
+        uint8_t *bytes = vector_items_Byte(code) + offsets[index];
+        uint16_t operand = instr->operand;
+
+        if (bytecode_is_jump(instr->opcode))
+        {
+            int64_t distance = (instr->target <= instrs->count) ? (int64_t)offsets[instr->target] - offsets[index + 1U] : INT64_MAX;
+
+            ok = distance >= INT16_MIN && distance <= INT16_MAX;
+            operand = (uint16_t)(int16_t)distance;
+        }
+
+        bytes[0] = instr->opcode;
+
+        switch (bytecode_formats[instr->opcode])
+        {
+        case CASK_BC_FMT_U8:
+            bytes[1] = (uint8_t)operand;
+            break;
+        case CASK_BC_FMT_U16:
+        case CASK_BC_FMT_I16:
+            bytes[1] = (uint8_t)(operand & 0xffU);
+            bytes[2] = (uint8_t)(operand >> 8);
+            break;
+        case CASK_BC_FMT_U8_U8:
+            bytes[1] = (uint8_t)operand;
+            bytes[2] = instr->argc;
+            break;
+        case CASK_BC_FMT_U16_U8:
+            bytes[1] = (uint8_t)(operand & 0xffU);
+            bytes[2] = (uint8_t)(operand >> 8);
+            bytes[3] = instr->argc;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (ok)
+        code->count = offset;
+
+    free(offsets);
+
+    return ok;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file cache.c
+ * @author Derek Tan
+ * @brief Implements the on-disk cache of compiled module images.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "backend/compiler.h"
+#include "backend/cache.h"
+#include "utils/hash.h"
+
+#define CASK_CACHE_SALT "cask " CASK_COMPILER_VERSION
+
+/// @brief Numbers temporary entries, so threads of one process storing the same key never share a temporary name.
+static atomic_uint cache_temp_serial = 0U;
+
+/**
+ * @brief Writes the entry path for a key, `<cache_dir>/<key in hex>.caskb`.
+ * @return bool False if the path would not fit.
+ */
+static bool cache_entry_path(const char *cache_dir, uint64_t key, char *path)
+{
+    int length = snprintf(path, CASK_CACHE_PATH_MAX, "%s/%016llx%s", cache_dir, (unsigned long long)key, CASK_IMAGE_EXTENSION);
+
+    return length > 0 && (unsigned)length < CASK_CACHE_PATH_MAX;
+}
+
+uint64_t cache_key(const char *source, size_t length)
+{
+    uint64_t seed = hash_bytes(CASK_CACHE_SALT, sizeof(CASK_CACHE_SALT) - 1U, CASK_IMAGE_VERSION);
+
+    return hash_bytes(source, length, seed);
+}
+
+bool cache_load(const char *cache_dir, uint64_t key, Image *image)
+{
+    char path[CASK_CACHE_PATH_MAX];
+
+    return cache_entry_path(cache_dir, key, path) && image_load(image, path) == CASK_IMAGE_ERR_NONE;
+}
+
+ImageErrorCode cache_store(const char *cache_dir, uint64_t key, const Module *module)
+{
+    char path[CASK_CACHE_PATH_MAX];
+    char temp_path[CASK_CACHE_PATH_MAX];
+    ImageErrorCode error = CASK_IMAGE_ERR_NONE;
+
+    if (!cache_entry_path(cache_dir, key, path))
+        return CASK_IMAGE_ERR_IO;
+
+    int length = snprintf(temp_path, CASK_CACHE_PATH_MAX, "%s.%ld.%u.tmp", path, (long)getpid(), atomic_fetch_add(&cache_temp_serial, 1U));
+
+    if (length <= 0 || (unsigned)length >= CASK_CACHE_PATH_MAX || (mkdir(cache_dir, 0777) != 0 && errno != EEXIST))
+        return CASK_IMAGE_ERR_IO;
+
+    if ((error = image_save(module, temp_path)) == CASK_IMAGE_ERR_NONE && rename(temp_path, path) != 0)
+        error = CASK_IMAGE_ERR_IO;
+
+    if (error != CASK_IMAGE_ERR_NONE)
+        remove(temp_path);
+
+    return error;
+}
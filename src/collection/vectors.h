@@ -2,89 +2,146 @@
 #define VECTORS_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "utils/arena.h"
+
+/// @brief Elements kept inside the vector itself before any storage is allocated. Covers most parameter lists, aggregate members and call arguments.
+#define CASK_VECTOR_INLINE_CAPACITY 4U
+
+/**
+ * @brief Gives the capacity to grow to for holding at least `wanted` items. Capacity doubles so appends stay amortized O(1).
+ *
+ * @param capacity Current capacity.
+ * @param wanted
+ * @param item_size
+ * @return uint32_t 0 if the byte size would overflow.
+ */
+uint32_t vector_core_next_capacity(uint32_t capacity, uint32_t wanted, size_t item_size);
+
 /**
- * @brief Encapsulates state of a dynamic, generic reference array. Functions per stored type are generated by macros called `CASK_FN_VECTOR_X`.
- * @note This vector implementation is meant to be homogeneous: it stores all items as the same type.
- * @note Caveat: This does not support storing pointer-pointer types.
+ * @brief Moves a vector's items to storage of `new_size` bytes. Inline items are copied out, and heap or arena storage is resized.
+ *
+ * @param items Current items.
+ * @param is_inline If `items` is the vector's inline buffer.
+ * @param used_size Bytes of live items.
+ * @param old_size Bytes of current storage.
+ * @param new_size
+ * @param arena Backing arena, or NULL to use the C heap.
+ * @return void* NULL on allocation failure, leaving the items untouched.
  */
-typedef struct cask_vector_t
-{
-    void **data;
-    int32_t next_slot;
-    int32_t capacity;
-} Vector;
+void *vector_core_grow(void *items, bool is_inline, size_t used_size, size_t old_size, size_t new_size, Arena *arena);
 
-#define CASK_VECTOR_INIT_CAPACITY 8
-#define CASK_VECTOR_MAX_CAPACITY 16384
+/**
+ * @brief Frees heap storage. Arena storage is left to its arena.
+ */
+void vector_core_release(void *items, Arena *arena);
 
-/// @brief Type generic macro for generating an initializer function for any typed vector.
-#define CASK_FN_VECTOR_INIT(type) void vector_init_ ## type(Vector *vector)\
+/**
+ * @brief Declares a typed vector `tag ## Vector` of `type` items with its inline functions. Items are stored by value in one contiguous buffer: the first `CASK_VECTOR_INLINE_CAPACITY` live inside the vector, and larger vectors switch to storage from the `Arena` passed to each call, or the C heap when that arena is NULL.
+ * @note A vector must always be used with the same arena (or always NULL). Arena backed vectors need no dispose.
+ * @note Expand this only in headers, so the static inline functions are never unused in a source file.
+ */
+#define CASK_VECTOR_DECL(tag, type)\
+    typedef struct cask_vector_ ## tag ## _t\
     {\
-        vector->data = calloc(CASK_VECTOR_INIT_CAPACITY, sizeof(type *));\
-        if (!vector->data)\
+        union\
         {\
-            vector->next_slot = 0;\
-            vector->capacity = -1;\
-        }\
-        else\
-        {\
-            vector->next_slot = 0;\
-            vector->capacity = CASK_VECTOR_INIT_CAPACITY;\
-        }\
+            type *heap;\
+            type local[CASK_VECTOR_INLINE_CAPACITY];\
+        } storage;\
+        uint32_t count;\
+        uint32_t capacity;\
+    } tag ## Vector;\
+    \
+    static inline void vector_init_ ## tag(tag ## Vector *vector)\
+    {\
+        vector->count = 0U;\
+        vector->capacity = CASK_VECTOR_INLINE_CAPACITY;\
     }\
-
-#define CASK_FN_VECTOR_GET_PTR(type) type *vector_get_ ## type ## _ptr(const Vector *vector, int32_t index)\
+    \
+    static inline type *vector_items_ ## tag(tag ## Vector *vector)\
     {\
-        return vector->data[index];\
+        return (vector->capacity > CASK_VECTOR_INLINE_CAPACITY) ? vector->storage.heap : vector->storage.local;\
     }\
-
-#define CASK_FN_VECTOR_APPEND(type) bool vector_append_ ## type(Vector *vector, type *value_ptr)\
+    \
+    static inline type vector_at_ ## tag(const tag ## Vector *vector, uint32_t index)\
+    {\
+        return (vector->capacity > CASK_VECTOR_INLINE_CAPACITY) ? vector->storage.heap[index] : vector->storage.local[index];\
+    }\
+    \
+    static inline type const *vector_ref_ ## tag(const tag ## Vector *vector, uint32_t index)\
+    {\
+        return (vector->capacity > CASK_VECTOR_INLINE_CAPACITY) ? &vector->storage.heap[index] : &vector->storage.local[index];\
+    }\
+    \
+    static inline bool vector_reserve_ ## tag(tag ## Vector *vector, Arena *arena, uint32_t wanted)\
     {\
-        int32_t new_length = vector->next_slot;\
-        int32_t new_capacity = 2 * vector->capacity;\
-        if (new_capacity >= CASK_VECTOR_MAX_CAPACITY)\
+        if (wanted <= vector->capacity)\
+            return true;\
+        uint32_t new_capacity = vector_core_next_capacity(vector->capacity, wanted, sizeof(type));\
+        if (new_capacity == 0U)\
+            return false;\
+        type *new_items = vector_core_grow(vector_items_ ## tag(vector), vector->capacity <= CASK_VECTOR_INLINE_CAPACITY,\
+            vector->count * sizeof(type), vector->capacity * sizeof(type), new_capacity * sizeof(type), arena);\
+        if (!new_items)\
+            return false;\
+        vector->storage.heap = new_items;\
+        vector->capacity = new_capacity;\
+        return true;\
+    }\
+    \
+    static inline bool vector_append_ ## tag(tag ## Vector *vector, Arena *arena, type item)\
+    {\
+        if (vector->count == vector->capacity && !vector_reserve_ ## tag(vector, arena, vector->count + 1U))\
             return false;\
-        if (new_length < new_capacity)\
+        vector_items_ ## tag(vector)[vector->count++] = item;\
+        return true;\
+    }\
+    \
+    static inline void vector_shrink_ ## tag(tag ## Vector *vector, Arena *arena)\
+    {\
+        if (vector->capacity <= CASK_VECTOR_INLINE_CAPACITY)\
+            return;\
+        type *old_items = vector->storage.heap;\
+        if (vector->count <= CASK_VECTOR_INLINE_CAPACITY)\
         {\
-            vector->data[new_length] = value_ptr;\
-            vector->next_slot++;\
-            return true;\
+            for (uint32_t index = 0; index < vector->count; index++)\
+                vector->storage.local[index] = old_items[index];\
+            vector->capacity = CASK_VECTOR_INLINE_CAPACITY;\
+            vector_core_release(old_items, arena);\
+            return;\
         }\
-        type **new_data_ptr = realloc(vector->data, sizeof(type *) * new_capacity);\
-        if (new_data_ptr != NULL)\
+        if (arena != NULL || vector->count == vector->capacity)\
+            return;\
+        type *new_items = realloc(old_items, vector->count * sizeof(type));\
+        if (new_items != NULL)\
         {\
-            for (int32_t fill_index = new_length; fill_index < new_capacity; fill_index++)\
-            {\
-                new_data_ptr[fill_index] = NULL;\
-            }\
-            new_data_ptr[new_length] = value_ptr;\
-            vector->data = new_data_ptr;\
-            vector->capacity = new_capacity;\
-            vector->next_slot++;\
+            vector->storage.heap = new_items;\
+            vector->capacity = vector->count;\
         }\
-        return new_data_ptr != NULL;\
     }\
-
-/// @brief Type generic macro for generating a dispose function for any typed Vector.
-#define CASK_FN_VECTOR_DISPOSE(inner_type) void vector_dispose_ ## inner_type(Vector *vector, void (*disposer_ ## inner_type)(inner_type *ptr))\
+    \
+    /** @brief Makes the vector a view of `count` items it does not own, e.g. in a mapped file. Such a view must never be grown, shrunk or disposed. */\
+    static inline void vector_borrow_ ## tag(tag ## Vector *vector, type *items, uint32_t count)\
     {\
-        if (!vector->data)\
-            return;\
-        int32_t strides = vector->next_slot;\
-        inner_type **cursor = vector->data;\
-        if (disposer_ ## inner_type != NULL)\
-        {\
-            while (strides > 0)\
-            {\
-                disposer_ ## inner_type(cursor);\
-                cursor++;\
-                strides--;\
-            }\
-        }\
-        free(vector->data);\
-        vector->data = NULL;\
+        vector->storage.heap = items;\
+        vector->count = count;\
+        vector->capacity = (count > CASK_VECTOR_INLINE_CAPACITY) ? count : CASK_VECTOR_INLINE_CAPACITY + 1U;\
+    }\
+    \
+    static inline void vector_clear_ ## tag(tag ## Vector *vector)\
+    {\
+        vector->count = 0U;\
+    }\
+    \
+    static inline void vector_dispose_ ## tag(tag ## Vector *vector, Arena *arena)\
+    {\
+        if (vector->capacity > CASK_VECTOR_INLINE_CAPACITY)\
+            vector_core_release(vector->storage.heap, arena);\
+        vector_init_ ## tag(vector);\
     }\
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,1252 @@
+/**
+ * @file compiler.c
+ * @author Derek Tan
+ * @brief Implements the bytecode compiler.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "backend/compiler.h"
+#include "backend/typecheck.h"
+#include "backend/fold.h"
+#include "backend/purity.h"
+#include "backend/cse.h"
+#include "backend/consteval.h"
+#include "backend/loops.h"
+#include "backend/inliner.h"
+#include "backend/peephole.h"
+
+#define CASK_COMPILER_INIT_NAME "<init>"
+
+/* Compiler utility impls. */
+
+/// @note Only the first error is kept since later ones usually cascade from it.
+static void compiler_report(Compiler *compiler, CompileErrorCode code, SymbolID name)
+{
+    if (compiler->error != CASK_COMPILE_ERR_NONE)
+        return;
+
+    compiler->error = code;
+    compiler->error_name = name;
+}
+
+static bool compiler_ok(const Compiler *compiler)
+{
+    return compiler->error == CASK_COMPILE_ERR_NONE;
+}
+
+static const char *compiler_view_symbol(const Compiler *compiler, SymbolID id, uint32_t *length_out)
+{
+    return symbol_table_view(&compiler->unit->symbols, id, length_out);
+}
+
+static bool compiler_symbol_is(const Compiler *compiler, SymbolID id, const char *text)
+{
+    uint32_t length = 0U;
+    const char *symbol = compiler_view_symbol(compiler, id, &length);
+
+    return symbol != NULL && length == strlen(text) && memcmp(symbol, text, length) == 0;
+}
+
+static CodeObject *compiler_code(Compiler *compiler)
+{
+    return module_get_function(compiler->module, compiler->function);
+}
+
+static uint32_t compiler_code_size(Compiler *compiler)
+{
+    return compiler_code(compiler)->code.count;
+}
+
+/* Emitting helpers. */
+
+static bool compiler_emit_byte(Compiler *compiler, uint8_t byte)
+{
+    if (!vector_append_Byte(&compiler_code(compiler)->code, NULL, byte))
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Follows the operand stack depth along the emitted code to find each function's `max_stack`. Code is structured, so the straight-line depth bounds every path.
+ */
+static void compiler_track_stack(Compiler *compiler, int32_t delta)
+{
+    CodeObject *code = compiler_code(compiler);
+
+    compiler->stack_depth = (uint32_t)((int32_t)compiler->stack_depth + delta);
+
+    if (compiler->stack_depth > code->max_stack)
+        code->max_stack = compiler->stack_depth;
+}
+
+static bool compiler_emit_op(Compiler *compiler, Opcode opcode)
+{
+    if (!compiler_emit_byte(compiler, (uint8_t)opcode))
+        return false;
+
+    compiler_track_stack(compiler, bytecode_stack_effects[opcode]);
+
+    return true;
+}
+
+static bool compiler_emit_u8(Compiler *compiler, Opcode opcode, uint8_t operand)
+{
+    return compiler_emit_op(compiler, opcode) && compiler_emit_byte(compiler, operand);
+}
+
+static bool compiler_emit_u16(Compiler *compiler, Opcode opcode, uint16_t operand)
+{
+    return compiler_emit_op(compiler, opcode) && compiler_emit_byte(compiler, (uint8_t)(operand & 0xffU))
+        && compiler_emit_byte(compiler, (uint8_t)(operand >> 8));
+}
+
+/**
+ * @brief Emits a forward jump with a placeholder offset to fix up by `compiler_patch_jump`.
+ * @return uint32_t Offset of the jump instruction.
+ */
+static uint32_t compiler_emit_jump(Compiler *compiler, Opcode opcode)
+{
+    uint32_t jump_at = compiler_code_size(compiler);
+
+    compiler_emit_u16(compiler, opcode, 0U);
+
+    return jump_at;
+}
+
+static bool compiler_write_jump(Compiler *compiler, uint32_t jump_at, uint32_t target)
+{
+    int64_t offset = (int64_t)target - (int64_t)(jump_at + 3U);
+
+    if (offset < INT16_MIN || offset > INT16_MAX)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    uint8_t *operand = vector_items_Byte(&compiler_code(compiler)->code) + jump_at + 1U;
+    operand[0] = (uint8_t)((uint16_t)offset & 0xffU);
+    operand[1] = (uint8_t)((uint16_t)offset >> 8);
+
+    return true;
+}
+
+/// @brief Points a forward jump at the next instruction to be emitted.
+static bool compiler_patch_jump(Compiler *compiler, uint32_t jump_at)
+{
+    return compiler_ok(compiler) && compiler_write_jump(compiler, jump_at, compiler_code_size(compiler));
+}
+
+static bool compiler_emit_loop(Compiler *compiler, uint32_t loop_start)
+{
+    uint32_t jump_at = compiler_emit_jump(compiler, CASK_BC_JUMP);
+
+    return compiler_ok(compiler) && compiler_write_jump(compiler, jump_at, loop_start);
+}
+
+static bool compiler_emit_constant(Compiler *compiler, Constant constant)
+{
+    if (compiler->module->constants.count >= CASK_COMPILER_MAX_CONSTANTS)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    uint32_t index = module_add_constant(compiler->module, constant);
+
+    if (index == UINT32_MAX)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    return compiler_emit_u16(compiler, CASK_BC_PUSH_CONST, (uint16_t)index);
+}
+
+/**
+ * @brief Copies a symbol into the module string table, turning `\n`, `\t`, `\r` and `\\` escapes into their bytes when `unescape` is set.
+ */
+static uint32_t compiler_add_string(Compiler *compiler, SymbolID id, bool unescape)
+{
+    uint32_t length = 0U;
+    const char *text = compiler_view_symbol(compiler, id, &length);
+    char *buffer = (length > 0U) ? malloc(length) : NULL;
+    uint32_t buffer_length = 0U;
+
+    if (length > 0U && !buffer)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+        return UINT32_MAX;
+    }
+
+    for (uint32_t index = 0; index < length; index++)
+    {
+        char letter = text[index];
+
+        if (unescape && letter == '\\' && index + 1U < length)
+        {
+            switch (text[index + 1U])
+            {
+            case 'n':
+                letter = '\n';
+                break;
+            case 't':
+                letter = '\t';
+                break;
+            case 'r':
+                letter = '\r';
+                break;
+            case '\\':
+                letter = '\\';
+                break;
+            default:
+                break;
+            }
+
+            // Unknown escapes are kept as written.
+            if (letter != '\\' || text[index + 1U] == '\\')
+                index++;
+        }
+
+        buffer[buffer_length++] = letter;
+    }
+
+    uint32_t string_index = module_add_string(compiler->module, buffer, buffer_length);
+    free(buffer);
+
+    if (string_index == UINT32_MAX)
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+
+    return string_index;
+}
+
+/* Name resolution. */
+
+static Binding compiler_lookup_binding(const Compiler *compiler, SymbolID name)
+{
+    return compiler->bindings[name];
+}
+
+static bool compiler_bind(Compiler *compiler, SymbolID name, BindingKind kind, uint32_t index)
+{
+    if (compiler->bindings[name].kind != CASK_BIND_NONE)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_REDEFINED, name);
+        return false;
+    }
+
+    compiler->bindings[name] = (Binding){.index = index, .kind = kind};
+
+    return true;
+}
+
+/**
+ * @brief Finds the innermost local with a name.
+ * @return int32_t The slot, or -1 if the name is not a local.
+ */
+static int32_t compiler_resolve_local(const Compiler *compiler, SymbolID name)
+{
+    for (int32_t slot = (int32_t)compiler->local_count - 1; slot >= 0; slot--)
+    {
+        if (compiler->locals[slot].name == name)
+            return slot;
+    }
+
+    return -1;
+}
+
+static bool compiler_add_local(Compiler *compiler, SymbolID name, TypeInfo type, uint8_t *slot_out)
+{
+    for (int32_t slot = (int32_t)compiler->local_count - 1; slot >= 0 && compiler->locals[slot].depth == compiler->scope_depth; slot--)
+    {
+        if (compiler->locals[slot].name == name)
+        {
+            compiler_report(compiler, CASK_COMPILE_ERR_REDEFINED, name);
+            return false;
+        }
+    }
+
+    if (compiler->local_count == CASK_COMPILER_MAX_LOCALS)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, name);
+        return false;
+    }
+
+    *slot_out = (uint8_t)compiler->local_count;
+    compiler->locals[compiler->local_count++] = (LocalSlot){.name = name, .type = type, .depth = compiler->scope_depth};
+
+    CodeObject *code = compiler_code(compiler);
+
+    if (compiler->local_count > code->slot_count)
+        code->slot_count = (uint8_t)compiler->local_count;
+
+    return true;
+}
+
+static void compiler_begin_scope(Compiler *compiler)
+{
+    compiler->scope_depth++;
+}
+
+static void compiler_end_scope(Compiler *compiler)
+{
+    while (compiler->local_count > 0U && compiler->locals[compiler->local_count - 1U].depth == compiler->scope_depth)
+        compiler->local_count--;
+
+    compiler->scope_depth--;
+}
+
+/* Static types. */
+
+static TypeInfo compiler_decl_type(uint16_t mask, SymbolID name)
+{
+    return (TypeInfo){.mask = mask, .name = name};
+}
+
+int32_t compiler_find_field(const Compiler *compiler, TypeInfo aggregate_type, SymbolID field, TypeInfo *field_type)
+{
+    if ((aggregate_type.mask >> 8) != CASK_COMPTYPE_AGGREGATE || aggregate_type.name == CASK_SYMBOL_NONE)
+        return -1;
+
+    Binding binding = compiler_lookup_binding(compiler, aggregate_type.name);
+
+    if (binding.kind != CASK_BIND_AGGREGATE)
+        return -1;
+
+    const Statement *aggregate = vector_at_Statement(&compiler->aggregates, binding.index);
+
+    for (uint32_t index = 0; index < aggregate->contents.aggr_decl.members.count; index++)
+    {
+        const Statement *member = vector_at_Statement(&aggregate->contents.aggr_decl.members, index);
+
+        if (member->contents.field_decl.name == field)
+        {
+            *field_type = compiler_decl_type(member->contents.field_decl.type_mask, member->contents.field_decl.type_name);
+            return (int32_t)index;
+        }
+    }
+
+    return -1;
+}
+
+static TypeInfo compiler_type_of(const Expression *expr)
+{
+    return (TypeInfo){.mask = expr->type_mask, .name = expr->type_name};
+}
+
+/* Expression compiling. */
+
+static bool compiler_compile_expr(Compiler *compiler, const Expression *expr);
+
+static bool compiler_compile_expr_list(Compiler *compiler, const ExpressionVector *items)
+{
+    for (uint32_t index = 0; index < items->count && compiler_ok(compiler); index++)
+        compiler_compile_expr(compiler, vector_at_Expression(items, index));
+
+    return compiler_ok(compiler);
+}
+
+static bool compiler_compile_integer(Compiler *compiler, int32_t value)
+{
+    if (value >= INT16_MIN && value <= INT16_MAX)
+        return compiler_emit_u16(compiler, CASK_BC_PUSH_INT16, (uint16_t)(int16_t)value);
+
+    return compiler_emit_constant(compiler, (Constant){.as.integer = value, .type = CASK_CONST_INTEGER});
+}
+
+static bool compiler_compile_string(Compiler *compiler, SymbolID value)
+{
+    uint32_t cached = compiler->string_constants[value];
+
+    if (cached != 0U)
+        return compiler_emit_u16(compiler, CASK_BC_PUSH_CONST, (uint16_t)(cached - 1U));
+
+    uint32_t string_index = compiler_add_string(compiler, value, true);
+
+    if (string_index == UINT32_MAX || !compiler_emit_constant(compiler, (Constant){.as.string = string_index, .type = CASK_CONST_STRING}))
+        return false;
+
+    compiler->string_constants[value] = compiler->module->constants.count;
+
+    return true;
+}
+
+static bool compiler_compile_identifier(Compiler *compiler, SymbolID name)
+{
+    int32_t slot = compiler_resolve_local(compiler, name);
+
+    if (slot >= 0)
+        return compiler_emit_u8(compiler, CASK_BC_LOAD_LOCAL, (uint8_t)slot);
+
+    Binding binding = compiler_lookup_binding(compiler, name);
+
+    if (binding.kind == CASK_BIND_GLOBAL)
+        return compiler_emit_u16(compiler, CASK_BC_LOAD_GLOBAL, (uint16_t)binding.index);
+
+    compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+
+    return false;
+}
+
+static bool compiler_compile_call(Compiler *compiler, const Expression *expr)
+{
+    SymbolID name = expr->contents.call.name;
+    const ExpressionVector *args = &expr->contents.call.args;
+    Binding binding = compiler_lookup_binding(compiler, name);
+
+    if (binding.kind == CASK_BIND_FUNCTION)
+    {
+        const Statement *decl = vector_at_Statement(&compiler->functions, binding.index);
+
+        if (args->count != decl->contents.func_decl.params.count)
+        {
+            compiler_report(compiler, CASK_COMPILE_ERR_ARITY, name);
+            return false;
+        }
+
+        if (!compiler_compile_expr_list(compiler, args) || !compiler_emit_u16(compiler, CASK_BC_CALL, (uint16_t)binding.index))
+            return false;
+
+        compiler_track_stack(compiler, -(int32_t)args->count);
+
+        return compiler_emit_byte(compiler, (uint8_t)args->count);
+    }
+
+    if (binding.kind == CASK_BIND_NATIVE)
+    {
+        int8_t arity = bytecode_natives[binding.index].arity;
+
+        if ((arity == CASK_NATIVE_VARIADIC && args->count == 0U) || (arity != CASK_NATIVE_VARIADIC && args->count != (uint32_t)arity)
+            || args->count > UINT8_MAX)
+        {
+            compiler_report(compiler, CASK_COMPILE_ERR_ARITY, name);
+            return false;
+        }
+
+        if (!compiler_compile_expr_list(compiler, args) || !compiler_emit_u8(compiler, CASK_BC_CALL_NATIVE, (uint8_t)binding.index))
+            return false;
+
+        compiler_track_stack(compiler, -(int32_t)args->count);
+
+        return compiler_emit_byte(compiler, (uint8_t)args->count);
+    }
+
+    compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+
+    return false;
+}
+
+/**
+ * @brief Resolves the field index of an `.field` access on a statically typed aggregate.
+ */
+static bool compiler_resolve_field(Compiler *compiler, const Expression *access, uint8_t *field_out)
+{
+    TypeInfo field_type;
+    SymbolID field = access->contents.access.key->contents.identifier.name;
+    int32_t index = compiler_find_field(compiler, compiler_type_of(access->contents.access.target), field, &field_type);
+
+    if (index < 0 || index > UINT8_MAX)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_NAME, field);
+        return false;
+    }
+
+    *field_out = (uint8_t)index;
+
+    return true;
+}
+
+static bool compiler_compile_access(Compiler *compiler, const Expression *expr)
+{
+    if (expr->contents.access.has_aggr)
+    {
+        uint8_t field = 0U;
+
+        return compiler_resolve_field(compiler, expr, &field) && compiler_compile_expr(compiler, expr->contents.access.target)
+            && compiler_emit_u8(compiler, CASK_BC_GET_FIELD, field);
+    }
+
+    return compiler_compile_expr(compiler, expr->contents.access.target) && compiler_compile_expr(compiler, expr->contents.access.key)
+        && compiler_emit_op(compiler, expr->contents.access.in_bounds ? CASK_BC_INDEX_UNCHECKED : CASK_BC_INDEX);
+}
+
+static bool compiler_compile_logical(Compiler *compiler, const Expression *expr)
+{
+    Opcode jump_op = (expr->contents.conditional.op == CASK_OP_AND) ? CASK_BC_JUMP_IF_FALSE_OR_POP : CASK_BC_JUMP_IF_TRUE_OR_POP;
+
+    if (!compiler_compile_expr(compiler, expr->contents.conditional.left))
+        return false;
+
+    uint32_t jump_at = compiler_emit_jump(compiler, jump_op);
+
+    return compiler_compile_expr(compiler, expr->contents.conditional.right) && compiler_patch_jump(compiler, jump_at);
+}
+
+/**
+ * @brief Picks the opcode of a binary operator, preferring the typed form when the checker proved both operands are ints, floats or strings.
+ */
+static Opcode compiler_binary_opcode(OperatorType op, TypeInfo operand_type)
+{
+    static const Opcode generic_opcodes[] = {
+        [CASK_OP_NONE] = CASK_BC_NOP,
+        [CASK_OP_ADD] = CASK_BC_ADD,
+        [CASK_OP_SUB] = CASK_BC_SUB,
+        [CASK_OP_MUL] = CASK_BC_MUL,
+        [CASK_OP_DIV] = CASK_BC_DIV,
+        [CASK_OP_LT] = CASK_BC_LT,
+        [CASK_OP_LTE] = CASK_BC_LTE,
+        [CASK_OP_GT] = CASK_BC_GT,
+        [CASK_OP_GTE] = CASK_BC_GTE,
+        [CASK_OP_EQ] = CASK_BC_EQ,
+        [CASK_OP_NEQ] = CASK_BC_NEQ,
+        [CASK_OP_AND] = CASK_BC_NOP,
+        [CASK_OP_OR] = CASK_BC_NOP,
+        [CASK_OP_SHL] = CASK_BC_NOP,
+        [CASK_OP_SHR] = CASK_BC_NOP
+    };
+    static const Opcode int_opcodes[] = {
+        [CASK_OP_NONE] = CASK_BC_NOP,
+        [CASK_OP_ADD] = CASK_BC_ADD_I32,
+        [CASK_OP_SUB] = CASK_BC_SUB_I32,
+        [CASK_OP_MUL] = CASK_BC_MUL_I32,
+        [CASK_OP_DIV] = CASK_BC_DIV_I32,
+        [CASK_OP_LT] = CASK_BC_LT_I32,
+        [CASK_OP_LTE] = CASK_BC_LTE_I32,
+        [CASK_OP_GT] = CASK_BC_GT_I32,
+        [CASK_OP_GTE] = CASK_BC_GTE_I32,
+        [CASK_OP_EQ] = CASK_BC_EQ_I32,
+        [CASK_OP_NEQ] = CASK_BC_NEQ_I32,
+        [CASK_OP_AND] = CASK_BC_NOP,
+        [CASK_OP_OR] = CASK_BC_NOP,
+        [CASK_OP_SHL] = CASK_BC_SHL_I32,
+        [CASK_OP_SHR] = CASK_BC_SHR_I32
+    };
+    static const Opcode float_opcodes[] = {
+        [CASK_OP_NONE] = CASK_BC_NOP,
+        [CASK_OP_ADD] = CASK_BC_ADD_F32,
+        [CASK_OP_SUB] = CASK_BC_SUB_F32,
+        [CASK_OP_MUL] = CASK_BC_MUL_F32,
+        [CASK_OP_DIV] = CASK_BC_DIV_F32,
+        [CASK_OP_LT] = CASK_BC_LT_F32,
+        [CASK_OP_LTE] = CASK_BC_LTE_F32,
+        [CASK_OP_GT] = CASK_BC_GT_F32,
+        [CASK_OP_GTE] = CASK_BC_GTE_F32,
+        [CASK_OP_EQ] = CASK_BC_EQ_F32,
+        [CASK_OP_NEQ] = CASK_BC_NEQ_F32,
+        [CASK_OP_AND] = CASK_BC_NOP,
+        [CASK_OP_OR] = CASK_BC_NOP,
+        [CASK_OP_SHL] = CASK_BC_NOP,
+        [CASK_OP_SHR] = CASK_BC_NOP
+    };
+
+    if (operand_type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_INTEGER))
+        return int_opcodes[op];
+
+    if (operand_type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_FLOAT))
+        return float_opcodes[op];
+
+    // Booleans have one encoding per value, so the bitwise integer compare fits them too.
+    if (operand_type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_BOOLEAN) && (op == CASK_OP_EQ || op == CASK_OP_NEQ))
+        return int_opcodes[op];
+
+    if (operand_type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_STRING))
+    {
+        if (op == CASK_OP_ADD)
+            return CASK_BC_CONCAT_STR;
+
+        if (op == CASK_OP_EQ || op == CASK_OP_NEQ)
+            return (op == CASK_OP_EQ) ? CASK_BC_EQ_STR : CASK_BC_NEQ_STR;
+    }
+
+    return generic_opcodes[op];
+}
+
+static bool compiler_compile_binary(Compiler *compiler, const Expression *expr)
+{
+    const Expression *left = expr->contents.term.left;
+    const Expression *right = expr->contents.term.right;
+
+    if (expr->type == CASK_EXPR_CONDITIONAL)
+        return compiler_compile_logical(compiler, expr);
+
+    // Shifts come from the folding pass with the count as an int literal, which becomes the operand.
+    if (expr->contents.factor.op == CASK_OP_SHL || expr->contents.factor.op == CASK_OP_SHR)
+    {
+        return compiler_compile_expr(compiler, left)
+            && compiler_emit_u8(compiler, compiler_binary_opcode(expr->contents.factor.op, compiler_type_of(left)), (uint8_t)right->contents.integer.value);
+    }
+
+    // Typed ops need both sides typed alike, which `x == nil` style compares are not.
+    TypeInfo operand_type = compiler_type_of(left);
+
+    if (operand_type.mask != right->type_mask)
+        operand_type.mask = CASK_TYPE_MASK(CASK_COMPTYPE_UNKNOWN, CASK_DATATYPE_UNKNOWN);
+
+    return compiler_compile_expr(compiler, left) && compiler_compile_expr(compiler, right)
+        && compiler_emit_op(compiler, compiler_binary_opcode(expr->contents.term.op, operand_type));
+}
+
+/**
+ * @brief Gives a CSE temp a fresh slot for the rest of the statement and saves the value on top of the stack into it.
+ */
+static bool compiler_save_temp(Compiler *compiler, uint8_t temp)
+{
+    // Temps have no name, so they skip the redefinition check of `compiler_add_local`.
+    if (compiler->local_count == CASK_COMPILER_MAX_LOCALS)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    uint8_t slot = (uint8_t)compiler->local_count;
+    CodeObject *code = compiler_code(compiler);
+
+    compiler->locals[compiler->local_count++] = (LocalSlot){.name = CASK_SYMBOL_NONE, .type = {0}, .depth = compiler->scope_depth};
+    compiler->temp_slots[temp] = slot;
+
+    if (compiler->local_count > code->slot_count)
+        code->slot_count = (uint8_t)compiler->local_count;
+
+    return compiler_emit_u8(compiler, CASK_BC_TEE_LOCAL, slot);
+}
+
+/**
+ * @brief Frees the temp slots of a finished statement. Every local above `local_base` is a temp, as statements declare at most one local, and only after their temps are dropped.
+ */
+static void compiler_drop_temps(Compiler *compiler, uint32_t local_base)
+{
+    compiler->local_count = local_base;
+}
+
+static bool compiler_compile_node(Compiler *compiler, const Expression *expr)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+        if (expr->contents.special.is_nil)
+            return compiler_emit_op(compiler, CASK_BC_PUSH_NIL);
+
+        return compiler_emit_op(compiler, expr->contents.special.boolean ? CASK_BC_PUSH_TRUE : CASK_BC_PUSH_FALSE);
+    case CASK_EXPR_LITERAL_INTEGER:
+        return compiler_compile_integer(compiler, expr->contents.integer.value);
+    case CASK_EXPR_LITERAL_FLOAT:
+        return compiler_emit_constant(compiler, (Constant){.as.realnum = expr->contents.realnum.value, .type = CASK_CONST_FLOAT});
+    case CASK_EXPR_LITERAL_STRING:
+        return compiler_compile_string(compiler, expr->contents.string.value);
+    case CASK_EXPR_LITERAL_ARRAY:
+        if (expr->contents.array.values.count > UINT16_MAX)
+        {
+            compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, CASK_SYMBOL_NONE);
+            return false;
+        }
+
+        if (!compiler_compile_expr_list(compiler, &expr->contents.array.values)
+            || !compiler_emit_u16(compiler, CASK_BC_MAKE_ARRAY, (uint16_t)expr->contents.array.values.count))
+            return false;
+
+        compiler_track_stack(compiler, -(int32_t)expr->contents.array.values.count);
+
+        return true;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        if (expr->contents.aggregate.literals.count > UINT8_MAX)
+        {
+            compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, CASK_SYMBOL_NONE);
+            return false;
+        }
+
+        if (!compiler_compile_expr_list(compiler, &expr->contents.aggregate.literals)
+            || !compiler_emit_u16(compiler, CASK_BC_MAKE_AGGR, (uint16_t)expr->contents.aggregate.literals.count))
+            return false;
+
+        compiler_track_stack(compiler, -(int32_t)expr->contents.aggregate.literals.count);
+
+        return true;
+    case CASK_EXPR_IDENTIFIER:
+        return compiler_compile_identifier(compiler, expr->contents.identifier.name);
+    case CASK_EXPR_CALL:
+        return compiler_compile_call(compiler, expr);
+    case CASK_EXPR_ACCESS:
+        return compiler_compile_access(compiler, expr);
+    case CASK_EXPR_TEMP:
+        return compiler_emit_u8(compiler, CASK_BC_LOAD_LOCAL, compiler->temp_slots[expr->contents.temp.index]);
+    default:
+        return compiler_compile_binary(compiler, expr);
+    }
+}
+
+static bool compiler_compile_expr(Compiler *compiler, const Expression *expr)
+{
+    if (!compiler_ok(compiler) || !compiler_compile_node(compiler, expr))
+        return false;
+
+    return expr->temp_def == 0U || compiler_save_temp(compiler, expr->temp_def - 1U);
+}
+
+/* Statement compiling. */
+
+static bool compiler_compile_stmt(Compiler *compiler, const Statement *stmt);
+
+static bool compiler_compile_block(Compiler *compiler, const Statement *block)
+{
+    compiler_begin_scope(compiler);
+
+    for (uint32_t index = 0; index < block->contents.block.stmts.count && compiler_ok(compiler); index++)
+        compiler_compile_stmt(compiler, vector_at_Statement(&block->contents.block.stmts, index));
+
+    compiler_end_scope(compiler);
+
+    return compiler_ok(compiler);
+}
+
+static bool compiler_compile_decl(Compiler *compiler, const Statement *stmt)
+{
+    SymbolID name = stmt->contents.prim_decl.name;
+    uint32_t local_base = compiler->local_count;
+
+    if (!compiler_compile_expr(compiler, stmt->contents.prim_decl.value))
+        return false;
+
+    compiler_drop_temps(compiler, local_base);
+
+    // Top-level declarations are globals stored by the init function.
+    if (compiler->scope_depth == 0U)
+        return compiler_emit_u16(compiler, CASK_BC_STORE_GLOBAL, (uint16_t)compiler_lookup_binding(compiler, name).index);
+
+    uint8_t slot = 0U;
+
+    /// @note The local is added after its initializer, so `x: int = x` still reads an outer `x`.
+    return compiler_add_local(compiler, name, compiler_decl_type(stmt->contents.prim_decl.type_mask, stmt->contents.prim_decl.type_name), &slot)
+        && compiler_emit_u8(compiler, CASK_BC_STORE_LOCAL, slot);
+}
+
+static bool compiler_compile_reassign(Compiler *compiler, const Statement *stmt)
+{
+    const Expression *target = stmt->contents.reassign.target;
+    const Expression *value = stmt->contents.reassign.value;
+
+    if (target->type == CASK_EXPR_IDENTIFIER)
+    {
+        SymbolID name = target->contents.identifier.name;
+        int32_t slot = compiler_resolve_local(compiler, name);
+
+        if (!compiler_compile_expr(compiler, value))
+            return false;
+
+        if (slot >= 0)
+            return compiler_emit_u8(compiler, CASK_BC_STORE_LOCAL, (uint8_t)slot);
+
+        Binding binding = compiler_lookup_binding(compiler, name);
+
+        if (binding.kind == CASK_BIND_GLOBAL)
+            return compiler_emit_u16(compiler, CASK_BC_STORE_GLOBAL, (uint16_t)binding.index);
+
+        compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+        return false;
+    }
+
+    if (target->type != CASK_EXPR_ACCESS)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_BAD_TARGET, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    if (target->contents.access.has_aggr)
+    {
+        uint8_t field = 0U;
+
+        return compiler_resolve_field(compiler, target, &field) && compiler_compile_expr(compiler, target->contents.access.target)
+            && compiler_compile_expr(compiler, value) && compiler_emit_u8(compiler, CASK_BC_SET_FIELD, field);
+    }
+
+    return compiler_compile_expr(compiler, target->contents.access.target) && compiler_compile_expr(compiler, target->contents.access.key)
+        && compiler_compile_expr(compiler, value) && compiler_emit_op(compiler, target->contents.access.in_bounds ? CASK_BC_SET_INDEX_UNCHECKED : CASK_BC_SET_INDEX);
+}
+
+/**
+ * @brief Computes the values hoisted out of a loop's condition into temps, which keep their slots until the loop ends.
+ */
+static bool compiler_compile_hoists(Compiler *compiler, const Statement *loop)
+{
+    for (uint32_t index = 0; index < compiler->hoists.count; index++)
+    {
+        const LoopHoist *hoist = vector_ref_LoopHoist(&compiler->hoists, index);
+
+        if (hoist->loop == loop && (!compiler_compile_expr(compiler, &hoist->value) || !compiler_emit_op(compiler, CASK_BC_POP)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool compiler_compile_while(Compiler *compiler, const Statement *stmt)
+{
+    uint32_t hoist_base = compiler->local_count;
+
+    if (!compiler_compile_hoists(compiler, stmt))
+        return false;
+
+    uint32_t loop_start = compiler_code_size(compiler);
+    uint32_t local_base = compiler->local_count;
+
+    if (!compiler_compile_expr(compiler, stmt->contents.while_ctrl.condition))
+        return false;
+
+    compiler_drop_temps(compiler, local_base);
+
+    uint32_t exit_jump = compiler_emit_jump(compiler, CASK_BC_JUMP_IF_FALSE);
+    bool ok = compiler_compile_block(compiler, stmt->contents.while_ctrl.block) && compiler_emit_loop(compiler, loop_start)
+        && compiler_patch_jump(compiler, exit_jump);
+
+    compiler_drop_temps(compiler, hoist_base);
+
+    return ok;
+}
+
+static bool compiler_compile_if(Compiler *compiler, const Statement *stmt)
+{
+    const Statement *other = stmt->contents.if_ctrl.other;
+    uint32_t local_base = compiler->local_count;
+
+    if (!compiler_compile_expr(compiler, stmt->contents.if_ctrl.condition))
+        return false;
+
+    compiler_drop_temps(compiler, local_base);
+
+    uint32_t else_jump = compiler_emit_jump(compiler, CASK_BC_JUMP_IF_FALSE);
+
+    if (!compiler_compile_block(compiler, stmt->contents.if_ctrl.block))
+        return false;
+
+    if (!other)
+        return compiler_patch_jump(compiler, else_jump);
+
+    uint32_t end_jump = compiler_emit_jump(compiler, CASK_BC_JUMP);
+
+    return compiler_patch_jump(compiler, else_jump) && compiler_compile_block(compiler, other->contents.else_ctrl.block)
+        && compiler_patch_jump(compiler, end_jump);
+}
+
+static bool compiler_compile_stmt(Compiler *compiler, const Statement *stmt)
+{
+    uint32_t local_base = compiler->local_count;
+    bool ok = false;
+
+    if (!compiler_ok(compiler))
+        return false;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        return compiler_compile_decl(compiler, stmt);
+    case CASK_STMT_WHILE:
+        return compiler_compile_while(compiler, stmt);
+    case CASK_STMT_IF:
+        return compiler_compile_if(compiler, stmt);
+    case CASK_STMT_BLOCK:
+        return compiler_compile_block(compiler, stmt);
+    case CASK_STMT_RETURN:
+        if (!stmt->contents.return_stmt.value)
+            return compiler_emit_op(compiler, CASK_BC_RETURN_NIL);
+
+        ok = compiler_compile_expr(compiler, stmt->contents.return_stmt.value) && compiler_emit_op(compiler, CASK_BC_RETURN);
+        break;
+    case CASK_STMT_REASSIGN:
+        ok = compiler_compile_reassign(compiler, stmt);
+        break;
+    case CASK_STMT_EXPR:
+        ok = compiler_compile_expr(compiler, stmt->contents.expr_stmt.expr) && compiler_emit_op(compiler, CASK_BC_POP);
+        break;
+    default:
+        // Imports, aggregates and functions were handled by the declaring pass.
+        return true;
+    }
+
+    compiler_drop_temps(compiler, local_base);
+
+    return ok;
+}
+
+static bool compiler_compile_function(Compiler *compiler, uint32_t function_index)
+{
+    const Statement *decl = vector_at_Statement(&compiler->functions, function_index);
+    uint8_t slot = 0U;
+
+    compiler->function = function_index;
+    compiler->local_count = 0U;
+    compiler->scope_depth = 1U;
+    compiler->stack_depth = 0U;
+
+    for (uint32_t index = 0; index < decl->contents.func_decl.params.count && compiler_ok(compiler); index++)
+    {
+        const Statement *param = vector_at_Statement(&decl->contents.func_decl.params, index);
+
+        compiler_add_local(compiler, param->contents.param_decl.name,
+            compiler_decl_type(param->contents.param_decl.type_mask, param->contents.param_decl.type_name), &slot);
+    }
+
+    compiler_compile_block(compiler, decl->contents.func_decl.block);
+
+    // Falling off the end returns nil.
+    compiler_emit_op(compiler, CASK_BC_RETURN_NIL);
+
+    compiler->function = compiler->module->init_function;
+    compiler->local_count = 0U;
+    compiler->scope_depth = 0U;
+    compiler->stack_depth = 0U;
+
+    return compiler_ok(compiler);
+}
+
+/* Declaring pass. */
+
+static bool compiler_declare_import(Compiler *compiler, const Statement *stmt)
+{
+    SymbolID module_name = stmt->contents.import.name;
+    const ExpressionVector *items = &stmt->contents.import.items;
+    bool known_module = false;
+
+    for (uint32_t native = 0; native < CASK_NATIVE_COUNT; native++)
+    {
+        const NativeInfo *info = &bytecode_natives[native];
+
+        if (!info->module || !compiler_symbol_is(compiler, module_name, info->module))
+            continue;
+
+        known_module = true;
+
+        // `from "io" import *` brings in every native of the module.
+        if (items->count == 0U)
+        {
+            SymbolID name = symbol_table_find(&compiler->unit->symbols, info->name, (uint32_t)strlen(info->name));
+
+            if (name != CASK_SYMBOL_NONE && compiler_lookup_binding(compiler, name).kind == CASK_BIND_NONE)
+                compiler_bind(compiler, name, CASK_BIND_NATIVE, native);
+        }
+    }
+
+    if (!known_module)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_MODULE, module_name);
+        return false;
+    }
+
+    for (uint32_t index = 0; index < items->count && compiler_ok(compiler); index++)
+    {
+        SymbolID name = vector_at_Expression(items, index)->contents.identifier.name;
+        bool found = false;
+
+        for (uint32_t native = 0; native < CASK_NATIVE_COUNT && !found; native++)
+        {
+            const NativeInfo *info = &bytecode_natives[native];
+
+            if (info->module != NULL && compiler_symbol_is(compiler, module_name, info->module) && compiler_symbol_is(compiler, name, info->name))
+            {
+                found = true;
+
+                // Importing the same native twice is harmless.
+                if (compiler_lookup_binding(compiler, name).kind != CASK_BIND_NATIVE)
+                    compiler_bind(compiler, name, CASK_BIND_NATIVE, native);
+            }
+        }
+
+        if (!found)
+            compiler_report(compiler, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+    }
+
+    return compiler_ok(compiler);
+}
+
+static bool compiler_declare_function(Compiler *compiler, Statement *stmt)
+{
+    SymbolID name = stmt->contents.func_decl.name;
+    uint32_t name_index = compiler_add_string(compiler, name, false);
+
+    if (!compiler_ok(compiler))
+        return false;
+
+    if (stmt->contents.func_decl.params.count > UINT8_MAX)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, name);
+        return false;
+    }
+
+    uint32_t index = module_add_function(compiler->module, name_index);
+
+    if (index == UINT32_MAX || index > UINT16_MAX || !vector_append_Statement(&compiler->functions, NULL, stmt))
+    {
+        compiler_report(compiler, (index == UINT32_MAX) ? CASK_COMPILE_ERR_GENERAL : CASK_COMPILE_ERR_LIMIT, name);
+        return false;
+    }
+
+    CodeObject *function = module_get_function(compiler->module, index);
+    function->arity = (uint8_t)stmt->contents.func_decl.params.count;
+    function->return_mask = stmt->contents.func_decl.type_mask;
+
+    if (compiler_symbol_is(compiler, name, "main"))
+        compiler->module->main_function = index;
+
+    return compiler_bind(compiler, name, CASK_BIND_FUNCTION, index);
+}
+
+static bool compiler_declare_global(Compiler *compiler, const Statement *stmt)
+{
+    SymbolID name = stmt->contents.prim_decl.name;
+    uint32_t index = compiler->module->global_count;
+
+    if (index == UINT16_MAX)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_LIMIT, name);
+        return false;
+    }
+
+    compiler->global_types[index] = compiler_decl_type(stmt->contents.prim_decl.type_mask, stmt->contents.prim_decl.type_name);
+    compiler->module->global_count++;
+
+    return compiler_bind(compiler, name, CASK_BIND_GLOBAL, index);
+}
+
+static bool compiler_declare_toplevel(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+    uint32_t global_capacity = 0U;
+
+    for (uint32_t index = 0; index < statements->count; index++)
+        global_capacity += (vector_at_Statement(statements, index)->type == CASK_STMT_PRIMITIVE_DECL) ? 1U : 0U;
+
+    compiler->global_types = malloc((global_capacity > 0U ? global_capacity : 1U) * sizeof(TypeInfo));
+
+    if (!compiler->global_types)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+        return false;
+    }
+
+    // Builtins are visible everywhere unless a program defines the same name.
+    for (uint32_t native = 0; native < CASK_NATIVE_COUNT; native++)
+    {
+        const char *native_name = bytecode_natives[native].name;
+        SymbolID name = symbol_table_find(&compiler->unit->symbols, native_name, (uint32_t)strlen(native_name));
+
+        if (!bytecode_natives[native].module && name != CASK_SYMBOL_NONE)
+            compiler->bindings[name] = (Binding){.index = native, .kind = CASK_BIND_NATIVE};
+    }
+
+    for (uint32_t index = 0; index < statements->count && compiler_ok(compiler); index++)
+    {
+        Statement *stmt = vector_at_Statement(statements, index);
+
+        if (stmt->type != CASK_STMT_IMPORT)
+        {
+            if (stmt->type == CASK_STMT_FUNCTION_DECL || stmt->type == CASK_STMT_AGGREGATE_DECL || stmt->type == CASK_STMT_PRIMITIVE_DECL)
+            {
+                SymbolID name = (stmt->type == CASK_STMT_FUNCTION_DECL) ? stmt->contents.func_decl.name
+                    : (stmt->type == CASK_STMT_AGGREGATE_DECL) ? stmt->contents.aggr_decl.name : stmt->contents.prim_decl.name;
+
+                if (compiler->bindings[name].kind == CASK_BIND_NATIVE && !bytecode_natives[compiler->bindings[name].index].module)
+                    compiler->bindings[name].kind = CASK_BIND_NONE;
+            }
+        }
+
+        switch (stmt->type)
+        {
+        case CASK_STMT_IMPORT:
+            compiler_declare_import(compiler, stmt);
+            break;
+        case CASK_STMT_AGGREGATE_DECL:
+            if (vector_append_Statement(&compiler->aggregates, NULL, stmt))
+                compiler_bind(compiler, stmt->contents.aggr_decl.name, CASK_BIND_AGGREGATE, compiler->aggregates.count - 1U);
+            else
+                compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+            break;
+        case CASK_STMT_FUNCTION_DECL:
+            compiler_declare_function(compiler, stmt);
+            break;
+        case CASK_STMT_PRIMITIVE_DECL:
+            compiler_declare_global(compiler, stmt);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return compiler_ok(compiler);
+}
+
+static bool compiler_compile_toplevel(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+
+    for (uint32_t index = 0; index < statements->count && compiler_ok(compiler); index++)
+    {
+        const Statement *stmt = vector_at_Statement(statements, index);
+
+        if (stmt->type == CASK_STMT_FUNCTION_DECL)
+            compiler_compile_function(compiler, compiler_lookup_binding(compiler, stmt->contents.func_decl.name).index);
+        else
+            compiler_compile_stmt(compiler, stmt);
+    }
+
+    compiler->function = compiler->module->init_function;
+
+    return compiler_ok(compiler) && compiler_emit_op(compiler, CASK_BC_RETURN_NIL);
+}
+
+/* Compiler impl. */
+
+void compiler_init(Compiler *compiler)
+{
+    compiler->unit = NULL;
+    compiler->module = NULL;
+    compiler->bindings = NULL;
+    compiler->string_constants = NULL;
+    compiler->global_types = NULL;
+    vector_init_Statement(&compiler->aggregates);
+    vector_init_Statement(&compiler->functions);
+    compiler->pure_functions = NULL;
+    vector_init_LoopHoist(&compiler->hoists);
+    peephole_stats_init(&compiler->peephole);
+    compiler->local_count = 0U;
+    compiler->scope_depth = 0U;
+    compiler->function = 0U;
+    compiler->stack_depth = 0U;
+    compiler->error = CASK_COMPILE_ERR_NONE;
+    compiler->error_name = CASK_SYMBOL_NONE;
+}
+
+/**
+ * @brief Frees the per-compile lookup tables. The module is left alone.
+ */
+static void compiler_release(Compiler *compiler)
+{
+    free(compiler->bindings);
+    free(compiler->string_constants);
+    free(compiler->global_types);
+    free(compiler->pure_functions);
+    vector_dispose_Statement(&compiler->aggregates, NULL);
+    vector_dispose_Statement(&compiler->functions, NULL);
+    vector_dispose_LoopHoist(&compiler->hoists, NULL);
+    compiler->bindings = NULL;
+    compiler->string_constants = NULL;
+    compiler->global_types = NULL;
+    compiler->pure_functions = NULL;
+    compiler->unit = NULL;
+    compiler->module = NULL;
+}
+
+static Module *compiler_compile_unit(Compiler *compiler, const ProgramUnit *prog_unit, bool optimize, CompileErrorCode *code_ptr);
+
+/**
+ * @brief Replaces pure calls on literal arguments with their results. These run in a VM over a module compiled first from the same unit, without the call-dependent passes.
+ */
+static void compiler_evaluate_calls(Compiler *compiler)
+{
+    if (!consteval_prepare(compiler))
+        return;
+
+    Compiler *scratch = malloc(sizeof(Compiler));
+    CompileErrorCode scratch_code = CASK_COMPILE_ERR_NONE;
+    Module *snapshot = NULL;
+
+    if (scratch == NULL)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+        return;
+    }
+
+    compiler_init(scratch);
+    snapshot = compiler_compile_unit(scratch, compiler->unit, false, &scratch_code);
+
+    if (snapshot != NULL)
+    {
+        consteval_unit(compiler, snapshot);
+        module_dispose(snapshot);
+        free(snapshot);
+    }
+
+    free(scratch);
+}
+
+Module *compiler_compile(Compiler *compiler, const ProgramUnit *prog_unit, CompileErrorCode *code_ptr)
+{
+    return compiler_compile_unit(compiler, prog_unit, true, code_ptr);
+}
+
+/**
+ * @param optimize Whether to run the passes after purity analysis. The scratch compile for ahead of time evaluation goes without them.
+ */
+static Module *compiler_compile_unit(Compiler *compiler, const ProgramUnit *prog_unit, bool optimize, CompileErrorCode *code_ptr)
+{
+    uint32_t symbol_slots = prog_unit->symbols.entry_count + 1U;
+    Module *module = malloc(sizeof(Module));
+
+    compiler_release(compiler);
+    compiler_init(compiler);
+    compiler->unit = prog_unit;
+    compiler->module = module;
+    compiler->bindings = calloc(symbol_slots, sizeof(Binding));
+    compiler->string_constants = calloc(symbol_slots, sizeof(uint32_t));
+
+    if (module != NULL)
+        module_init(module);
+
+    if (!module || !compiler->bindings || !compiler->string_constants)
+    {
+        compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+    }
+    else
+    {
+        uint32_t init_name = module_add_string(module, CASK_COMPILER_INIT_NAME, (uint32_t)strlen(CASK_COMPILER_INIT_NAME));
+
+        // The init function has no declaration, so its slot in `functions` stays NULL.
+        module->init_function = (init_name != UINT32_MAX) ? module_add_function(module, init_name) : UINT32_MAX;
+
+        if (module->init_function == UINT32_MAX || !vector_append_Statement(&compiler->functions, NULL, NULL))
+            compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+
+        compiler->function = module->init_function;
+
+        if (compiler_ok(compiler) && compiler_declare_toplevel(compiler) && typecheck_unit(compiler))
+        {
+            fold_unit(compiler->unit);
+
+            if (purity_analyze(compiler))
+            {
+                if (optimize)
+                {
+                    compiler_evaluate_calls(compiler);
+
+                    if (compiler_ok(compiler) && loops_unit(compiler))
+                        cse_unit(compiler);
+                }
+
+                if (compiler_ok(compiler))
+                    compiler_compile_toplevel(compiler);
+
+                if (optimize && compiler_ok(compiler) && (!inliner_apply(module) || !peephole_apply(module, &compiler->peephole)))
+                    compiler_report(compiler, CASK_COMPILE_ERR_GENERAL, CASK_SYMBOL_NONE);
+            }
+        }
+    }
+
+    *code_ptr = compiler->error;
+    compiler_release(compiler);
+
+    if (*code_ptr != CASK_COMPILE_ERR_NONE)
+    {
+        if (module != NULL)
+            module_dispose(module);
+
+        free(module);
+        return NULL;
+    }
+
+    return module;
+}
@@ -0,0 +1,461 @@
+/**
+ * @file consteval.c
+ * @author Derek Tan
+ * @brief Implements ahead of time evaluation of pure calls.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include "backend/consteval.h"
+#include "backend/fold.h"
+#include "runtime/vm.h"
+
+/// @brief Calls plus loop iterations one evaluation may spend, so that compiling always ends.
+#define CASK_CONSTEVAL_STEP_BUDGET 100000U
+
+/**
+ * @brief A local in scope while propagating. `value` is its literal initializer, or NULL when it is not constant.
+ */
+typedef struct cask_const_local_t
+{
+    SymbolID name;
+    const Expression *value;
+    uint32_t depth;
+} ConstLocal;
+
+typedef struct cask_consteval_state_t
+{
+    Compiler *compiler;
+    uint8_t *stored;                // by SymbolID: set for names the current function stores to
+    ConstLocal locals[CASK_COMPILER_MAX_LOCALS];
+    uint32_t local_count;
+    uint32_t depth;
+    VM *vm;                         // NULL while only counting candidate calls
+    uint32_t candidate_count;
+} ConstEvalState;
+
+static bool consteval_is_literal(const Expression *expr)
+{
+    return expr->type == CASK_EXPR_LITERAL_INTEGER || expr->type == CASK_EXPR_LITERAL_FLOAT || expr->type == CASK_EXPR_LITERAL_SPECIAL;
+}
+
+/* Constant propagation. */
+
+static void consteval_mark_stores(ConstEvalState *state, const Statement *stmt, uint8_t mark)
+{
+    const StatementVector *stmts = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_REASSIGN:
+        if (stmt->contents.reassign.target->type == CASK_EXPR_IDENTIFIER)
+            state->stored[stmt->contents.reassign.target->contents.identifier.name] = mark;
+        return;
+    case CASK_STMT_WHILE:
+        consteval_mark_stores(state, stmt->contents.while_ctrl.block, mark);
+        return;
+    case CASK_STMT_IF:
+        consteval_mark_stores(state, stmt->contents.if_ctrl.block, mark);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            consteval_mark_stores(state, stmt->contents.if_ctrl.other->contents.else_ctrl.block, mark);
+        return;
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t index = 0; index < stmts->count; index++)
+            consteval_mark_stores(state, vector_at_Statement(stmts, index), mark);
+        return;
+    default:
+        return;
+    }
+}
+
+static void consteval_add_local(ConstEvalState *state, SymbolID name, const Expression *value)
+{
+    // The checker already held every scope within the slot limit.
+    if (state->local_count < CASK_COMPILER_MAX_LOCALS)
+        state->locals[state->local_count++] = (ConstLocal){.name = name, .value = value, .depth = state->depth};
+}
+
+static void consteval_propagate_expr(ConstEvalState *state, Expression *expr);
+
+static void consteval_propagate_list(ConstEvalState *state, const ExpressionVector *items)
+{
+    for (uint32_t index = 0; index < items->count; index++)
+        consteval_propagate_expr(state, vector_at_Expression(items, index));
+}
+
+static void consteval_propagate_expr(ConstEvalState *state, Expression *expr)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_IDENTIFIER:
+        for (uint32_t slot = state->local_count; slot > 0U; slot--)
+        {
+            const ConstLocal *local = &state->locals[slot - 1U];
+
+            if (local->name != expr->contents.identifier.name)
+                continue;
+
+            if (local->value != NULL)
+            {
+                uint16_t mask = expr->type_mask;
+                SymbolID type_name = expr->type_name;
+
+                *expr = *local->value;
+                expr->type_mask = mask;
+                expr->type_name = type_name;
+            }
+
+            return;
+        }
+        return;
+    case CASK_EXPR_LITERAL_ARRAY:
+        consteval_propagate_list(state, &expr->contents.array.values);
+        return;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        consteval_propagate_list(state, &expr->contents.aggregate.literals);
+        return;
+    case CASK_EXPR_CALL:
+        consteval_propagate_list(state, &expr->contents.call.args);
+        return;
+    case CASK_EXPR_ACCESS:
+        consteval_propagate_expr(state, expr->contents.access.target);
+
+        if (!expr->contents.access.has_aggr)
+            consteval_propagate_expr(state, expr->contents.access.key);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        consteval_propagate_expr(state, expr->contents.term.left);
+        consteval_propagate_expr(state, expr->contents.term.right);
+        return;
+    default:
+        return;
+    }
+}
+
+static void consteval_propagate_stmt(ConstEvalState *state, Statement *stmt);
+
+static void consteval_propagate_block(ConstEvalState *state, const Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+
+    state->depth++;
+
+    for (uint32_t index = 0; index < stmts->count; index++)
+        consteval_propagate_stmt(state, vector_at_Statement(stmts, index));
+
+    while (state->local_count > 0U && state->locals[state->local_count - 1U].depth == state->depth)
+        state->local_count--;
+
+    state->depth--;
+}
+
+static void consteval_propagate_stmt(ConstEvalState *state, Statement *stmt)
+{
+    Expression *value = NULL;
+    Expression *target = NULL;
+    const Statement *other = NULL;
+    bool is_constant = false;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        value = stmt->contents.prim_decl.value;
+
+        consteval_propagate_expr(state, value);
+        fold_expr(value);
+
+        // Nil initializers stay variables, since the declared reference type may later matter to codegen.
+        is_constant = consteval_is_literal(value) && !state->stored[stmt->contents.prim_decl.name]
+            && (value->type != CASK_EXPR_LITERAL_SPECIAL || !value->contents.special.is_nil);
+
+        consteval_add_local(state, stmt->contents.prim_decl.name, is_constant ? value : NULL);
+        break;
+    case CASK_STMT_WHILE:
+        consteval_propagate_expr(state, stmt->contents.while_ctrl.condition);
+        consteval_propagate_block(state, stmt->contents.while_ctrl.block);
+        break;
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        consteval_propagate_expr(state, stmt->contents.if_ctrl.condition);
+        consteval_propagate_block(state, stmt->contents.if_ctrl.block);
+
+        if (other != NULL)
+            consteval_propagate_block(state, other->contents.else_ctrl.block);
+        break;
+    case CASK_STMT_BLOCK:
+        consteval_propagate_block(state, stmt);
+        break;
+    case CASK_STMT_RETURN:
+        if (stmt->contents.return_stmt.value != NULL)
+            consteval_propagate_expr(state, stmt->contents.return_stmt.value);
+        break;
+    case CASK_STMT_REASSIGN:
+        target = stmt->contents.reassign.target;
+
+        // A stored variable is not read. The object and key of a stored item are.
+        if (target->type == CASK_EXPR_ACCESS)
+            consteval_propagate_expr(state, target);
+
+        consteval_propagate_expr(state, stmt->contents.reassign.value);
+        break;
+    case CASK_STMT_EXPR:
+        consteval_propagate_expr(state, stmt->contents.expr_stmt.expr);
+        break;
+    default:
+        break;
+    }
+}
+
+static void consteval_propagate_function(ConstEvalState *state, const Statement *decl)
+{
+    const StatementVector *params = &decl->contents.func_decl.params;
+
+    consteval_mark_stores(state, decl->contents.func_decl.block, 1U);
+
+    state->local_count = 0U;
+    state->depth = 1U;
+
+    for (uint32_t index = 0; index < params->count; index++)
+        consteval_add_local(state, vector_at_Statement(params, index)->contents.param_decl.name, NULL);
+
+    consteval_propagate_block(state, decl->contents.func_decl.block);
+
+    state->local_count = 0U;
+    state->depth = 0U;
+    consteval_mark_stores(state, decl->contents.func_decl.block, 0U);
+}
+
+/* Call evaluation. */
+
+static bool consteval_is_candidate(const ConstEvalState *state, const Expression *call)
+{
+    const Compiler *compiler = state->compiler;
+    Binding binding = compiler->bindings[call->contents.call.name];
+    const ExpressionVector *args = &call->contents.call.args;
+    DataType result_type = (DataType)(call->type_mask & 0xffU);
+
+    if (binding.kind != CASK_BIND_FUNCTION || !compiler->pure_functions[binding.index] || args->count > UINT8_MAX)
+        return false;
+
+    // Only single values can become literals.
+    if ((call->type_mask >> 8) != CASK_COMPTYPE_SINGLE || result_type == CASK_DATATYPE_STRING || result_type == CASK_DATATYPE_UNKNOWN)
+        return false;
+
+    for (uint32_t index = 0; index < args->count; index++)
+    {
+        if (!consteval_is_literal(vector_at_Expression(args, index)))
+            return false;
+    }
+
+    return true;
+}
+
+static Value consteval_to_value(const Expression *literal)
+{
+    if (literal->type == CASK_EXPR_LITERAL_INTEGER)
+        return value_int(literal->contents.integer.value);
+
+    if (literal->type == CASK_EXPR_LITERAL_FLOAT)
+        return value_float(literal->contents.realnum.value);
+
+    return literal->contents.special.is_nil ? value_nil() : value_bool(literal->contents.special.boolean);
+}
+
+static void consteval_evaluate(ConstEvalState *state, Expression *call)
+{
+    const ExpressionVector *args = &call->contents.call.args;
+    Value arg_values[UINT8_MAX];
+    Value result = value_nil();
+    uint16_t mask = call->type_mask;
+    SymbolID type_name = call->type_name;
+
+    for (uint32_t index = 0; index < args->count; index++)
+        arg_values[index] = consteval_to_value(vector_at_Expression(args, index));
+
+    state->vm->budget = CASK_CONSTEVAL_STEP_BUDGET;
+
+    if (vm_call(state->vm, state->compiler->bindings[call->contents.call.name].index, arg_values, args->count, &result) != CASK_VM_ERR_NONE)
+        return;
+
+    if (value_is_int(result))
+        expression_init_integer_ltrl(call, value_as_int(result));
+    else if (value_is_float(result))
+        expression_init_realnum_ltrl(call, value_as_float(result));
+    else if (value_is_bool(result))
+        expression_init_special_ltrl(call, false, value_as_bool(result));
+    else if (value_is_nil(result))
+        expression_init_special_ltrl(call, true, false);
+    else
+        return;
+
+    call->type_mask = mask;
+    call->type_name = type_name;
+}
+
+static void consteval_calls(ConstEvalState *state, Expression *expr);
+
+static void consteval_calls_in_list(ConstEvalState *state, const ExpressionVector *items)
+{
+    for (uint32_t index = 0; index < items->count; index++)
+        consteval_calls(state, vector_at_Expression(items, index));
+}
+
+/// @note Goes bottom up, so a call whose arguments were calls on literals is evaluated right after them.
+static void consteval_calls(ConstEvalState *state, Expression *expr)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_ARRAY:
+        consteval_calls_in_list(state, &expr->contents.array.values);
+        return;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        consteval_calls_in_list(state, &expr->contents.aggregate.literals);
+        return;
+    case CASK_EXPR_CALL:
+        consteval_calls_in_list(state, &expr->contents.call.args);
+
+        if (!consteval_is_candidate(state, expr))
+            return;
+
+        if (state->vm != NULL)
+            consteval_evaluate(state, expr);
+        else
+            state->candidate_count++;
+        return;
+    case CASK_EXPR_ACCESS:
+        consteval_calls(state, expr->contents.access.target);
+
+        if (!expr->contents.access.has_aggr)
+            consteval_calls(state, expr->contents.access.key);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        consteval_calls(state, expr->contents.term.left);
+        consteval_calls(state, expr->contents.term.right);
+        return;
+    default:
+        return;
+    }
+}
+
+static void consteval_calls_in_stmt(ConstEvalState *state, Statement *stmt)
+{
+    const StatementVector *stmts = NULL;
+    Expression *target = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        consteval_calls(state, stmt->contents.prim_decl.value);
+        return;
+    case CASK_STMT_FUNCTION_DECL:
+        consteval_calls_in_stmt(state, stmt->contents.func_decl.block);
+        return;
+    case CASK_STMT_WHILE:
+        consteval_calls(state, stmt->contents.while_ctrl.condition);
+        consteval_calls_in_stmt(state, stmt->contents.while_ctrl.block);
+        return;
+    case CASK_STMT_IF:
+        consteval_calls(state, stmt->contents.if_ctrl.condition);
+        consteval_calls_in_stmt(state, stmt->contents.if_ctrl.block);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            consteval_calls_in_stmt(state, stmt->contents.if_ctrl.other->contents.else_ctrl.block);
+        return;
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t index = 0; index < stmts->count; index++)
+            consteval_calls_in_stmt(state, vector_at_Statement(stmts, index));
+        return;
+    case CASK_STMT_RETURN:
+        if (stmt->contents.return_stmt.value != NULL)
+            consteval_calls(state, stmt->contents.return_stmt.value);
+        return;
+    case CASK_STMT_REASSIGN:
+        target = stmt->contents.reassign.target;
+
+        if (target->type == CASK_EXPR_ACCESS)
+            consteval_calls(state, target);
+
+        consteval_calls(state, stmt->contents.reassign.value);
+        return;
+    case CASK_STMT_EXPR:
+        consteval_calls(state, stmt->contents.expr_stmt.expr);
+        return;
+    default:
+        return;
+    }
+}
+
+static void consteval_calls_in_unit(ConstEvalState *state)
+{
+    const StatementVector *statements = &state->compiler->unit->statements;
+
+    for (uint32_t index = 0; index < statements->count; index++)
+        consteval_calls_in_stmt(state, vector_at_Statement(statements, index));
+}
+
+/* Pass impls. */
+
+bool consteval_prepare(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+    ConstEvalState *state = malloc(sizeof(ConstEvalState));
+    uint8_t *stored = calloc(compiler->unit->symbols.entry_count + 1U, sizeof(uint8_t));
+    bool has_work = false;
+
+    if (state != NULL && stored != NULL)
+    {
+        *state = (ConstEvalState){.compiler = compiler, .stored = stored, .local_count = 0U, .depth = 0U, .vm = NULL, .candidate_count = 0U};
+
+        for (uint32_t index = 0; index < statements->count; index++)
+        {
+            const Statement *stmt = vector_at_Statement(statements, index);
+
+            if (stmt->type == CASK_STMT_FUNCTION_DECL)
+                consteval_propagate_function(state, stmt);
+        }
+
+        fold_unit(compiler->unit);
+        consteval_calls_in_unit(state);
+        has_work = state->candidate_count > 0U;
+    }
+    else
+    {
+        compiler->error = CASK_COMPILE_ERR_GENERAL;
+    }
+
+    free(stored);
+    free(state);
+
+    return has_work;
+}
+
+void consteval_unit(Compiler *compiler, const Module *snapshot)
+{
+    VM vm;
+    ConstEvalState state = {.compiler = compiler, .stored = NULL, .local_count = 0U, .depth = 0U, .vm = &vm, .candidate_count = 0U};
+
+    // Skipping evaluation only costs speed, so a VM that cannot start is no error.
+    if (!vm_init(&vm, snapshot))
+        return;
+
+    consteval_calls_in_unit(&state);
+    vm_dispose(&vm);
+    fold_unit(compiler->unit);
+}
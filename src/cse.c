@@ -0,0 +1,349 @@
+/**
+ * @file cse.c
+ * @author Derek Tan
+ * @brief Implements common subexpression elimination.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "backend/cse.h"
+#include "backend/purity.h"
+
+#define CASK_CSE_MAX_CANDIDATES 64U
+
+/**
+ * @brief Per-statement state. `candidates` holds the stable subtrees met so far in evaluation order, each of which may become a temp's definition.
+ */
+typedef struct cask_cse_state_t
+{
+    const Compiler *compiler;
+    Expression *candidates[CASK_CSE_MAX_CANDIDATES];
+    uint32_t candidate_count;
+    uint32_t temp_count;
+    uint16_t temp_uses[CASK_COMPILER_MAX_TEMPS];
+} CSEState;
+
+/* Matching. */
+
+/// @return int32_t The temp a node defines or reloads, or -1.
+static int32_t cse_temp_of(const Expression *expr)
+{
+    if (expr->type == CASK_EXPR_TEMP)
+        return expr->contents.temp.index;
+
+    return (int32_t)expr->temp_def - 1;
+}
+
+static bool cse_equal(const Expression *left, const Expression *right);
+
+static bool cse_equal_lists(const ExpressionVector *left, const ExpressionVector *right)
+{
+    if (left->count != right->count)
+        return false;
+
+    for (uint32_t index = 0; index < left->count; index++)
+    {
+        if (!cse_equal(vector_at_Expression(left, index), vector_at_Expression(right, index)))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Structural equality of stable subtrees. A reload equals its definition, so merged parents still match.
+ */
+static bool cse_equal(const Expression *left, const Expression *right)
+{
+    if (left->type == CASK_EXPR_TEMP || right->type == CASK_EXPR_TEMP)
+        return cse_temp_of(left) >= 0 && cse_temp_of(left) == cse_temp_of(right);
+
+    if (left->type != right->type)
+        return false;
+
+    switch (left->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+        return left->contents.special.is_nil == right->contents.special.is_nil
+            && left->contents.special.boolean == right->contents.special.boolean;
+    case CASK_EXPR_LITERAL_INTEGER:
+        return left->contents.integer.value == right->contents.integer.value;
+    case CASK_EXPR_LITERAL_FLOAT:
+        return memcmp(&left->contents.realnum.value, &right->contents.realnum.value, sizeof(float)) == 0;
+    case CASK_EXPR_LITERAL_STRING:
+        return left->contents.string.value == right->contents.string.value;
+    case CASK_EXPR_IDENTIFIER:
+        return left->contents.identifier.name == right->contents.identifier.name;
+    case CASK_EXPR_CALL:
+        return left->contents.call.name == right->contents.call.name && cse_equal_lists(&left->contents.call.args, &right->contents.call.args);
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+        return left->contents.term.op == right->contents.term.op && cse_equal(left->contents.term.left, right->contents.term.left)
+            && cse_equal(left->contents.term.right, right->contents.term.right);
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Turns `expr` into a reload when an earlier candidate matches it, or else records it. Candidates from the subtree of a reloaded node are dropped with it.
+ */
+static void cse_merge(CSEState *state, Expression *expr, uint32_t mark, bool conditional)
+{
+    for (uint32_t index = 0; index < mark; index++)
+    {
+        Expression *earlier = state->candidates[index];
+
+        if (!cse_equal(earlier, expr))
+            continue;
+
+        if (earlier->temp_def == 0U)
+        {
+            if (state->temp_count == CASK_COMPILER_MAX_TEMPS - CASK_COMPILER_MAX_HOISTS)
+                return;
+
+            earlier->temp_def = (uint8_t)++state->temp_count;
+        }
+
+        uint16_t mask = expr->type_mask;
+        SymbolID name = expr->type_name;
+
+        expression_init_temp(expr, earlier->temp_def - 1U);
+        expr->type_mask = mask;
+        expr->type_name = name;
+        state->candidate_count = mark;
+        return;
+    }
+
+    if (!conditional && state->candidate_count < CASK_CSE_MAX_CANDIDATES)
+        state->candidates[state->candidate_count++] = expr;
+}
+
+/* Tree walk. */
+
+static bool cse_visit(CSEState *state, Expression *expr, bool conditional);
+
+static bool cse_visit_list(CSEState *state, const ExpressionVector *items, bool conditional)
+{
+    bool stable = true;
+
+    for (uint32_t index = 0; index < items->count; index++)
+        stable = cse_visit(state, vector_at_Expression(items, index), conditional) && stable;
+
+    return stable;
+}
+
+/**
+ * @brief Visits a subtree in evaluation order, merging repeats bottom up.
+ * @param conditional Whether the subtree may be skipped at runtime.
+ * @return bool Whether the subtree is stable: its value depends only on literals and locals.
+ */
+static bool cse_visit(CSEState *state, Expression *expr, bool conditional)
+{
+    uint32_t mark = state->candidate_count;
+    bool stable = false;
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+    case CASK_EXPR_LITERAL_INTEGER:
+    case CASK_EXPR_LITERAL_FLOAT:
+    case CASK_EXPR_LITERAL_STRING:
+    case CASK_EXPR_TEMP:
+        return true;
+    case CASK_EXPR_IDENTIFIER:
+        // Calls in between may store to globals, so only locals are stable.
+        return state->compiler->bindings[expr->contents.identifier.name].kind != CASK_BIND_GLOBAL;
+    case CASK_EXPR_LITERAL_ARRAY:
+        cse_visit_list(state, &expr->contents.array.values, conditional);
+        return false;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        cse_visit_list(state, &expr->contents.aggregate.literals, conditional);
+        return false;
+    case CASK_EXPR_ACCESS:
+        cse_visit(state, expr->contents.access.target, conditional);
+
+        if (!expr->contents.access.has_aggr)
+            cse_visit(state, expr->contents.access.key, conditional);
+        return false;
+    case CASK_EXPR_CALL:
+        stable = cse_visit_list(state, &expr->contents.call.args, conditional) && purity_call_is_pure(state->compiler, expr);
+
+        // Each call makes distinct heap objects, so only single value results merge.
+        if (!stable || (expr->type_mask >> 8) != CASK_COMPTYPE_SINGLE)
+            return stable;
+        break;
+    case CASK_EXPR_CONDITIONAL:
+        cse_visit(state, expr->contents.conditional.left, conditional);
+        cse_visit(state, expr->contents.conditional.right, true);
+        return false;
+    default:
+        stable = cse_visit(state, expr->contents.term.left, conditional);
+        stable = cse_visit(state, expr->contents.term.right, conditional) && stable;
+
+        if (!stable)
+            return false;
+        break;
+    }
+
+    cse_merge(state, expr, mark, conditional);
+
+    return true;
+}
+
+/**
+ * @brief Counts reloads of each temp, or with `prune` set, drops the definitions nothing reloads. Those appear when a parent merged away every reload of a child temp.
+ */
+static void cse_walk_temps(CSEState *state, Expression *expr, bool prune)
+{
+    const ExpressionVector *items = NULL;
+
+    if (prune && expr->temp_def != 0U && state->temp_uses[expr->temp_def - 1U] == 0U)
+        expr->temp_def = 0U;
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_TEMP:
+        if (!prune)
+            state->temp_uses[expr->contents.temp.index]++;
+        return;
+    case CASK_EXPR_LITERAL_ARRAY:
+        items = &expr->contents.array.values;
+        break;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        items = &expr->contents.aggregate.literals;
+        break;
+    case CASK_EXPR_CALL:
+        items = &expr->contents.call.args;
+        break;
+    case CASK_EXPR_ACCESS:
+        cse_walk_temps(state, expr->contents.access.target, prune);
+
+        if (!expr->contents.access.has_aggr)
+            cse_walk_temps(state, expr->contents.access.key, prune);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        cse_walk_temps(state, expr->contents.term.left, prune);
+        cse_walk_temps(state, expr->contents.term.right, prune);
+        return;
+    default:
+        return;
+    }
+
+    for (uint32_t index = 0; index < items->count; index++)
+        cse_walk_temps(state, vector_at_Expression(items, index), prune);
+}
+
+/**
+ * @brief Runs CSE over the expressions of one statement, given in evaluation order. Temps never outlive the statement.
+ */
+static void cse_roots(CSEState *state, Expression **roots, uint32_t count)
+{
+    state->candidate_count = 0U;
+    state->temp_count = 0U;
+
+    for (uint32_t index = 0; index < count; index++)
+        cse_visit(state, roots[index], false);
+
+    if (state->temp_count == 0U)
+        return;
+
+    memset(state->temp_uses, 0, state->temp_count * sizeof(uint16_t));
+
+    for (uint32_t index = 0; index < count; index++)
+        cse_walk_temps(state, roots[index], false);
+
+    for (uint32_t index = 0; index < count; index++)
+        cse_walk_temps(state, roots[index], true);
+}
+
+static void cse_stmt(CSEState *state, Statement *stmt);
+
+static void cse_block(CSEState *state, const Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+
+    for (uint32_t index = 0; index < stmts->count; index++)
+        cse_stmt(state, vector_at_Statement(stmts, index));
+}
+
+static void cse_stmt(CSEState *state, Statement *stmt)
+{
+    const Statement *other = NULL;
+    Expression *target = NULL;
+    Expression *roots[3];
+    uint32_t root_count = 0U;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        cse_roots(state, &stmt->contents.prim_decl.value, 1U);
+        break;
+    case CASK_STMT_WHILE:
+        cse_roots(state, &stmt->contents.while_ctrl.condition, 1U);
+        cse_block(state, stmt->contents.while_ctrl.block);
+        break;
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        cse_roots(state, &stmt->contents.if_ctrl.condition, 1U);
+        cse_block(state, stmt->contents.if_ctrl.block);
+
+        if (other != NULL)
+            cse_block(state, other->contents.else_ctrl.block);
+        break;
+    case CASK_STMT_BLOCK:
+        cse_block(state, stmt);
+        break;
+    case CASK_STMT_RETURN:
+        if (stmt->contents.return_stmt.value != NULL)
+            cse_roots(state, &stmt->contents.return_stmt.value, 1U);
+        break;
+    case CASK_STMT_REASSIGN:
+        target = stmt->contents.reassign.target;
+
+        // A stored variable is not read, but the object and key of a stored item are, before the value.
+        if (target->type == CASK_EXPR_ACCESS)
+        {
+            roots[root_count++] = target->contents.access.target;
+
+            if (!target->contents.access.has_aggr)
+                roots[root_count++] = target->contents.access.key;
+        }
+
+        roots[root_count++] = stmt->contents.reassign.value;
+        cse_roots(state, roots, root_count);
+        break;
+    case CASK_STMT_EXPR:
+        cse_roots(state, &stmt->contents.expr_stmt.expr, 1U);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Pass impl. */
+
+void cse_unit(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+    CSEState state = {.compiler = compiler, .candidate_count = 0U, .temp_count = 0U};
+
+    // Top-level code runs once over globals, so only function bodies are worth it.
+    for (uint32_t index = 0; index < statements->count; index++)
+    {
+        const Statement *stmt = vector_at_Statement(statements, index);
+
+        if (stmt->type == CASK_STMT_FUNCTION_DECL)
+            cse_block(&state, stmt->contents.func_decl.block);
+    }
+}
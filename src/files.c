@@ -8,8 +8,14 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "utils/files.h"
 
 char *file_load(const char *file_path)
@@ -21,7 +27,7 @@ char *file_load(const char *file_path)
         return content_buffer;
 
     fseek(fs, 0, SEEK_END);
-    ssize_t content_size = ftell(fs);
+    long content_size = ftell(fs);
     fseek(fs, 0, SEEK_SET);
 
     if (content_size < 0)
@@ -48,6 +54,112 @@ release_fs_point:
     return content_buffer;
 }
 
+/**
+ * @brief Reads a whole descriptor into a heap buffer for files that cannot be mapped.
+ */
+static bool file_read_fallback(int fd, SourceFile *source)
+{
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *buffer = malloc(capacity);
+
+    while (buffer != NULL)
+    {
+        if (length == capacity)
+        {
+            char *grown = realloc(buffer, capacity * 2);
+
+            if (!grown)
+                break;
+
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        ssize_t count = read(fd, buffer + length, capacity - length);
+
+        if (count < 0)
+            break;
+
+        if (count == 0)
+        {
+            source->data = buffer;
+            source->length = length;
+            source->storage = CASK_SOURCE_HEAP;
+            return true;
+        }
+
+        length += (size_t)count;
+    }
+
+    free(buffer);
+    return false;
+}
+
+bool file_map(const char *file_path, SourceFile *source)
+{
+    struct stat file_info;
+    int fd = open(file_path, O_RDONLY);
+    bool status = false;
+
+    source->data = NULL;
+    source->length = 0;
+    source->storage = CASK_SOURCE_EMPTY;
+
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &file_info) != 0)
+        goto release_fd_point;
+
+    if (!S_ISREG(file_info.st_mode))
+    {
+        status = file_read_fallback(fd, source);
+        goto release_fd_point;
+    }
+
+    /// @note mmap rejects zero lengths, and an empty file needs no storage anyway.
+    if (file_info.st_size == 0)
+    {
+        source->data = "";
+        status = true;
+        goto release_fd_point;
+    }
+
+    void *mapping = mmap(NULL, (size_t)file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping == MAP_FAILED)
+    {
+        status = file_read_fallback(fd, source);
+        goto release_fd_point;
+    }
+
+    // Lexing walks the file front to back once.
+    posix_madvise(mapping, (size_t)file_info.st_size, POSIX_MADV_SEQUENTIAL);
+
+    source->data = mapping;
+    source->length = (size_t)file_info.st_size;
+    source->storage = CASK_SOURCE_MAPPED;
+    status = true;
+
+    /// @note Cleanup execution point: the mapping stays valid after its descriptor closes.
+release_fd_point:
+    close(fd);
+    return status;
+}
+
+void file_unmap(SourceFile *source)
+{
+    if (source->storage == CASK_SOURCE_MAPPED)
+        munmap((void *)source->data, source->length);
+    else if (source->storage == CASK_SOURCE_HEAP)
+        free((void *)source->data);
+
+    source->data = NULL;
+    source->length = 0;
+    source->storage = CASK_SOURCE_EMPTY;
+}
+
 bool file_putblob(const char *file_path, const uint8_t *source, uint32_t size)
 {
     FILE *fs = fopen(file_path, CASK_NATIVE_FWRITE_BIN);
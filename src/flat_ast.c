@@ -0,0 +1,276 @@
+/**
+ * @file flat_ast.c
+ * @author Derek Tan
+ * @brief Implements flattening of the pointer AST into index-based arrays.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "syntax/flat_ast.h"
+
+/* Flat AST helpers. */
+
+/**
+ * @brief Reserves `count` entries of `extra` for one child list, to be filled once the children get their indexes.
+ */
+static bool flat_reserve_list(FlatAst *flat, uint32_t count, FlatIndex *start_out)
+{
+    *start_out = flat->extra.count;
+
+    if (!vector_reserve_FlatIndex(&flat->extra, NULL, flat->extra.count + count))
+        return false;
+
+    for (uint32_t index = 0; index < count; index++)
+        vector_append_FlatIndex(&flat->extra, NULL, CASK_FLAT_NONE);
+
+    return true;
+}
+
+static void flat_set_child(FlatAst *flat, FlatIndex start, uint32_t offset, FlatIndex child)
+{
+    vector_items_FlatIndex(&flat->extra)[start + offset] = child;
+}
+
+static bool flat_push_expr(FlatAst *flat, FlatExpr node, FlatIndex *index_out)
+{
+    *index_out = flat->exprs.count;
+
+    return vector_append_FlatExpr(&flat->exprs, NULL, node);
+}
+
+static bool flat_push_stmt(FlatAst *flat, FlatStmt node, FlatIndex *index_out)
+{
+    *index_out = flat->stmts.count;
+
+    return vector_append_FlatStmt(&flat->stmts, NULL, node);
+}
+
+static bool flat_add_expr(FlatAst *flat, const Expression *expr, FlatIndex *index_out);
+
+static bool flat_add_expr_list(FlatAst *flat, const ExpressionVector *items, FlatIndex *start_out)
+{
+    if (!flat_reserve_list(flat, items->count, start_out))
+        return false;
+
+    for (uint32_t offset = 0; offset < items->count; offset++)
+    {
+        FlatIndex child;
+
+        if (!flat_add_expr(flat, vector_at_Expression(items, offset), &child))
+            return false;
+
+        flat_set_child(flat, *start_out, offset, child);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Flattens one expression after its children, so children always get the lower indexes. A NULL expression gives `CASK_FLAT_NONE`.
+ */
+static bool flat_add_expr(FlatAst *flat, const Expression *expr, FlatIndex *index_out)
+{
+    FlatExpr node = {.kind = 0U, .op = CASK_OP_NONE, .flags = 0U, .a = CASK_FLAT_NONE, .b = CASK_FLAT_NONE, .c = CASK_FLAT_NONE};
+
+    if (!expr)
+    {
+        *index_out = CASK_FLAT_NONE;
+        return true;
+    }
+
+    node.kind = (uint8_t)expr->type;
+    node.flags = expr->is_lvalue ? CASK_FLAT_FLAG_LVALUE : 0U;
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+        node.flags |= expr->contents.special.is_nil ? CASK_FLAT_FLAG_NIL : 0U;
+        node.flags |= expr->contents.special.boolean ? CASK_FLAT_FLAG_TRUE : 0U;
+        break;
+    case CASK_EXPR_LITERAL_INTEGER:
+        node.a = (uint32_t)expr->contents.integer.value;
+        break;
+    case CASK_EXPR_LITERAL_FLOAT:
+        memcpy(&node.a, &expr->contents.realnum.value, sizeof(float));
+        break;
+    case CASK_EXPR_LITERAL_STRING:
+        node.a = expr->contents.string.value;
+        break;
+    case CASK_EXPR_LITERAL_ARRAY:
+        node.b = expr->contents.array.values.count;
+        if (!flat_add_expr_list(flat, &expr->contents.array.values, &node.a))
+            return false;
+        break;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        node.b = expr->contents.aggregate.literals.count;
+        if (!flat_add_expr_list(flat, &expr->contents.aggregate.literals, &node.a))
+            return false;
+        break;
+    case CASK_EXPR_IDENTIFIER:
+        node.a = expr->contents.identifier.name;
+        break;
+    case CASK_EXPR_CALL:
+        node.b = expr->contents.call.args.count;
+        node.c = expr->contents.call.name;
+        if (!flat_add_expr_list(flat, &expr->contents.call.args, &node.a))
+            return false;
+        break;
+    case CASK_EXPR_ACCESS:
+        node.flags |= expr->contents.access.has_aggr ? CASK_FLAT_FLAG_HAS_AGGR : 0U;
+        node.flags |= expr->contents.access.in_bounds ? CASK_FLAT_FLAG_IN_BOUNDS : 0U;
+        if (!flat_add_expr(flat, expr->contents.access.target, &node.a) || !flat_add_expr(flat, expr->contents.access.key, &node.b))
+            return false;
+        break;
+    case CASK_EXPR_TEMP:
+        node.a = expr->contents.temp.index;
+        break;
+    default:
+        /// @note Every binary kind shares the `term` layout of its union.
+        node.op = (uint8_t)expr->contents.term.op;
+        if (!flat_add_expr(flat, expr->contents.term.left, &node.a) || !flat_add_expr(flat, expr->contents.term.right, &node.b))
+            return false;
+        break;
+    }
+
+    return flat_push_expr(flat, node, index_out);
+}
+
+static bool flat_add_stmt(FlatAst *flat, const Statement *stmt, FlatIndex *index_out);
+
+static bool flat_add_stmt_list(FlatAst *flat, const StatementVector *children, FlatIndex *start_out)
+{
+    if (!flat_reserve_list(flat, children->count, start_out))
+        return false;
+
+    for (uint32_t offset = 0; offset < children->count; offset++)
+    {
+        FlatIndex child;
+
+        if (!flat_add_stmt(flat, vector_at_Statement(children, offset), &child))
+            return false;
+
+        flat_set_child(flat, *start_out, offset, child);
+    }
+
+    return true;
+}
+
+static bool flat_add_stmt(FlatAst *flat, const Statement *stmt, FlatIndex *index_out)
+{
+    FlatStmt node = {.kind = 0U, .type_mask = 0U, .name = CASK_SYMBOL_NONE, .type_name = CASK_SYMBOL_NONE, .a = CASK_FLAT_NONE, .b = CASK_FLAT_NONE, .c = CASK_FLAT_NONE};
+    bool status = true;
+
+    if (!stmt)
+    {
+        *index_out = CASK_FLAT_NONE;
+        return true;
+    }
+
+    node.kind = (uint8_t)stmt->type;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_IMPORT:
+        node.name = stmt->contents.import.name;
+        node.b = stmt->contents.import.items.count;
+        status = flat_add_expr_list(flat, &stmt->contents.import.items, &node.a);
+        break;
+    case CASK_STMT_PRIMITIVE_DECL:
+        node.name = stmt->contents.prim_decl.name;
+        node.type_mask = stmt->contents.prim_decl.type_mask;
+        node.type_name = stmt->contents.prim_decl.type_name;
+        status = flat_add_expr(flat, stmt->contents.prim_decl.value, &node.a);
+        break;
+    case CASK_STMT_FIELD_DECL:
+        node.name = stmt->contents.field_decl.name;
+        node.type_mask = stmt->contents.field_decl.type_mask;
+        node.type_name = stmt->contents.field_decl.type_name;
+        break;
+    case CASK_STMT_AGGREGATE_DECL:
+        node.name = stmt->contents.aggr_decl.name;
+        node.b = stmt->contents.aggr_decl.members.count;
+        status = flat_add_stmt_list(flat, &stmt->contents.aggr_decl.members, &node.a);
+        break;
+    case CASK_STMT_FUNCTION_DECL:
+        node.name = stmt->contents.func_decl.name;
+        node.type_mask = stmt->contents.func_decl.type_mask;
+        node.type_name = stmt->contents.func_decl.type_name;
+        node.b = stmt->contents.func_decl.params.count;
+        status = flat_add_stmt_list(flat, &stmt->contents.func_decl.params, &node.a)
+            && flat_add_stmt(flat, stmt->contents.func_decl.block, &node.c);
+        break;
+    case CASK_STMT_PARAMETER_DECL:
+        node.name = stmt->contents.param_decl.name;
+        node.type_mask = stmt->contents.param_decl.type_mask;
+        node.type_name = stmt->contents.param_decl.type_name;
+        break;
+    case CASK_STMT_WHILE:
+        status = flat_add_expr(flat, stmt->contents.while_ctrl.condition, &node.a)
+            && flat_add_stmt(flat, stmt->contents.while_ctrl.block, &node.b);
+        break;
+    case CASK_STMT_IF:
+        status = flat_add_expr(flat, stmt->contents.if_ctrl.condition, &node.a)
+            && flat_add_stmt(flat, stmt->contents.if_ctrl.block, &node.b)
+            && flat_add_stmt(flat, stmt->contents.if_ctrl.other, &node.c);
+        break;
+    case CASK_STMT_ELSE:
+        status = flat_add_stmt(flat, stmt->contents.else_ctrl.block, &node.a);
+        break;
+    case CASK_STMT_BLOCK:
+        node.b = stmt->contents.block.stmts.count;
+        status = flat_add_stmt_list(flat, &stmt->contents.block.stmts, &node.a);
+        break;
+    case CASK_STMT_RETURN:
+        status = flat_add_expr(flat, stmt->contents.return_stmt.value, &node.a);
+        break;
+    case CASK_STMT_REASSIGN:
+        status = flat_add_expr(flat, stmt->contents.reassign.target, &node.a)
+            && flat_add_expr(flat, stmt->contents.reassign.value, &node.b);
+        break;
+    case CASK_STMT_EXPR:
+        status = flat_add_expr(flat, stmt->contents.expr_stmt.expr, &node.a);
+        break;
+    default:
+        return false;
+    }
+
+    return status && flat_push_stmt(flat, node, index_out);
+}
+
+/* Flat AST impl. */
+
+void flat_ast_init(FlatAst *flat)
+{
+    vector_init_FlatExpr(&flat->exprs);
+    vector_init_FlatStmt(&flat->stmts);
+    vector_init_FlatIndex(&flat->extra);
+    flat->roots = 0U;
+    flat->root_count = 0U;
+}
+
+bool flat_ast_build(FlatAst *flat, const ProgramUnit *prog_unit)
+{
+    flat->root_count = prog_unit->statements.count;
+
+    if (!flat_add_stmt_list(flat, &prog_unit->statements, &flat->roots))
+        return false;
+
+    /// @note Building over-allocates by up to 2x, so give the slack back once the sizes are final.
+    vector_shrink_FlatExpr(&flat->exprs, NULL);
+    vector_shrink_FlatStmt(&flat->stmts, NULL);
+    vector_shrink_FlatIndex(&flat->extra, NULL);
+
+    return true;
+}
+
+void flat_ast_dispose(FlatAst *flat)
+{
+    vector_dispose_FlatExpr(&flat->exprs, NULL);
+    vector_dispose_FlatStmt(&flat->stmts, NULL);
+    vector_dispose_FlatIndex(&flat->extra, NULL);
+    flat->roots = 0U;
+    flat->root_count = 0U;
+}
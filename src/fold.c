@@ -0,0 +1,422 @@
+/**
+ * @file fold.c
+ * @author Derek Tan
+ * @brief Implements constant folding and algebraic simplification of expressions.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "backend/fold.h"
+
+/* Node helpers. */
+
+static bool fold_has_type(const Expression *expr, DataType type)
+{
+    return expr->type_mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, type);
+}
+
+/// @note The checker types a binary node from either operand, so rewrites test both to rule out unknown ones.
+static bool fold_operands_have_type(const Expression *expr, DataType type)
+{
+    return fold_has_type(expr->contents.term.left, type) && fold_has_type(expr->contents.term.right, type);
+}
+
+static bool fold_is_int(const Expression *expr, int32_t value)
+{
+    return expr->type == CASK_EXPR_LITERAL_INTEGER && expr->contents.integer.value == value;
+}
+
+static bool fold_is_one(const Expression *expr)
+{
+    return fold_is_int(expr, 1) || (expr->type == CASK_EXPR_LITERAL_FLOAT && expr->contents.realnum.value == 1.0f);
+}
+
+static bool fold_is_bool(const Expression *expr, bool flag)
+{
+    return expr->type == CASK_EXPR_LITERAL_SPECIAL && !expr->contents.special.is_nil && expr->contents.special.boolean == flag;
+}
+
+/// @brief Gives k when `value` is 2^k for k of at least 1, else 0.
+static uint8_t fold_log2(int32_t value)
+{
+    uint8_t shift = 0U;
+
+    if (value < 2 || (value & (value - 1)) != 0)
+        return 0U;
+
+    while ((value >> shift) != 1)
+        shift++;
+
+    return shift;
+}
+
+/// @note The annotation of `expr` is kept, since a rewrite never changes the static type of a node.
+static void fold_set_int(Expression *expr, int32_t value)
+{
+    uint16_t mask = expr->type_mask;
+
+    expression_init_integer_ltrl(expr, value);
+    expr->type_mask = mask;
+}
+
+static void fold_set_float(Expression *expr, float value)
+{
+    uint16_t mask = expr->type_mask;
+
+    expression_init_realnum_ltrl(expr, value);
+    expr->type_mask = mask;
+}
+
+static void fold_set_bool(Expression *expr, bool flag)
+{
+    uint16_t mask = expr->type_mask;
+
+    expression_init_special_ltrl(expr, false, flag);
+    expr->type_mask = mask;
+}
+
+/// @brief Replaces a node by one of its operands. Operand nodes are never shared, so copying is safe.
+static void fold_replace(Expression *expr, const Expression *operand)
+{
+    *expr = *operand;
+}
+
+/* Folding of literal operands. */
+
+static bool fold_int_binary(Expression *expr, int32_t left, int32_t right)
+{
+    uint32_t wrapped_left = (uint32_t)left;
+    uint32_t wrapped_right = (uint32_t)right;
+
+    switch (expr->contents.term.op)
+    {
+    case CASK_OP_ADD:
+        fold_set_int(expr, (int32_t)(wrapped_left + wrapped_right));
+        return true;
+    case CASK_OP_SUB:
+        fold_set_int(expr, (int32_t)(wrapped_left - wrapped_right));
+        return true;
+    case CASK_OP_MUL:
+        fold_set_int(expr, (int32_t)(wrapped_left * wrapped_right));
+        return true;
+    case CASK_OP_DIV:
+        // Keep the runtime divide error.
+        if (right == 0)
+            return false;
+
+        fold_set_int(expr, (right == -1) ? (int32_t)(0U - wrapped_left) : left / right);
+        return true;
+    case CASK_OP_SHL:
+        fold_set_int(expr, (int32_t)(wrapped_left << right));
+        return true;
+    case CASK_OP_SHR:
+        fold_set_int(expr, left / (int32_t)(1U << right));
+        return true;
+    case CASK_OP_LT:
+        fold_set_bool(expr, left < right);
+        return true;
+    case CASK_OP_LTE:
+        fold_set_bool(expr, left <= right);
+        return true;
+    case CASK_OP_GT:
+        fold_set_bool(expr, left > right);
+        return true;
+    case CASK_OP_GTE:
+        fold_set_bool(expr, left >= right);
+        return true;
+    case CASK_OP_EQ:
+        fold_set_bool(expr, left == right);
+        return true;
+    case CASK_OP_NEQ:
+        fold_set_bool(expr, left != right);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @note Results are rounded to single precision, exactly as the VM's float ops do.
+static bool fold_float_binary(Expression *expr, float left, float right)
+{
+    switch (expr->contents.term.op)
+    {
+    case CASK_OP_ADD:
+        fold_set_float(expr, (float)(left + right));
+        return true;
+    case CASK_OP_SUB:
+        fold_set_float(expr, (float)(left - right));
+        return true;
+    case CASK_OP_MUL:
+        fold_set_float(expr, (float)(left * right));
+        return true;
+    case CASK_OP_DIV:
+        fold_set_float(expr, (float)(left / right));
+        return true;
+    case CASK_OP_LT:
+        fold_set_bool(expr, left < right);
+        return true;
+    case CASK_OP_LTE:
+        fold_set_bool(expr, left <= right);
+        return true;
+    case CASK_OP_GT:
+        fold_set_bool(expr, left > right);
+        return true;
+    case CASK_OP_GTE:
+        fold_set_bool(expr, left >= right);
+        return true;
+    case CASK_OP_EQ:
+        fold_set_bool(expr, left == right);
+        return true;
+    case CASK_OP_NEQ:
+        fold_set_bool(expr, left != right);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool fold_literals(Expression *expr)
+{
+    const Expression *left = expr->contents.term.left;
+    const Expression *right = expr->contents.term.right;
+    OperatorType op = expr->contents.term.op;
+
+    if (left->type == CASK_EXPR_LITERAL_INTEGER && right->type == CASK_EXPR_LITERAL_INTEGER)
+        return fold_int_binary(expr, left->contents.integer.value, right->contents.integer.value);
+
+    if (left->type == CASK_EXPR_LITERAL_FLOAT && right->type == CASK_EXPR_LITERAL_FLOAT)
+        return fold_float_binary(expr, left->contents.realnum.value, right->contents.realnum.value);
+
+    if (fold_is_bool(left, true) || fold_is_bool(left, false))
+    {
+        if ((op == CASK_OP_EQ || op == CASK_OP_NEQ) && (fold_is_bool(right, true) || fold_is_bool(right, false)))
+        {
+            fold_set_bool(expr, (left->contents.special.boolean == right->contents.special.boolean) == (op == CASK_OP_EQ));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Algebraic simplification. */
+
+/**
+ * @brief Applies `&&` and `||` identities. A known left side decides or vanishes; a right side is only dropped when it is the neutral literal, so no side effect is lost.
+ */
+static void fold_logical(Expression *expr)
+{
+    const Expression *left = expr->contents.conditional.left;
+    const Expression *right = expr->contents.conditional.right;
+    bool is_and = expr->contents.conditional.op == CASK_OP_AND;
+
+    // `true && x`, `false || x`
+    if (fold_is_bool(left, is_and))
+        fold_replace(expr, right);
+    // `false && x`, `true || x`
+    else if (fold_is_bool(left, !is_and))
+        fold_replace(expr, left);
+    // `x && true`, `x || false`: only exact when x is a bool, since the operators yield an operand.
+    else if (fold_is_bool(right, is_and) && fold_has_type(left, CASK_DATATYPE_BOOLEAN))
+        fold_replace(expr, left);
+}
+
+/// @brief Turns `x == true` and `x != false` (either way round) into `x` for bool x.
+static void fold_equality(Expression *expr)
+{
+    const Expression *left = expr->contents.equality.left;
+    const Expression *right = expr->contents.equality.right;
+    bool neutral = expr->contents.equality.op == CASK_OP_EQ;
+
+    if (fold_is_bool(right, neutral) && fold_has_type(left, CASK_DATATYPE_BOOLEAN))
+        fold_replace(expr, left);
+    else if (fold_is_bool(left, neutral) && fold_has_type(right, CASK_DATATYPE_BOOLEAN))
+        fold_replace(expr, right);
+}
+
+/**
+ * @brief Drops `+ 0` and `- 0` on ints. Floats keep them, since `-0.0 + 0` is `+0.0`.
+ */
+static void fold_term(Expression *expr)
+{
+    Expression *left = expr->contents.term.left;
+    Expression *right = expr->contents.term.right;
+
+    if (!fold_operands_have_type(expr, CASK_DATATYPE_INTEGER))
+        return;
+
+    if (fold_is_int(right, 0))
+        fold_replace(expr, left);
+    else if (expr->contents.term.op == CASK_OP_ADD && fold_is_int(left, 0))
+        fold_replace(expr, right);
+}
+
+/**
+ * @brief Drops `* 1` and `/ 1`, then turns int factors by 2^k into shifts. The shift count replaces the power in the right literal.
+ */
+static void fold_factor(Expression *expr)
+{
+    Expression *left = expr->contents.factor.left;
+    Expression *right = expr->contents.factor.right;
+    bool is_mul = expr->contents.factor.op == CASK_OP_MUL;
+    bool is_int = fold_operands_have_type(expr, CASK_DATATYPE_INTEGER);
+
+    // Shifts made by an earlier run are final, which keeps the pass safe to repeat.
+    if (expr->contents.factor.op != CASK_OP_MUL && expr->contents.factor.op != CASK_OP_DIV)
+        return;
+
+    if (!is_int && !fold_operands_have_type(expr, CASK_DATATYPE_FLOAT))
+        return;
+
+    if (fold_is_one(right))
+    {
+        fold_replace(expr, left);
+        return;
+    }
+
+    if (is_mul && fold_is_one(left))
+    {
+        fold_replace(expr, right);
+        return;
+    }
+
+    if (!is_int)
+        return;
+
+    // Literals have no side effects, so `2^k * x` may be reordered into `x << k`.
+    if (is_mul && left->type == CASK_EXPR_LITERAL_INTEGER && fold_log2(left->contents.integer.value) != 0U)
+    {
+        expr->contents.factor.left = right;
+        expr->contents.factor.right = left;
+        left = expr->contents.factor.left;
+        right = expr->contents.factor.right;
+    }
+
+    uint8_t shift = (right->type == CASK_EXPR_LITERAL_INTEGER) ? fold_log2(right->contents.integer.value) : 0U;
+
+    if (shift == 0U)
+        return;
+
+    expr->contents.factor.op = is_mul ? CASK_OP_SHL : CASK_OP_SHR;
+    right->contents.integer.value = shift;
+}
+
+/* Tree walk. */
+
+static void fold_expr_list(const ExpressionVector *items)
+{
+    for (uint32_t index = 0; index < items->count; index++)
+        fold_expr(vector_at_Expression(items, index));
+}
+
+/// @note Folds bottom up, so that a parent sees literals made from its operands.
+void fold_expr(Expression *expr)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_ARRAY:
+        fold_expr_list(&expr->contents.array.values);
+        return;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        fold_expr_list(&expr->contents.aggregate.literals);
+        return;
+    case CASK_EXPR_CALL:
+        fold_expr_list(&expr->contents.call.args);
+        return;
+    case CASK_EXPR_ACCESS:
+        fold_expr(expr->contents.access.target);
+
+        if (!expr->contents.access.has_aggr)
+            fold_expr(expr->contents.access.key);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        break;
+    default:
+        return;
+    }
+
+    fold_expr(expr->contents.term.left);
+    fold_expr(expr->contents.term.right);
+
+    if (expr->type != CASK_EXPR_CONDITIONAL && fold_literals(expr))
+        return;
+
+    if (expr->type == CASK_EXPR_CONDITIONAL)
+        fold_logical(expr);
+    else if (expr->type == CASK_EXPR_EQUALITY)
+        fold_equality(expr);
+    else if (expr->type == CASK_EXPR_TERM)
+        fold_term(expr);
+    else if (expr->type == CASK_EXPR_FACTOR)
+        fold_factor(expr);
+}
+
+static void fold_stmt(Statement *stmt);
+
+static void fold_block(const Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+
+    for (uint32_t index = 0; index < stmts->count; index++)
+        fold_stmt(vector_at_Statement(stmts, index));
+}
+
+static void fold_stmt(Statement *stmt)
+{
+    const Statement *other = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        fold_expr(stmt->contents.prim_decl.value);
+        break;
+    case CASK_STMT_FUNCTION_DECL:
+        fold_block(stmt->contents.func_decl.block);
+        break;
+    case CASK_STMT_WHILE:
+        fold_expr(stmt->contents.while_ctrl.condition);
+        fold_block(stmt->contents.while_ctrl.block);
+        break;
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        fold_expr(stmt->contents.if_ctrl.condition);
+        fold_block(stmt->contents.if_ctrl.block);
+
+        if (other != NULL)
+            fold_block(other->contents.else_ctrl.block);
+        break;
+    case CASK_STMT_BLOCK:
+        fold_block(stmt);
+        break;
+    case CASK_STMT_RETURN:
+        if (stmt->contents.return_stmt.value != NULL)
+            fold_expr(stmt->contents.return_stmt.value);
+        break;
+    case CASK_STMT_REASSIGN:
+        fold_expr(stmt->contents.reassign.target);
+        fold_expr(stmt->contents.reassign.value);
+        break;
+    case CASK_STMT_EXPR:
+        fold_expr(stmt->contents.expr_stmt.expr);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Pass impl. */
+
+void fold_unit(const ProgramUnit *unit)
+{
+    const StatementVector *statements = &unit->statements;
+
+    for (uint32_t index = 0; index < statements->count; index++)
+        fold_stmt(vector_at_Statement(statements, index));
+}
@@ -6,6 +6,46 @@
 
 #include "frontend/token.h"
 
+/**
+ * @brief Byte classes used by the Lexer's dispatch table. Each source byte maps to exactly one class, so classifying a character is a single table load.
+ */
+typedef enum cask_char_class_e
+{
+    CASK_CHAR_OTHER,
+    CASK_CHAR_SPACING,
+    CASK_CHAR_DIGIT,
+    CASK_CHAR_ALPHA,
+    CASK_CHAR_SYMBOLIC,
+    CASK_CHAR_HASH,
+    CASK_CHAR_QUOTE,
+    CASK_CHAR_DOT,
+    CASK_CHAR_COMMA,
+    CASK_CHAR_COLON,
+    CASK_CHAR_LPAREN,
+    CASK_CHAR_RPAREN,
+    CASK_CHAR_LBRACK,
+    CASK_CHAR_RBRACK,
+    CASK_CHAR_LBRACE,
+    CASK_CHAR_RBRACE
+} CharClass;
+
+/// @brief 256 entry table of `CharClass` values indexed by unsigned byte. See `lexer.c`.
+extern const uint8_t lexer_char_classes[256];
+
+static inline CharClass lexer_classify(char c)
+{
+    return (CharClass)lexer_char_classes[(unsigned char)c];
+}
+
+/**
+ * @brief Classifies an alphabetic run as a keyword token type or `CASK_IDENTIFIER_TOKEN`. Uses a perfect hash over the keyword set, so this costs one table probe and at most one short compare.
+ * 
+ * @param begin 
+ * @param length 
+ * @return LexicalType 
+ */
+LexicalType lexer_match_keyword(const char *begin, uint32_t length);
+
 /**
  * @brief Defines a character testing function for the Lexer to classify a character's token category.
  */
@@ -39,6 +79,15 @@ typedef struct lexer_t
  */
 void lexer_init(Lexer *lexer, const char *source_cstr);
 
+/**
+ * @brief Initializes the Lexer over a source view of known length, e.g. a mapped file from `file_map`. The view needs no NUL terminator and is never read past `length`.
+ * 
+ * @param lexer 
+ * @param source 
+ * @param length 
+ */
+void lexer_init_view(Lexer *lexer, const char *source, uint32_t length);
+
 static inline char lexer_peek(const Lexer *lexer)
 {
     return lexer->source_view[lexer->source_index];
@@ -0,0 +1,71 @@
+#ifndef LEXER_STREAM_H
+#define LEXER_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frontend/lexer.h"
+
+/// @brief Default window size. Lexemes longer than the window cannot be held, except spacing and comments, which are skipped without one.
+#define CASK_LEXER_STREAM_WINDOW (64U * 1024U)
+
+/// @brief Smallest window accepted by `lexer_stream_init`.
+#define CASK_LEXER_STREAM_WINDOW_MIN 64U
+
+typedef enum cask_lexer_stream_error_e
+{
+    CASK_LEXER_STREAM_ERR_NONE,
+    CASK_LEXER_STREAM_ERR_IO,
+    CASK_LEXER_STREAM_ERR_TOO_LONG      // a lexeme other than spacing or a comment outgrew the window
+} LexerStreamError;
+
+/**
+ * @brief A token from a stream. `begin` is a 64-bit position in the whole input, and `lexeme` views the token's text in the window.
+ * @note `lexeme` stays valid only until the next `lexer_stream_yield`, which may slide the window. It is NULL for EOF tokens and for spacing or comments longer than the window.
+ */
+typedef struct cask_stream_token_t
+{
+    const char *lexeme;
+    uint64_t begin;
+    uint64_t length;
+    LexicalType type;
+} StreamToken;
+
+/**
+ * @brief Lexes input read from a file descriptor through a fixed-size window, so any amount of input takes constant memory. Tokens are the same as the Lexer would give over the whole input at once.
+ * @note When a token runs into the window end, the unread tail is moved to the window start and the rest refilled, then the token is lexed again.
+ */
+typedef struct cask_lexer_stream_t
+{
+    char *window;
+    uint64_t window_offset;             // input position of `window[0]`
+    uint32_t capacity;
+    uint32_t filled;                    // window bytes holding input
+    uint32_t index;                     // next window byte to lex
+    int fd;
+    bool at_end;                        // no more input: end of file, or a failed read
+    LexerStreamError error;
+} LexerStream;
+
+/**
+ * @brief Sets up a stream over an open file descriptor, which the stream reads but never closes.
+ *
+ * @param stream
+ * @param fd
+ * @param window_size Clamped to at least `CASK_LEXER_STREAM_WINDOW_MIN`.
+ * @return bool False if the window could not be allocated.
+ */
+bool lexer_stream_init(LexerStream *stream, int fd, uint32_t window_size);
+
+/**
+ * @brief Yields the next token, reading more input as needed. The final output is an EOF token, given again on every later call.
+ * @note On a read error, or a lexeme too long for the window, the stream sets `error` and yields a `CASK_UNKNOWN_TOKEN` at that point, then EOF.
+ *
+ * @param stream
+ * @return StreamToken
+ */
+StreamToken lexer_stream_yield(LexerStream *stream);
+
+void lexer_stream_dispose(LexerStream *stream);
+
+#endif
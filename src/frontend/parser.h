@@ -2,6 +2,7 @@
 #define PARSER_H
 
 #include "frontend/lexer.h"
+#include "frontend/token_stream.h"
 #include "syntax/ast.h"
 
 #define CASK_VALIDATE_TOKEN(token) (token.type >= CASK_COMMENT_TOKEN && token.type <= CASK_EOF_TOKEN)
@@ -23,20 +24,53 @@ typedef Statement *(*StmtParseFunc)(void *parser_ptr);
 
 /**
  * @brief A recursive descent parser to convert a sequence of tokens into an AST unit of the program.
+ * @note `stmt_helpers` is a table of statement parsers indexed by `LexicalType`. It is swapped between the top-level table and the function body table as the parser enters and leaves `func` bodies.
+ * @note The whole file is lexed into `tokens` before parsing, and `cursor` indexes the current token. `previous` and `current` cache the tokens around the cursor.
  */
 typedef struct parser_t
 {
     Lexer lexer;
+    TokenStream tokens;
+    uint32_t cursor;
     const StmtParseFunc *stmt_helpers;
+    ProgramUnit *unit;
+    const char *file_path;
+    SourceFile source;
     Token previous;
     Token current;
+    Token error_token;
+    uint32_t error_line;
+    ParserErrorCode error;
 } Parser;
 
 void parser_init(Parser *parser);
 
-static void parser_reset(Parser *parser);
+/**
+ * @brief Maps a source file and lexes it into the parser's token stream, on one thread per core if it is large. The mapping is handed to the `ProgramUnit` made by `parser_parse`.
+ *
+ * @param parser
+ * @param file_path Must stay valid until `parser_parse` returns.
+ * @return true if the file was mapped. Files over 4 GiB are rejected, as token positions are 32-bit.
+ */
+bool parser_use_file(Parser *parser, const char *file_path);
+
+/**
+ * @brief Lexes an already mapped source into the parser's token stream, like `parser_use_file`. The parser takes the mapping, even on failure, and empties `source`.
+ *
+ * @param parser
+ * @param source
+ * @param file_path Must stay valid until `parser_parse` returns.
+ * @param worker_count Threads lexing a large source. Pass 1 when already running on a pool worker.
+ * @return true if the source was lexed. Sources over 4 GiB are rejected.
+ */
+bool parser_use_source(Parser *parser, SourceFile *source, const char *file_path, uint32_t worker_count);
 
-void parser_use_file(Parser *parser, const char *file_path);
+/**
+ * @brief Frees the token stream and unmaps a source file that was never handed to a ProgramUnit.
+ *
+ * @param parser
+ */
+void parser_dispose(Parser *parser);
 
 bool parser_advance(Parser *parser);
 
@@ -44,6 +78,21 @@ Token parser_peek_curr(const Parser *parser);
 
 Token parser_peek_back(const Parser *parser);
 
+/**
+ * @brief Looks `offset` tokens past the current one without consuming anything. Offset 0 is the current token.
+ *
+ * @param parser
+ * @param offset
+ * @return Token The trailing EOF token when looking past the end.
+ */
+Token parser_peek_ahead(const Parser *parser, uint32_t offset);
+
+/**
+ * @brief Finds the statement parser for the current token with one table index on its type.
+ *
+ * @param parser
+ * @return StmtParseFunc NULL if no statement can begin with the current token.
+ */
 StmtParseFunc parser_lookup_helper(const Parser *parser);
 
 Expression *parse_expr_special(Parser *parser_ptr);
@@ -62,10 +111,10 @@ Expression *parse_expr_basic(Parser *parser_ptr);
 
 Expression *parse_expr_access(Parser *parser_ptr);
 
-Expression *parse_expr_term(Parser *parser_ptr);
-
 Expression *parse_expr_factor(Parser *parser_ptr);
 
+Expression *parse_expr_term(Parser *parser_ptr);
+
 Expression *parse_expr_comparison(Parser *parser_ptr);
 
 Expression *parse_expr_equality(Parser *parser_ptr);
@@ -78,8 +127,6 @@ Statement *parse_decl_field(void *parser_ptr);
 
 Statement *parse_decl_aggregate(void *parser_ptr);
 
-Statement *parse_decl_array(void *parser_ptr);
-
 Statement *parse_decl_any_value(void *parser_ptr);
 
 Statement *parse_decl_func(void *parser_ptr);
@@ -88,7 +135,7 @@ Statement *parse_decl_param(void *parser_ptr);
 
 Statement *parse_stmt_import(void *parser_ptr);
 
-Statement *parse_stmt_reassign(void *parser_ptr);
+Statement *parse_stmt_return(void *parser_ptr);
 
 Statement *parse_stmt_while(void *parser_ptr);
 
@@ -98,6 +145,13 @@ Statement *parse_stmt_else(void *parser_ptr);
 
 Statement *parse_stmt_block(void *parser_ptr);
 
+/**
+ * @brief Parses the loaded file into a heap allocated ProgramUnit. The token stream is released afterwards, since the AST only refers to the source.
+ *
+ * @param parser
+ * @param code_ptr Receives `CASK_PARSER_ERR_NONE` or the first error found. See `error_token` and `error_line` for its location.
+ * @return ProgramUnit* NULL on error. Otherwise release it with `program_unit_dispose` and then `free`.
+ */
 ProgramUnit *parser_parse(Parser *parser, ParserErrorCode *code_ptr);
 
-#endif
\ No newline at end of file
+#endif
@@ -3,13 +3,31 @@
 
 #include <stdint.h>
 
+/**
+ * @brief Token categories. Each Cask keyword has a dedicated type so the parser can dispatch on `type` alone; any other alphabetic run is a `CASK_IDENTIFIER_TOKEN`.
+ */
 typedef enum cask_lexical_type
 {
     CASK_COMMENT_TOKEN,
     CASK_SPACING_TOKEN,
-    CASK_RESERVED_TOKEN,
+    CASK_IDENTIFIER_TOKEN,
+    CASK_FUNC_TOKEN,
+    CASK_AGG_TOKEN,
+    CASK_WHILE_TOKEN,
+    CASK_IF_TOKEN,
+    CASK_ELSE_TOKEN,
+    CASK_END_TOKEN,
+    CASK_FROM_TOKEN,
+    CASK_IMPORT_TOKEN,
+    CASK_RETURN_TOKEN,
+    CASK_INT_TYPE_TOKEN,
+    CASK_FLOAT_TYPE_TOKEN,
+    CASK_BOOL_TYPE_TOKEN,
+    CASK_STRING_TYPE_TOKEN,
+    CASK_NIL_TOKEN,
+    CASK_TRUE_TOKEN,
+    CASK_FALSE_TOKEN,
     CASK_OPERATOR_TOKEN,
-    CASK_BOOLEAN_TOKEN,
     CASK_DIGITS_TOKEN,
     CASK_STRING_TOKEN,
     CASK_DOT_TOKEN,
@@ -25,6 +43,8 @@ typedef enum cask_lexical_type
     CASK_UNKNOWN_TOKEN
 } LexicalType;
 
+#define CASK_LEXICAL_TYPE_COUNT (CASK_UNKNOWN_TOKEN + 1)
+
 typedef struct cask_token_t
 {
     uint32_t begin;
@@ -32,10 +52,19 @@ typedef struct cask_token_t
     LexicalType type;
 } Token;
 
-char *token_stringify(const Token *token, const char *source);
+/**
+ * @brief Views a token's lexeme in place within its source buffer. No copy is made, so the lexeme is NOT NUL terminated and lives as long as the source.
+ * 
+ * @param token 
+ * @param source 
+ * @return const char* NULL for empty or EOF tokens.
+ */
+const char *token_view(const Token *token, const char *source);
 
 #define CASK_TOKEN_PTR_IS_EMPTY(token) (token->length == 0U)
 #define CASK_TOKEN_IS_EOF(token) (token->type == CASK_EOF_TOKEN)
 #define CASK_TOKEN_IS_SYMBOLIC(token) (token->type >= CASK_COMMA_TOKEN && token->type <= CASK_RBRACE_TOKEN)
+#define CASK_TOKEN_IS_KEYWORD(token) (token->type >= CASK_FUNC_TOKEN && token->type <= CASK_FALSE_TOKEN)
+#define CASK_TOKEN_IS_TYPENAME(token) (token->type >= CASK_INT_TYPE_TOKEN && token->type <= CASK_STRING_TYPE_TOKEN)
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,76 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frontend/lexer.h"
+
+#define CASK_TOKEN_STREAM_MIN_CAPACITY 64U
+
+/// @brief Sources shorter than this are lexed on one thread, as starting workers would cost more than it saves.
+#define CASK_TOKEN_STREAM_PARALLEL_MIN (1U << 20)
+
+/// @brief Smallest chunk handed to one lexing task.
+#define CASK_TOKEN_STREAM_CHUNK_MIN (1U << 18)
+
+/**
+ * @brief A whole file's tokens lexed up front, stored as parallel arrays (struct of arrays) so the parser walks them sequentially and can look ahead by plain indexing. Spacing and comment tokens are dropped.
+ * @note The stream always ends with one `CASK_EOF_TOKEN`. Lexing stops at the first `CASK_UNKNOWN_TOKEN`, which is kept just before that EOF so the parser can report it in order.
+ */
+typedef struct cask_token_stream_t
+{
+    uint8_t *types;
+    uint32_t *begins;
+    uint32_t *lengths;
+    uint32_t count;
+    uint32_t capacity;
+} TokenStream;
+
+/**
+ * @brief Initializes an empty stream with room for about `capacity_hint` tokens.
+ *
+ * @param stream
+ * @param capacity_hint
+ * @return true on success.
+ */
+bool token_stream_init(TokenStream *stream, uint32_t capacity_hint);
+
+/**
+ * @brief Runs the lexer to the end of its source, appending every significant token and the final EOF.
+ *
+ * @param stream
+ * @param lexer
+ * @return false on allocation failure.
+ */
+bool token_stream_lex(TokenStream *stream, Lexer *lexer);
+
+/**
+ * @brief Lexes like `token_stream_lex`, but splits a large source into chunks lexed on `worker_count` threads, giving the same stream.
+ * @note Chunks start just after a newline. Only comments and strings span lines, so each chunk starts either between tokens or inside one of those two. Each chunk is lexed speculatively for all three start states at once, then the results are stitched in order, each chunk's state picking which of the next chunk's results is right.
+ *
+ * @param stream An empty stream from `token_stream_init`.
+ * @param lexer Positioned at its source's start.
+ * @param worker_count
+ * @return false on allocation failure.
+ */
+bool token_stream_lex_parallel(TokenStream *stream, Lexer *lexer, uint32_t worker_count);
+
+/**
+ * @brief Reads the token at `index`. Indexes past the end give the trailing EOF token.
+ *
+ * @param stream
+ * @param index
+ * @return Token
+ */
+static inline Token token_stream_at(const TokenStream *stream, uint32_t index)
+{
+    if (index >= stream->count)
+        index = stream->count - 1U;
+
+    return (Token){.begin = stream->begins[index], .length = stream->lengths[index], .type = (LexicalType)stream->types[index]};
+}
+
+void token_stream_dispose(TokenStream *stream);
+
+#endif
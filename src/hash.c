@@ -0,0 +1,102 @@
+/**
+ * @file hash.c
+ * @author Derek Tan
+ * @brief Implements the XXH64 byte hash.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "utils/hash.h"
+
+#define CASK_HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define CASK_HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define CASK_HASH_PRIME_3 0x165667B19E3779F9ULL
+#define CASK_HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define CASK_HASH_PRIME_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t hash_rotl(uint64_t value, unsigned bits)
+{
+    return (value << bits) | (value >> (64U - bits));
+}
+
+static inline uint64_t hash_read64(const uint8_t *bytes)
+{
+    uint64_t value;
+
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash_read32(const uint8_t *bytes)
+{
+    uint32_t value;
+
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input)
+{
+    acc += input * CASK_HASH_PRIME_2;
+    return hash_rotl(acc, 31U) * CASK_HASH_PRIME_1;
+}
+
+static inline uint64_t hash_merge(uint64_t acc, uint64_t lane)
+{
+    acc ^= hash_round(0U, lane);
+    return acc * CASK_HASH_PRIME_1 + CASK_HASH_PRIME_4;
+}
+
+uint64_t hash_bytes(const void *data, size_t length, uint64_t seed)
+{
+    const uint8_t *bytes = data;
+    const uint8_t *end = bytes + length;
+    uint64_t hash;
+
+    if (length >= 32U)
+    {
+        // Four independent lanes keep several multiplies in flight.
+        uint64_t lanes[4] = {seed + CASK_HASH_PRIME_1 + CASK_HASH_PRIME_2, seed + CASK_HASH_PRIME_2, seed, seed - CASK_HASH_PRIME_1};
+
+        for (; end - bytes >= 32; bytes += 32)
+        {
+            for (unsigned lane = 0; lane < 4U; lane++)
+                lanes[lane] = hash_round(lanes[lane], hash_read64(bytes + lane * 8U));
+        }
+
+        hash = hash_rotl(lanes[0], 1U) + hash_rotl(lanes[1], 7U) + hash_rotl(lanes[2], 12U) + hash_rotl(lanes[3], 18U);
+
+        for (unsigned lane = 0; lane < 4U; lane++)
+            hash = hash_merge(hash, lanes[lane]);
+    }
+    else
+    {
+        hash = seed + CASK_HASH_PRIME_5;
+    }
+
+    hash += (uint64_t)length;
+
+    for (; end - bytes >= 8; bytes += 8)
+        hash = hash_rotl(hash ^ hash_round(0U, hash_read64(bytes)), 27U) * CASK_HASH_PRIME_1 + CASK_HASH_PRIME_4;
+
+    if (end - bytes >= 4)
+    {
+        hash = hash_rotl(hash ^ (hash_read32(bytes) * CASK_HASH_PRIME_1), 23U) * CASK_HASH_PRIME_2 + CASK_HASH_PRIME_3;
+        bytes += 4;
+    }
+
+    for (; bytes < end; bytes++)
+        hash = hash_rotl(hash ^ (*bytes * CASK_HASH_PRIME_5), 11U) * CASK_HASH_PRIME_1;
+
+    // Final avalanche, so every input bit affects every output bit.
+    hash ^= hash >> 33;
+    hash *= CASK_HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= CASK_HASH_PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
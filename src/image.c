@@ -0,0 +1,457 @@
+/**
+ * @file image.c
+ * @author Derek Tan
+ * @brief Implements writing and mapping of precompiled module images.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "backend/image.h"
+#include "utils/hash.h"
+
+_Static_assert(offsetof(ImageHeader, checksum) + sizeof(uint64_t) == sizeof(ImageHeader), "the checksum must end the header");
+
+/**
+ * @brief Hashes a whole image but its checksum field, which ends the header.
+ */
+static uint64_t image_checksum(const void *bytes, uint32_t size)
+{
+    uint64_t header_hash = hash_bytes(bytes, offsetof(ImageHeader, checksum), CASK_IMAGE_VERSION);
+
+    return hash_bytes((const uint8_t *)bytes + sizeof(ImageHeader), size - sizeof(ImageHeader), header_hash);
+}
+
+/* Writing. */
+
+static bool image_append(ByteVector *out, const void *bytes, uint32_t size)
+{
+    if (out->count > UINT32_MAX - size || !vector_reserve_Byte(out, NULL, out->count + size))
+        return false;
+
+    if (size > 0U)
+        memcpy(vector_items_Byte(out) + out->count, bytes, size);
+
+    out->count += size;
+
+    return true;
+}
+
+/**
+ * @brief Pads `out` with zeroes up to the next section boundary, giving the offset there relative to `base`.
+ */
+static bool image_align(ByteVector *out, uint32_t base, uint32_t *offset_out)
+{
+    static const uint8_t zeroes[CASK_IMAGE_ALIGN] = {0};
+    uint32_t padding = (CASK_IMAGE_ALIGN - (out->count - base) % CASK_IMAGE_ALIGN) % CASK_IMAGE_ALIGN;
+
+    *offset_out = out->count - base + padding;
+
+    return image_append(out, zeroes, padding);
+}
+
+bool image_serialize(const Module *module, ByteVector *out)
+{
+    uint32_t base = out->count;
+    uint32_t code_size = 0U;
+    ImageHeader header = {
+        .magic = {CASK_IMAGE_MAGIC[0], CASK_IMAGE_MAGIC[1], CASK_IMAGE_MAGIC[2], CASK_IMAGE_MAGIC[3]},
+        .version = CASK_IMAGE_VERSION,
+        .byte_order = CASK_IMAGE_BYTE_ORDER,
+        .function_count = module->functions.count,
+        .constant_count = module->constants.count,
+        .string_count = module->strings.count,
+        .string_bytes_size = module->string_bytes.count,
+        .init_function = module->init_function,
+        .main_function = module->main_function,
+        .global_count = module->global_count
+    };
+
+    // The header is filled in last, once every offset is known.
+    bool ok = image_append(out, &header, sizeof(ImageHeader)) && image_align(out, base, &header.function_offset);
+
+    for (uint32_t index = 0; ok && index < module->functions.count; index++)
+    {
+        const CodeObject *function = vector_ref_CodeObject(&module->functions, index);
+        ImageFunction record = {
+            .code_offset = code_size,
+            .code_size = function->code.count,
+            .name = function->name,
+            .max_stack = function->max_stack,
+            .return_mask = function->return_mask,
+            .arity = function->arity,
+            .slot_count = function->slot_count
+        };
+
+        ok = code_size <= UINT32_MAX - function->code.count && image_append(out, &record, sizeof(ImageFunction));
+        code_size += function->code.count;
+    }
+
+    ok = ok && image_align(out, base, &header.constant_offset);
+
+    for (uint32_t index = 0; ok && index < module->constants.count; index++)
+    {
+        Constant constant = vector_at_Constant(&module->constants, index);
+        ImageConstant record = {.bits = 0U, .type = (uint32_t)constant.type};
+
+        memcpy(&record.bits, &constant.as, sizeof(record.bits));
+        ok = image_append(out, &record, sizeof(ImageConstant));
+    }
+
+    ok = ok && image_align(out, base, &header.string_offset);
+
+    for (uint32_t index = 0; ok && index < module->strings.count; index++)
+        ok = image_append(out, vector_ref_StringRef(&module->strings, index), sizeof(StringRef));
+
+    ok = ok && image_align(out, base, &header.string_bytes_offset);
+
+    if (ok && module->string_bytes.count > 0U)
+        ok = image_append(out, vector_ref_Byte(&module->string_bytes, 0), module->string_bytes.count);
+
+    ok = ok && image_align(out, base, &header.code_offset);
+
+    for (uint32_t index = 0; ok && index < module->functions.count; index++)
+    {
+        const CodeObject *function = vector_ref_CodeObject(&module->functions, index);
+
+        if (function->code.count > 0U)
+            ok = image_append(out, vector_ref_Byte(&function->code, 0), function->code.count);
+    }
+
+    if (!ok)
+        return false;
+
+    header.code_size = code_size;
+    header.size = out->count - base;
+    memcpy(vector_items_Byte(out) + base, &header, sizeof(ImageHeader));
+    header.checksum = image_checksum(vector_items_Byte(out) + base, header.size);
+    memcpy(vector_items_Byte(out) + base + offsetof(ImageHeader, checksum), &header.checksum, sizeof(header.checksum));
+
+    return true;
+}
+
+ImageErrorCode image_save(const Module *module, const char *file_path)
+{
+    ByteVector bytes;
+    ImageErrorCode error = CASK_IMAGE_ERR_NONE;
+
+    vector_init_Byte(&bytes);
+
+    if (!image_serialize(module, &bytes))
+        error = CASK_IMAGE_ERR_MEMORY;
+    else if (!file_putblob(file_path, vector_ref_Byte(&bytes, 0), bytes.count))
+        error = CASK_IMAGE_ERR_IO;
+
+    vector_dispose_Byte(&bytes, NULL);
+
+    return error;
+}
+
+/* Loading. */
+
+static bool image_section_fits(const ImageHeader *header, uint32_t offset, uint32_t count, uint32_t item_size)
+{
+    return offset % CASK_IMAGE_ALIGN == 0U && offset >= sizeof(ImageHeader) && (uint64_t)offset + (uint64_t)count * item_size <= header->size;
+}
+
+static bool image_check_header(const ImageHeader *header, size_t file_size, ImageErrorCode *error)
+{
+    *error = CASK_IMAGE_ERR_FORMAT;
+
+    if (file_size < sizeof(ImageHeader) || memcmp(header->magic, CASK_IMAGE_MAGIC, sizeof(header->magic)) != 0
+        || header->byte_order != CASK_IMAGE_BYTE_ORDER)
+        return false;
+
+    if (header->version != CASK_IMAGE_VERSION)
+    {
+        *error = CASK_IMAGE_ERR_VERSION;
+        return false;
+    }
+
+    return header->size == file_size && header->reserved == 0U
+        && image_section_fits(header, header->function_offset, header->function_count, sizeof(ImageFunction))
+        && image_section_fits(header, header->constant_offset, header->constant_count, sizeof(ImageConstant))
+        && image_section_fits(header, header->string_offset, header->string_count, sizeof(StringRef))
+        && image_section_fits(header, header->string_bytes_offset, header->string_bytes_size, 1U)
+        && image_section_fits(header, header->code_offset, header->code_size, 1U)
+        && header->init_function < header->function_count
+        && (header->main_function < header->function_count || header->main_function == CASK_MODULE_NO_FUNCTION)
+        && header->global_count <= UINT16_MAX;
+}
+
+/**
+ * @brief Checks that every operand of an instruction names something that exists.
+ */
+static bool image_check_operands(const Module *module, const CodeObject *function, const Instr *instr)
+{
+    switch (instr->opcode)
+    {
+    case CASK_BC_PUSH_CONST:
+        return instr->operand < module->constants.count;
+    case CASK_BC_LOAD_LOCAL:
+    case CASK_BC_STORE_LOCAL:
+    case CASK_BC_TEE_LOCAL:
+    case CASK_BC_INC_LOCAL_I32:
+        return instr->operand < function->slot_count;
+    case CASK_BC_LOAD_LOCAL_PAIR:
+        return instr->operand < function->slot_count && instr->argc < function->slot_count;
+    case CASK_BC_LOAD_GLOBAL:
+    case CASK_BC_STORE_GLOBAL:
+        return instr->operand < module->global_count;
+    case CASK_BC_SHL_I32:
+    case CASK_BC_SHR_I32:
+        return instr->operand < 32U;
+    case CASK_BC_CALL:
+        return instr->operand < module->functions.count && instr->argc == vector_ref_CodeObject(&module->functions, instr->operand)->arity;
+    case CASK_BC_CALL_NATIVE:
+        if (instr->operand >= CASK_NATIVE_COUNT)
+            return false;
+
+        return (bytecode_natives[instr->operand].arity == CASK_NATIVE_VARIADIC) ? instr->argc >= 1U : instr->argc == bytecode_natives[instr->operand].arity;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Gives how many operand stack values an instruction reads.
+ */
+static uint32_t image_stack_inputs(const Instr *instr)
+{
+    switch (instr->opcode)
+    {
+    case CASK_BC_POP:
+    case CASK_BC_STORE_LOCAL:
+    case CASK_BC_TEE_LOCAL:
+    case CASK_BC_STORE_GLOBAL:
+    case CASK_BC_SHL_I32:
+    case CASK_BC_SHR_I32:
+    case CASK_BC_JUMP_IF_FALSE:
+    case CASK_BC_JUMP_IF_FALSE_OR_POP:
+    case CASK_BC_JUMP_IF_TRUE_OR_POP:
+    case CASK_BC_GET_FIELD:
+    case CASK_BC_RETURN:
+        return 1U;
+    case CASK_BC_SET_INDEX:
+    case CASK_BC_SET_INDEX_UNCHECKED:
+        return 3U;
+    case CASK_BC_MAKE_ARRAY:
+    case CASK_BC_MAKE_AGGR:
+        return instr->operand;
+    case CASK_BC_CALL:
+    case CASK_BC_CALL_NATIVE:
+        return instr->argc;
+    default:
+        break;
+    }
+
+    // Every other op reading values is binary: the arithmetic, comparisons, fused compare-and-branches, INDEX and SET_FIELD.
+    bool is_binary = (instr->opcode >= CASK_BC_ADD && instr->opcode <= CASK_BC_NEQ_STR)
+        || (instr->opcode >= CASK_BC_JUMP_UNLESS_LT_I32 && instr->opcode <= CASK_BC_JUMP_UNLESS_NEQ_I32)
+        || instr->opcode == CASK_BC_INDEX || instr->opcode == CASK_BC_INDEX_UNCHECKED || instr->opcode == CASK_BC_SET_FIELD;
+
+    return is_binary ? 2U : 0U;
+}
+
+/**
+ * @brief Checks that the operand stack never underflows or outgrows `max_stack`, with one depth per instruction on every path to it.
+ * @note Code that only a later backward jump reaches is refused, as the compiler never emits it, so one pass in code order suffices.
+ */
+static bool image_check_stack(const CodeObject *function, const InstrVector *instrs)
+{
+    uint32_t count = instrs->count;
+    int64_t *depths = malloc(count * sizeof(int64_t));
+    bool ok = depths != NULL;
+
+    for (uint32_t index = 0; ok && index < count; index++)
+        depths[index] = -1;
+
+    if (ok)
+        depths[0] = 0;
+
+    for (uint32_t index = 0; ok && index < count; index++)
+    {
+        const Instr *instr = vector_ref_Instr(instrs, index);
+        int64_t depth = depths[index];
+
+        // Nothing runs this yet, e.g. a jump after a return.
+        if (depth < 0)
+            continue;
+
+        int64_t after = depth + bytecode_stack_effects[instr->opcode];
+
+        if (instr->opcode == CASK_BC_MAKE_ARRAY || instr->opcode == CASK_BC_MAKE_AGGR)
+            after -= instr->operand;
+        else if (instr->opcode == CASK_BC_CALL || instr->opcode == CASK_BC_CALL_NATIVE)
+            after -= instr->argc;
+
+        ok = depth >= image_stack_inputs(instr) && after <= function->max_stack;
+
+        if (ok && bytecode_is_jump(instr->opcode))
+        {
+            // The `_OR_POP` forms keep their condition when they jump.
+            bool keeps = instr->opcode == CASK_BC_JUMP_IF_FALSE_OR_POP || instr->opcode == CASK_BC_JUMP_IF_TRUE_OR_POP;
+            int64_t *target = &depths[instr->target];
+            int64_t taken = keeps ? depth : after;
+
+            if (*target < 0 && instr->target > index)
+                *target = taken;
+            else
+                ok = *target == taken;
+        }
+
+        bool falls_through = instr->opcode != CASK_BC_JUMP && instr->opcode != CASK_BC_RETURN && instr->opcode != CASK_BC_RETURN_NIL;
+
+        if (ok && falls_through && index + 1U < count)
+        {
+            if (depths[index + 1U] < 0)
+                depths[index + 1U] = after;
+            else
+                ok = depths[index + 1U] == after;
+        }
+    }
+
+    free(depths);
+
+    return ok;
+}
+
+/**
+ * @brief Checks one function's code: its opcodes, that jumps land on instructions, that operands are in range, its stack use, and that it cannot run off its end.
+ */
+static bool image_check_code(const Module *module, const CodeObject *function, InstrVector *instrs)
+{
+    vector_clear_Instr(instrs);
+
+    if (function->slot_count < function->arity || !bytecode_decode(&function->code, instrs) || instrs->count == 0U)
+        return false;
+
+    for (uint32_t index = 0; index < instrs->count; index++)
+    {
+        const Instr *instr = vector_ref_Instr(instrs, index);
+
+        if (!image_check_operands(module, function, instr) || (bytecode_is_jump(instr->opcode) && instr->target >= instrs->count))
+            return false;
+    }
+
+    uint8_t last = vector_ref_Instr(instrs, instrs->count - 1U)->opcode;
+
+    return (last == CASK_BC_RETURN || last == CASK_BC_RETURN_NIL || last == CASK_BC_JUMP) && image_check_stack(function, instrs);
+}
+
+/**
+ * @brief Fills in the module from a checked header. Tables are copied and everything else borrowed from the mapping.
+ */
+static ImageErrorCode image_build_module(Image *image, const ImageHeader *header)
+{
+    uint8_t *bytes = (uint8_t *)image->file.data;
+    Module *module = &image->module;
+
+    module_init(module);
+    module->init_function = header->init_function;
+    module->main_function = header->main_function;
+    module->global_count = (uint16_t)header->global_count;
+    vector_borrow_StringRef(&module->strings, (StringRef *)(bytes + header->string_offset), header->string_count);
+    vector_borrow_Byte(&module->string_bytes, bytes + header->string_bytes_offset, header->string_bytes_size);
+
+    for (uint32_t index = 0; index < header->string_count; index++)
+    {
+        StringRef ref = vector_at_StringRef(&module->strings, index);
+
+        if ((uint64_t)ref.offset + ref.length > header->string_bytes_size)
+            return CASK_IMAGE_ERR_FORMAT;
+    }
+
+    if (!vector_reserve_Constant(&module->constants, NULL, header->constant_count)
+        || !vector_reserve_CodeObject(&module->functions, NULL, header->function_count))
+        return CASK_IMAGE_ERR_MEMORY;
+
+    for (uint32_t index = 0; index < header->constant_count; index++)
+    {
+        ImageConstant record;
+        Constant constant;
+
+        memcpy(&record, bytes + header->constant_offset + index * sizeof(ImageConstant), sizeof(ImageConstant));
+        memcpy(&constant.as, &record.bits, sizeof(record.bits));
+        constant.type = (ConstantType)record.type;
+
+        if (record.type > CASK_CONST_STRING || (record.type == CASK_CONST_STRING && record.bits >= header->string_count))
+            return CASK_IMAGE_ERR_FORMAT;
+
+        vector_append_Constant(&module->constants, NULL, constant);
+    }
+
+    for (uint32_t index = 0; index < header->function_count; index++)
+    {
+        ImageFunction record;
+        CodeObject function;
+
+        memcpy(&record, bytes + header->function_offset + index * sizeof(ImageFunction), sizeof(ImageFunction));
+
+        if ((uint64_t)record.code_offset + record.code_size > header->code_size || record.name >= header->string_count)
+            return CASK_IMAGE_ERR_FORMAT;
+
+        function = (CodeObject){
+            .name = record.name,
+            .max_stack = record.max_stack,
+            .return_mask = record.return_mask,
+            .arity = record.arity,
+            .slot_count = record.slot_count
+        };
+        vector_borrow_Byte(&function.code, bytes + header->code_offset + record.code_offset, record.code_size);
+        vector_append_CodeObject(&module->functions, NULL, function);
+    }
+
+    InstrVector instrs;
+    bool ok = true;
+
+    vector_init_Instr(&instrs);
+
+    // Calls check the callee's arity, so every function is in place before any code is checked.
+    for (uint32_t index = 0; ok && index < header->function_count; index++)
+        ok = image_check_code(module, vector_ref_CodeObject(&module->functions, index), &instrs);
+
+    vector_dispose_Instr(&instrs, NULL);
+
+    return ok ? CASK_IMAGE_ERR_NONE : CASK_IMAGE_ERR_CODE;
+}
+
+ImageErrorCode image_load(Image *image, const char *file_path)
+{
+    ImageHeader header;
+    ImageErrorCode error = CASK_IMAGE_ERR_NONE;
+
+    module_init(&image->module);
+
+    if (!file_map(file_path, &image->file))
+        return CASK_IMAGE_ERR_IO;
+
+    memset(&header, 0, sizeof(ImageHeader));
+
+    if (image->file.length >= sizeof(ImageHeader))
+        memcpy(&header, image->file.data, sizeof(ImageHeader));
+
+    if (image_check_header(&header, image->file.length, &error))
+        error = (image_checksum(image->file.data, header.size) == header.checksum) ? image_build_module(image, &header) : CASK_IMAGE_ERR_CHECKSUM;
+
+    if (error != CASK_IMAGE_ERR_NONE)
+    {
+        image_dispose(image);
+        return error;
+    }
+
+    return CASK_IMAGE_ERR_NONE;
+}
+
+void image_dispose(Image *image)
+{
+    // Only the tables were allocated. Code and strings belong to the mapping.
+    vector_dispose_CodeObject(&image->module.functions, NULL);
+    vector_dispose_Constant(&image->module.constants, NULL);
+    module_init(&image->module);
+    file_unmap(&image->file);
+}
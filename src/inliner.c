@@ -0,0 +1,293 @@
+/**
+ * @file inliner.c
+ * @author Derek Tan
+ * @brief Implements bytecode inlining of small functions.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include "backend/inliner.h"
+
+#define CASK_INLINER_MAX_INSTRS 16U
+
+/**
+ * @brief A function's original code and frame size, which copies are taken from even after the function itself was rewritten. For inlinable ones, `positions` gives where each instruction lands in a copy, relative to the copy's start, and `positions[length]` is the copy's size.
+ */
+typedef struct cask_inline_callee_t
+{
+    InstrVector body;
+    uint32_t max_stack;
+    uint32_t length;
+    uint8_t slot_count;
+    uint32_t positions[CASK_INLINER_MAX_INSTRS + 1U];
+    bool inlinable;
+} InlineCallee;
+
+/* Callee analysis. */
+
+static bool inliner_is_slot_op(uint8_t opcode)
+{
+    return opcode == CASK_BC_LOAD_LOCAL || opcode == CASK_BC_STORE_LOCAL || opcode == CASK_BC_TEE_LOCAL;
+}
+
+static bool inliner_is_jumped_to(const Instr *instrs, uint32_t count, uint32_t target)
+{
+    for (uint32_t index = 0; index < count; index++)
+    {
+        if (bytecode_is_jump(instrs[index].opcode) && instrs[index].target == target)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Decides whether a function may be copied into callers, then lays out its copy. A return becomes a jump past the copy, except the last one, which falls through.
+ */
+static void inliner_plan(InlineCallee *callee, uint32_t function)
+{
+    const Instr *instrs = vector_ref_Instr(&callee->body, 0);
+    uint32_t count = callee->body.count;
+    uint32_t position = 0U;
+
+    if (count == 0U || count > CASK_INLINER_MAX_INSTRS + 1U)
+        return;
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        if (instrs[index].opcode == CASK_BC_CALL && instrs[index].operand == function)
+            return;
+
+        // The code always ends in a return, so no jump leaves it. Bail out rather than mistranslate one.
+        if (bytecode_is_jump(instrs[index].opcode) && instrs[index].target >= count)
+            return;
+    }
+
+    callee->length = count;
+
+    // Code ends with a RETURN_NIL, which nothing reaches after a RETURN unless some jump does.
+    if (count >= 2U && instrs[count - 2U].opcode == CASK_BC_RETURN && instrs[count - 1U].opcode == CASK_BC_RETURN_NIL
+        && !inliner_is_jumped_to(instrs, count, count - 1U))
+        callee->length = count - 1U;
+
+    if (callee->length > CASK_INLINER_MAX_INSTRS)
+        return;
+
+    for (uint32_t index = 0; index < callee->length; index++)
+    {
+        bool is_last = index == callee->length - 1U;
+
+        callee->positions[index] = position;
+
+        if (instrs[index].opcode == CASK_BC_RETURN)
+            position += is_last ? 0U : 1U;
+        else if (instrs[index].opcode == CASK_BC_RETURN_NIL)
+            position += is_last ? 1U : 2U;
+        else
+            position++;
+    }
+
+    callee->positions[callee->length] = position;
+    callee->inlinable = true;
+}
+
+/* Call site rewriting. */
+
+static bool inliner_emit(InstrVector *out, uint8_t opcode, uint16_t operand, uint32_t target)
+{
+    return vector_append_Instr(out, NULL, (Instr){.target = target, .operand = operand, .argc = 0U, .opcode = opcode});
+}
+
+/**
+ * @brief Appends a copy of the callee for a call at `out`'s end, with its arguments popped into slots from `base` on.
+ */
+static bool inliner_splice(InstrVector *out, const InlineCallee *callee, uint8_t argc, uint32_t base)
+{
+    const Instr *instrs = vector_ref_Instr(&callee->body, 0);
+    bool ok = true;
+
+    // Arguments were pushed first to last, so the last one is on top.
+    for (uint32_t arg = argc; ok && arg > 0U; arg--)
+        ok = inliner_emit(out, CASK_BC_STORE_LOCAL, (uint16_t)(base + arg - 1U), 0U);
+
+    uint32_t start = out->count;
+    uint32_t end = start + callee->positions[callee->length];
+
+    for (uint32_t index = 0; ok && index < callee->length; index++)
+    {
+        Instr instr = instrs[index];
+        bool is_last = index == callee->length - 1U;
+
+        if (instr.opcode == CASK_BC_RETURN_NIL)
+        {
+            ok = inliner_emit(out, CASK_BC_PUSH_NIL, 0U, 0U);
+            instr.opcode = CASK_BC_RETURN;
+        }
+
+        if (!ok)
+            break;
+
+        if (instr.opcode == CASK_BC_RETURN)
+        {
+            ok = is_last || inliner_emit(out, CASK_BC_JUMP, 0U, end);
+            continue;
+        }
+
+        if (inliner_is_slot_op(instr.opcode))
+            instr.operand = (uint16_t)(instr.operand + base);
+        else if (bytecode_is_jump(instr.opcode))
+            instr.target = start + callee->positions[instr.target];
+
+        ok = vector_append_Instr(out, NULL, instr);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Gives the plan of the callee when `instr` is a call worth inlining into `function`, or else NULL.
+ */
+static const InlineCallee *inliner_callee_of(const Module *module, const InlineCallee *callees, uint32_t function, const Instr *instr)
+{
+    if (instr->opcode != CASK_BC_CALL || instr->operand == function || instr->operand >= module->functions.count || !callees[instr->operand].inlinable)
+        return NULL;
+
+    return ((uint32_t)callees[function].slot_count + callees[instr->operand].slot_count <= UINT8_MAX) ? &callees[instr->operand] : NULL;
+}
+
+/**
+ * @brief Rewrites one function, keeping its code when nothing is inlined or the result cannot be encoded.
+ * @return bool False on allocation failure.
+ */
+static bool inliner_rewrite(Module *module, const InlineCallee *callees, uint32_t function)
+{
+    CodeObject *caller = module_get_function(module, function);
+    const InstrVector *body = &callees[function].body;
+    uint32_t count = body->count;
+    uint32_t base = caller->slot_count;
+    uint32_t extra_slots = 0U;
+    uint32_t extra_stack = 0U;
+    uint32_t *map = NULL;
+    InstrVector out;
+    ByteVector code;
+    bool changed = false;
+    bool ok = true;
+
+    // New positions of the caller's instructions, for retargeting its jumps.
+    map = malloc((count + 1U) * sizeof(uint32_t));
+
+    if (map == NULL)
+        return false;
+
+    for (uint32_t index = 0, position = 0; index <= count; index++)
+    {
+        map[index] = position;
+
+        if (index == count)
+            break;
+
+        const Instr *instr = vector_ref_Instr(body, index);
+        const InlineCallee *plan = inliner_callee_of(module, callees, function, instr);
+
+        if (plan == NULL)
+        {
+            position++;
+            continue;
+        }
+
+        position += instr->argc + plan->positions[plan->length];
+        extra_slots = (plan->slot_count > extra_slots) ? plan->slot_count : extra_slots;
+        extra_stack = (plan->max_stack > extra_stack) ? plan->max_stack : extra_stack;
+        changed = true;
+    }
+
+    if (!changed)
+    {
+        free(map);
+        return true;
+    }
+
+    vector_init_Instr(&out);
+    vector_init_Byte(&code);
+
+    for (uint32_t index = 0; ok && index < count; index++)
+    {
+        Instr instr = vector_at_Instr(body, index);
+        const InlineCallee *plan = inliner_callee_of(module, callees, function, &instr);
+
+        if (plan != NULL)
+        {
+            ok = inliner_splice(&out, plan, instr.argc, base);
+            continue;
+        }
+
+        if (bytecode_is_jump(instr.opcode))
+            instr.target = map[instr.target];
+
+        ok = vector_append_Instr(&out, NULL, instr);
+    }
+
+    // Copies run one at a time, so they all share the slots past the caller's own.
+    if (ok && bytecode_encode(&out, &code))
+    {
+        vector_dispose_Byte(&caller->code, NULL);
+        caller->code = code;
+        caller->slot_count = (uint8_t)(base + extra_slots);
+        caller->max_stack += extra_stack;
+    }
+    else
+    {
+        vector_dispose_Byte(&code, NULL);
+    }
+
+    vector_dispose_Instr(&out, NULL);
+    free(map);
+
+    return ok;
+}
+
+/* Pass impl. */
+
+bool inliner_apply(Module *module)
+{
+    uint32_t function_count = module->functions.count;
+    InlineCallee *callees = malloc((function_count + 1U) * sizeof(InlineCallee));
+    bool ok = callees != NULL;
+
+    if (!ok)
+        return false;
+
+    for (uint32_t index = 0; index < function_count; index++)
+    {
+        InlineCallee *callee = &callees[index];
+        const CodeObject *function = module_get_function(module, index);
+
+        vector_init_Instr(&callee->body);
+        callee->max_stack = function->max_stack;
+        callee->length = 0U;
+        callee->slot_count = function->slot_count;
+        callee->inlinable = false;
+
+        // Code that fails to decode is neither copied nor rewritten.
+        if (!bytecode_decode(&function->code, &callee->body))
+            vector_clear_Instr(&callee->body);
+        else if (index != module->init_function)
+            inliner_plan(callee, index);
+    }
+
+    for (uint32_t index = 0; ok && index < function_count; index++)
+    {
+        if (callees[index].body.count > 0U)
+            ok = inliner_rewrite(module, callees, index);
+    }
+
+    for (uint32_t index = 0; index < function_count; index++)
+        vector_dispose_Instr(&callees[index].body, NULL);
+
+    free(callees);
+
+    return ok;
+}
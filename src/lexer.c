@@ -9,45 +9,182 @@
  */
 
 #include <string.h>
+#include "utils/scan.h"
 #include "frontend/lexer.h"
 
+/// @brief How many spacing bytes the Lexer checks inline before switching to a wide scan.
+#define CASK_LEXER_INLINE_SPACING 8U
+
+/* Lexer char class table. */
+
+/// @note Bytes not listed here (including all non-ASCII bytes) default to `CASK_CHAR_OTHER`.
+const uint8_t lexer_char_classes[256] = {
+    [' '] = CASK_CHAR_SPACING, ['\t'] = CASK_CHAR_SPACING, ['\r'] = CASK_CHAR_SPACING, ['\n'] = CASK_CHAR_SPACING,
+    ['0'] = CASK_CHAR_DIGIT, ['1'] = CASK_CHAR_DIGIT, ['2'] = CASK_CHAR_DIGIT, ['3'] = CASK_CHAR_DIGIT, ['4'] = CASK_CHAR_DIGIT, ['5'] = CASK_CHAR_DIGIT,
+    ['6'] = CASK_CHAR_DIGIT, ['7'] = CASK_CHAR_DIGIT, ['8'] = CASK_CHAR_DIGIT, ['9'] = CASK_CHAR_DIGIT,
+    ['a'] = CASK_CHAR_ALPHA, ['b'] = CASK_CHAR_ALPHA, ['c'] = CASK_CHAR_ALPHA, ['d'] = CASK_CHAR_ALPHA, ['e'] = CASK_CHAR_ALPHA, ['f'] = CASK_CHAR_ALPHA,
+    ['g'] = CASK_CHAR_ALPHA, ['h'] = CASK_CHAR_ALPHA, ['i'] = CASK_CHAR_ALPHA, ['j'] = CASK_CHAR_ALPHA, ['k'] = CASK_CHAR_ALPHA, ['l'] = CASK_CHAR_ALPHA,
+    ['m'] = CASK_CHAR_ALPHA, ['n'] = CASK_CHAR_ALPHA, ['o'] = CASK_CHAR_ALPHA, ['p'] = CASK_CHAR_ALPHA, ['q'] = CASK_CHAR_ALPHA, ['r'] = CASK_CHAR_ALPHA,
+    ['s'] = CASK_CHAR_ALPHA, ['t'] = CASK_CHAR_ALPHA, ['u'] = CASK_CHAR_ALPHA, ['v'] = CASK_CHAR_ALPHA, ['w'] = CASK_CHAR_ALPHA, ['x'] = CASK_CHAR_ALPHA,
+    ['y'] = CASK_CHAR_ALPHA, ['z'] = CASK_CHAR_ALPHA,
+    ['A'] = CASK_CHAR_ALPHA, ['B'] = CASK_CHAR_ALPHA, ['C'] = CASK_CHAR_ALPHA, ['D'] = CASK_CHAR_ALPHA, ['E'] = CASK_CHAR_ALPHA, ['F'] = CASK_CHAR_ALPHA,
+    ['G'] = CASK_CHAR_ALPHA, ['H'] = CASK_CHAR_ALPHA, ['I'] = CASK_CHAR_ALPHA, ['J'] = CASK_CHAR_ALPHA, ['K'] = CASK_CHAR_ALPHA, ['L'] = CASK_CHAR_ALPHA,
+    ['M'] = CASK_CHAR_ALPHA, ['N'] = CASK_CHAR_ALPHA, ['O'] = CASK_CHAR_ALPHA, ['P'] = CASK_CHAR_ALPHA, ['Q'] = CASK_CHAR_ALPHA, ['R'] = CASK_CHAR_ALPHA,
+    ['S'] = CASK_CHAR_ALPHA, ['T'] = CASK_CHAR_ALPHA, ['U'] = CASK_CHAR_ALPHA, ['V'] = CASK_CHAR_ALPHA, ['W'] = CASK_CHAR_ALPHA, ['X'] = CASK_CHAR_ALPHA,
+    ['Y'] = CASK_CHAR_ALPHA, ['Z'] = CASK_CHAR_ALPHA, ['_'] = CASK_CHAR_ALPHA,
+    ['='] = CASK_CHAR_SYMBOLIC, ['!'] = CASK_CHAR_SYMBOLIC, ['>'] = CASK_CHAR_SYMBOLIC, ['<'] = CASK_CHAR_SYMBOLIC, ['+'] = CASK_CHAR_SYMBOLIC, ['-'] = CASK_CHAR_SYMBOLIC,
+    ['*'] = CASK_CHAR_SYMBOLIC, ['/'] = CASK_CHAR_SYMBOLIC, ['|'] = CASK_CHAR_SYMBOLIC, ['&'] = CASK_CHAR_SYMBOLIC,
+    ['#'] = CASK_CHAR_HASH, ['\"'] = CASK_CHAR_QUOTE, ['.'] = CASK_CHAR_DOT, [','] = CASK_CHAR_COMMA,
+    [':'] = CASK_CHAR_COLON, ['('] = CASK_CHAR_LPAREN, [')'] = CASK_CHAR_RPAREN, ['['] = CASK_CHAR_LBRACK,
+    [']'] = CASK_CHAR_RBRACK, ['{'] = CASK_CHAR_LBRACE, ['}'] = CASK_CHAR_RBRACE,
+};
+
+/* Keyword perfect hash. */
+
+/**
+ * @brief One slot of the keyword table. Empty slots have a zero length so they never match.
+ */
+typedef struct cask_keyword_slot_t
+{
+    const char *text;
+    uint32_t length;
+    LexicalType type;
+} KeywordSlot;
+
+#define CASK_KEYWORD_MIN_LENGTH 2U
+#define CASK_KEYWORD_MAX_LENGTH 6U
+#define CASK_KEYWORD_SLOTS 32U
+
+/// @note The multipliers 2 and 5 were found by an offline search as the smallest pair that gives all 16 keywords distinct slots. If the keyword set changes, search again.
+#define CASK_KEYWORD_HASH(begin, length) ((2U * (unsigned char)(begin)[0] + 5U * (unsigned char)(begin)[(length) - 1U] + (length)) & (CASK_KEYWORD_SLOTS - 1U))
+
+static const KeywordSlot lexer_keywords[CASK_KEYWORD_SLOTS] = {
+    [1] = {"end", 3, CASK_END_TOKEN},
+    [4] = {"bool", 4, CASK_BOOL_TYPE_TOKEN},
+    [5] = {"true", 4, CASK_TRUE_TOKEN},
+    [7] = {"else", 4, CASK_ELSE_TOKEN},
+    [8] = {"agg", 3, CASK_AGG_TOKEN},
+    [10] = {"false", 5, CASK_FALSE_TOKEN},
+    [12] = {"while", 5, CASK_WHILE_TOKEN},
+    [15] = {"string", 6, CASK_STRING_TYPE_TOKEN},
+    [16] = {"return", 6, CASK_RETURN_TOKEN},
+    [17] = {"from", 4, CASK_FROM_TOKEN},
+    [18] = {"if", 2, CASK_IF_TOKEN},
+    [21] = {"float", 5, CASK_FLOAT_TYPE_TOKEN},
+    [25] = {"int", 3, CASK_INT_TYPE_TOKEN},
+    [27] = {"nil", 3, CASK_NIL_TOKEN},
+    [28] = {"import", 6, CASK_IMPORT_TOKEN},
+    [31] = {"func", 4, CASK_FUNC_TOKEN},
+};
+
+LexicalType lexer_match_keyword(const char *begin, uint32_t length)
+{
+    if (length < CASK_KEYWORD_MIN_LENGTH || length > CASK_KEYWORD_MAX_LENGTH)
+        return CASK_IDENTIFIER_TOKEN;
+
+    const KeywordSlot *slot = &lexer_keywords[CASK_KEYWORD_HASH(begin, length)];
+
+    if (slot->length == length && memcmp(slot->text, begin, length) == 0)
+        return slot->type;
+
+    return CASK_IDENTIFIER_TOKEN;
+}
+
 /* Lexer char predicate impl. */
 
 bool predicate_is_spacing(char c)
 {
-    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    return lexer_classify(c) == CASK_CHAR_SPACING;
 }
 
 bool predicate_is_numeric(char c)
 {
-    return c >= '0' && c <= '9';
+    return lexer_classify(c) == CASK_CHAR_DIGIT;
 }
 
 bool predicate_is_alpha(char c)
 {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    return lexer_classify(c) == CASK_CHAR_ALPHA;
 }
 
 bool predicate_is_alphanum(char c)
 {
-    return predicate_is_alpha(c) || predicate_is_numeric(c);
+    CharClass char_class = lexer_classify(c);
+
+    return char_class == CASK_CHAR_ALPHA || char_class == CASK_CHAR_DIGIT;
 }
 
 bool predicate_is_symbolic(char c)
 {
-    return c == '=' || c == '!'
-        || c == '>' || c == '<'
-        || c == '+' || c == '-' || c == '*' || c == '/'
-        || c == '|' || c == '&';
+    return lexer_classify(c) == CASK_CHAR_SYMBOLIC;
+}
+
+/**
+ * @brief Scans a run of bytes sharing one `CharClass`. The caller has already classified the first byte, so the loop starts after it and does one table load per byte.
+ */
+static inline Token lexer_lex_class(Lexer *lexer, LexicalType lexical_type, CharClass char_class)
+{
+    const char *source = lexer->source_view;
+    uint32_t source_length = lexer->source_length;
+    uint32_t token_position = lexer->source_index;
+    uint32_t scan_index = token_position + 1U;
+
+    while (scan_index < source_length && lexer_char_classes[(unsigned char)source[scan_index]] == char_class)
+        scan_index++;
+
+    lexer->source_index = scan_index;
+
+    return (Token){.begin = token_position, .length = scan_index - token_position, .type = lexical_type};
 }
 
 /* Lexer impl. */
 
 void lexer_init(Lexer *lexer, const char *source_cstr)
 {
-    lexer->source_view = source_cstr;
+    lexer_init_view(lexer, source_cstr, strlen(source_cstr));
+}
+
+void lexer_init_view(Lexer *lexer, const char *source, uint32_t length)
+{
+    lexer->source_view = source;
     lexer->source_index = 0U;
-    lexer->source_length = strlen(source_cstr);
+    lexer->source_length = length;
+}
+
+/**
+ * @brief Scans an alphabetic run, then types it as a keyword or an identifier with one keyword table probe.
+ */
+static inline Token lexer_lex_word(Lexer *lexer)
+{
+    Token word = lexer_lex_class(lexer, CASK_IDENTIFIER_TOKEN, CASK_CHAR_ALPHA);
+
+    word.type = lexer_match_keyword(lexer->source_view + word.begin, word.length);
+
+    return word;
+}
+
+/**
+ * @brief Scans a spacing run. Short runs like single spaces stay in the inline table loop, while longer indentation and blank line runs go to the wide kernels from `scan.c`.
+ */
+static inline Token lexer_lex_spacing(Lexer *lexer)
+{
+    const char *source = lexer->source_view;
+    uint32_t source_length = lexer->source_length;
+    uint32_t token_position = lexer->source_index;
+    uint32_t run_end = token_position + 1U;
+
+    while (run_end < source_length && lexer_char_classes[(unsigned char)source[run_end]] == CASK_CHAR_SPACING)
+    {
+        if (++run_end - token_position >= CASK_LEXER_INLINE_SPACING)
+        {
+            run_end = scan_skip_spacing(source, run_end, source_length);
+            break;
+        }
+    }
+
+    lexer->source_index = run_end;
+
+    return (Token){.begin = token_position, .length = run_end - token_position, .type = CASK_SPACING_TOKEN};
 }
 
 Token lexer_lex_single(Lexer *lexer, LexicalType lexical_type)
@@ -66,21 +203,12 @@ Token lexer_lex_until(Lexer *lexer, LexicalType lexical_type, char terminator)
     lexer->source_index++;
 
     uint32_t token_position = lexer->source_index;
-    uint32_t token_length = 0U;
-
-    while (lexer->source_index < lexer->source_length)
-    {
-        if (lexer_peek(lexer) == terminator)
-        {
-            lexer->source_index++;
-            break;
-        }
+    uint32_t terminator_index = scan_find_byte(lexer->source_view, token_position, lexer->source_length, terminator);
 
-        lexer->source_index++;
-        token_length++;
-    }
+    // Consume the closing terminator too unless the text ran out first.
+    lexer->source_index = (terminator_index < lexer->source_length) ? terminator_index + 1U : terminator_index;
 
-    return (Token){.begin = token_position, .length = token_length, .type = lexical_type};
+    return (Token){.begin = token_position, .length = terminator_index - token_position, .type = lexical_type};
 }
 
 Token lexer_lex_by(Lexer *lexer, LexicalType lexical_type, LexerPredicate predicate)
@@ -107,44 +235,40 @@ Token lexer_yield_token(Lexer *lexer)
         return (Token){.begin = lexer->source_index, .length = 1U, .type = CASK_EOF_TOKEN};
     }
 
-    char temp = lexer_peek(lexer);
-
-    switch (temp)
+    switch (lexer_classify(lexer_peek(lexer)))
     {
-    case '.':
+    case CASK_CHAR_SPACING:
+        return lexer_lex_spacing(lexer);
+    case CASK_CHAR_ALPHA:
+        return lexer_lex_word(lexer);
+    case CASK_CHAR_DIGIT:
+        return lexer_lex_class(lexer, CASK_DIGITS_TOKEN, CASK_CHAR_DIGIT);
+    case CASK_CHAR_SYMBOLIC:
+        return lexer_lex_class(lexer, CASK_OPERATOR_TOKEN, CASK_CHAR_SYMBOLIC);
+    case CASK_CHAR_HASH:
+        return lexer_lex_until(lexer, CASK_COMMENT_TOKEN, '#');
+    case CASK_CHAR_QUOTE:
+        return lexer_lex_until(lexer, CASK_STRING_TOKEN, '\"');
+    case CASK_CHAR_DOT:
         return lexer_lex_single(lexer, CASK_DOT_TOKEN);
-    case ',':
+    case CASK_CHAR_COMMA:
         return lexer_lex_single(lexer, CASK_COMMA_TOKEN);
-    case ':':
+    case CASK_CHAR_COLON:
         return lexer_lex_single(lexer, CASK_COLON_TOKEN);
-    case '(':
+    case CASK_CHAR_LPAREN:
         return lexer_lex_single(lexer, CASK_LPAREN_TOKEN);
-    case ')':
+    case CASK_CHAR_RPAREN:
         return lexer_lex_single(lexer, CASK_RPAREN_TOKEN);
-    case '[':
+    case CASK_CHAR_LBRACK:
         return lexer_lex_single(lexer, CASK_LBRACK_TOKEN);
-    case ']':
+    case CASK_CHAR_RBRACK:
         return lexer_lex_single(lexer, CASK_RBRACK_TOKEN);
-    case '{':
+    case CASK_CHAR_LBRACE:
         return lexer_lex_single(lexer, CASK_LBRACE_TOKEN);
-    case '}':
+    case CASK_CHAR_RBRACE:
         return lexer_lex_single(lexer, CASK_RBRACE_TOKEN);
     default:
-        if (predicate_is_spacing(temp))
-            return lexer_lex_by(lexer, CASK_SPACING_TOKEN, predicate_is_spacing);
-        else if (temp == '#')
-            return lexer_lex_until(lexer, CASK_COMMENT_TOKEN, temp);
-        else if (temp == '\"')
-            return lexer_lex_until(lexer, CASK_STRING_TOKEN, temp);
-        else if (predicate_is_alpha(temp))
-            return lexer_lex_by(lexer, CASK_RESERVED_TOKEN, predicate_is_alpha);
-        else if (predicate_is_numeric(temp))
-            return lexer_lex_by(lexer, CASK_DIGITS_TOKEN, predicate_is_numeric);
-        else if (predicate_is_symbolic(temp))
-            return lexer_lex_by(lexer, CASK_OPERATOR_TOKEN, predicate_is_symbolic);
-        else
-            return lexer_lex_single(lexer, CASK_UNKNOWN_TOKEN);
-        break;
+        return lexer_lex_single(lexer, CASK_UNKNOWN_TOKEN);
     }
 }
 
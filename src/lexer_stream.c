@@ -0,0 +1,171 @@
+/**
+ * @file lexer_stream.c
+ * @author Derek Tan
+ * @brief Implements the streaming lexer over a refilled window.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/scan.h"
+#include "frontend/lexer_stream.h"
+
+/**
+ * @brief Drops the window bytes before `keep_from`, moves the rest to the front, and reads more input after them.
+ */
+static void lexer_stream_refill(LexerStream *stream, uint32_t keep_from)
+{
+    uint32_t kept = stream->filled - keep_from;
+    ssize_t got = 0;
+
+    if (keep_from > 0U)
+    {
+        memmove(stream->window, stream->window + keep_from, kept);
+        stream->window_offset += keep_from;
+        stream->filled = kept;
+        stream->index -= keep_from;
+    }
+
+    do
+    {
+        got = read(stream->fd, stream->window + stream->filled, stream->capacity - stream->filled);
+    } while (got < 0 && errno == EINTR);
+
+    if (got > 0)
+    {
+        stream->filled += (uint32_t)got;
+        return;
+    }
+
+    stream->at_end = true;
+
+    if (got < 0)
+        stream->error = CASK_LEXER_STREAM_ERR_IO;
+}
+
+/**
+ * @brief Ends the stream at the current position with an unknown token, after an error.
+ */
+static StreamToken lexer_stream_fail(LexerStream *stream)
+{
+    StreamToken token = {.lexeme = NULL, .begin = stream->window_offset + stream->index, .length = 0U, .type = CASK_UNKNOWN_TOKEN};
+
+    stream->index = stream->filled;
+    stream->at_end = true;
+
+    return token;
+}
+
+/**
+ * @brief Finishes a spacing run or comment that fills the whole window, sliding past its text without keeping it.
+ */
+static StreamToken lexer_stream_skip_long(LexerStream *stream, LexicalType type)
+{
+    // A comment's text starts after its opening `#`, and its closing `#` is consumed but not counted.
+    uint64_t begin = stream->window_offset + stream->index + ((type == CASK_COMMENT_TOKEN) ? 1U : 0U);
+    uint32_t stop = 0U;
+
+    do
+    {
+        stream->index = stream->filled;
+        lexer_stream_refill(stream, stream->filled);
+
+        if (stream->error != CASK_LEXER_STREAM_ERR_NONE)
+            return lexer_stream_fail(stream);
+
+        // Input ending first ends the token there, as with a whole source.
+        stop = (type == CASK_SPACING_TOKEN) ? scan_skip_spacing(stream->window, 0U, stream->filled) : scan_find_byte(stream->window, 0U, stream->filled, '#');
+    } while (stop == stream->filled && stream->filled > 0U);
+
+    stream->index = (stop < stream->filled && type == CASK_COMMENT_TOKEN) ? stop + 1U : stop;
+
+    return (StreamToken){.lexeme = NULL, .begin = begin, .length = stream->window_offset + stop - begin, .type = type};
+}
+
+bool lexer_stream_init(LexerStream *stream, int fd, uint32_t window_size)
+{
+    if (window_size < CASK_LEXER_STREAM_WINDOW_MIN)
+        window_size = CASK_LEXER_STREAM_WINDOW_MIN;
+
+    stream->window = malloc(window_size);
+    stream->window_offset = 0U;
+    stream->capacity = window_size;
+    stream->filled = 0U;
+    stream->index = 0U;
+    stream->fd = fd;
+    stream->at_end = false;
+    stream->error = CASK_LEXER_STREAM_ERR_NONE;
+
+    return stream->window != NULL;
+}
+
+StreamToken lexer_stream_yield(LexerStream *stream)
+{
+    Lexer lexer;
+    Token token;
+
+    for (;;)
+    {
+        if (stream->index == stream->filled)
+        {
+            if (stream->at_end)
+                return (StreamToken){.lexeme = NULL, .begin = stream->window_offset + stream->filled, .length = 1U, .type = CASK_EOF_TOKEN};
+
+            lexer_stream_refill(stream, stream->index);
+
+            if (stream->error != CASK_LEXER_STREAM_ERR_NONE)
+                return lexer_stream_fail(stream);
+
+            continue;
+        }
+
+        lexer_init_view(&lexer, stream->window, stream->filled);
+        lexer.source_index = stream->index;
+        token = lexer_yield_token(&lexer);
+
+        // Comments and strings are whole once their closing byte is in the window. Other tokens may go on past the window end.
+        bool delimited = token.type == CASK_COMMENT_TOKEN || token.type == CASK_STRING_TOKEN;
+        bool cut = delimited ? token.begin + token.length == stream->filled : lexer.source_index == stream->filled;
+
+        if (!cut || stream->at_end)
+        {
+            stream->index = lexer.source_index;
+            return (StreamToken){.lexeme = stream->window + token.begin, .begin = stream->window_offset + token.begin, .length = token.length, .type = token.type};
+        }
+
+        // Slide the token to the window start and read the rest of it, unless it already fills the window.
+        uint32_t start = delimited ? token.begin - 1U : token.begin;
+
+        if (start > 0U || stream->filled < stream->capacity)
+        {
+            lexer_stream_refill(stream, start);
+
+            if (stream->error != CASK_LEXER_STREAM_ERR_NONE)
+                return lexer_stream_fail(stream);
+
+            continue;
+        }
+
+        if (token.type == CASK_SPACING_TOKEN || token.type == CASK_COMMENT_TOKEN)
+            return lexer_stream_skip_long(stream, token.type);
+
+        stream->error = CASK_LEXER_STREAM_ERR_TOO_LONG;
+        return lexer_stream_fail(stream);
+    }
+}
+
+void lexer_stream_dispose(LexerStream *stream)
+{
+    free(stream->window);
+    stream->window = NULL;
+    stream->capacity = 0U;
+    stream->filled = 0U;
+    stream->index = 0U;
+}
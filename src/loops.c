@@ -0,0 +1,517 @@
+/**
+ * @file loops.c
+ * @author Derek Tan
+ * @brief Implements bounds check elimination and invariant hoisting for while loops.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "backend/loops.h"
+#include "backend/purity.h"
+
+/**
+ * @brief What a function does with one name. `init` is the initializer of its one declaration, or NULL.
+ */
+typedef struct cask_loop_name_t
+{
+    const Expression *init;
+    uint16_t decls;
+    uint16_t stores;
+    bool is_param;
+} LoopName;
+
+typedef struct cask_loops_state_t
+{
+    Compiler *compiler;
+    LoopName *names;            // by SymbolID, for the function being optimized
+    uint8_t *loop_stores;       // by SymbolID: set for names the loop being hoisted from stores to
+    const Statement *loop;
+    uint32_t hoist_count;
+    bool ok;
+} LoopsState;
+
+/* Name scanning. */
+
+static void loops_count_names(LoopsState *state, const Statement *stmt)
+{
+    const StatementVector *stmts = NULL;
+    LoopName *name = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        name = &state->names[stmt->contents.prim_decl.name];
+        name->init = (name->decls++ == 0U) ? stmt->contents.prim_decl.value : NULL;
+        return;
+    case CASK_STMT_REASSIGN:
+        if (stmt->contents.reassign.target->type == CASK_EXPR_IDENTIFIER)
+            state->names[stmt->contents.reassign.target->contents.identifier.name].stores++;
+        return;
+    case CASK_STMT_WHILE:
+        loops_count_names(state, stmt->contents.while_ctrl.block);
+        return;
+    case CASK_STMT_IF:
+        loops_count_names(state, stmt->contents.if_ctrl.block);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            loops_count_names(state, stmt->contents.if_ctrl.other->contents.else_ctrl.block);
+        return;
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t index = 0; index < stmts->count; index++)
+            loops_count_names(state, vector_at_Statement(stmts, index));
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * @brief Marks (or with `mark` 0, unmarks) the names stored to anywhere in a loop body.
+ */
+static void loops_mark_stores(LoopsState *state, const Statement *stmt, uint8_t mark)
+{
+    const StatementVector *stmts = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_REASSIGN:
+        if (stmt->contents.reassign.target->type == CASK_EXPR_IDENTIFIER)
+            state->loop_stores[stmt->contents.reassign.target->contents.identifier.name] = mark;
+        return;
+    case CASK_STMT_WHILE:
+        loops_mark_stores(state, stmt->contents.while_ctrl.block, mark);
+        return;
+    case CASK_STMT_IF:
+        loops_mark_stores(state, stmt->contents.if_ctrl.block, mark);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            loops_mark_stores(state, stmt->contents.if_ctrl.other->contents.else_ctrl.block, mark);
+        return;
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t index = 0; index < stmts->count; index++)
+            loops_mark_stores(state, vector_at_Statement(stmts, index), mark);
+        return;
+    default:
+        return;
+    }
+}
+
+/// @brief Whether a name is one local of the function, so every use of it means the same variable.
+static bool loops_is_sole_local(const LoopsState *state, SymbolID name)
+{
+    return state->names[name].decls == 1U && state->compiler->bindings[name].kind != CASK_BIND_GLOBAL;
+}
+
+static bool loops_is_identifier(const Expression *expr, SymbolID name)
+{
+    return expr->type == CASK_EXPR_IDENTIFIER && expr->contents.identifier.name == name;
+}
+
+/**
+ * @brief Matches `length(a)` on a local array `a`, giving the array's name.
+ */
+static bool loops_is_array_length(const LoopsState *state, const Expression *expr, SymbolID *array_out)
+{
+    if (expr == NULL || expr->type != CASK_EXPR_CALL || expr->contents.call.args.count != 1U)
+        return false;
+
+    Binding binding = state->compiler->bindings[expr->contents.call.name];
+    const Expression *array = vector_at_Expression(&expr->contents.call.args, 0);
+
+    if (binding.kind != CASK_BIND_NATIVE || binding.index != CASK_NATIVE_LENGTH || array->type != CASK_EXPR_IDENTIFIER
+        || (array->type_mask >> 8) != CASK_COMPTYPE_ARRAY)
+        return false;
+
+    *array_out = array->contents.identifier.name;
+
+    return true;
+}
+
+/* Bounds check elimination. */
+
+static void loops_mark_access(Expression *expr, SymbolID array, SymbolID index);
+
+static void loops_mark_access_list(const ExpressionVector *items, SymbolID array, SymbolID index)
+{
+    for (uint32_t item = 0; item < items->count; item++)
+        loops_mark_access(vector_at_Expression(items, item), array, index);
+}
+
+static void loops_mark_access(Expression *expr, SymbolID array, SymbolID index)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_ARRAY:
+        loops_mark_access_list(&expr->contents.array.values, array, index);
+        return;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        loops_mark_access_list(&expr->contents.aggregate.literals, array, index);
+        return;
+    case CASK_EXPR_CALL:
+        loops_mark_access_list(&expr->contents.call.args, array, index);
+        return;
+    case CASK_EXPR_ACCESS:
+        if (expr->contents.access.has_aggr)
+        {
+            loops_mark_access(expr->contents.access.target, array, index);
+            return;
+        }
+
+        if (loops_is_identifier(expr->contents.access.target, array) && loops_is_identifier(expr->contents.access.key, index))
+            expr->contents.access.in_bounds = true;
+
+        loops_mark_access(expr->contents.access.target, array, index);
+        loops_mark_access(expr->contents.access.key, array, index);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        loops_mark_access(expr->contents.term.left, array, index);
+        loops_mark_access(expr->contents.term.right, array, index);
+        return;
+    default:
+        return;
+    }
+}
+
+static void loops_mark_access_in(const Statement *stmt, SymbolID array, SymbolID index)
+{
+    const StatementVector *stmts = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        loops_mark_access(stmt->contents.prim_decl.value, array, index);
+        return;
+    case CASK_STMT_WHILE:
+        loops_mark_access(stmt->contents.while_ctrl.condition, array, index);
+        loops_mark_access_in(stmt->contents.while_ctrl.block, array, index);
+        return;
+    case CASK_STMT_IF:
+        loops_mark_access(stmt->contents.if_ctrl.condition, array, index);
+        loops_mark_access_in(stmt->contents.if_ctrl.block, array, index);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            loops_mark_access_in(stmt->contents.if_ctrl.other->contents.else_ctrl.block, array, index);
+        return;
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t item = 0; item < stmts->count; item++)
+            loops_mark_access_in(vector_at_Statement(stmts, item), array, index);
+        return;
+    case CASK_STMT_RETURN:
+        if (stmt->contents.return_stmt.value != NULL)
+            loops_mark_access(stmt->contents.return_stmt.value, array, index);
+        return;
+    case CASK_STMT_REASSIGN:
+        loops_mark_access(stmt->contents.reassign.target, array, index);
+        loops_mark_access(stmt->contents.reassign.value, array, index);
+        return;
+    case CASK_STMT_EXPR:
+        loops_mark_access(stmt->contents.expr_stmt.expr, array, index);
+        return;
+    default:
+        return;
+    }
+}
+
+/// @brief Matches the statement `index = index + 1`.
+static bool loops_is_increment(const Statement *stmt, SymbolID index)
+{
+    if (stmt->type != CASK_STMT_REASSIGN || !loops_is_identifier(stmt->contents.reassign.target, index))
+        return false;
+
+    const Expression *value = stmt->contents.reassign.value;
+
+    if (value->type != CASK_EXPR_TERM || value->contents.term.op != CASK_OP_ADD)
+        return false;
+
+    const Expression *left = value->contents.term.left;
+    const Expression *right = value->contents.term.right;
+
+    return (loops_is_identifier(left, index) && right->type == CASK_EXPR_LITERAL_INTEGER && right->contents.integer.value == 1)
+        || (loops_is_identifier(right, index) && left->type == CASK_EXPR_LITERAL_INTEGER && left->contents.integer.value == 1);
+}
+
+/**
+ * @brief Marks the accesses proven in range by one `index < limit` fact of a loop condition.
+ * @note `index` starts non-negative and only ever grows by one right after the condition held, so it stays within `[0, length]` and cannot wrap. Until the increment, it is below the length.
+ */
+static void loops_bound_index(const LoopsState *state, const Statement *loop, const Expression *index_expr, const Expression *limit)
+{
+    SymbolID array = CASK_SYMBOL_NONE;
+
+    if (index_expr->type != CASK_EXPR_IDENTIFIER || index_expr->type_mask != CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, CASK_DATATYPE_INTEGER))
+        return;
+
+    SymbolID index = index_expr->contents.identifier.name;
+    const LoopName *index_name = &state->names[index];
+
+    if (!loops_is_sole_local(state, index) || index_name->is_param || index_name->stores != 1U || index_name->init == NULL
+        || index_name->init->type != CASK_EXPR_LITERAL_INTEGER || index_name->init->contents.integer.value < 0)
+        return;
+
+    if (!loops_is_array_length(state, limit, &array))
+    {
+        if (limit->type != CASK_EXPR_IDENTIFIER || !loops_is_sole_local(state, limit->contents.identifier.name))
+            return;
+
+        const LoopName *limit_name = &state->names[limit->contents.identifier.name];
+
+        if (limit_name->is_param || limit_name->stores != 0U || !loops_is_array_length(state, limit_name->init, &array))
+            return;
+    }
+
+    if (!loops_is_sole_local(state, array) || state->names[array].stores != 0U)
+        return;
+
+    const StatementVector *body = &loop->contents.while_ctrl.block->contents.block.stmts;
+    uint32_t increment = 0U;
+
+    while (increment < body->count && !loops_is_increment(vector_at_Statement(body, increment), index))
+        increment++;
+
+    for (uint32_t item = 0; increment < body->count && item < increment; item++)
+        loops_mark_access_in(vector_at_Statement(body, item), array, index);
+}
+
+/// @brief Every `&&` operand of a condition holds inside the loop body.
+static void loops_bound_from(const LoopsState *state, const Statement *loop, const Expression *condition)
+{
+    if (condition->type == CASK_EXPR_CONDITIONAL && condition->contents.conditional.op == CASK_OP_AND)
+    {
+        loops_bound_from(state, loop, condition->contents.conditional.left);
+        loops_bound_from(state, loop, condition->contents.conditional.right);
+    }
+    else if (condition->type == CASK_EXPR_COMPARISON && condition->contents.comparison.op == CASK_OP_LT)
+    {
+        loops_bound_index(state, loop, condition->contents.comparison.left, condition->contents.comparison.right);
+    }
+}
+
+/* Invariant hoisting. */
+
+/**
+ * @brief Tells whether a subtree gives the same value on every evaluation of the loop's condition.
+ */
+static bool loops_is_invariant(const LoopsState *state, const Expression *expr)
+{
+    const ExpressionVector *args = NULL;
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+    case CASK_EXPR_LITERAL_INTEGER:
+    case CASK_EXPR_LITERAL_FLOAT:
+    case CASK_EXPR_LITERAL_STRING:
+        return true;
+    case CASK_EXPR_IDENTIFIER:
+        return state->names[expr->contents.identifier.name].decls > 0U && state->compiler->bindings[expr->contents.identifier.name].kind != CASK_BIND_GLOBAL
+            && !state->loop_stores[expr->contents.identifier.name];
+    case CASK_EXPR_CALL:
+        // Each call makes distinct heap objects, so only single value results are kept.
+        if (!purity_call_is_pure(state->compiler, expr) || (expr->type_mask >> 8) != CASK_COMPTYPE_SINGLE)
+            return false;
+
+        args = &expr->contents.call.args;
+
+        for (uint32_t index = 0; index < args->count; index++)
+        {
+            if (!loops_is_invariant(state, vector_at_Expression(args, index)))
+                return false;
+        }
+
+        return true;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+        return loops_is_invariant(state, expr->contents.term.left) && loops_is_invariant(state, expr->contents.term.right);
+    default:
+        return false;
+    }
+}
+
+static void loops_hoist(LoopsState *state, Expression *expr)
+{
+    if (state->hoist_count == CASK_COMPILER_MAX_HOISTS)
+        return;
+
+    uint8_t temp = (uint8_t)(CASK_COMPILER_MAX_TEMPS - 1U - state->hoist_count);
+    LoopHoist hoist = {.loop = state->loop, .value = *expr};
+    uint16_t mask = expr->type_mask;
+    SymbolID type_name = expr->type_name;
+
+    hoist.value.temp_def = temp + 1U;
+
+    if (!vector_append_LoopHoist(&state->compiler->hoists, NULL, hoist))
+    {
+        state->ok = false;
+        return;
+    }
+
+    state->hoist_count++;
+    expression_init_temp(expr, temp);
+    expr->type_mask = mask;
+    expr->type_name = type_name;
+}
+
+/**
+ * @brief Hoists the largest invariant subtrees of an expression that cost more than a load.
+ */
+static void loops_hoist_in(LoopsState *state, Expression *expr)
+{
+    const ExpressionVector *items = NULL;
+
+    if (loops_is_invariant(state, expr))
+    {
+        if (expr->type == CASK_EXPR_CALL || expr->type >= CASK_EXPR_TERM)
+            loops_hoist(state, expr);
+        return;
+    }
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_ARRAY:
+        items = &expr->contents.array.values;
+        break;
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        items = &expr->contents.aggregate.literals;
+        break;
+    case CASK_EXPR_CALL:
+        items = &expr->contents.call.args;
+        break;
+    case CASK_EXPR_ACCESS:
+        loops_hoist_in(state, expr->contents.access.target);
+
+        if (!expr->contents.access.has_aggr)
+            loops_hoist_in(state, expr->contents.access.key);
+        return;
+    case CASK_EXPR_CONDITIONAL:
+        // The right side may be skipped, so only the left is sure to run.
+        loops_hoist_in(state, expr->contents.conditional.left);
+        return;
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+        loops_hoist_in(state, expr->contents.term.left);
+        loops_hoist_in(state, expr->contents.term.right);
+        return;
+    default:
+        return;
+    }
+
+    for (uint32_t index = 0; index < items->count; index++)
+        loops_hoist_in(state, vector_at_Expression(items, index));
+}
+
+/* Tree walk. */
+
+static void loops_stmt(LoopsState *state, const Statement *stmt);
+
+static void loops_block(LoopsState *state, const Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+
+    for (uint32_t index = 0; index < stmts->count; index++)
+        loops_stmt(state, vector_at_Statement(stmts, index));
+}
+
+static void loops_while(LoopsState *state, const Statement *loop)
+{
+    loops_bound_from(state, loop, loop->contents.while_ctrl.condition);
+
+    loops_mark_stores(state, loop->contents.while_ctrl.block, 1U);
+    state->loop = loop;
+    state->hoist_count = 0U;
+    loops_hoist_in(state, loop->contents.while_ctrl.condition);
+    loops_mark_stores(state, loop->contents.while_ctrl.block, 0U);
+
+    loops_block(state, loop->contents.while_ctrl.block);
+}
+
+static void loops_stmt(LoopsState *state, const Statement *stmt)
+{
+    switch (stmt->type)
+    {
+    case CASK_STMT_WHILE:
+        loops_while(state, stmt);
+        return;
+    case CASK_STMT_IF:
+        loops_block(state, stmt->contents.if_ctrl.block);
+
+        if (stmt->contents.if_ctrl.other != NULL)
+            loops_block(state, stmt->contents.if_ctrl.other->contents.else_ctrl.block);
+        return;
+    case CASK_STMT_BLOCK:
+        loops_block(state, stmt);
+        return;
+    default:
+        return;
+    }
+}
+
+static void loops_function(LoopsState *state, const Statement *decl, size_t name_bytes)
+{
+    const StatementVector *params = &decl->contents.func_decl.params;
+
+    memset(state->names, 0, name_bytes);
+
+    for (uint32_t index = 0; index < params->count; index++)
+    {
+        LoopName *name = &state->names[vector_at_Statement(params, index)->contents.param_decl.name];
+
+        name->decls++;
+        name->is_param = true;
+    }
+
+    loops_count_names(state, decl->contents.func_decl.block);
+    loops_block(state, decl->contents.func_decl.block);
+}
+
+/* Pass impl. */
+
+bool loops_unit(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+    uint32_t symbol_slots = compiler->unit->symbols.entry_count + 1U;
+    LoopsState state = {
+        .compiler = compiler,
+        .names = malloc(symbol_slots * sizeof(LoopName)),
+        .loop_stores = calloc(symbol_slots, sizeof(uint8_t)),
+        .loop = NULL,
+        .hoist_count = 0U,
+        .ok = true
+    };
+
+    state.ok = state.names != NULL && state.loop_stores != NULL;
+
+    // Top-level loops work on globals, which any call may store to, so only function bodies are worth it.
+    for (uint32_t index = 0; state.ok && index < statements->count; index++)
+    {
+        const Statement *stmt = vector_at_Statement(statements, index);
+
+        if (stmt->type == CASK_STMT_FUNCTION_DECL)
+            loops_function(&state, stmt, symbol_slots * sizeof(LoopName));
+    }
+
+    free(state.names);
+    free(state.loop_stores);
+
+    if (!state.ok)
+        compiler->error = CASK_COMPILE_ERR_GENERAL;
+
+    return state.ok;
+}
@@ -0,0 +1,1172 @@
+/**
+ * @file parser.c
+ * @author Derek Tan
+ * @brief Implements the Cask recursive descent parser.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/files.h"
+#include "utils/pool.h"
+#include "frontend/parser.h"
+
+#define CASK_PARSER_NUMBER_MAX 63U
+
+/* Statement helper tables, indexed by LexicalType. */
+
+static const StmtParseFunc parser_toplevel_helpers[CASK_LEXICAL_TYPE_COUNT] = {
+    [CASK_IDENTIFIER_TOKEN] = parse_decl_any_value,
+    [CASK_FUNC_TOKEN] = parse_decl_func,
+    [CASK_AGG_TOKEN] = parse_decl_aggregate,
+    [CASK_FROM_TOKEN] = parse_stmt_import
+};
+
+static const StmtParseFunc parser_body_helpers[CASK_LEXICAL_TYPE_COUNT] = {
+    [CASK_IDENTIFIER_TOKEN] = parse_decl_any_value,
+    [CASK_WHILE_TOKEN] = parse_stmt_while,
+    [CASK_IF_TOKEN] = parse_stmt_if,
+    [CASK_RETURN_TOKEN] = parse_stmt_return
+};
+
+/* Parser utility impls. */
+
+static uint32_t parser_line_of(const Parser *parser, uint32_t position)
+{
+    const char *source = parser->lexer.source_view;
+    uint32_t line = 1U;
+
+    for (uint32_t index = 0; index < position && index < parser->lexer.source_length; index++)
+    {
+        if (source[index] == '\n')
+            line++;
+    }
+
+    return line;
+}
+
+/// @note Only the first error is kept since later ones usually cascade from it.
+static void parser_report_at(Parser *parser, ParserErrorCode code, Token token)
+{
+    if (parser->error != CASK_PARSER_ERR_NONE)
+        return;
+
+    parser->error = code;
+    parser->error_token = token;
+    parser->error_line = parser_line_of(parser, token.begin);
+}
+
+static void parser_report(Parser *parser, ParserErrorCode code)
+{
+    parser_report_at(parser, code, parser->current);
+}
+
+static bool parser_check(const Parser *parser, LexicalType type)
+{
+    return parser->current.type == type;
+}
+
+static bool parser_match(Parser *parser, LexicalType type)
+{
+    if (!parser_check(parser, type))
+        return false;
+
+    parser_advance(parser);
+    return true;
+}
+
+static bool parser_consume(Parser *parser, LexicalType type)
+{
+    if (parser_match(parser, type))
+        return true;
+
+    parser_report(parser, parser_check(parser, CASK_EOF_TOKEN) ? CASK_PARSER_ERR_UNCLOSED_BLOCK : CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+    return false;
+}
+
+static bool parser_check_text(const Parser *parser, const char *text)
+{
+    const Token *token = &parser->current;
+
+    return token->type == CASK_OPERATOR_TOKEN && token->length == strlen(text)
+        && memcmp(parser->lexer.source_view + token->begin, text, token->length) == 0;
+}
+
+static OperatorType parser_decode_operator(const Parser *parser)
+{
+    const Token *token = &parser->current;
+
+    if (token->type != CASK_OPERATOR_TOKEN || token->length > 2U)
+        return CASK_OP_NONE;
+
+    const char *lexeme = parser->lexer.source_view + token->begin;
+    char first = lexeme[0];
+    char second = (token->length == 2U) ? lexeme[1] : '\0';
+
+    switch (first)
+    {
+    case '+':
+        return (second == '\0') ? CASK_OP_ADD : CASK_OP_NONE;
+    case '-':
+        return (second == '\0') ? CASK_OP_SUB : CASK_OP_NONE;
+    case '*':
+        return (second == '\0') ? CASK_OP_MUL : CASK_OP_NONE;
+    case '/':
+        return (second == '\0') ? CASK_OP_DIV : CASK_OP_NONE;
+    case '<':
+        return (second == '\0') ? CASK_OP_LT : ((second == '=') ? CASK_OP_LTE : CASK_OP_NONE);
+    case '>':
+        return (second == '\0') ? CASK_OP_GT : ((second == '=') ? CASK_OP_GTE : CASK_OP_NONE);
+    case '=':
+        return (second == '=') ? CASK_OP_EQ : CASK_OP_NONE;
+    case '!':
+        return (second == '=') ? CASK_OP_NEQ : CASK_OP_NONE;
+    case '&':
+        return (second == '&') ? CASK_OP_AND : CASK_OP_NONE;
+    case '|':
+        return (second == '|') ? CASK_OP_OR : CASK_OP_NONE;
+    default:
+        return CASK_OP_NONE;
+    }
+}
+
+static SymbolID parser_intern_token(Parser *parser, const Token *token)
+{
+    return program_unit_intern(parser->unit, parser->lexer.source_view + token->begin, token->length);
+}
+
+static Expression *parser_new_expr(Parser *parser)
+{
+    Expression *expr = program_unit_new_expr(parser->unit);
+
+    if (!expr)
+        parser_report(parser, CASK_PARSER_ERR_GENERAL);
+
+    return expr;
+}
+
+static Statement *parser_new_stmt(Parser *parser)
+{
+    Statement *stmt = program_unit_new_stmt(parser->unit);
+
+    if (!stmt)
+        parser_report(parser, CASK_PARSER_ERR_GENERAL);
+
+    return stmt;
+}
+
+/**
+ * @brief Parses a type annotation: a primitive type name or aggregate name, optionally followed by `[]` for arrays.
+ */
+static bool parser_parse_type(Parser *parser, CompositeType *high_type, DataType *low_type, SymbolID *type_name)
+{
+    *high_type = CASK_COMPTYPE_SINGLE;
+    *low_type = CASK_DATATYPE_UNKNOWN;
+    *type_name = CASK_SYMBOL_NONE;
+
+    switch (parser->current.type)
+    {
+    case CASK_INT_TYPE_TOKEN:
+        *low_type = CASK_DATATYPE_INTEGER;
+        break;
+    case CASK_FLOAT_TYPE_TOKEN:
+        *low_type = CASK_DATATYPE_FLOAT;
+        break;
+    case CASK_BOOL_TYPE_TOKEN:
+        *low_type = CASK_DATATYPE_BOOLEAN;
+        break;
+    case CASK_STRING_TYPE_TOKEN:
+        *low_type = CASK_DATATYPE_STRING;
+        break;
+    case CASK_NIL_TOKEN:
+        *low_type = CASK_DATATYPE_NIL;
+        break;
+    case CASK_IDENTIFIER_TOKEN:
+        *high_type = CASK_COMPTYPE_AGGREGATE;
+        *type_name = parser_intern_token(parser, &parser->current);
+        break;
+    default:
+        parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return false;
+    }
+
+    parser_advance(parser);
+
+    if (parser_match(parser, CASK_LBRACK_TOKEN))
+    {
+        if (!parser_consume(parser, CASK_RBRACK_TOKEN))
+            return false;
+
+        *high_type = CASK_COMPTYPE_ARRAY;
+    }
+
+    return parser->error == CASK_PARSER_ERR_NONE;
+}
+
+/**
+ * @brief Consumes the `end` closing a block, reporting an unclosed block at EOF.
+ */
+static bool parser_close_block(Parser *parser)
+{
+    return parser_consume(parser, CASK_END_TOKEN);
+}
+
+/* Parser impl. */
+
+void parser_init(Parser *parser)
+{
+    parser->lexer.source_view = NULL;
+    parser->lexer.source_index = 0U;
+    parser->lexer.source_length = 0U;
+    parser->tokens = (TokenStream){.types = NULL, .begins = NULL, .lengths = NULL, .count = 0U, .capacity = 0U};
+    parser->cursor = 0U;
+    parser->stmt_helpers = parser_toplevel_helpers;
+    parser->unit = NULL;
+    parser->file_path = NULL;
+    parser->source = (SourceFile){.data = NULL, .length = 0, .storage = CASK_SOURCE_EMPTY};
+    parser->previous = (Token){.begin = 0U, .length = 0U, .type = CASK_EOF_TOKEN};
+    parser->current = parser->previous;
+    parser->error_token = parser->previous;
+    parser->error_line = 0U;
+    parser->error = CASK_PARSER_ERR_NONE;
+}
+
+bool parser_use_file(Parser *parser, const char *file_path)
+{
+    SourceFile source;
+
+    if (!file_map(file_path, &source))
+        return false;
+
+    return parser_use_source(parser, &source, file_path, pool_core_count());
+}
+
+bool parser_use_source(Parser *parser, SourceFile *source, const char *file_path, uint32_t worker_count)
+{
+    if (source->length > UINT32_MAX)
+    {
+        file_unmap(source);
+        return false;
+    }
+
+    parser_dispose(parser);
+    parser_init(parser);
+    parser->source = *source;
+    parser->file_path = file_path;
+    *source = (SourceFile){.data = NULL, .length = 0, .storage = CASK_SOURCE_EMPTY};
+    lexer_init_view(&parser->lexer, parser->source.data, (uint32_t)parser->source.length);
+
+    /// @note Sizing for one token per 4 bytes avoids most regrowth on typical sources. Multi-megabyte sources are lexed in chunks on `worker_count` threads.
+    if (!token_stream_init(&parser->tokens, (uint32_t)(parser->source.length / 4U)) || !token_stream_lex_parallel(&parser->tokens, &parser->lexer, worker_count))
+    {
+        parser_dispose(parser);
+        return false;
+    }
+
+    return true;
+}
+
+void parser_dispose(Parser *parser)
+{
+    token_stream_dispose(&parser->tokens);
+    file_unmap(&parser->source);
+}
+
+/**
+ * @brief Loads the token under the cursor as the current token.
+ */
+static bool parser_load_current(Parser *parser)
+{
+    parser->current = token_stream_at(&parser->tokens, parser->cursor);
+
+    if (parser->current.type == CASK_UNKNOWN_TOKEN)
+    {
+        parser_report(parser, CASK_PARSER_ERR_UNKNOWN_TOKEN);
+        return false;
+    }
+
+    return parser->current.type != CASK_EOF_TOKEN;
+}
+
+bool parser_advance(Parser *parser)
+{
+    parser->previous = parser->current;
+
+    if (parser->cursor + 1U < parser->tokens.count)
+        parser->cursor++;
+
+    return parser_load_current(parser);
+}
+
+Token parser_peek_curr(const Parser *parser)
+{
+    return parser->current;
+}
+
+Token parser_peek_back(const Parser *parser)
+{
+    return parser->previous;
+}
+
+Token parser_peek_ahead(const Parser *parser, uint32_t offset)
+{
+    return token_stream_at(&parser->tokens, parser->cursor + offset);
+}
+
+StmtParseFunc parser_lookup_helper(const Parser *parser)
+{
+    return parser->stmt_helpers[parser->current.type];
+}
+
+/* Expression parsing impls. */
+
+Expression *parse_expr_special(Parser *parser_ptr)
+{
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    switch (parser_ptr->current.type)
+    {
+    case CASK_NIL_TOKEN:
+        expression_init_special_ltrl(expr, true, false);
+        break;
+    case CASK_TRUE_TOKEN:
+        expression_init_special_ltrl(expr, false, true);
+        break;
+    case CASK_FALSE_TOKEN:
+        expression_init_special_ltrl(expr, false, false);
+        break;
+    default:
+        parser_report(parser_ptr, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return NULL;
+    }
+
+    parser_advance(parser_ptr);
+
+    return expr;
+}
+
+Expression *parse_expr_numeric(Parser *parser_ptr)
+{
+    bool negative = false;
+
+    if (parser_check_text(parser_ptr, "-"))
+    {
+        negative = true;
+        parser_advance(parser_ptr);
+    }
+
+    if (!parser_check(parser_ptr, CASK_DIGITS_TOKEN))
+    {
+        parser_report(parser_ptr, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return NULL;
+    }
+
+    Token whole = parser_ptr->current;
+    Token dot = parser_peek_ahead(parser_ptr, 1U);
+    const char *source = parser_ptr->lexer.source_view;
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    // A float literal is digits, a dot and digits with no spacing between them.
+    if (dot.type == CASK_DOT_TOKEN && dot.begin == whole.begin + whole.length)
+    {
+        Token fraction = parser_peek_ahead(parser_ptr, 2U);
+
+        if (fraction.type != CASK_DIGITS_TOKEN || fraction.begin != dot.begin + 1U
+            || whole.length + fraction.length + 1U > CASK_PARSER_NUMBER_MAX)
+        {
+            parser_report_at(parser_ptr, CASK_PARSER_ERR_UNEXPECTED_TOKEN, fraction);
+            return NULL;
+        }
+
+        char number_buffer[CASK_PARSER_NUMBER_MAX + 1U];
+        uint32_t number_length = whole.length + fraction.length + 1U;
+
+        memcpy(number_buffer, source + whole.begin, number_length);
+        number_buffer[number_length] = '\0';
+
+        for (int step = 0; step < 3; step++)
+            parser_advance(parser_ptr);
+
+        float value = strtof(number_buffer, NULL);
+        expression_init_realnum_ltrl(expr, negative ? -value : value);
+
+        return expr;
+    }
+
+    parser_advance(parser_ptr);
+
+    /// @note The magnitude limit is one higher for negative literals so INT32_MIN is expressible.
+    int64_t limit = negative ? 2147483648LL : 2147483647LL;
+    int64_t value = 0;
+
+    for (uint32_t index = 0; index < whole.length; index++)
+    {
+        value = value * 10 + (source[whole.begin + index] - '0');
+
+        if (value > limit)
+        {
+            parser_report_at(parser_ptr, CASK_PARSER_ERR_GENERAL, whole);
+            return NULL;
+        }
+    }
+
+    expression_init_integer_ltrl(expr, (int32_t)(negative ? -value : value));
+
+    return expr;
+}
+
+Expression *parse_expr_string(Parser *parser_ptr)
+{
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    expression_init_string_ltrl(expr, parser_intern_token(parser_ptr, &parser_ptr->current));
+    parser_advance(parser_ptr);
+
+    return expr;
+}
+
+/**
+ * @brief Parses comma separated expressions up to a closing token into an array, aggregate or call node. A trailing comma is allowed.
+ */
+static bool parser_parse_expr_list(Parser *parser, Expression *owner, LexicalType closer)
+{
+    while (!parser_check(parser, closer) && parser->error == CASK_PARSER_ERR_NONE)
+    {
+        Expression *item = parse_expr_conditional(parser);
+
+        if (!item)
+            return false;
+
+        if (!expression_append_child(owner, &parser->unit->arena, owner->type, item))
+        {
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+            return false;
+        }
+
+        if (!parser_match(parser, CASK_COMMA_TOKEN))
+            break;
+    }
+
+    return parser_consume(parser, closer);
+}
+
+Expression *parse_expr_agg(Parser *parser_ptr)
+{
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    expression_init_aggr_ltrl(expr);
+    parser_advance(parser_ptr);
+
+    return parser_parse_expr_list(parser_ptr, expr, CASK_RBRACE_TOKEN) ? expr : NULL;
+}
+
+Expression *parse_expr_array(Parser *parser_ptr)
+{
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    expression_init_array_ltrl(expr);
+    parser_advance(parser_ptr);
+
+    return parser_parse_expr_list(parser_ptr, expr, CASK_RBRACK_TOKEN) ? expr : NULL;
+}
+
+Expression *parse_expr_call(Parser *parser_ptr)
+{
+    /// @note The callee name was just consumed, so it is the previous token.
+    Expression *expr = parser_new_expr(parser_ptr);
+
+    if (!expr)
+        return NULL;
+
+    expression_init_call(expr, parser_intern_token(parser_ptr, &parser_ptr->previous));
+
+    if (!parser_consume(parser_ptr, CASK_LPAREN_TOKEN))
+        return NULL;
+
+    return parser_parse_expr_list(parser_ptr, expr, CASK_RPAREN_TOKEN) ? expr : NULL;
+}
+
+Expression *parse_expr_basic(Parser *parser_ptr)
+{
+    Expression *expr = NULL;
+
+    switch (parser_ptr->current.type)
+    {
+    case CASK_NIL_TOKEN:
+    case CASK_TRUE_TOKEN:
+    case CASK_FALSE_TOKEN:
+        return parse_expr_special(parser_ptr);
+    case CASK_DIGITS_TOKEN:
+        return parse_expr_numeric(parser_ptr);
+    case CASK_OPERATOR_TOKEN:
+        if (parser_check_text(parser_ptr, "-"))
+            return parse_expr_numeric(parser_ptr);
+        break;
+    case CASK_STRING_TOKEN:
+        return parse_expr_string(parser_ptr);
+    case CASK_LBRACK_TOKEN:
+        return parse_expr_array(parser_ptr);
+    case CASK_LBRACE_TOKEN:
+        return parse_expr_agg(parser_ptr);
+    case CASK_IDENTIFIER_TOKEN:
+        parser_advance(parser_ptr);
+
+        if (parser_check(parser_ptr, CASK_LPAREN_TOKEN))
+            return parse_expr_call(parser_ptr);
+
+        if ((expr = parser_new_expr(parser_ptr)) != NULL)
+            expression_init_identifier_ltrl(expr, parser_intern_token(parser_ptr, &parser_ptr->previous));
+
+        return expr;
+    case CASK_LPAREN_TOKEN:
+        parser_advance(parser_ptr);
+        expr = parse_expr_conditional(parser_ptr);
+
+        if (!expr || !parser_consume(parser_ptr, CASK_RPAREN_TOKEN))
+            return NULL;
+
+        return expr;
+    default:
+        break;
+    }
+
+    parser_report(parser_ptr, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+
+    return NULL;
+}
+
+/**
+ * @brief Applies any `[key]` or `.field` suffixes to an already parsed operand.
+ */
+static Expression *parser_parse_postfix(Parser *parser, Expression *target)
+{
+    while (target != NULL)
+    {
+        Expression *key = NULL;
+        bool has_aggr = false;
+
+        if (parser_match(parser, CASK_LBRACK_TOKEN))
+        {
+            key = parse_expr_conditional(parser);
+
+            if (!key || !parser_consume(parser, CASK_RBRACK_TOKEN))
+                return NULL;
+        }
+        else if (parser_match(parser, CASK_DOT_TOKEN))
+        {
+            if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN) || (key = parser_new_expr(parser)) == NULL)
+                return NULL;
+
+            expression_init_identifier_ltrl(key, parser_intern_token(parser, &parser->previous));
+            has_aggr = true;
+        }
+        else
+        {
+            break;
+        }
+
+        Expression *access = parser_new_expr(parser);
+
+        if (!access)
+            return NULL;
+
+        expression_init_access(access, target, key, has_aggr);
+        target = access;
+    }
+
+    return target;
+}
+
+Expression *parse_expr_access(Parser *parser_ptr)
+{
+    return parser_parse_postfix(parser_ptr, parse_expr_basic(parser_ptr));
+}
+
+/**
+ * @brief Binding power and node kind of one binary operator. Higher precedence binds tighter, and 0 means "not a binary operator".
+ */
+typedef struct parser_binary_rule_t
+{
+    uint8_t precedence;
+    ExpressionType node_type;
+} BinaryRule;
+
+#define CASK_PREC_CONDITIONAL 1U
+#define CASK_PREC_EQUALITY 2U
+#define CASK_PREC_COMPARISON 3U
+#define CASK_PREC_TERM 4U
+#define CASK_PREC_FACTOR 5U
+
+/// @note Indexed by `OperatorType`. `&&` and `||` share one level, as in the grammar.
+static const BinaryRule parser_binary_rules[] = {
+    [CASK_OP_NONE] = {0U, CASK_EXPR_CONDITIONAL},
+    [CASK_OP_ADD] = {CASK_PREC_TERM, CASK_EXPR_TERM},
+    [CASK_OP_SUB] = {CASK_PREC_TERM, CASK_EXPR_TERM},
+    [CASK_OP_MUL] = {CASK_PREC_FACTOR, CASK_EXPR_FACTOR},
+    [CASK_OP_DIV] = {CASK_PREC_FACTOR, CASK_EXPR_FACTOR},
+    [CASK_OP_LT] = {CASK_PREC_COMPARISON, CASK_EXPR_COMPARISON},
+    [CASK_OP_LTE] = {CASK_PREC_COMPARISON, CASK_EXPR_COMPARISON},
+    [CASK_OP_GT] = {CASK_PREC_COMPARISON, CASK_EXPR_COMPARISON},
+    [CASK_OP_GTE] = {CASK_PREC_COMPARISON, CASK_EXPR_COMPARISON},
+    [CASK_OP_EQ] = {CASK_PREC_EQUALITY, CASK_EXPR_EQUALITY},
+    [CASK_OP_NEQ] = {CASK_PREC_EQUALITY, CASK_EXPR_EQUALITY},
+    [CASK_OP_AND] = {CASK_PREC_CONDITIONAL, CASK_EXPR_CONDITIONAL},
+    [CASK_OP_OR] = {CASK_PREC_CONDITIONAL, CASK_EXPR_CONDITIONAL}
+};
+
+/**
+ * @brief Precedence climbing: parses an operand, then folds in every following binary operator that binds at least as tight as `min_precedence`. Right operands only take tighter operators, so all levels stay left associative.
+ */
+static Expression *parser_parse_precedence(Parser *parser, uint8_t min_precedence)
+{
+    Expression *left = parse_expr_access(parser);
+
+    while (left != NULL)
+    {
+        OperatorType op = parser_decode_operator(parser);
+        const BinaryRule *rule = &parser_binary_rules[op];
+
+        if (rule->precedence == 0U || rule->precedence < min_precedence)
+            break;
+
+        parser_advance(parser);
+
+        Expression *right = parser_parse_precedence(parser, rule->precedence + 1U);
+        Expression *node = (right != NULL) ? parser_new_expr(parser) : NULL;
+
+        if (!node)
+            return NULL;
+
+        expression_init_binary(node, rule->node_type, left, right, op);
+        left = node;
+    }
+
+    return left;
+}
+
+Expression *parse_expr_factor(Parser *parser_ptr)
+{
+    return parser_parse_precedence(parser_ptr, CASK_PREC_FACTOR);
+}
+
+Expression *parse_expr_term(Parser *parser_ptr)
+{
+    return parser_parse_precedence(parser_ptr, CASK_PREC_TERM);
+}
+
+Expression *parse_expr_comparison(Parser *parser_ptr)
+{
+    return parser_parse_precedence(parser_ptr, CASK_PREC_COMPARISON);
+}
+
+Expression *parse_expr_equality(Parser *parser_ptr)
+{
+    return parser_parse_precedence(parser_ptr, CASK_PREC_EQUALITY);
+}
+
+Expression *parse_expr_conditional(Parser *parser_ptr)
+{
+    return parser_parse_precedence(parser_ptr, CASK_PREC_CONDITIONAL);
+}
+
+/* Statement parsing impls. */
+
+Statement *parse_decl_primitive(void *parser_ptr)
+{
+    /// @note The declared name was just consumed, so it is the previous token and the current one is `:`.
+    Parser *parser = parser_ptr;
+    SymbolID name = parser_intern_token(parser, &parser->previous);
+    CompositeType high_type;
+    DataType low_type;
+    SymbolID type_name;
+
+    if (!parser_consume(parser, CASK_COLON_TOKEN) || !parser_parse_type(parser, &high_type, &low_type, &type_name))
+        return NULL;
+
+    if (!parser_check_text(parser, "="))
+    {
+        parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return NULL;
+    }
+
+    parser_advance(parser);
+
+    Expression *value = parse_expr_conditional(parser);
+    Statement *stmt = (value != NULL) ? parser_new_stmt(parser) : NULL;
+
+    if (stmt != NULL)
+        statement_init_prim_decl(stmt, name, value, high_type, low_type, type_name);
+
+    return stmt;
+}
+
+Statement *parse_decl_field(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+    CompositeType high_type;
+    DataType low_type;
+    SymbolID type_name;
+
+    if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN))
+        return NULL;
+
+    SymbolID name = parser_intern_token(parser, &parser->previous);
+
+    if (!parser_consume(parser, CASK_COLON_TOKEN) || !parser_parse_type(parser, &high_type, &low_type, &type_name))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_field_decl(stmt, name, high_type, low_type, type_name);
+
+    return stmt;
+}
+
+Statement *parse_decl_aggregate(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (!stmt)
+        return NULL;
+
+    statement_init_aggr_decl(stmt, parser_intern_token(parser, &parser->previous));
+
+    if (!parser_consume(parser, CASK_LBRACE_TOKEN))
+        return NULL;
+
+    while (!parser_check(parser, CASK_RBRACE_TOKEN) && parser->error == CASK_PARSER_ERR_NONE)
+    {
+        Statement *field = parse_decl_field(parser);
+
+        if (!field)
+            return NULL;
+
+        if (!statement_append_child(stmt, &parser->unit->arena, field))
+        {
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+            return NULL;
+        }
+
+        parser_match(parser, CASK_COMMA_TOKEN);
+    }
+
+    return parser_consume(parser, CASK_RBRACE_TOKEN) ? stmt : NULL;
+}
+
+Statement *parse_decl_any_value(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    if (parser_check(parser, CASK_COLON_TOKEN))
+        return parse_decl_primitive(parser);
+
+    Expression *target = NULL;
+
+    if (parser_check(parser, CASK_LPAREN_TOKEN))
+    {
+        target = parse_expr_call(parser);
+    }
+    else if ((target = parser_new_expr(parser)) != NULL)
+    {
+        expression_init_identifier_ltrl(target, parser_intern_token(parser, &parser->previous));
+    }
+
+    target = parser_parse_postfix(parser, target);
+
+    if (!target)
+        return NULL;
+
+    Statement *stmt = NULL;
+
+    if (parser_check_text(parser, "=") && target->is_lvalue)
+    {
+        parser_advance(parser);
+
+        Expression *value = parse_expr_conditional(parser);
+
+        if (value != NULL && (stmt = parser_new_stmt(parser)) != NULL)
+            statement_init_reassign(stmt, target, value);
+
+        return stmt;
+    }
+
+    // Only calls are useful as bare expression statements.
+    if (target->type != CASK_EXPR_CALL)
+    {
+        parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return NULL;
+    }
+
+    if ((stmt = parser_new_stmt(parser)) != NULL)
+        statement_init_expr_stmt(stmt, target);
+
+    return stmt;
+}
+
+Statement *parse_decl_func(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (!stmt)
+        return NULL;
+
+    statement_init_func_decl(stmt, parser_intern_token(parser, &parser->previous), NULL);
+
+    if (!parser_consume(parser, CASK_LPAREN_TOKEN))
+        return NULL;
+
+    while (!parser_check(parser, CASK_RPAREN_TOKEN) && parser->error == CASK_PARSER_ERR_NONE)
+    {
+        Statement *param = parse_decl_param(parser);
+
+        if (!param)
+            return NULL;
+
+        if (!statement_append_child(stmt, &parser->unit->arena, param))
+        {
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+            return NULL;
+        }
+
+        if (!parser_match(parser, CASK_COMMA_TOKEN))
+            break;
+    }
+
+    if (!parser_consume(parser, CASK_RPAREN_TOKEN))
+        return NULL;
+
+    if (parser_match(parser, CASK_COLON_TOKEN))
+    {
+        CompositeType high_type;
+        DataType low_type;
+
+        if (!parser_parse_type(parser, &high_type, &low_type, &stmt->contents.func_decl.type_name))
+            return NULL;
+
+        stmt->contents.func_decl.type_mask = CASK_TYPE_MASK(high_type, low_type);
+    }
+
+    const StmtParseFunc *outer_helpers = parser->stmt_helpers;
+
+    parser->stmt_helpers = parser_body_helpers;
+    stmt->contents.func_decl.block = parse_stmt_block(parser);
+    parser->stmt_helpers = outer_helpers;
+
+    if (!stmt->contents.func_decl.block || !parser_close_block(parser))
+        return NULL;
+
+    return stmt;
+}
+
+Statement *parse_decl_param(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+    CompositeType high_type;
+    DataType low_type;
+    SymbolID type_name;
+
+    if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN))
+        return NULL;
+
+    SymbolID name = parser_intern_token(parser, &parser->previous);
+
+    if (!parser_consume(parser, CASK_COLON_TOKEN) || !parser_parse_type(parser, &high_type, &low_type, &type_name))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_param_decl(stmt, name, high_type, low_type, type_name);
+
+    return stmt;
+}
+
+Statement *parse_stmt_import(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    if (!parser_check(parser, CASK_STRING_TOKEN) && !parser_check(parser, CASK_IDENTIFIER_TOKEN))
+    {
+        parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+        return NULL;
+    }
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (!stmt)
+        return NULL;
+
+    statement_init_import(stmt, parser_intern_token(parser, &parser->current));
+    parser_advance(parser);
+
+    if (!parser_consume(parser, CASK_IMPORT_TOKEN))
+        return NULL;
+
+    /// @note `import *` leaves the item list empty, meaning every exported name.
+    if (parser_check_text(parser, "*"))
+    {
+        parser_advance(parser);
+        return stmt;
+    }
+
+    do
+    {
+        Expression *item = NULL;
+
+        if (!parser_consume(parser, CASK_IDENTIFIER_TOKEN) || (item = parser_new_expr(parser)) == NULL)
+            return NULL;
+
+        expression_init_identifier_ltrl(item, parser_intern_token(parser, &parser->previous));
+
+        if (!statement_append_import(stmt, &parser->unit->arena, item))
+        {
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+            return NULL;
+        }
+    } while (parser_match(parser, CASK_COMMA_TOKEN));
+
+    return stmt;
+}
+
+Statement *parse_stmt_return(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+    Expression *value = NULL;
+
+    parser_advance(parser);
+
+    // A bare return is followed directly by the end of its block.
+    if (!parser_check(parser, CASK_END_TOKEN) && !parser_check(parser, CASK_ELSE_TOKEN) && !parser_check(parser, CASK_EOF_TOKEN))
+    {
+        if ((value = parse_expr_conditional(parser)) == NULL)
+            return NULL;
+    }
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_return(stmt, value);
+
+    return stmt;
+}
+
+/**
+ * @brief Parses `"(" conditional ")"` for while and if headers.
+ */
+static Expression *parser_parse_condition(Parser *parser)
+{
+    if (!parser_consume(parser, CASK_LPAREN_TOKEN))
+        return NULL;
+
+    Expression *condition = parse_expr_conditional(parser);
+
+    if (!condition || !parser_consume(parser, CASK_RPAREN_TOKEN))
+        return NULL;
+
+    return condition;
+}
+
+Statement *parse_stmt_while(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    Expression *condition = parser_parse_condition(parser);
+    Statement *block = (condition != NULL) ? parse_stmt_block(parser) : NULL;
+
+    if (!block || !parser_close_block(parser))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_while_ctrl(stmt, condition, block);
+
+    return stmt;
+}
+
+Statement *parse_stmt_if(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    Expression *condition = parser_parse_condition(parser);
+    Statement *block = (condition != NULL) ? parse_stmt_block(parser) : NULL;
+    Statement *other = NULL;
+
+    if (!block)
+        return NULL;
+
+    /// @note One `end` closes both the if block and its else block.
+    if (parser_check(parser, CASK_ELSE_TOKEN))
+    {
+        if ((other = parse_stmt_else(parser)) == NULL)
+            return NULL;
+    }
+    else if (!parser_close_block(parser))
+    {
+        return NULL;
+    }
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_if_ctrl(stmt, condition, block, other);
+
+    return stmt;
+}
+
+Statement *parse_stmt_else(void *parser_ptr)
+{
+    Parser *parser = parser_ptr;
+
+    parser_advance(parser);
+
+    Statement *block = parse_stmt_block(parser);
+
+    if (!block || !parser_close_block(parser))
+        return NULL;
+
+    Statement *stmt = parser_new_stmt(parser);
+
+    if (stmt != NULL)
+        statement_init_else_ctrl(stmt, block);
+
+    return stmt;
+}
+
+Statement *parse_stmt_block(void *parser_ptr)
+{
+    /// @note Stops before `end` or `else` without consuming it. The caller decides which terminator is valid.
+    Parser *parser = parser_ptr;
+    Statement *block = parser_new_stmt(parser);
+
+    if (!block)
+        return NULL;
+
+    statement_init_block(block);
+
+    while (!parser_check(parser, CASK_END_TOKEN) && !parser_check(parser, CASK_ELSE_TOKEN) && parser->error == CASK_PARSER_ERR_NONE)
+    {
+        if (parser_check(parser, CASK_EOF_TOKEN))
+        {
+            parser_report(parser, CASK_PARSER_ERR_UNCLOSED_BLOCK);
+            return NULL;
+        }
+
+        StmtParseFunc helper = parser_lookup_helper(parser);
+
+        if (!helper)
+        {
+            parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+            return NULL;
+        }
+
+        Statement *child = helper(parser);
+
+        if (!child)
+            return NULL;
+
+        if (!statement_append_child(block, &parser->unit->arena, child))
+        {
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+            return NULL;
+        }
+    }
+
+    return (parser->error == CASK_PARSER_ERR_NONE) ? block : NULL;
+}
+
+ProgramUnit *parser_parse(Parser *parser, ParserErrorCode *code_ptr)
+{
+    ProgramUnit *unit = (parser->source.data != NULL) ? malloc(sizeof(ProgramUnit)) : NULL;
+
+    if (!unit)
+    {
+        *code_ptr = CASK_PARSER_ERR_GENERAL;
+        return NULL;
+    }
+
+    program_unit_init(unit, parser->file_path);
+    program_unit_adopt_source(unit, &parser->source);
+    parser->unit = unit;
+    parser->stmt_helpers = parser_toplevel_helpers;
+    parser->cursor = 0U;
+
+    parser_load_current(parser);
+
+    while (parser->error == CASK_PARSER_ERR_NONE && !parser_check(parser, CASK_EOF_TOKEN))
+    {
+        StmtParseFunc helper = parser_lookup_helper(parser);
+
+        if (!helper)
+        {
+            parser_report(parser, CASK_PARSER_ERR_UNEXPECTED_TOKEN);
+            break;
+        }
+
+        Statement *stmt = helper(parser);
+
+        if (!stmt)
+            break;
+
+        if (!program_unit_append(unit, stmt))
+            parser_report(parser, CASK_PARSER_ERR_GENERAL);
+    }
+
+    /// @note A helper may return NULL before reporting, e.g. on allocation failure.
+    if (parser->error == CASK_PARSER_ERR_NONE && !parser_check(parser, CASK_EOF_TOKEN))
+        parser_report(parser, CASK_PARSER_ERR_GENERAL);
+
+    *code_ptr = parser->error;
+    parser->unit = NULL;
+    token_stream_dispose(&parser->tokens);
+
+    if (parser->error != CASK_PARSER_ERR_NONE)
+    {
+        program_unit_dispose(unit);
+        free(unit);
+        return NULL;
+    }
+
+    return unit;
+}
@@ -0,0 +1,330 @@
+/**
+ * @file peephole.c
+ * @author Derek Tan
+ * @brief Implements the peephole pass fusing instruction sequences into superinstructions.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "backend/peephole.h"
+
+/// @note Every round shrinks the code, so this only bounds pathological chains of rewrites.
+#define CASK_PEEPHOLE_MAX_ROUNDS 8U
+
+const char *const peephole_names[CASK_PEEPHOLE_COUNT] = {
+    "inc-local", "compare-jump", "const-branch", "store-load", "tee-pop", "push-pop", "jump-next", "jump-thread", "load-pair"
+};
+
+void peephole_stats_init(PeepholeStats *stats)
+{
+    memset(stats->hits, 0, sizeof(stats->hits));
+}
+
+/* Pattern helpers. */
+
+/**
+ * @brief Gives the fused compare-and-branch form of a typed int comparison, or NOP for other opcodes.
+ */
+static uint8_t peephole_fused_jump(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case CASK_BC_LT_I32:
+        return CASK_BC_JUMP_UNLESS_LT_I32;
+    case CASK_BC_LTE_I32:
+        return CASK_BC_JUMP_UNLESS_LTE_I32;
+    case CASK_BC_GT_I32:
+        return CASK_BC_JUMP_UNLESS_GT_I32;
+    case CASK_BC_GTE_I32:
+        return CASK_BC_JUMP_UNLESS_GTE_I32;
+    case CASK_BC_EQ_I32:
+        return CASK_BC_JUMP_UNLESS_EQ_I32;
+    case CASK_BC_NEQ_I32:
+        return CASK_BC_JUMP_UNLESS_NEQ_I32;
+    default:
+        return CASK_BC_NOP;
+    }
+}
+
+static bool peephole_is_plain_push(uint8_t opcode)
+{
+    return (opcode >= CASK_BC_PUSH_NIL && opcode <= CASK_BC_PUSH_CONST) || opcode == CASK_BC_LOAD_LOCAL || opcode == CASK_BC_LOAD_GLOBAL;
+}
+
+/**
+ * @brief Checks that `length` instructions from `index` exist and that no jump lands past the first of them.
+ */
+static bool peephole_fits(const bool *targeted, uint32_t count, uint32_t index, uint32_t length)
+{
+    if (index + length > count)
+        return false;
+
+    for (uint32_t offset = 1U; offset < length; offset++)
+    {
+        if (targeted[index + offset])
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Points jumps at the final target of any chain of JUMPs they land on.
+ */
+static void peephole_thread_jumps(Instr *instrs, uint32_t count, PeepholeStats *stats)
+{
+    for (uint32_t index = 0; index < count; index++)
+    {
+        Instr *instr = &instrs[index];
+        uint32_t target = instr->target;
+
+        if (!bytecode_is_jump(instr->opcode))
+            continue;
+
+        // A cycle of JUMPs never runs out, so stop after as many hops as there are instructions.
+        for (uint32_t hops = 0; hops < count && target < count && instrs[target].opcode == CASK_BC_JUMP && instrs[target].target != target; hops++)
+            target = instrs[target].target;
+
+        if (target == instr->target || (instr->opcode != CASK_BC_JUMP && target <= index))
+            continue;
+
+        instr->target = target;
+        stats->hits[CASK_PEEPHOLE_JUMP_THREAD]++;
+    }
+}
+
+/* Rewrite rounds. */
+
+/**
+ * @brief Matches one pattern at `index`, appending its rewrite to `out`.
+ * @return uint32_t How many instructions the match consumed, or 0 if none matched.
+ */
+static uint32_t peephole_match(const Instr *instrs, uint32_t count, const bool *targeted, uint32_t index, InstrVector *out, PeepholeStats *stats,
+    bool *ok)
+{
+    const Instr *instr = &instrs[index];
+    Instr fused = {.target = 0U, .operand = instr->operand, .argc = 0U, .opcode = CASK_BC_NOP};
+    uint32_t length = 0U;
+    PeepholePattern pattern = CASK_PEEPHOLE_COUNT;
+
+    if (peephole_fits(targeted, count, index, 4U) && instr->opcode == CASK_BC_LOAD_LOCAL && instrs[index + 1U].opcode == CASK_BC_PUSH_INT16
+        && (instrs[index + 2U].opcode == CASK_BC_ADD_I32 || instrs[index + 2U].opcode == CASK_BC_SUB_I32)
+        && instrs[index + 3U].opcode == CASK_BC_STORE_LOCAL && instrs[index + 3U].operand == instr->operand)
+    {
+        int32_t step = (int16_t)instrs[index + 1U].operand;
+
+        if (instrs[index + 2U].opcode == CASK_BC_SUB_I32)
+            step = -step;
+
+        if (step >= INT8_MIN && step <= INT8_MAX)
+        {
+            fused.opcode = CASK_BC_INC_LOCAL_I32;
+            fused.argc = (uint8_t)(int8_t)step;
+            length = 4U;
+            pattern = CASK_PEEPHOLE_INC_LOCAL;
+        }
+    }
+
+    if (length == 0U && peephole_fits(targeted, count, index, 2U))
+    {
+        const Instr *next = &instrs[index + 1U];
+
+        length = 2U;
+
+        if (next->opcode == CASK_BC_JUMP_IF_FALSE && peephole_fused_jump(instr->opcode) != CASK_BC_NOP)
+        {
+            fused = (Instr){.target = next->target, .operand = 0U, .argc = 0U, .opcode = peephole_fused_jump(instr->opcode)};
+            pattern = CASK_PEEPHOLE_COMPARE_JUMP;
+        }
+        else if (next->opcode == CASK_BC_JUMP_IF_FALSE && (instr->opcode == CASK_BC_PUSH_TRUE || instr->opcode == CASK_BC_PUSH_FALSE))
+        {
+            // A true condition never jumps, so both go. A false one always does.
+            fused = (Instr){.target = next->target, .operand = 0U, .argc = 0U, .opcode = (instr->opcode == CASK_BC_PUSH_FALSE) ? CASK_BC_JUMP : CASK_BC_NOP};
+            pattern = CASK_PEEPHOLE_CONST_BRANCH;
+        }
+        else if (instr->opcode == CASK_BC_STORE_LOCAL && next->opcode == CASK_BC_LOAD_LOCAL && next->operand == instr->operand)
+        {
+            fused.opcode = CASK_BC_TEE_LOCAL;
+            pattern = CASK_PEEPHOLE_STORE_LOAD;
+        }
+        else if (instr->opcode == CASK_BC_TEE_LOCAL && next->opcode == CASK_BC_POP)
+        {
+            fused.opcode = CASK_BC_STORE_LOCAL;
+            pattern = CASK_PEEPHOLE_TEE_POP;
+        }
+        else if (peephole_is_plain_push(instr->opcode) && next->opcode == CASK_BC_POP)
+        {
+            pattern = CASK_PEEPHOLE_PUSH_POP;
+        }
+        else if (instr->opcode == CASK_BC_LOAD_LOCAL && next->opcode == CASK_BC_LOAD_LOCAL)
+        {
+            fused.opcode = CASK_BC_LOAD_LOCAL_PAIR;
+            fused.argc = (uint8_t)next->operand;
+            pattern = CASK_PEEPHOLE_LOAD_PAIR;
+        }
+        else
+        {
+            length = 0U;
+        }
+    }
+
+    if (length == 0U && instr->opcode == CASK_BC_JUMP && instr->target == index + 1U)
+    {
+        length = 1U;
+        pattern = CASK_PEEPHOLE_JUMP_NEXT;
+    }
+
+    if (length == 0U)
+        return 0U;
+
+    // Rewrites to nothing leave a NOP here, which is never emitted.
+    if (fused.opcode != CASK_BC_NOP)
+        *ok = vector_append_Instr(out, NULL, fused);
+
+    stats->hits[pattern]++;
+
+    return length;
+}
+
+/**
+ * @brief Rewrites `in` into `out` once. Jumps into removed code land on whatever follows it.
+ * @return bool False on allocation failure.
+ */
+static bool peephole_round(InstrVector *in, InstrVector *out, PeepholeStats *stats)
+{
+    Instr *instrs = vector_items_Instr(in);
+    uint32_t count = in->count;
+    bool *targeted = calloc(count + 1U, sizeof(bool));
+    uint32_t *map = malloc((count + 1U) * sizeof(uint32_t));
+    bool ok = targeted != NULL && map != NULL;
+
+    if (ok)
+    {
+        peephole_thread_jumps(instrs, count, stats);
+
+        for (uint32_t index = 0; index < count; index++)
+        {
+            if (bytecode_is_jump(instrs[index].opcode))
+                targeted[instrs[index].target] = true;
+        }
+    }
+
+    for (uint32_t index = 0; ok && index < count;)
+    {
+        uint32_t position = out->count;
+        uint32_t length = peephole_match(instrs, count, targeted, index, out, stats, &ok);
+
+        if (length == 0U)
+        {
+            length = 1U;
+            ok = vector_append_Instr(out, NULL, instrs[index]);
+        }
+
+        for (uint32_t offset = 0; offset < length; offset++)
+            map[index + offset] = position;
+
+        index += length;
+    }
+
+    if (ok)
+    {
+        map[count] = out->count;
+
+        for (uint32_t index = 0; index < out->count; index++)
+        {
+            Instr *instr = vector_items_Instr(out) + index;
+
+            if (bytecode_is_jump(instr->opcode))
+                instr->target = map[instr->target];
+        }
+    }
+
+    free(targeted);
+    free(map);
+
+    return ok;
+}
+
+/**
+ * @brief Rewrites one function, keeping its code when nothing fired or the result cannot be encoded.
+ * @return bool False on allocation failure.
+ */
+static bool peephole_rewrite(CodeObject *function, PeepholeStats *stats)
+{
+    PeepholeStats function_stats;
+    InstrVector instrs;
+    InstrVector next;
+    ByteVector code;
+    bool changed = false;
+    bool ok = true;
+
+    peephole_stats_init(&function_stats);
+    vector_init_Instr(&instrs);
+    vector_init_Instr(&next);
+    vector_init_Byte(&code);
+
+    // Code that fails to decode is left alone.
+    if (!bytecode_decode(&function->code, &instrs))
+    {
+        vector_dispose_Instr(&instrs, NULL);
+        return true;
+    }
+
+    for (uint32_t round = 0; ok && round < CASK_PEEPHOLE_MAX_ROUNDS; round++)
+    {
+        PeepholeStats round_stats;
+        bool fired = false;
+
+        peephole_stats_init(&round_stats);
+        vector_clear_Instr(&next);
+        ok = peephole_round(&instrs, &next, &round_stats);
+
+        for (uint32_t pattern = 0; ok && pattern < CASK_PEEPHOLE_COUNT; pattern++)
+        {
+            function_stats.hits[pattern] += round_stats.hits[pattern];
+            fired = fired || round_stats.hits[pattern] > 0U;
+        }
+
+        if (!ok || !fired)
+            break;
+
+        InstrVector swap = instrs;
+        instrs = next;
+        next = swap;
+        changed = true;
+    }
+
+    if (ok && changed && bytecode_encode(&instrs, &code))
+    {
+        vector_dispose_Byte(&function->code, NULL);
+        function->code = code;
+
+        for (uint32_t pattern = 0; pattern < CASK_PEEPHOLE_COUNT; pattern++)
+            stats->hits[pattern] += function_stats.hits[pattern];
+    }
+    else
+    {
+        vector_dispose_Byte(&code, NULL);
+    }
+
+    vector_dispose_Instr(&instrs, NULL);
+    vector_dispose_Instr(&next, NULL);
+
+    return ok;
+}
+
+/* Pass impl. */
+
+bool peephole_apply(Module *module, PeepholeStats *stats)
+{
+    bool ok = true;
+
+    for (uint32_t index = 0; ok && index < module->functions.count; index++)
+        ok = peephole_rewrite(module_get_function(module, index), stats);
+
+    return ok;
+}
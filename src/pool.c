@@ -0,0 +1,252 @@
+/**
+ * @file pool.c
+ * @author Derek Tan
+ * @brief Implements the work-stealing thread pool.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "utils/pool.h"
+
+#define CASK_POOL_DEQUE_MIN_CAPACITY 16U
+
+/**
+ * @brief Start argument of a worker thread.
+ */
+typedef struct cask_pool_worker_t
+{
+    Pool *pool;
+    uint32_t index;
+} PoolWorker;
+
+/* Deques. */
+
+static bool pool_deque_push(PoolDeque *deque, uint32_t task)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity)
+    {
+        uint32_t capacity = (deque->capacity > 0U) ? deque->capacity * 2U : CASK_POOL_DEQUE_MIN_CAPACITY;
+        uint32_t *tasks = (capacity > deque->capacity) ? malloc(capacity * sizeof(uint32_t)) : NULL;
+
+        ok = tasks != NULL;
+
+        // Unwrap the ring so it starts at index 0 again.
+        for (uint32_t index = 0; ok && index < deque->count; index++)
+            tasks[index] = deque->tasks[(deque->head + index) % deque->capacity];
+
+        if (ok)
+        {
+            free(deque->tasks);
+            deque->tasks = tasks;
+            deque->capacity = capacity;
+            deque->head = 0U;
+        }
+    }
+
+    if (ok)
+        deque->tasks[(deque->head + deque->count++) % deque->capacity] = task;
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return ok;
+}
+
+/**
+ * @brief Takes a task from the back of a deque when `steal` is false, or from the front when true.
+ */
+static bool pool_deque_take(PoolDeque *deque, bool steal, uint32_t *task)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count > 0U)
+    {
+        found = true;
+        deque->count--;
+
+        if (steal)
+        {
+            *task = deque->tasks[deque->head];
+            deque->head = (deque->head + 1U) % deque->capacity;
+        }
+        else
+        {
+            *task = deque->tasks[(deque->head + deque->count) % deque->capacity];
+        }
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return found;
+}
+
+/* Workers. */
+
+static bool pool_take(Pool *pool, uint32_t worker, uint32_t *task)
+{
+    bool found = pool_deque_take(&pool->deques[worker], false, task);
+
+    // Victims are tried in a fixed rotation from the thief's own index, which spreads thieves across deques.
+    for (uint32_t offset = 1U; !found && offset < pool->worker_count; offset++)
+        found = pool_deque_take(&pool->deques[(worker + offset) % pool->worker_count], true, task);
+
+    if (found)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return found;
+}
+
+static void pool_finish_task(Pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    if (++pool->finished == pool->total)
+        pthread_cond_broadcast(&pool->wake);
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_work(Pool *pool, uint32_t worker)
+{
+    for (;;)
+    {
+        uint32_t task = 0U;
+
+        if (pool_take(pool, worker, &task))
+        {
+            pool->run(pool, worker, task, pool->context);
+            pool_finish_task(pool);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+
+        while (pool->queued == 0U && pool->finished < pool->total)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+
+        bool done = pool->finished >= pool->total;
+
+        pthread_mutex_unlock(&pool->lock);
+
+        if (done)
+            return;
+    }
+}
+
+static void *pool_worker_main(void *arg)
+{
+    PoolWorker *worker = arg;
+
+    pool_work(worker->pool, worker->index);
+
+    return NULL;
+}
+
+/* Pool impl. */
+
+uint32_t pool_core_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (count > 0L && count <= (long)UINT16_MAX) ? (uint32_t)count : 1U;
+}
+
+void pool_submit(Pool *pool, uint32_t worker, uint32_t task)
+{
+    // Counted before it is published, so a thief taking it at once cannot bring `queued` below zero.
+    pthread_mutex_lock(&pool->lock);
+    pool->queued++;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!pool_deque_push(&pool->deques[worker], task))
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->run(pool, worker, task, pool->context);
+        pool_finish_task(pool);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+bool pool_run(uint32_t worker_count, uint32_t total, const uint32_t *initial, uint32_t initial_count, PoolTaskFn run, void *context)
+{
+    Pool pool = {.run = run, .context = context, .worker_count = (worker_count > 0U) ? worker_count : 1U, .queued = 0U, .finished = 0U, .total = total};
+    pthread_t *threads = NULL;
+    PoolWorker *workers = NULL;
+    uint32_t started = 0U;
+    uint32_t ready_deques = 0U;
+    bool ok = true;
+
+    if (total == 0U)
+        return true;
+
+    pool.deques = calloc(pool.worker_count, sizeof(PoolDeque));
+    threads = malloc(pool.worker_count * sizeof(pthread_t));
+    workers = malloc(pool.worker_count * sizeof(PoolWorker));
+    ok = pool.deques != NULL && threads != NULL && workers != NULL;
+
+    for (; ok && ready_deques < pool.worker_count; ready_deques++)
+        pthread_mutex_init(&pool.deques[ready_deques].lock, NULL);
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+
+    for (uint32_t index = 0; ok && index < initial_count; index++)
+    {
+        ok = pool_deque_push(&pool.deques[index % pool.worker_count], initial[index]);
+        pool.queued += ok ? 1U : 0U;
+    }
+
+    if (ok)
+    {
+        // The calling thread is worker 0.
+        for (uint32_t index = 1U; index < pool.worker_count; index++)
+        {
+            workers[index] = (PoolWorker){.pool = &pool, .index = index};
+
+            if (pthread_create(&threads[started + 1U], NULL, pool_worker_main, &workers[index]) == 0)
+                started++;
+        }
+
+        pool_work(&pool, 0U);
+
+        for (uint32_t index = 1U; index <= started; index++)
+            pthread_join(threads[index], NULL);
+    }
+
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.wake);
+
+    for (uint32_t index = 0; index < ready_deques; index++)
+    {
+        pthread_mutex_destroy(&pool.deques[index].lock);
+        free(pool.deques[index].tasks);
+    }
+
+    free(pool.deques);
+    free(threads);
+    free(workers);
+
+    return ok;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file purity.c
+ * @author Derek Tan
+ * @brief Implements the function purity analysis.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include "backend/purity.h"
+
+/* Body scanning. */
+
+static bool purity_expr(const Compiler *compiler, const Expression *expr);
+
+static bool purity_expr_list(const Compiler *compiler, const ExpressionVector *items)
+{
+    for (uint32_t index = 0; index < items->count; index++)
+    {
+        if (!purity_expr(compiler, vector_at_Expression(items, index)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool purity_expr(const Compiler *compiler, const Expression *expr)
+{
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_ARRAY:
+        return purity_expr_list(compiler, &expr->contents.array.values);
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        return purity_expr_list(compiler, &expr->contents.aggregate.literals);
+    case CASK_EXPR_IDENTIFIER:
+        return compiler->bindings[expr->contents.identifier.name].kind != CASK_BIND_GLOBAL;
+    case CASK_EXPR_CALL:
+        return purity_call_is_pure(compiler, expr) && purity_expr_list(compiler, &expr->contents.call.args);
+    case CASK_EXPR_ACCESS:
+        // A field key is a name, not a variable read.
+        return purity_expr(compiler, expr->contents.access.target)
+            && (expr->contents.access.has_aggr || purity_expr(compiler, expr->contents.access.key));
+    case CASK_EXPR_TERM:
+    case CASK_EXPR_FACTOR:
+    case CASK_EXPR_COMPARISON:
+    case CASK_EXPR_EQUALITY:
+    case CASK_EXPR_CONDITIONAL:
+        return purity_expr(compiler, expr->contents.term.left) && purity_expr(compiler, expr->contents.term.right);
+    default:
+        return true;
+    }
+}
+
+static bool purity_stmt(const Compiler *compiler, const Statement *stmt);
+
+static bool purity_block(const Compiler *compiler, const Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+
+    for (uint32_t index = 0; index < stmts->count; index++)
+    {
+        if (!purity_stmt(compiler, vector_at_Statement(stmts, index)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool purity_stmt(const Compiler *compiler, const Statement *stmt)
+{
+    const Statement *other = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        return purity_expr(compiler, stmt->contents.prim_decl.value);
+    case CASK_STMT_WHILE:
+        return purity_expr(compiler, stmt->contents.while_ctrl.condition) && purity_block(compiler, stmt->contents.while_ctrl.block);
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        return purity_expr(compiler, stmt->contents.if_ctrl.condition) && purity_block(compiler, stmt->contents.if_ctrl.block)
+            && (!other || purity_block(compiler, other->contents.else_ctrl.block));
+    case CASK_STMT_BLOCK:
+        return purity_block(compiler, stmt);
+    case CASK_STMT_RETURN:
+        return !stmt->contents.return_stmt.value || purity_expr(compiler, stmt->contents.return_stmt.value);
+    case CASK_STMT_REASSIGN:
+        // Stores through a target only reach objects made by this call, so only the names matter.
+        return purity_expr(compiler, stmt->contents.reassign.target) && purity_expr(compiler, stmt->contents.reassign.value);
+    case CASK_STMT_EXPR:
+        return purity_expr(compiler, stmt->contents.expr_stmt.expr);
+    default:
+        return true;
+    }
+}
+
+static bool purity_params_are_single(const Statement *decl)
+{
+    const StatementVector *params = &decl->contents.func_decl.params;
+
+    for (uint32_t index = 0; index < params->count; index++)
+    {
+        const Statement *param = vector_at_Statement(params, index);
+
+        if ((param->contents.param_decl.type_mask >> 8) != CASK_COMPTYPE_SINGLE)
+            return false;
+    }
+
+    return true;
+}
+
+/* Analysis impl. */
+
+bool purity_analyze(Compiler *compiler)
+{
+    uint32_t count = compiler->functions.count;
+    bool changed = true;
+
+    free(compiler->pure_functions);
+    compiler->pure_functions = malloc(count * sizeof(bool));
+
+    if (!compiler->pure_functions)
+    {
+        compiler->error = CASK_COMPILE_ERR_GENERAL;
+        return false;
+    }
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const Statement *decl = vector_at_Statement(&compiler->functions, index);
+
+        compiler->pure_functions[index] = decl != NULL && purity_params_are_single(decl);
+    }
+
+    // Purity only ever gets revoked, so this settles within one round per function.
+    while (changed)
+    {
+        changed = false;
+
+        for (uint32_t index = 0; index < count; index++)
+        {
+            const Statement *decl = vector_at_Statement(&compiler->functions, index);
+
+            if (compiler->pure_functions[index] && !purity_block(compiler, decl->contents.func_decl.block))
+            {
+                compiler->pure_functions[index] = false;
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool purity_call_is_pure(const Compiler *compiler, const Expression *call)
+{
+    Binding binding = compiler->bindings[call->contents.call.name];
+
+    if (binding.kind == CASK_BIND_FUNCTION)
+        return compiler->pure_functions[binding.index];
+
+    return binding.kind == CASK_BIND_NATIVE && bytecode_natives[binding.index].pure;
+}
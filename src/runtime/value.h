@@ -0,0 +1,212 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Heap objects */
+
+typedef enum cask_object_type_e
+{
+    CASK_OBJ_STRING,
+    CASK_OBJ_ARRAY,
+    CASK_OBJ_AGGREGATE
+} ObjectType;
+
+/**
+ * @brief Header of every heap object. Objects are chained through `next` into the list of their owner, which frees them all at once.
+ */
+typedef struct cask_object_t
+{
+    struct cask_object_t *next;
+    ObjectType type;
+} Object;
+
+/* Values */
+
+/**
+ * @brief A runtime value NaN-boxed into one 64-bit word. Floats are stored widened to doubles, and every other kind hides in the payload of a quiet NaN:
+ * - nil, false and true are `CASK_VALUE_QNAN` plus 1, 2 and 3.
+ * - Integers are `CASK_VALUE_QNAN | CASK_VALUE_TAG_INT` plus the 32 bits of the integer.
+ * - Object pointers are `CASK_VALUE_SIGN | CASK_VALUE_QNAN` plus the 48-bit address.
+ * @note Only use the `value_*` helpers on it, since the encoding is an implementation detail.
+ */
+typedef uint64_t Value;
+
+#define CASK_VALUE_SIGN 0x8000000000000000ULL
+#define CASK_VALUE_QNAN 0x7ffc000000000000ULL
+#define CASK_VALUE_TAG_INT 0x0001000000000000ULL
+#define CASK_VALUE_TAG_MASK 0x0003000000000000ULL
+#define CASK_VALUE_NIL (CASK_VALUE_QNAN | 1ULL)
+#define CASK_VALUE_FALSE (CASK_VALUE_QNAN | 2ULL)
+#define CASK_VALUE_TRUE (CASK_VALUE_QNAN | 3ULL)
+
+/// @brief The NaN every float NaN is folded into, so that payload bits never alias a boxed value.
+#define CASK_VALUE_FLOAT_NAN 0x7ff8000000000000ULL
+
+_Static_assert(sizeof(void *) <= sizeof(Value), "object pointers must fit a boxed value");
+
+static inline Value value_nil(void)
+{
+    return CASK_VALUE_NIL;
+}
+
+static inline Value value_bool(bool flag)
+{
+    return flag ? CASK_VALUE_TRUE : CASK_VALUE_FALSE;
+}
+
+static inline Value value_int(int32_t integer)
+{
+    return CASK_VALUE_QNAN | CASK_VALUE_TAG_INT | (uint32_t)integer;
+}
+
+static inline Value value_float(float realnum)
+{
+    double widened = realnum;
+    Value bits = CASK_VALUE_FLOAT_NAN;
+
+    if (realnum == realnum)
+        memcpy(&bits, &widened, sizeof(Value));
+
+    return bits;
+}
+
+static inline Value value_object(Object *object)
+{
+    return CASK_VALUE_SIGN | CASK_VALUE_QNAN | (uint64_t)(uintptr_t)object;
+}
+
+static inline bool value_is_nil(Value value)
+{
+    return value == CASK_VALUE_NIL;
+}
+
+static inline bool value_is_bool(Value value)
+{
+    return (value | 1ULL) == CASK_VALUE_TRUE;
+}
+
+static inline bool value_is_int(Value value)
+{
+    return (value & (CASK_VALUE_SIGN | CASK_VALUE_QNAN | CASK_VALUE_TAG_MASK)) == (CASK_VALUE_QNAN | CASK_VALUE_TAG_INT);
+}
+
+static inline bool value_is_float(Value value)
+{
+    return (value & CASK_VALUE_QNAN) != CASK_VALUE_QNAN;
+}
+
+static inline bool value_is_object(Value value)
+{
+    return (value & (CASK_VALUE_SIGN | CASK_VALUE_QNAN)) == (CASK_VALUE_SIGN | CASK_VALUE_QNAN);
+}
+
+static inline bool value_both_int(Value left, Value right)
+{
+    return value_is_int(left) && value_is_int(right);
+}
+
+static inline bool value_both_float(Value left, Value right)
+{
+    return value_is_float(left) && value_is_float(right);
+}
+
+static inline bool value_as_bool(Value value)
+{
+    return value == CASK_VALUE_TRUE;
+}
+
+static inline int32_t value_as_int(Value value)
+{
+    return (int32_t)(uint32_t)value;
+}
+
+/// @note Float results are computed in single precision and widened back, so the double storage never changes program results.
+static inline float value_as_float(Value value)
+{
+    double widened = 0.0;
+
+    memcpy(&widened, &value, sizeof(Value));
+
+    return (float)widened;
+}
+
+static inline Object *value_as_object(Value value)
+{
+    return (Object *)(uintptr_t)(value & ~(CASK_VALUE_SIGN | CASK_VALUE_QNAN));
+}
+
+/// @brief Only `nil` and `false` are falsy.
+static inline bool value_is_falsy(Value value)
+{
+    return value == CASK_VALUE_NIL || value == CASK_VALUE_FALSE;
+}
+
+static inline bool value_is_object_type(Value value, ObjectType type)
+{
+    return value_is_object(value) && value_as_object(value)->type == type;
+}
+
+/* Object kinds */
+
+typedef struct cask_string_object_t
+{
+    Object base;
+    uint32_t length;
+    char chars[];
+} StringObject;
+
+/**
+ * @brief A fixed size sequence of values. Arrays and aggregate instances share this layout, told apart by `base.type`.
+ */
+typedef struct cask_array_object_t
+{
+    Object base;
+    uint32_t count;
+    Value items[];
+} ArrayObject;
+
+static inline StringObject *value_as_string(Value value)
+{
+    return (StringObject *)value_as_object(value);
+}
+
+static inline ArrayObject *value_as_array(Value value)
+{
+    return (ArrayObject *)value_as_object(value);
+}
+
+/**
+ * @brief Allocates a string object holding a copy of the text and links it into `owner`.
+ * @return StringObject* NULL on allocation failure.
+ */
+StringObject *object_new_string(Object **owner, const char *text, uint32_t length);
+
+/**
+ * @brief Allocates a string holding two texts back to back, as for `+` on strings.
+ * @return StringObject* NULL on allocation failure.
+ */
+StringObject *object_concat_strings(Object **owner, const StringObject *left, const StringObject *right);
+
+/**
+ * @brief Allocates an array or aggregate object of `count` items and links it into `owner`. The items are left for the caller to fill.
+ * @return ArrayObject* NULL on allocation failure.
+ */
+ArrayObject *object_new_array(Object **owner, ObjectType type, uint32_t count);
+
+/**
+ * @brief Frees every object linked into `owner`.
+ */
+void object_free_all(Object **owner);
+
+/**
+ * @brief Compares two values the way `==` does: strings by content, other objects by identity.
+ */
+bool value_equals(Value left, Value right);
+
+void value_print(Value value, FILE *out);
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "backend/bytecode.h"
+#include "runtime/value.h"
+
+/* VM config */
+
+/// @note Build with `-DCASK_VM_SWITCH_DISPATCH` (`make SWITCH_DISPATCH=1`) to use a plain `switch` loop instead of computed gotos.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(CASK_VM_SWITCH_DISPATCH)
+    #define CASK_VM_THREADED_DISPATCH
+#endif
+
+#define CASK_VM_STACK_SLOTS 65536U
+#define CASK_VM_FRAME_LIMIT 4096U
+
+/* VM type decls. */
+
+typedef enum cask_vm_error_code_e
+{
+    CASK_VM_ERR_NONE,
+    CASK_VM_ERR_TYPE,
+    CASK_VM_ERR_DIVIDE,
+    CASK_VM_ERR_BOUNDS,
+    CASK_VM_ERR_OVERFLOW,
+    CASK_VM_ERR_CALL,
+    CASK_VM_ERR_MEMORY,
+    CASK_VM_ERR_NATIVE,
+    CASK_VM_ERR_BAD_OPCODE,
+    CASK_VM_ERR_BUDGET
+} VMErrorCode;
+
+/**
+ * @brief An active call. `slots` points at its first parameter on the value stack, and `ip` is the resume point saved while it calls another function.
+ */
+typedef struct cask_call_frame_t
+{
+    const CodeObject *function;
+    const uint8_t *ip;
+    Value *slots;
+} CallFrame;
+
+/**
+ * @brief Stack interpreter for a compiled Module. The value and frame stacks are allocated once by `vm_init`, so calls never allocate.
+ * @note Heap objects live until `vm_dispose`.
+ */
+typedef struct cask_vm_t
+{
+    const Module *module;
+    Value *stack;
+    Value *stack_end;
+    CallFrame *frames;
+    uint32_t frame_count;
+    Value *globals;
+    Value *constants;
+    Object *objects;
+    uint64_t budget;                // calls and backward jumps left before `CASK_VM_ERR_BUDGET`
+    VMErrorCode error;
+    uint32_t error_function;
+    uint32_t error_offset;
+} VM;
+
+/**
+ * @brief Prepares a VM for a module, loading its constants as values. The step budget starts out unlimited.
+ *
+ * @param vm
+ * @param module Must outlive the VM.
+ * @return bool False on allocation failure.
+ */
+bool vm_init(VM *vm, const Module *module);
+
+/**
+ * @brief Runs a function taking no arguments to completion.
+ *
+ * @param vm
+ * @param function Function index in the module.
+ * @param result_out Receives the returned value.
+ * @return VMErrorCode `CASK_VM_ERR_NONE` on success. Otherwise `error_function` and `error_offset` locate the failing instruction.
+ */
+VMErrorCode vm_run(VM *vm, uint32_t function, Value *result_out);
+
+/**
+ * @brief Runs a function on the given arguments to completion, like `vm_run`.
+ * @note Set `budget` first to bound the run, as the compiler does when evaluating calls ahead of time. Every call and loop iteration spends one step.
+ *
+ * @param vm
+ * @param function Function index in the module.
+ * @param args `argc` values, which must match the function's arity.
+ * @param argc
+ * @param result_out Receives the returned value.
+ * @return VMErrorCode
+ */
+VMErrorCode vm_call(VM *vm, uint32_t function, const Value *args, uint32_t argc, Value *result_out);
+
+void vm_dispose(VM *vm);
+
+#endif
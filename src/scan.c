@@ -0,0 +1,190 @@
+/**
+ * @file scan.c
+ * @author Derek Tan
+ * @brief Implements wide byte scanning kernels for the lexer's spacing, comment and string runs.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdatomic.h>
+#include "utils/scan.h"
+
+/// @note Define `CASK_SCAN_SCALAR_ONLY` at build time to force the portable kernels.
+#if !defined(CASK_SCAN_SCALAR_ONLY) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define CASK_SCAN_HAS_X86 1
+#include <immintrin.h>
+#else
+#define CASK_SCAN_HAS_X86 0
+#endif
+
+/* Scalar kernels. */
+
+static inline int scan_is_spacing(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static uint32_t scan_find_byte_scalar(const char *source, uint32_t index, uint32_t length, char needle)
+{
+    while (index < length && source[index] != needle)
+        index++;
+
+    return index;
+}
+
+static uint32_t scan_skip_spacing_scalar(const char *source, uint32_t index, uint32_t length)
+{
+    while (index < length && scan_is_spacing(source[index]))
+        index++;
+
+    return index;
+}
+
+#if CASK_SCAN_HAS_X86
+
+/* SSE2 kernels: 16 bytes per step. */
+
+static inline __m128i scan_spacing_mask_sse2(__m128i chunk)
+{
+    __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+    __m128i breaks = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+
+    return _mm_or_si128(spaces, breaks);
+}
+
+static uint32_t scan_find_byte_sse2(const char *source, uint32_t index, uint32_t length, char needle)
+{
+    const __m128i pattern = _mm_set1_epi8(needle);
+
+    while (length - index >= 16U)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(source + index));
+        unsigned int hits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern));
+
+        if (hits != 0U)
+            return index + (uint32_t)__builtin_ctz(hits);
+
+        index += 16U;
+    }
+
+    return scan_find_byte_scalar(source, index, length, needle);
+}
+
+static uint32_t scan_skip_spacing_sse2(const char *source, uint32_t index, uint32_t length)
+{
+    while (length - index >= 16U)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(source + index));
+        unsigned int misses = ~(unsigned int)_mm_movemask_epi8(scan_spacing_mask_sse2(chunk)) & 0xffffU;
+
+        if (misses != 0U)
+            return index + (uint32_t)__builtin_ctz(misses);
+
+        index += 16U;
+    }
+
+    return scan_skip_spacing_scalar(source, index, length);
+}
+
+/* AVX2 kernels: 32 bytes per step, compiled for AVX2 only within these functions. */
+
+__attribute__((target("avx2")))
+static uint32_t scan_find_byte_avx2(const char *source, uint32_t index, uint32_t length, char needle)
+{
+    const __m256i pattern = _mm256_set1_epi8(needle);
+
+    while (length - index >= 32U)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(source + index));
+        unsigned int hits = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern));
+
+        if (hits != 0U)
+            return index + (uint32_t)__builtin_ctz(hits);
+
+        index += 32U;
+    }
+
+    return scan_find_byte_sse2(source, index, length, needle);
+}
+
+__attribute__((target("avx2")))
+static uint32_t scan_skip_spacing_avx2(const char *source, uint32_t index, uint32_t length)
+{
+    while (length - index >= 32U)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(source + index));
+        __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+        __m256i breaks = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+        unsigned int misses = ~(unsigned int)_mm256_movemask_epi8(_mm256_or_si256(spaces, breaks));
+
+        if (misses != 0U)
+            return index + (uint32_t)__builtin_ctz(misses);
+
+        index += 32U;
+    }
+
+    return scan_skip_spacing_sse2(source, index, length);
+}
+
+#endif
+
+/* Kernel selection. */
+
+/// @note -1 means unresolved. Every thread that races to resolve stores the same answer.
+static atomic_int scan_kernel = -1;
+
+static ScanKernel scan_resolve_kernel(void)
+{
+    int kernel = atomic_load_explicit(&scan_kernel, memory_order_relaxed);
+
+    if (kernel >= 0)
+        return (ScanKernel)kernel;
+
+#if CASK_SCAN_HAS_X86
+    __builtin_cpu_init();
+    kernel = __builtin_cpu_supports("avx2") ? CASK_SCAN_AVX2 : CASK_SCAN_SSE2;
+#else
+    kernel = CASK_SCAN_SCALAR;
+#endif
+
+    atomic_store_explicit(&scan_kernel, kernel, memory_order_relaxed);
+
+    return (ScanKernel)kernel;
+}
+
+uint32_t scan_find_byte(const char *source, uint32_t index, uint32_t length, char needle)
+{
+    switch (scan_resolve_kernel())
+    {
+#if CASK_SCAN_HAS_X86
+    case CASK_SCAN_AVX2:
+        return scan_find_byte_avx2(source, index, length, needle);
+    case CASK_SCAN_SSE2:
+        return scan_find_byte_sse2(source, index, length, needle);
+#endif
+    default:
+        return scan_find_byte_scalar(source, index, length, needle);
+    }
+}
+
+uint32_t scan_skip_spacing(const char *source, uint32_t index, uint32_t length)
+{
+    switch (scan_resolve_kernel())
+    {
+#if CASK_SCAN_HAS_X86
+    case CASK_SCAN_AVX2:
+        return scan_skip_spacing_avx2(source, index, length);
+    case CASK_SCAN_SSE2:
+        return scan_skip_spacing_sse2(source, index, length);
+#endif
+    default:
+        return scan_skip_spacing_scalar(source, index, length);
+    }
+}
+
+ScanKernel scan_active_kernel(void)
+{
+    return scan_resolve_kernel();
+}
@@ -0,0 +1,167 @@
+/**
+ * @file symbols.c
+ * @author Derek Tan
+ * @brief Implements the name interning table.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/symbols.h"
+
+/// @note FNV-1a: cheap and good enough for short identifiers.
+static uint32_t symbol_hash(const char *begin, uint32_t length)
+{
+    uint32_t hash = 2166136261U;
+
+    for (uint32_t index = 0; index < length; index++)
+    {
+        hash ^= (unsigned char)begin[index];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static bool symbol_entry_matches(const SymbolEntry *entry, const char *begin, uint32_t length, uint32_t hash)
+{
+    return entry->hash == hash && entry->length == length && memcmp(entry->begin, begin, length) == 0;
+}
+
+static bool symbol_table_rehash(SymbolTable *table, uint32_t new_slot_capacity)
+{
+    uint32_t *new_slots = calloc(new_slot_capacity, sizeof(uint32_t));
+
+    if (!new_slots)
+        return false;
+
+    uint32_t mask = new_slot_capacity - 1U;
+
+    for (SymbolID id = 1; id <= table->entry_count; id++)
+    {
+        uint32_t probe = table->entries[id].hash & mask;
+
+        while (new_slots[probe] != CASK_SYMBOL_NONE)
+            probe = (probe + 1U) & mask;
+
+        new_slots[probe] = id;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->slot_capacity = new_slot_capacity;
+
+    return true;
+}
+
+bool symbol_table_init(SymbolTable *table)
+{
+    table->entries = malloc(CASK_SYMBOLS_INIT_CAPACITY * sizeof(SymbolEntry));
+    table->slots = calloc(2U * CASK_SYMBOLS_INIT_CAPACITY, sizeof(uint32_t));
+    table->entry_count = 0;
+    table->entry_capacity = CASK_SYMBOLS_INIT_CAPACITY;
+    table->slot_capacity = 2U * CASK_SYMBOLS_INIT_CAPACITY;
+
+    if (!table->entries || !table->slots)
+    {
+        symbol_table_dispose(table);
+        return false;
+    }
+
+    return true;
+}
+
+SymbolID symbol_table_intern(SymbolTable *table, const char *begin, uint32_t length)
+{
+    if (!table->slots)
+        return CASK_SYMBOL_NONE;
+
+    uint32_t hash = symbol_hash(begin, length);
+    uint32_t mask = table->slot_capacity - 1U;
+    uint32_t probe = hash & mask;
+
+    while (table->slots[probe] != CASK_SYMBOL_NONE)
+    {
+        SymbolID candidate = table->slots[probe];
+
+        if (symbol_entry_matches(&table->entries[candidate], begin, length, hash))
+            return candidate;
+
+        probe = (probe + 1U) & mask;
+    }
+
+    // Entry 0 is the reserved "none" slot, so the next ID is entry_count + 1.
+    if (table->entry_count + 1U >= table->entry_capacity)
+    {
+        SymbolEntry *new_entries = realloc(table->entries, 2U * table->entry_capacity * sizeof(SymbolEntry));
+
+        if (!new_entries)
+            return CASK_SYMBOL_NONE;
+
+        table->entries = new_entries;
+        table->entry_capacity *= 2U;
+    }
+
+    SymbolID id = ++table->entry_count;
+    table->entries[id] = (SymbolEntry){.begin = begin, .length = length, .hash = hash};
+    table->slots[probe] = id;
+
+    /// @note Keep the load factor at or below one half so probe runs stay short.
+    if (2U * table->entry_count > table->slot_capacity && !symbol_table_rehash(table, 2U * table->slot_capacity))
+    {
+        table->slots[probe] = CASK_SYMBOL_NONE;
+        table->entry_count--;
+        return CASK_SYMBOL_NONE;
+    }
+
+    return id;
+}
+
+SymbolID symbol_table_find(const SymbolTable *table, const char *begin, uint32_t length)
+{
+    if (!table->slots)
+        return CASK_SYMBOL_NONE;
+
+    uint32_t hash = symbol_hash(begin, length);
+    uint32_t mask = table->slot_capacity - 1U;
+    uint32_t probe = hash & mask;
+
+    while (table->slots[probe] != CASK_SYMBOL_NONE)
+    {
+        SymbolID candidate = table->slots[probe];
+
+        if (symbol_entry_matches(&table->entries[candidate], begin, length, hash))
+            return candidate;
+
+        probe = (probe + 1U) & mask;
+    }
+
+    return CASK_SYMBOL_NONE;
+}
+
+const char *symbol_table_view(const SymbolTable *table, SymbolID id, uint32_t *length_out)
+{
+    if (id == CASK_SYMBOL_NONE || id > table->entry_count)
+    {
+        *length_out = 0;
+        return NULL;
+    }
+
+    *length_out = table->entries[id].length;
+
+    return table->entries[id].begin;
+}
+
+void symbol_table_dispose(SymbolTable *table)
+{
+    free(table->entries);
+    free(table->slots);
+    table->entries = NULL;
+    table->slots = NULL;
+    table->entry_count = 0;
+    table->entry_capacity = 0;
+    table->slot_capacity = 0;
+}
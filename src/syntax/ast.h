@@ -5,6 +5,8 @@
 #include <stdint.h>
 
 #include "collection/vectors.h"
+#include "utils/files.h"
+#include "utils/symbols.h"
 
 /* AST type codes */
 
@@ -14,6 +16,7 @@ typedef enum cask_datatype_e
     CASK_DATATYPE_INTEGER,
     CASK_DATATYPE_FLOAT,
     CASK_DATATYPE_STRING,
+    CASK_DATATYPE_BOOLEAN,
     CASK_DATATYPE_UNKNOWN
 } DataType;
 
@@ -25,6 +28,29 @@ typedef enum cask_comptype_e
     CASK_COMPTYPE_UNKNOWN
 } CompositeType;
 
+/// @brief Packs a declared type as `CompositeType : uint8_t, DataType : uint8_t`. Aggregate typed declarations also carry the aggregate's name in a `type_name` field.
+#define CASK_TYPE_MASK(high_type, low_type) ((uint16_t)(((high_type) << 8) + (low_type)))
+
+typedef enum cask_operator_e
+{
+    CASK_OP_NONE,
+    CASK_OP_ADD,
+    CASK_OP_SUB,
+    CASK_OP_MUL,
+    CASK_OP_DIV,
+    CASK_OP_LT,
+    CASK_OP_LTE,
+    CASK_OP_GT,
+    CASK_OP_GTE,
+    CASK_OP_EQ,
+    CASK_OP_NEQ,
+    CASK_OP_AND,
+    CASK_OP_OR,
+    // Only made by the folding pass from int factors by a power of two. The right operand is the shift count literal.
+    CASK_OP_SHL,
+    CASK_OP_SHR
+} OperatorType;
+
 typedef enum cask_expr_type_e
 {
     CASK_EXPR_LITERAL_SPECIAL,  // nil, true, false 
@@ -34,12 +60,14 @@ typedef enum cask_expr_type_e
     CASK_EXPR_LITERAL_ARRAY,
     CASK_EXPR_LITERAL_AGGREGATE,
     CASK_EXPR_IDENTIFIER,
+    CASK_EXPR_CALL,
     CASK_EXPR_ACCESS,
     CASK_EXPR_TERM,
     CASK_EXPR_FACTOR,
     CASK_EXPR_COMPARISON,
     CASK_EXPR_EQUALITY,
-    CASK_EXPR_CONDITIONAL
+    CASK_EXPR_CONDITIONAL,
+    CASK_EXPR_TEMP              // reload of a value saved by the CSE pass
 } ExpressionType;
 
 typedef enum cask_stmt_type_e
@@ -53,12 +81,22 @@ typedef enum cask_stmt_type_e
     CASK_STMT_WHILE,
     CASK_STMT_IF,
     CASK_STMT_ELSE,
-    CASK_STMT_BLOCK
+    CASK_STMT_BLOCK,
+    CASK_STMT_RETURN,
+    CASK_STMT_REASSIGN,
+    CASK_STMT_EXPR
 } StatementType;
 
 /* AST structures */
 
-typedef struct cask_expr_t
+typedef struct cask_expr_t Expression;
+typedef struct cask_stmt_t Statement;
+
+/// @brief Child lists of AST nodes hold node pointers, backed by the owning ProgramUnit's arena.
+CASK_VECTOR_DECL(Expression, Expression *)
+CASK_VECTOR_DECL(Statement, Statement *)
+
+struct cask_expr_t
 {
     union
     {
@@ -80,70 +118,89 @@ typedef struct cask_expr_t
         
         struct
         {
-            char *value;
+            SymbolID value;
         } string;
         
         struct
         {
-            Vector values;
+            ExpressionVector values;
         } array;
         
         struct
         {
-            Vector literals;
+            ExpressionVector literals;
         } aggregate;
 
         struct
         {
-            char *name;
+            SymbolID name;
         } identifier;
 
+        struct
+        {
+            ExpressionVector args;
+            SymbolID name;
+        } call;
+
         struct
         {
             struct cask_expr_t *target;
             struct cask_expr_t *key;
             bool has_aggr;
+            bool in_bounds;     // set by the loops pass when the key is proven a valid index of the array
         } access;
 
         struct
         {
             struct cask_expr_t *left;
             struct cask_expr_t *right;
-            char op;
+            OperatorType op;
         } term;
 
         struct
         {
             struct cask_expr_t *left;
             struct cask_expr_t *right;
-            char op;
+            OperatorType op;
         } factor;
 
         struct
         {
             struct cask_expr_t *left;
             struct cask_expr_t *right;
-            char op;
+            OperatorType op;
         } comparison;
 
         struct
         {
             struct cask_expr_t *left;
             struct cask_expr_t *right;
-            char op;
+            OperatorType op;
         } equality;
 
         struct
         {
             struct cask_expr_t *left;
             struct cask_expr_t *right;
-            char op;
+            OperatorType op;
         } conditional;
+
+        struct
+        {
+            uint8_t index;
+        } temp;
     } contents;
 
     ExpressionType type;
     bool is_lvalue;
-} Expression;
+
+    // Set by the CSE pass: the value is also saved into temp `temp_def - 1` for later `CASK_EXPR_TEMP` nodes. 0 if none.
+    uint8_t temp_def;
+
+    // Static type set by the type checker, packed like `prim_decl.type_mask`. Unknown until checked.
+    uint16_t type_mask;
+    SymbolID type_name;
+};
 
 void expression_init_special_ltrl(Expression *expr, bool is_nil, bool bool_flag);
 
@@ -155,66 +212,88 @@ void expression_init_array_ltrl(Expression *expr);
 
 void expression_init_aggr_ltrl(Expression *expr);
 
-void expression_init_identifier_ltrl(Expression *expr, char *name);
+void expression_init_string_ltrl(Expression *expr, SymbolID value);
+
+void expression_init_identifier_ltrl(Expression *expr, SymbolID name);
+
+void expression_init_call(Expression *expr, SymbolID name);
 
 void expression_init_access(Expression *expr, Expression *target, Expression *key, bool has_aggr);
 
-void expression_init_term(Expression *expr, Expression *left, Expression *right, char op);
+void expression_init_term(Expression *expr, Expression *left, Expression *right, OperatorType op);
+
+void expression_init_factor(Expression *expr, Expression *left, Expression *right, OperatorType op);
 
-void expression_init_factor(Expression *expr, Expression *left, Expression *right, char op);
+void expression_init_comparison(Expression *expr, Expression *left, Expression *right, OperatorType op);
 
-void expression_init_comparison(Expression *expr, Expression *left, Expression *right, char op);
+void expression_init_equality(Expression *expr, Expression *left, Expression *right, OperatorType op);
 
-void expression_init_equality(Expression *expr, Expression *left, Expression *right, char op);
+void expression_init_conditional(Expression *expr, Expression *left, Expression *right, OperatorType op);
 
-void expression_init_conditional(Expression *expr, Expression *left, Expression *right, char op);
+void expression_init_temp(Expression *expr, uint8_t index);
 
-bool expression_append_child(Expression *expr, ExpressionType type, Expression *child);
+/**
+ * @brief Initializes any binary node kind (term, factor, comparison, equality or conditional). They all share one layout.
+ * 
+ * @param expr 
+ * @param type 
+ * @param left 
+ * @param right 
+ * @param op 
+ */
+void expression_init_binary(Expression *expr, ExpressionType type, Expression *left, Expression *right, OperatorType op);
 
-void expression_dispose(Expression *expr);
+bool expression_append_child(Expression *expr, Arena *arena, ExpressionType type, Expression *child);
 
-typedef struct cask_stmt_t
+struct cask_stmt_t
 {
     union
     {
         struct
         {
-            Vector items;
-            char *name;
+            ExpressionVector items;
+            SymbolID name;
         } import;
 
         struct
         {
-            char *name;
+            SymbolID name;
             Expression *value;
 
             // `CompositeType : uint8_t, DataType : uint8_t`
             uint16_t type_mask;
+            SymbolID type_name;
         } prim_decl;
 
         struct
         {
-            char *name;
+            SymbolID name;
             uint16_t type_mask;
+            SymbolID type_name;
         } field_decl;
 
         struct
         {
-            Vector members;
-            char *name;
+            StatementVector members;
+            SymbolID name;
         } aggr_decl;
 
         struct
         {
-            Vector params;
-            char *name;
+            StatementVector params;
+            SymbolID name;
             struct cask_stmt_t *block;
+
+            // Return type, packed like `prim_decl.type_mask`.
+            uint16_t type_mask;
+            SymbolID type_name;
         } func_decl;
         
         struct
         {
-            char *name;
+            SymbolID name;
             uint16_t type_mask;
+            SymbolID type_name;
         } param_decl;
 
         struct
@@ -227,6 +306,7 @@ typedef struct cask_stmt_t
         {
             Expression *condition;
             struct cask_stmt_t *block;
+            struct cask_stmt_t *other;  // else statement or NULL
         } if_ctrl;
 
         struct
@@ -236,53 +316,114 @@ typedef struct cask_stmt_t
 
         struct
         {
-            Vector stmts;
+            StatementVector stmts;
         } block;
+
+        struct
+        {
+            Expression *value;  // NULL for a bare `return`
+        } return_stmt;
+
+        struct
+        {
+            Expression *target;
+            Expression *value;
+        } reassign;
+
+        struct
+        {
+            Expression *expr;
+        } expr_stmt;
     } contents;
     
     StatementType type;
-} Statement;
+};
 
-void statement_init_import(Statement *stmt, char *module_name);
+void statement_init_import(Statement *stmt, SymbolID module_name);
 
-void statement_init_prim_decl(Statement *stmt, char *name, Expression *value, CompositeType high_type, DataType low_type);
+void statement_init_prim_decl(Statement *stmt, SymbolID name, Expression *value, CompositeType high_type, DataType low_type, SymbolID type_name);
 
-void statement_init_field_decl(Statement *stmt, char *name, CompositeType high_type, DataType lower_type);
+void statement_init_field_decl(Statement *stmt, SymbolID name, CompositeType high_type, DataType lower_type, SymbolID type_name);
 
-void statement_init_aggr_decl(Statement *stmt, char *name);
+void statement_init_aggr_decl(Statement *stmt, SymbolID name);
 
-void statement_init_func_decl(Statement *stmt, char *name, Statement *block);
+void statement_init_func_decl(Statement *stmt, SymbolID name, Statement *block);
 
-void statement_init_param_decl(Statement *stmt, char *name, CompositeType high_type, DataType low_type);
+void statement_init_param_decl(Statement *stmt, SymbolID name, CompositeType high_type, DataType low_type, SymbolID type_name);
 
 void statement_init_while_ctrl(Statement *stmt, Expression *conditional, Statement *block);
 
-void statement_init_if_ctrl(Statement *stmt, Expression *conditional, Statement *block);
+void statement_init_if_ctrl(Statement *stmt, Expression *conditional, Statement *block, Statement *other);
 
 void statement_init_else_ctrl(Statement *stmt, Statement *block);
 
 void statement_init_block(Statement *stmt);
 
-bool statement_append_child(Statement *stmt, Statement *child);
+void statement_init_return(Statement *stmt, Expression *value);
+
+void statement_init_reassign(Statement *stmt, Expression *target, Expression *value);
+
+void statement_init_expr_stmt(Statement *stmt, Expression *expr);
+
+bool statement_append_child(Statement *stmt, Arena *arena, Statement *child);
+
+bool statement_append_import(Statement *stmt, Arena *arena, Expression *item);
 
 uint8_t statement_decode_comptype(const Statement *stmt);
 
 uint8_t statement_decode_datatype(const Statement *stmt);
 
-void statement_dispose(Statement *stmt);
-
+/**
+ * @brief Owns one parsed source file. Every node and child vector of its AST is allocated from `arena`, so teardown is a single arena release. Names are `SymbolID`s from `symbols`, whose text views `source`, so the unit takes ownership of the loaded source file.
+ */
 typedef struct cask_program_unit_t
 {
-    Vector statements;
+    Arena arena;
+    SymbolTable symbols;
+    StatementVector statements;
     char *name;
+    SourceFile source;
 } ProgramUnit;
 
-void program_unit_init(ProgramUnit *prog_unit, char *name);
+/**
+ * @brief Initializes an empty ProgramUnit and copies its name into the unit's arena.
+ * 
+ * @param prog_unit 
+ * @param name 
+ */
+void program_unit_init(ProgramUnit *prog_unit, const char *name);
+
+Expression *program_unit_new_expr(ProgramUnit *prog_unit);
+
+Statement *program_unit_new_stmt(ProgramUnit *prog_unit);
+
+/**
+ * @brief Interns an identifier or string slice of the source into the unit's symbol table.
+ * 
+ * @param prog_unit 
+ * @param begin 
+ * @param length 
+ * @return SymbolID 
+ */
+SymbolID program_unit_intern(ProgramUnit *prog_unit, const char *begin, uint32_t length);
 
 const char *program_unit_view_name(const ProgramUnit *prog_unit);
 
 bool program_unit_append(ProgramUnit *prog_unit, Statement *stmt_ptr);
 
+/**
+ * @brief Moves a loaded source file into the unit, leaving `source` empty. It is released by `program_unit_dispose`.
+ * 
+ * @param prog_unit 
+ * @param source 
+ */
+void program_unit_adopt_source(ProgramUnit *prog_unit, SourceFile *source);
+
+/**
+ * @brief Releases the whole AST of the unit at once by disposing its arena, then unmaps the source file.
+ * 
+ * @param prog_unit 
+ */
 void program_unit_dispose(ProgramUnit *prog_unit);
 
 #endif
\ No newline at end of file
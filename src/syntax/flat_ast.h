@@ -0,0 +1,116 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "syntax/ast.h"
+
+/* Flat AST decls. */
+
+/// @brief Index of a flat node, or of a child list's first entry in `extra`.
+typedef uint32_t FlatIndex;
+
+/// @brief Marks a missing child, e.g. a bare `return` or an `if` without `else`.
+#define CASK_FLAT_NONE UINT32_MAX
+
+#define CASK_FLAT_FLAG_LVALUE 0x01U
+#define CASK_FLAT_FLAG_NIL 0x02U
+#define CASK_FLAT_FLAG_TRUE 0x04U
+#define CASK_FLAT_FLAG_HAS_AGGR 0x08U
+#define CASK_FLAT_FLAG_IN_BOUNDS 0x10U
+
+/**
+ * @brief One expression node. What `a`, `b` and `c` hold depends on `kind`:
+ * - special: only `flags`
+ * - integer: `a` is the value's bits; float: `a` is the float's bits
+ * - string, identifier: `a` is the SymbolID
+ * - array, aggregate: `a`..`a + b` is the range of item indexes in `extra`
+ * - call: as above for args, and `c` is the callee SymbolID
+ * - access: `a` is the target, `b` the key, `CASK_FLAT_FLAG_HAS_AGGR` marks `.field`, and `CASK_FLAT_FLAG_IN_BOUNDS` a proven index
+ * - binary kinds: `a` is left, `b` is right, and `op` is the OperatorType
+ */
+typedef struct cask_flat_expr_t
+{
+    uint8_t kind;   // ExpressionType
+    uint8_t op;     // OperatorType
+    uint8_t flags;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+} FlatExpr;
+
+/**
+ * @brief One statement node. `name`, `type_mask` and `type_name` mirror the pointer AST's declaration fields. Other children go by `kind`:
+ * - import: `a`..`a + b` is the range of item expression indexes in `extra`
+ * - primitive decl: `a` is the value
+ * - aggregate decl, block: `a`..`a + b` is the range of member / child statements in `extra`
+ * - function decl: `a`..`a + b` are params, and `c` is the body block
+ * - while: `a` is the condition, `b` the block
+ * - if: `a` is the condition, `b` the block, `c` the else statement or `CASK_FLAT_NONE`
+ * - else: `a` is the block
+ * - return: `a` is the value or `CASK_FLAT_NONE`
+ * - reassign: `a` is the target, `b` the value
+ * - expression statement: `a` is the expression
+ */
+typedef struct cask_flat_stmt_t
+{
+    uint8_t kind;   // StatementType
+    uint16_t type_mask;
+    SymbolID name;
+    SymbolID type_name;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+} FlatStmt;
+
+CASK_VECTOR_DECL(FlatExpr, FlatExpr)
+CASK_VECTOR_DECL(FlatStmt, FlatStmt)
+CASK_VECTOR_DECL(FlatIndex, FlatIndex)
+
+/**
+ * @brief Index-based form of a ProgramUnit's AST. Each node kind lives in one contiguous array, children are 32-bit indexes, and child lists are ranges of the shared `extra` array.
+ * @note Nodes are stored in post-order, so every child precedes its parent. Passes that want children first (folding, type checks) can walk the arrays front to back.
+ * @note Names and strings stay SymbolIDs of the source ProgramUnit, which must outlive this.
+ */
+typedef struct cask_flat_ast_t
+{
+    FlatExprVector exprs;
+    FlatStmtVector stmts;
+    FlatIndexVector extra;
+    FlatIndex roots;       // range start of top-level statements in `extra`
+    uint32_t root_count;
+} FlatAst;
+
+void flat_ast_init(FlatAst *flat);
+
+/**
+ * @brief Flattens the statements of a parsed unit.
+ *
+ * @param flat An initialized, empty FlatAst.
+ * @param prog_unit
+ * @return false on allocation failure.
+ */
+bool flat_ast_build(FlatAst *flat, const ProgramUnit *prog_unit);
+
+static inline const FlatExpr *flat_ast_expr(const FlatAst *flat, FlatIndex index)
+{
+    return vector_ref_FlatExpr(&flat->exprs, index);
+}
+
+static inline const FlatStmt *flat_ast_stmt(const FlatAst *flat, FlatIndex index)
+{
+    return vector_ref_FlatStmt(&flat->stmts, index);
+}
+
+/**
+ * @brief Reads entry `offset` of a child list starting at `start` in `extra`.
+ */
+static inline FlatIndex flat_ast_child(const FlatAst *flat, FlatIndex start, uint32_t offset)
+{
+    return vector_at_FlatIndex(&flat->extra, start + offset);
+}
+
+void flat_ast_dispose(FlatAst *flat);
+
+#endif
@@ -8,11 +8,10 @@
  * 
  */
 
-#include <stdlib.h>
-#include <string.h>
+#include <stddef.h>
 #include "frontend/token.h"
 
-char *token_stringify(const Token *token, const char *source)
+const char *token_view(const Token *token, const char *source)
 {
     if (!token)
         return NULL;
@@ -20,14 +19,5 @@ char *token_stringify(const Token *token, const char *source)
     if (CASK_TOKEN_PTR_IS_EMPTY(token) || CASK_TOKEN_IS_EOF(token))
         return NULL;
 
-    uint32_t buffer_size = token->length + 1U;
-    uint32_t buffer_pos = token->begin;
-    char *lexeme_buffer = calloc(buffer_size, sizeof(char));
-
-    if (lexeme_buffer != NULL)
-    {
-        strncpy(lexeme_buffer, source + buffer_pos, buffer_size - 1U);
-    }
-
-    return lexeme_buffer;
+    return source + token->begin;
 }
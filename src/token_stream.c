@@ -0,0 +1,329 @@
+/**
+ * @file token_stream.c
+ * @author Derek Tan
+ * @brief Implements the pre-lexed token stream.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/pool.h"
+#include "utils/scan.h"
+#include "frontend/token_stream.h"
+
+/**
+ * @brief Where lexing of a chunk starts or stops: between tokens, or inside a comment or string opened before.
+ */
+typedef enum cask_chunk_state_e
+{
+    CASK_CHUNK_OUTSIDE,
+    CASK_CHUNK_IN_COMMENT,
+    CASK_CHUNK_IN_STRING,
+    CASK_CHUNK_STATE_COUNT
+} ChunkState;
+
+/**
+ * @brief The tokens of one chunk lexed from one assumed start state.
+ */
+typedef struct cask_chunk_lex_t
+{
+    TokenStream tokens;
+    uint32_t close;                 // for starts inside a comment or string, the offset of its closing byte, or `UINT32_MAX` if the chunk has none
+    uint32_t open_begin;            // text start of a comment or string left open at the chunk end
+    ChunkState end_state;
+    bool stopped;                   // ends at an unknown token
+    bool ok;
+} ChunkLex;
+
+/**
+ * @brief Shared by the lexing tasks. Task `chunk * CASK_CHUNK_STATE_COUNT + state` lexes `source[bounds[chunk] .. bounds[chunk + 1])` from `state` into the result of the same index.
+ */
+typedef struct cask_chunk_job_t
+{
+    const char *source;
+    const uint32_t *bounds;
+    ChunkLex *results;
+} ChunkJob;
+
+static bool token_stream_reserve(TokenStream *stream, uint32_t new_capacity)
+{
+    uint8_t *new_types = realloc(stream->types, new_capacity * sizeof(uint8_t));
+
+    if (!new_types)
+        return false;
+
+    stream->types = new_types;
+
+    uint32_t *new_begins = realloc(stream->begins, new_capacity * sizeof(uint32_t));
+
+    if (!new_begins)
+        return false;
+
+    stream->begins = new_begins;
+
+    uint32_t *new_lengths = realloc(stream->lengths, new_capacity * sizeof(uint32_t));
+
+    if (!new_lengths)
+        return false;
+
+    stream->lengths = new_lengths;
+    stream->capacity = new_capacity;
+
+    return true;
+}
+
+static bool token_stream_push(TokenStream *stream, Token token)
+{
+    if (stream->count == stream->capacity && !token_stream_reserve(stream, 2U * stream->capacity))
+        return false;
+
+    stream->types[stream->count] = (uint8_t)token.type;
+    stream->begins[stream->count] = token.begin;
+    stream->lengths[stream->count] = token.length;
+    stream->count++;
+
+    return true;
+}
+
+static bool token_stream_append(TokenStream *stream, const TokenStream *other)
+{
+    uint32_t wanted = stream->count + other->count;
+
+    if (wanted < stream->count)
+        return false;
+
+    if (wanted > stream->capacity && !token_stream_reserve(stream, (wanted > 2U * stream->capacity) ? wanted : 2U * stream->capacity))
+        return false;
+
+    memcpy(stream->types + stream->count, other->types, other->count * sizeof(uint8_t));
+    memcpy(stream->begins + stream->count, other->begins, other->count * sizeof(uint32_t));
+    memcpy(stream->lengths + stream->count, other->lengths, other->count * sizeof(uint32_t));
+    stream->count = wanted;
+
+    return true;
+}
+
+static void token_stream_lex_chunk(Pool *pool, uint32_t worker, uint32_t task, void *context)
+{
+    (void)pool;
+    (void)worker;
+
+    const ChunkJob *job = context;
+    ChunkLex *result = &job->results[task];
+    ChunkState state = (ChunkState)(task % CASK_CHUNK_STATE_COUNT);
+    uint32_t chunk = task / CASK_CHUNK_STATE_COUNT;
+    uint32_t begin = job->bounds[chunk];
+    uint32_t end = job->bounds[chunk + 1U];
+    Lexer lexer;
+    Token token;
+
+    result->close = begin;
+    result->open_begin = 0U;
+    result->end_state = CASK_CHUNK_OUTSIDE;
+    result->stopped = false;
+    result->ok = token_stream_init(&result->tokens, (end - begin) / 4U);
+
+    if (!result->ok)
+        return;
+
+    // Starting inside a comment or string, first find where it closes.
+    if (state != CASK_CHUNK_OUTSIDE)
+    {
+        result->close = scan_find_byte(job->source, begin, end, (state == CASK_CHUNK_IN_COMMENT) ? '#' : '\"');
+
+        if (result->close == end)
+        {
+            result->close = UINT32_MAX;
+            result->end_state = state;
+            return;
+        }
+
+        begin = result->close + 1U;
+    }
+
+    lexer_init_view(&lexer, job->source, end);
+    lexer.source_index = begin;
+
+    while ((token = lexer_yield_token(&lexer)).type != CASK_EOF_TOKEN)
+    {
+        // A comment or string reaching the chunk end without its closing byte continues in the next chunk.
+        if ((token.type == CASK_COMMENT_TOKEN || token.type == CASK_STRING_TOKEN) && token.begin + token.length == end)
+        {
+            result->end_state = (token.type == CASK_COMMENT_TOKEN) ? CASK_CHUNK_IN_COMMENT : CASK_CHUNK_IN_STRING;
+            result->open_begin = token.begin;
+            return;
+        }
+
+        if (token.type == CASK_SPACING_TOKEN || token.type == CASK_COMMENT_TOKEN)
+            continue;
+
+        if (!(result->ok = token_stream_push(&result->tokens, token)))
+            return;
+
+        if (token.type == CASK_UNKNOWN_TOKEN)
+        {
+            result->stopped = true;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Joins the chunk results into `stream`, following the state each chunk ends in to the right result of the next.
+ */
+static bool token_stream_stitch(TokenStream *stream, const ChunkLex *results, uint32_t chunk_count, uint32_t source_length)
+{
+    ChunkState state = CASK_CHUNK_OUTSIDE;
+    uint32_t open_begin = 0U;
+
+    for (uint32_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        const ChunkLex *result = &results[chunk * CASK_CHUNK_STATE_COUNT + state];
+
+        if (!result->ok)
+            return false;
+
+        if (state != CASK_CHUNK_OUTSIDE)
+        {
+            // The comment or string runs through the whole chunk.
+            if (result->close == UINT32_MAX)
+                continue;
+
+            if (state == CASK_CHUNK_IN_STRING && !token_stream_push(stream, (Token){.begin = open_begin, .length = result->close - open_begin, .type = CASK_STRING_TOKEN}))
+                return false;
+        }
+
+        if (!token_stream_append(stream, &result->tokens))
+            return false;
+
+        if (result->stopped)
+            return token_stream_push(stream, (Token){.begin = stream->begins[stream->count - 1U], .length = 0U, .type = CASK_EOF_TOKEN});
+
+        state = result->end_state;
+        open_begin = result->open_begin;
+    }
+
+    // A string still open at the end runs to the end of the source, like in `lexer_lex_until`.
+    if (state == CASK_CHUNK_IN_STRING && !token_stream_push(stream, (Token){.begin = open_begin, .length = source_length - open_begin, .type = CASK_STRING_TOKEN}))
+        return false;
+
+    return token_stream_push(stream, (Token){.begin = source_length, .length = 1U, .type = CASK_EOF_TOKEN});
+}
+
+bool token_stream_init(TokenStream *stream, uint32_t capacity_hint)
+{
+    stream->types = NULL;
+    stream->begins = NULL;
+    stream->lengths = NULL;
+    stream->count = 0U;
+    stream->capacity = 0U;
+
+    if (capacity_hint < CASK_TOKEN_STREAM_MIN_CAPACITY)
+        capacity_hint = CASK_TOKEN_STREAM_MIN_CAPACITY;
+
+    if (!token_stream_reserve(stream, capacity_hint))
+    {
+        token_stream_dispose(stream);
+        return false;
+    }
+
+    return true;
+}
+
+bool token_stream_lex(TokenStream *stream, Lexer *lexer)
+{
+    Token token;
+
+    do
+    {
+        token = lexer_yield_token(lexer);
+
+        if (token.type == CASK_SPACING_TOKEN || token.type == CASK_COMMENT_TOKEN)
+            continue;
+
+        if (!token_stream_push(stream, token))
+            return false;
+
+        if (token.type == CASK_UNKNOWN_TOKEN)
+            return token_stream_push(stream, (Token){.begin = token.begin, .length = 0U, .type = CASK_EOF_TOKEN});
+    } while (token.type != CASK_EOF_TOKEN);
+
+    return true;
+}
+
+bool token_stream_lex_parallel(TokenStream *stream, Lexer *lexer, uint32_t worker_count)
+{
+    const char *source = lexer->source_view;
+    uint32_t length = lexer->source_length;
+
+    if (worker_count <= 1U || length < CASK_TOKEN_STREAM_PARALLEL_MIN || lexer->source_index != 0U)
+        return token_stream_lex(stream, lexer);
+
+    // About four chunks per worker, so workers that finish early can steal the rest.
+    uint32_t chunk_size = length / (4U * worker_count);
+
+    if (chunk_size < CASK_TOKEN_STREAM_CHUNK_MIN)
+        chunk_size = CASK_TOKEN_STREAM_CHUNK_MIN;
+
+    uint32_t max_chunks = length / chunk_size + 1U;
+    uint32_t *bounds = malloc((max_chunks + 1U) * sizeof(uint32_t));
+    uint32_t chunk_count = 0U;
+
+    if (!bounds)
+        return false;
+
+    bounds[0] = 0U;
+
+    while (bounds[chunk_count] < length)
+    {
+        uint32_t target = bounds[chunk_count];
+        uint32_t next = (length - target > chunk_size) ? scan_find_byte(source, target + chunk_size, length, '\n') : length;
+
+        bounds[++chunk_count] = (next < length) ? next + 1U : length;
+    }
+
+    uint32_t result_count = chunk_count * CASK_CHUNK_STATE_COUNT;
+    ChunkLex *results = calloc(result_count, sizeof(ChunkLex));
+    uint32_t *tasks = malloc(result_count * sizeof(uint32_t));
+    uint32_t task_count = 0U;
+    ChunkJob job = {.source = source, .bounds = bounds, .results = results};
+    bool ok = results != NULL && tasks != NULL;
+
+    // The first chunk always starts between tokens, so it needs no speculation.
+    for (uint32_t task = 0; ok && task < result_count; task++)
+    {
+        if (task < CASK_CHUNK_STATE_COUNT && task != CASK_CHUNK_OUTSIDE)
+            continue;
+
+        tasks[task_count++] = task;
+    }
+
+    ok = ok && pool_run(worker_count, task_count, tasks, task_count, token_stream_lex_chunk, &job);
+    ok = ok && token_stream_stitch(stream, results, chunk_count, length);
+
+    for (uint32_t index = 0; results != NULL && index < result_count; index++)
+        token_stream_dispose(&results[index].tokens);
+
+    free(results);
+    free(tasks);
+    free(bounds);
+
+    lexer->source_index = length;
+
+    return ok;
+}
+
+void token_stream_dispose(TokenStream *stream)
+{
+    free(stream->types);
+    free(stream->begins);
+    free(stream->lengths);
+    stream->types = NULL;
+    stream->begins = NULL;
+    stream->lengths = NULL;
+    stream->count = 0U;
+    stream->capacity = 0U;
+}
@@ -0,0 +1,664 @@
+/**
+ * @file typecheck.c
+ * @author Derek Tan
+ * @brief Implements the static type checking pass.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "backend/typecheck.h"
+
+/**
+ * @brief Per-function state: what `return` must give and which name to blame for errors without a better one.
+ */
+typedef struct cask_type_context_t
+{
+    Compiler *compiler;
+    TypeInfo return_type;
+    SymbolID function_name;
+} TypeContext;
+
+static const TypeInfo typecheck_unknown = {.mask = CASK_TYPE_MASK(CASK_COMPTYPE_UNKNOWN, CASK_DATATYPE_UNKNOWN), .name = CASK_SYMBOL_NONE};
+
+/* Type helpers. */
+
+static TypeInfo typecheck_single(DataType type)
+{
+    return (TypeInfo){.mask = CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, type), .name = CASK_SYMBOL_NONE};
+}
+
+static CompositeType typecheck_high(TypeInfo type)
+{
+    return (CompositeType)(type.mask >> 8);
+}
+
+static DataType typecheck_low(TypeInfo type)
+{
+    return (DataType)(type.mask & 0xffU);
+}
+
+static bool typecheck_is(TypeInfo type, DataType data_type)
+{
+    return type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_SINGLE, data_type);
+}
+
+static bool typecheck_is_unknown(TypeInfo type)
+{
+    return typecheck_high(type) == CASK_COMPTYPE_UNKNOWN;
+}
+
+static bool typecheck_same(TypeInfo left, TypeInfo right)
+{
+    return left.mask == right.mask && left.name == right.name;
+}
+
+/// @brief Strings, arrays and aggregates are heap references, so `nil` stands in for them.
+static bool typecheck_is_reference(TypeInfo type)
+{
+    return typecheck_high(type) == CASK_COMPTYPE_AGGREGATE || typecheck_high(type) == CASK_COMPTYPE_ARRAY || typecheck_is(type, CASK_DATATYPE_STRING);
+}
+
+/// @brief An aggregate literal's type before it meets a declared aggregate type.
+static bool typecheck_is_anonymous_aggregate(TypeInfo type)
+{
+    return typecheck_high(type) == CASK_COMPTYPE_AGGREGATE && type.name == CASK_SYMBOL_NONE;
+}
+
+/// @brief An empty array literal's type, which fits any array.
+static bool typecheck_is_any_array(TypeInfo type)
+{
+    return type.mask == CASK_TYPE_MASK(CASK_COMPTYPE_ARRAY, CASK_DATATYPE_UNKNOWN) && type.name == CASK_SYMBOL_NONE;
+}
+
+static TypeInfo typecheck_element_of(TypeInfo array_type)
+{
+    if (array_type.name != CASK_SYMBOL_NONE)
+        return (TypeInfo){.mask = CASK_TYPE_MASK(CASK_COMPTYPE_AGGREGATE, CASK_DATATYPE_UNKNOWN), .name = array_type.name};
+
+    if (typecheck_low(array_type) == CASK_DATATYPE_UNKNOWN)
+        return typecheck_unknown;
+
+    return typecheck_single(typecheck_low(array_type));
+}
+
+static TypeInfo typecheck_array_of(TypeInfo element_type)
+{
+    if (typecheck_high(element_type) == CASK_COMPTYPE_SINGLE)
+        return (TypeInfo){.mask = CASK_TYPE_MASK(CASK_COMPTYPE_ARRAY, typecheck_low(element_type)), .name = CASK_SYMBOL_NONE};
+
+    // Anonymous aggregate items and nested arrays are only known element by element.
+    return (TypeInfo){.mask = CASK_TYPE_MASK(CASK_COMPTYPE_ARRAY, CASK_DATATYPE_UNKNOWN),
+        .name = (typecheck_high(element_type) == CASK_COMPTYPE_AGGREGATE) ? element_type.name : CASK_SYMBOL_NONE};
+}
+
+/**
+ * @brief Tells if two operand types may meet in `==`, `!=` or one array literal.
+ */
+static bool typecheck_compatible(TypeInfo left, TypeInfo right)
+{
+    if (typecheck_is_unknown(left) || typecheck_is_unknown(right) || typecheck_same(left, right))
+        return true;
+
+    if ((typecheck_is(left, CASK_DATATYPE_NIL) && typecheck_is_reference(right)) || (typecheck_is(right, CASK_DATATYPE_NIL) && typecheck_is_reference(left)))
+        return true;
+
+    if (typecheck_high(left) == CASK_COMPTYPE_AGGREGATE && typecheck_high(right) == CASK_COMPTYPE_AGGREGATE)
+        return typecheck_is_anonymous_aggregate(left) || typecheck_is_anonymous_aggregate(right);
+
+    return typecheck_is_any_array(left) || typecheck_is_any_array(right);
+}
+
+/* Checker utility impls. */
+
+static bool typecheck_fail(TypeContext *context, CompileErrorCode code, SymbolID name)
+{
+    Compiler *compiler = context->compiler;
+
+    if (compiler->error == CASK_COMPILE_ERR_NONE)
+    {
+        compiler->error = code;
+        compiler->error_name = (name != CASK_SYMBOL_NONE) ? name : context->function_name;
+    }
+
+    return false;
+}
+
+static void typecheck_annotate(Expression *expr, TypeInfo type)
+{
+    expr->type_mask = type.mask;
+    expr->type_name = type.name;
+}
+
+static TypeInfo typecheck_annotation(const Expression *expr)
+{
+    return (TypeInfo){.mask = expr->type_mask, .name = expr->type_name};
+}
+
+static TypeInfo typecheck_decl_type(uint16_t mask, SymbolID name)
+{
+    return (TypeInfo){.mask = mask, .name = name};
+}
+
+static const LocalSlot *typecheck_find_local(const Compiler *compiler, SymbolID name)
+{
+    for (uint32_t slot = compiler->local_count; slot > 0U; slot--)
+    {
+        if (compiler->locals[slot - 1U].name == name)
+            return &compiler->locals[slot - 1U];
+    }
+
+    return NULL;
+}
+
+static bool typecheck_add_local(TypeContext *context, SymbolID name, TypeInfo type)
+{
+    Compiler *compiler = context->compiler;
+
+    if (compiler->local_count == CASK_COMPILER_MAX_LOCALS)
+        return typecheck_fail(context, CASK_COMPILE_ERR_LIMIT, name);
+
+    compiler->locals[compiler->local_count++] = (LocalSlot){.name = name, .type = type, .depth = compiler->scope_depth};
+
+    return true;
+}
+
+static void typecheck_end_scope(Compiler *compiler)
+{
+    while (compiler->local_count > 0U && compiler->locals[compiler->local_count - 1U].depth == compiler->scope_depth)
+        compiler->local_count--;
+
+    compiler->scope_depth--;
+}
+
+/* Expression checking. */
+
+static bool typecheck_expr(TypeContext *context, Expression *expr);
+
+/**
+ * @brief Checks that an already checked expression may be stored where `expected` is declared. Array and aggregate literals are checked item by item and then take the declared type.
+ * @param blame Name reported on a mismatch, such as the declared variable.
+ */
+static bool typecheck_assignable(TypeContext *context, TypeInfo expected, Expression *expr, SymbolID blame)
+{
+    TypeInfo actual = typecheck_annotation(expr);
+
+    if (typecheck_is_unknown(expected) || typecheck_is_unknown(actual) || typecheck_same(expected, actual))
+        return true;
+
+    if (typecheck_is(actual, CASK_DATATYPE_NIL) && typecheck_is_reference(expected))
+        return true;
+
+    if (typecheck_high(expected) == CASK_COMPTYPE_ARRAY && expr->type == CASK_EXPR_LITERAL_ARRAY)
+    {
+        const ExpressionVector *items = &expr->contents.array.values;
+
+        for (uint32_t index = 0; index < items->count; index++)
+        {
+            if (!typecheck_assignable(context, typecheck_element_of(expected), vector_at_Expression(items, index), blame))
+                return false;
+        }
+
+        typecheck_annotate(expr, expected);
+        return true;
+    }
+
+    if (typecheck_high(expected) == CASK_COMPTYPE_AGGREGATE && expr->type == CASK_EXPR_LITERAL_AGGREGATE)
+    {
+        Binding binding = context->compiler->bindings[expected.name];
+        const ExpressionVector *literals = &expr->contents.aggregate.literals;
+
+        if (binding.kind != CASK_BIND_AGGREGATE)
+            return typecheck_fail(context, CASK_COMPILE_ERR_UNKNOWN_NAME, expected.name);
+
+        const Statement *aggregate = vector_at_Statement(&context->compiler->aggregates, binding.index);
+        const StatementVector *members = &aggregate->contents.aggr_decl.members;
+
+        if (members->count != literals->count)
+            return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, blame);
+
+        for (uint32_t index = 0; index < literals->count; index++)
+        {
+            const Statement *member = vector_at_Statement(members, index);
+            TypeInfo member_type = typecheck_decl_type(member->contents.field_decl.type_mask, member->contents.field_decl.type_name);
+
+            if (!typecheck_assignable(context, member_type, vector_at_Expression(literals, index), blame))
+                return false;
+        }
+
+        typecheck_annotate(expr, expected);
+        return true;
+    }
+
+    return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, blame);
+}
+
+static bool typecheck_array_literal(TypeContext *context, Expression *expr)
+{
+    const ExpressionVector *items = &expr->contents.array.values;
+    TypeInfo element_type = typecheck_unknown;
+
+    for (uint32_t index = 0; index < items->count; index++)
+    {
+        Expression *item = vector_at_Expression(items, index);
+
+        if (!typecheck_expr(context, item))
+            return false;
+
+        if (!typecheck_compatible(element_type, typecheck_annotation(item)))
+            return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+
+        if (typecheck_is_unknown(element_type) || typecheck_is(element_type, CASK_DATATYPE_NIL))
+            element_type = typecheck_annotation(item);
+    }
+
+    typecheck_annotate(expr, typecheck_array_of(element_type));
+
+    return true;
+}
+
+static bool typecheck_identifier(TypeContext *context, Expression *expr)
+{
+    SymbolID name = expr->contents.identifier.name;
+    const LocalSlot *local = typecheck_find_local(context->compiler, name);
+    Binding binding = context->compiler->bindings[name];
+
+    if (local != NULL)
+        typecheck_annotate(expr, local->type);
+    else if (binding.kind == CASK_BIND_GLOBAL)
+        typecheck_annotate(expr, context->compiler->global_types[binding.index]);
+    else
+        return typecheck_fail(context, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+
+    return true;
+}
+
+static bool typecheck_native_args(TypeContext *context, NativeID native, const ExpressionVector *args, SymbolID name)
+{
+    TypeInfo first = typecheck_annotation(vector_at_Expression(args, 0));
+    bool valid = typecheck_is_unknown(first);
+
+    switch (native)
+    {
+    case CASK_NATIVE_PUTS:
+    case CASK_NATIVE_PUTF:
+        valid = valid || typecheck_is(first, CASK_DATATYPE_STRING);
+        break;
+    case CASK_NATIVE_LENGTH:
+        valid = valid || typecheck_is(first, CASK_DATATYPE_STRING) || typecheck_high(first) == CASK_COMPTYPE_ARRAY;
+        break;
+    default:
+        break;
+    }
+
+    return valid || typecheck_fail(context, CASK_COMPILE_ERR_TYPE, name);
+}
+
+static bool typecheck_call(TypeContext *context, Expression *expr)
+{
+    SymbolID name = expr->contents.call.name;
+    const ExpressionVector *args = &expr->contents.call.args;
+    Binding binding = context->compiler->bindings[name];
+
+    for (uint32_t index = 0; index < args->count; index++)
+    {
+        if (!typecheck_expr(context, vector_at_Expression(args, index)))
+            return false;
+    }
+
+    if (binding.kind == CASK_BIND_FUNCTION)
+    {
+        const Statement *decl = vector_at_Statement(&context->compiler->functions, binding.index);
+        const StatementVector *params = &decl->contents.func_decl.params;
+
+        if (params->count != args->count)
+            return typecheck_fail(context, CASK_COMPILE_ERR_ARITY, name);
+
+        for (uint32_t index = 0; index < args->count; index++)
+        {
+            const Statement *param = vector_at_Statement(params, index);
+            TypeInfo param_type = typecheck_decl_type(param->contents.param_decl.type_mask, param->contents.param_decl.type_name);
+
+            if (!typecheck_assignable(context, param_type, vector_at_Expression(args, index), name))
+                return false;
+        }
+
+        typecheck_annotate(expr, typecheck_decl_type(decl->contents.func_decl.type_mask, decl->contents.func_decl.type_name));
+        return true;
+    }
+
+    if (binding.kind == CASK_BIND_NATIVE)
+    {
+        int8_t arity = bytecode_natives[binding.index].arity;
+
+        if ((arity == CASK_NATIVE_VARIADIC && args->count == 0U) || (arity != CASK_NATIVE_VARIADIC && args->count != (uint32_t)arity))
+            return typecheck_fail(context, CASK_COMPILE_ERR_ARITY, name);
+
+        if (!typecheck_native_args(context, (NativeID)binding.index, args, name))
+            return false;
+
+        typecheck_annotate(expr, typecheck_decl_type(bytecode_natives[binding.index].return_mask, CASK_SYMBOL_NONE));
+        return true;
+    }
+
+    return typecheck_fail(context, CASK_COMPILE_ERR_UNKNOWN_NAME, name);
+}
+
+static bool typecheck_access(TypeContext *context, Expression *expr)
+{
+    Expression *target = expr->contents.access.target;
+    Expression *key = expr->contents.access.key;
+
+    if (!typecheck_expr(context, target))
+        return false;
+
+    TypeInfo target_type = typecheck_annotation(target);
+
+    if (expr->contents.access.has_aggr)
+    {
+        TypeInfo field_type = typecheck_unknown;
+        SymbolID field = key->contents.identifier.name;
+
+        if (typecheck_is_unknown(target_type))
+        {
+            typecheck_annotate(expr, typecheck_unknown);
+            return true;
+        }
+
+        if (compiler_find_field(context->compiler, target_type, field, &field_type) < 0)
+            return typecheck_fail(context, CASK_COMPILE_ERR_UNKNOWN_NAME, field);
+
+        typecheck_annotate(key, field_type);
+        typecheck_annotate(expr, field_type);
+        return true;
+    }
+
+    if (!typecheck_expr(context, key))
+        return false;
+
+    TypeInfo key_type = typecheck_annotation(key);
+
+    if (!typecheck_is_unknown(key_type) && !typecheck_is(key_type, CASK_DATATYPE_INTEGER))
+        return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+
+    if (typecheck_is_unknown(target_type))
+        typecheck_annotate(expr, typecheck_unknown);
+    else if (typecheck_high(target_type) == CASK_COMPTYPE_ARRAY)
+        typecheck_annotate(expr, typecheck_element_of(target_type));
+    else
+        return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+
+    return true;
+}
+
+static bool typecheck_binary(TypeContext *context, Expression *expr)
+{
+    Expression *left = expr->contents.term.left;
+    Expression *right = expr->contents.term.right;
+
+    if (!typecheck_expr(context, left) || !typecheck_expr(context, right))
+        return false;
+
+    TypeInfo left_type = typecheck_annotation(left);
+    TypeInfo right_type = typecheck_annotation(right);
+    TypeInfo operand_type = typecheck_is_unknown(left_type) ? right_type : left_type;
+    bool numeric = typecheck_is(operand_type, CASK_DATATYPE_INTEGER) || typecheck_is(operand_type, CASK_DATATYPE_FLOAT);
+    bool matching = typecheck_is_unknown(left_type) || typecheck_is_unknown(right_type) || typecheck_same(left_type, right_type);
+    bool valid = false;
+    TypeInfo result = typecheck_single(CASK_DATATYPE_BOOLEAN);
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_TERM:
+        valid = matching && (numeric || typecheck_is_unknown(operand_type)
+            || (expr->contents.term.op == CASK_OP_ADD && typecheck_is(operand_type, CASK_DATATYPE_STRING)));
+        result = operand_type;
+        break;
+    case CASK_EXPR_FACTOR:
+        valid = matching && (numeric || typecheck_is_unknown(operand_type));
+        result = operand_type;
+        break;
+    case CASK_EXPR_COMPARISON:
+        valid = matching && (numeric || typecheck_is_unknown(operand_type));
+        break;
+    case CASK_EXPR_EQUALITY:
+        valid = typecheck_compatible(left_type, right_type);
+        break;
+    default:
+        valid = (typecheck_is_unknown(left_type) || typecheck_is(left_type, CASK_DATATYPE_BOOLEAN))
+            && (typecheck_is_unknown(right_type) || typecheck_is(right_type, CASK_DATATYPE_BOOLEAN));
+        break;
+    }
+
+    if (!valid)
+        return typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+
+    typecheck_annotate(expr, result);
+
+    return true;
+}
+
+static bool typecheck_expr(TypeContext *context, Expression *expr)
+{
+    const ExpressionVector *literals = NULL;
+
+    switch (expr->type)
+    {
+    case CASK_EXPR_LITERAL_SPECIAL:
+        typecheck_annotate(expr, typecheck_single(expr->contents.special.is_nil ? CASK_DATATYPE_NIL : CASK_DATATYPE_BOOLEAN));
+        return true;
+    case CASK_EXPR_LITERAL_INTEGER:
+        typecheck_annotate(expr, typecheck_single(CASK_DATATYPE_INTEGER));
+        return true;
+    case CASK_EXPR_LITERAL_FLOAT:
+        typecheck_annotate(expr, typecheck_single(CASK_DATATYPE_FLOAT));
+        return true;
+    case CASK_EXPR_LITERAL_STRING:
+        typecheck_annotate(expr, typecheck_single(CASK_DATATYPE_STRING));
+        return true;
+    case CASK_EXPR_LITERAL_ARRAY:
+        return typecheck_array_literal(context, expr);
+    case CASK_EXPR_LITERAL_AGGREGATE:
+        literals = &expr->contents.aggregate.literals;
+
+        for (uint32_t index = 0; index < literals->count; index++)
+        {
+            if (!typecheck_expr(context, vector_at_Expression(literals, index)))
+                return false;
+        }
+
+        typecheck_annotate(expr, (TypeInfo){.mask = CASK_TYPE_MASK(CASK_COMPTYPE_AGGREGATE, CASK_DATATYPE_UNKNOWN), .name = CASK_SYMBOL_NONE});
+        return true;
+    case CASK_EXPR_IDENTIFIER:
+        return typecheck_identifier(context, expr);
+    case CASK_EXPR_CALL:
+        return typecheck_call(context, expr);
+    case CASK_EXPR_ACCESS:
+        return typecheck_access(context, expr);
+    default:
+        return typecheck_binary(context, expr);
+    }
+}
+
+static bool typecheck_condition(TypeContext *context, Expression *condition)
+{
+    if (!typecheck_expr(context, condition))
+        return false;
+
+    TypeInfo type = typecheck_annotation(condition);
+
+    return typecheck_is_unknown(type) || typecheck_is(type, CASK_DATATYPE_BOOLEAN) || typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+}
+
+/* Statement checking. */
+
+static bool typecheck_stmt(TypeContext *context, Statement *stmt);
+
+static bool typecheck_block(TypeContext *context, Statement *block)
+{
+    const StatementVector *stmts = &block->contents.block.stmts;
+    bool ok = true;
+
+    context->compiler->scope_depth++;
+
+    for (uint32_t index = 0; index < stmts->count && ok; index++)
+        ok = typecheck_stmt(context, vector_at_Statement(stmts, index));
+
+    typecheck_end_scope(context->compiler);
+
+    return ok;
+}
+
+static bool typecheck_decl(TypeContext *context, Statement *stmt)
+{
+    SymbolID name = stmt->contents.prim_decl.name;
+    TypeInfo declared = typecheck_decl_type(stmt->contents.prim_decl.type_mask, stmt->contents.prim_decl.type_name);
+
+    if (!typecheck_expr(context, stmt->contents.prim_decl.value) || !typecheck_assignable(context, declared, stmt->contents.prim_decl.value, name))
+        return false;
+
+    // Globals were typed by the compiler's declaring pass.
+    return context->compiler->scope_depth == 0U || typecheck_add_local(context, name, declared);
+}
+
+static bool typecheck_reassign(TypeContext *context, Statement *stmt)
+{
+    Expression *target = stmt->contents.reassign.target;
+    Expression *value = stmt->contents.reassign.value;
+
+    if (!typecheck_expr(context, target) || !typecheck_expr(context, value))
+        return false;
+
+    SymbolID blame = (target->type == CASK_EXPR_IDENTIFIER) ? target->contents.identifier.name : CASK_SYMBOL_NONE;
+
+    return typecheck_assignable(context, typecheck_annotation(target), value, blame);
+}
+
+static bool typecheck_return(TypeContext *context, Statement *stmt)
+{
+    Expression *value = stmt->contents.return_stmt.value;
+
+    if (!value)
+    {
+        return typecheck_is_unknown(context->return_type) || typecheck_is(context->return_type, CASK_DATATYPE_NIL)
+            || typecheck_fail(context, CASK_COMPILE_ERR_TYPE, CASK_SYMBOL_NONE);
+    }
+
+    return typecheck_expr(context, value) && typecheck_assignable(context, context->return_type, value, CASK_SYMBOL_NONE);
+}
+
+static bool typecheck_stmt(TypeContext *context, Statement *stmt)
+{
+    const Statement *other = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_PRIMITIVE_DECL:
+        return typecheck_decl(context, stmt);
+    case CASK_STMT_WHILE:
+        return typecheck_condition(context, stmt->contents.while_ctrl.condition) && typecheck_block(context, stmt->contents.while_ctrl.block);
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        return typecheck_condition(context, stmt->contents.if_ctrl.condition) && typecheck_block(context, stmt->contents.if_ctrl.block)
+            && (!other || typecheck_block(context, other->contents.else_ctrl.block));
+    case CASK_STMT_BLOCK:
+        return typecheck_block(context, stmt);
+    case CASK_STMT_RETURN:
+        return typecheck_return(context, stmt);
+    case CASK_STMT_REASSIGN:
+        return typecheck_reassign(context, stmt);
+    case CASK_STMT_EXPR:
+        return typecheck_expr(context, stmt->contents.expr_stmt.expr);
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Tells if every path through a statement ends in `return`. Loops never do, as their body may not run.
+ */
+static bool typecheck_always_returns(const Statement *stmt)
+{
+    const StatementVector *stmts = NULL;
+    const Statement *other = NULL;
+
+    switch (stmt->type)
+    {
+    case CASK_STMT_RETURN:
+        return true;
+    case CASK_STMT_IF:
+        other = stmt->contents.if_ctrl.other;
+
+        return other != NULL && typecheck_always_returns(stmt->contents.if_ctrl.block) && typecheck_always_returns(other->contents.else_ctrl.block);
+    case CASK_STMT_BLOCK:
+        stmts = &stmt->contents.block.stmts;
+
+        for (uint32_t index = 0; index < stmts->count; index++)
+        {
+            if (typecheck_always_returns(vector_at_Statement(stmts, index)))
+                return true;
+        }
+
+        return false;
+    default:
+        return false;
+    }
+}
+
+static bool typecheck_function(Compiler *compiler, Statement *decl)
+{
+    const StatementVector *params = &decl->contents.func_decl.params;
+    TypeContext context = {
+        .compiler = compiler,
+        .return_type = typecheck_decl_type(decl->contents.func_decl.type_mask, decl->contents.func_decl.type_name),
+        .function_name = decl->contents.func_decl.name
+    };
+    bool ok = true;
+
+    compiler->scope_depth = 1U;
+
+    for (uint32_t index = 0; index < params->count && ok; index++)
+    {
+        const Statement *param = vector_at_Statement(params, index);
+
+        ok = typecheck_add_local(&context, param->contents.param_decl.name,
+            typecheck_decl_type(param->contents.param_decl.type_mask, param->contents.param_decl.type_name));
+    }
+
+    ok = ok && typecheck_block(&context, decl->contents.func_decl.block);
+
+    // Running off the end returns nil, which typed opcodes would misread as the declared type.
+    if (ok && !typecheck_is(context.return_type, CASK_DATATYPE_NIL) && !typecheck_always_returns(decl->contents.func_decl.block))
+        ok = typecheck_fail(&context, CASK_COMPILE_ERR_MISSING_RETURN, decl->contents.func_decl.name);
+
+    compiler->local_count = 0U;
+    compiler->scope_depth = 0U;
+
+    return ok;
+}
+
+/* Checker impl. */
+
+bool typecheck_unit(Compiler *compiler)
+{
+    const StatementVector *statements = &compiler->unit->statements;
+    TypeContext toplevel = {.compiler = compiler, .return_type = typecheck_unknown, .function_name = CASK_SYMBOL_NONE};
+    bool ok = true;
+
+    compiler->local_count = 0U;
+    compiler->scope_depth = 0U;
+
+    for (uint32_t index = 0; index < statements->count && ok; index++)
+    {
+        Statement *stmt = vector_at_Statement(statements, index);
+
+        if (stmt->type == CASK_STMT_FUNCTION_DECL)
+            ok = typecheck_function(compiler, stmt);
+        else
+            ok = typecheck_stmt(&toplevel, stmt);
+    }
+
+    return ok;
+}
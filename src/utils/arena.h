@@ -0,0 +1,77 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CASK_ARENA_DEFAULT_BLOCK_SIZE 65536
+#define CASK_ARENA_ALIGNMENT (_Alignof(max_align_t))
+
+/**
+ * @brief One chunk of arena memory. Blocks form a singly linked list with the current bump block at the head.
+ */
+typedef struct cask_arena_block_t
+{
+    struct cask_arena_block_t *next;
+    size_t used;
+    size_t capacity;
+    max_align_t data[];
+} ArenaBlock;
+
+/**
+ * @brief Encapsulates a bump allocator. Every allocation lives until `arena_dispose`, so owners release a whole object graph at once instead of freeing nodes one by one.
+ * @note Memory from `arena_alloc` is not zeroed.
+ */
+typedef struct cask_arena_t
+{
+    ArenaBlock *head;
+    size_t block_size;
+} Arena;
+
+/**
+ * @brief Initializes an empty arena. No memory is reserved until the first allocation.
+ *
+ * @param arena
+ * @param block_size Usual size of each backing block. Larger requests get their own block.
+ */
+void arena_init(Arena *arena, size_t block_size);
+
+/**
+ * @brief Bump allocates `size` bytes aligned for any object type.
+ *
+ * @param arena
+ * @param size
+ * @return void* NULL on allocation failure.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief Resizes an earlier arena allocation. If it was the most recent allocation and the block has room, it grows in place. Otherwise the contents are copied to a fresh allocation and the old bytes stay unused until disposal.
+ *
+ * @param arena
+ * @param old_ptr May be NULL for a plain allocation.
+ * @param old_size
+ * @param new_size
+ * @return void* NULL on allocation failure, leaving `old_ptr` untouched.
+ */
+void *arena_grow(Arena *arena, void *old_ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Copies `length` chars of a string slice into the arena as a NUL terminated c-string.
+ *
+ * @param arena
+ * @param source
+ * @param length
+ * @return char*
+ */
+char *arena_strndup(Arena *arena, const char *source, size_t length);
+
+/**
+ * @brief Releases every block of the arena at once.
+ *
+ * @param arena
+ */
+void arena_dispose(Arena *arena);
+
+#endif
@@ -2,6 +2,7 @@
 #define FILES_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define CASK_NATIVE_FWRITE "w"
@@ -9,8 +10,44 @@
 #define CASK_NATIVE_FWRITE_BIN "wb"
 #define CASK_NATIVE_FREAD_BIN "rb"
 
+/**
+ * @brief Tells how a `SourceFile` holds its bytes, so `file_unmap` knows how to release them.
+ */
+typedef enum cask_source_storage_e
+{
+    CASK_SOURCE_EMPTY,
+    CASK_SOURCE_MAPPED,
+    CASK_SOURCE_HEAP
+} SourceStorage;
+
+/**
+ * @brief Read-only view of a whole file's bytes. The view is NOT NUL terminated, so always bound reads by `length`.
+ */
+typedef struct cask_source_file_t
+{
+    const char *data;
+    size_t length;
+    SourceStorage storage;
+} SourceFile;
+
 char *file_load(const char *file_path);
 
+/**
+ * @brief Maps a file read-only into memory without copying it. Falls back to reading into a heap buffer when the file cannot be mapped, e.g. pipes.
+ *
+ * @param file_path
+ * @param source Receives the view. An empty file gives a zero length view.
+ * @return true on success.
+ */
+bool file_map(const char *file_path, SourceFile *source);
+
+/**
+ * @brief Releases a view from `file_map` and resets it to empty.
+ *
+ * @param source
+ */
+void file_unmap(SourceFile *source);
+
 bool file_putblob(const char *file_path, const uint8_t *source, uint32_t size);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,18 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Hashes bytes with the 64-bit xxHash algorithm (XXH64), which reads 32 bytes per step and passes the SMHasher quality tests. It is NOT cryptographic.
+ * @note Words are read in host byte order, so the result matches reference XXH64 on little endian hosts only. Keep hashes on the machine that made them.
+ *
+ * @param data
+ * @param length
+ * @param seed Picks an independent hash function, e.g. to fold in a version.
+ * @return uint64_t
+ */
+uint64_t hash_bytes(const void *data, size_t length, uint64_t seed);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief One worker's queue of task IDs, a ring buffer. Its owner pushes and pops at the back, newest first, while idle workers steal from the front, oldest first.
+ */
+typedef struct cask_pool_deque_t
+{
+    pthread_mutex_t lock;
+    uint32_t *tasks;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+} PoolDeque;
+
+struct cask_pool_t;
+
+/**
+ * @brief Runs one task. `worker` is the index of the running worker, for handing new tasks to `pool_submit`.
+ */
+typedef void (*PoolTaskFn)(struct cask_pool_t *pool, uint32_t worker, uint32_t task, void *context);
+
+/**
+ * @brief A work-stealing thread pool running a known number of tasks, named by IDs. Tasks may submit more tasks while running, e.g. ones whose inputs they just finished.
+ * @note Workers that run dry steal from the others and sleep only when every deque is empty.
+ */
+typedef struct cask_pool_t
+{
+    PoolDeque *deques;
+    PoolTaskFn run;
+    void *context;
+    pthread_mutex_t lock;           // guards the counts below
+    pthread_cond_t wake;
+    uint32_t worker_count;
+    uint32_t queued;                // tasks sitting in deques
+    uint32_t finished;
+    uint32_t total;
+} Pool;
+
+/**
+ * @brief Gives the number of online CPU cores, or 1 if unknown.
+ */
+uint32_t pool_core_count(void);
+
+/**
+ * @brief Runs tasks until `total` of them have finished, on `worker_count` workers including the calling thread.
+ * @note Every task counted in `total` must be among `initial` or get submitted by a task, or this never returns.
+ *
+ * @param worker_count Clamped to at least 1. Workers whose threads fail to start are simply missing, and their tasks get stolen.
+ * @param total
+ * @param initial Tasks to start with, dealt out round robin.
+ * @param initial_count
+ * @param run
+ * @param context Passed to every `run` call.
+ * @return bool False if the pool could not be set up, in which case no task ran.
+ */
+bool pool_run(uint32_t worker_count, uint32_t total, const uint32_t *initial, uint32_t initial_count, PoolTaskFn run, void *context);
+
+/**
+ * @brief Queues a task on a worker's own deque. Called from tasks only.
+ * @note When the deque cannot grow, the task runs at once on the calling worker instead.
+ *
+ * @param pool
+ * @param worker The calling worker.
+ * @param task
+ */
+void pool_submit(Pool *pool, uint32_t worker, uint32_t task);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+
+/**
+ * @brief Identifies the byte scanning kernel picked for the running CPU.
+ */
+typedef enum cask_scan_kernel_e
+{
+    CASK_SCAN_SCALAR,
+    CASK_SCAN_SSE2,
+    CASK_SCAN_AVX2
+} ScanKernel;
+
+/**
+ * @brief Finds the first occurrence of `needle` in `source[index .. length)`. Uses 16 or 32 byte wide compares when the CPU supports them.
+ *
+ * @param source
+ * @param index Starting offset.
+ * @param length Scan limit. Bytes at or past it are never read.
+ * @param needle
+ * @return uint32_t Offset of the match, or `length` if there is none.
+ */
+uint32_t scan_find_byte(const char *source, uint32_t index, uint32_t length, char needle);
+
+/**
+ * @brief Skips a run of spacing bytes (space, tab, CR, LF) in `source[index .. length)`.
+ *
+ * @param source
+ * @param index Starting offset.
+ * @param length Scan limit. Bytes at or past it are never read.
+ * @return uint32_t Offset of the first non-spacing byte, or `length`.
+ */
+uint32_t scan_skip_spacing(const char *source, uint32_t index, uint32_t length);
+
+/**
+ * @brief Reports which kernel the scanning functions dispatch to. The choice is made once, on first use.
+ *
+ * @return ScanKernel
+ */
+ScanKernel scan_active_kernel(void);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Stable 32-bit handle of an interned name or string. Equal text always maps to the same ID within one `SymbolTable`, so later passes compare names by integer.
+ */
+typedef uint32_t SymbolID;
+
+/// @brief Reserved ID meaning "no symbol". Real IDs start at 1.
+#define CASK_SYMBOL_NONE 0U
+
+#define CASK_SYMBOLS_INIT_CAPACITY 64U
+
+/**
+ * @brief A slice of text that an ID stands for. The bytes are not copied, so they must outlive the table (usually they point into a loaded source buffer).
+ */
+typedef struct cask_symbol_entry_t
+{
+    const char *begin;
+    uint32_t length;
+    uint32_t hash;
+} SymbolEntry;
+
+/**
+ * @brief Open addressing hash table (linear probing) that interns text slices into `SymbolID`s.
+ * @note `entries` is indexed by ID and `slots` holds IDs, with 0 marking an empty slot.
+ */
+typedef struct cask_symbol_table_t
+{
+    SymbolEntry *entries;
+    uint32_t *slots;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    uint32_t slot_capacity;
+} SymbolTable;
+
+bool symbol_table_init(SymbolTable *table);
+
+/**
+ * @brief Returns the ID of a text slice, adding it on first sight. The slice is referenced, not copied.
+ *
+ * @param table
+ * @param begin
+ * @param length
+ * @return SymbolID `CASK_SYMBOL_NONE` only on allocation failure.
+ */
+SymbolID symbol_table_intern(SymbolTable *table, const char *begin, uint32_t length);
+
+/**
+ * @brief Looks up a text slice without adding it.
+ *
+ * @param table
+ * @param begin
+ * @param length
+ * @return SymbolID `CASK_SYMBOL_NONE` if the text was never interned.
+ */
+SymbolID symbol_table_find(const SymbolTable *table, const char *begin, uint32_t length);
+
+/**
+ * @brief Views the text behind an ID. The text is NOT NUL terminated.
+ *
+ * @param table
+ * @param id
+ * @param length_out Receives the text length.
+ * @return const char* NULL for an unknown ID.
+ */
+const char *symbol_table_view(const SymbolTable *table, SymbolID id, uint32_t *length_out);
+
+void symbol_table_dispose(SymbolTable *table);
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file value.c
+ * @author Derek Tan
+ * @brief Implements runtime values and heap objects.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "runtime/value.h"
+
+/* Object impl. */
+
+static void object_link(Object **owner, Object *object, ObjectType type)
+{
+    object->type = type;
+    object->next = *owner;
+    *owner = object;
+}
+
+StringObject *object_new_string(Object **owner, const char *text, uint32_t length)
+{
+    StringObject *string = malloc(sizeof(StringObject) + length);
+
+    if (!string)
+        return NULL;
+
+    string->length = length;
+
+    if (length > 0U)
+        memcpy(string->chars, text, length);
+
+    object_link(owner, &string->base, CASK_OBJ_STRING);
+
+    return string;
+}
+
+StringObject *object_concat_strings(Object **owner, const StringObject *left, const StringObject *right)
+{
+    uint64_t length = (uint64_t)left->length + right->length;
+
+    if (length > UINT32_MAX)
+        return NULL;
+
+    StringObject *string = malloc(sizeof(StringObject) + (size_t)length);
+
+    if (!string)
+        return NULL;
+
+    string->length = (uint32_t)length;
+    memcpy(string->chars, left->chars, left->length);
+    memcpy(string->chars + left->length, right->chars, right->length);
+    object_link(owner, &string->base, CASK_OBJ_STRING);
+
+    return string;
+}
+
+ArrayObject *object_new_array(Object **owner, ObjectType type, uint32_t count)
+{
+    ArrayObject *array = malloc(sizeof(ArrayObject) + (size_t)count * sizeof(Value));
+
+    if (!array)
+        return NULL;
+
+    array->count = count;
+    object_link(owner, &array->base, type);
+
+    return array;
+}
+
+void object_free_all(Object **owner)
+{
+    Object *object = *owner;
+
+    while (object != NULL)
+    {
+        Object *next = object->next;
+        free(object);
+        object = next;
+    }
+
+    *owner = NULL;
+}
+
+/* Value impl. */
+
+bool value_equals(Value left, Value right)
+{
+    // Floats compare numerically so that NaN != NaN and 0.0 == -0.0.
+    if (value_both_float(left, right))
+        return value_as_float(left) == value_as_float(right);
+
+    // Every other kind has one encoding per value, so equal bits mean equal values.
+    if (left == right)
+        return true;
+
+    if (value_is_object_type(left, CASK_OBJ_STRING) && value_is_object_type(right, CASK_OBJ_STRING))
+    {
+        const StringObject *left_string = value_as_string(left);
+        const StringObject *right_string = value_as_string(right);
+
+        return left_string->length == right_string->length && memcmp(left_string->chars, right_string->chars, left_string->length) == 0;
+    }
+
+    return false;
+}
+
+void value_print(Value value, FILE *out)
+{
+    if (value_is_nil(value))
+        fputs("nil", out);
+    else if (value_is_bool(value))
+        fputs(value_as_bool(value) ? "true" : "false", out);
+    else if (value_is_int(value))
+        fprintf(out, "%i", value_as_int(value));
+    else if (value_is_float(value))
+        fprintf(out, "%f", value_as_float(value));
+    else if (value_is_object_type(value, CASK_OBJ_STRING))
+        fwrite(value_as_string(value)->chars, 1, value_as_string(value)->length, out);
+    else if (value_is_object_type(value, CASK_OBJ_ARRAY))
+        fprintf(out, "<array %u>", value_as_array(value)->count);
+    else
+        fprintf(out, "<aggregate %u>", value_as_array(value)->count);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file vectors.c
+ * @author Derek Tan
+ * @brief Implements the untyped storage helpers behind `CASK_VECTOR_DECL`.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "collection/vectors.h"
+
+uint32_t vector_core_next_capacity(uint32_t capacity, uint32_t wanted, size_t item_size)
+{
+    uint32_t new_capacity = capacity;
+
+    while (new_capacity < wanted)
+        new_capacity = (new_capacity > UINT32_MAX / 2U) ? wanted : 2U * new_capacity;
+
+    if ((size_t)new_capacity > SIZE_MAX / item_size)
+        return 0U;
+
+    return new_capacity;
+}
+
+void *vector_core_grow(void *items, bool is_inline, size_t used_size, size_t old_size, size_t new_size, Arena *arena)
+{
+    void *new_items = NULL;
+
+    if (is_inline)
+    {
+        new_items = (arena != NULL) ? arena_alloc(arena, new_size) : malloc(new_size);
+
+        if (new_items != NULL)
+            memcpy(new_items, items, used_size);
+    }
+    else
+    {
+        new_items = (arena != NULL) ? arena_grow(arena, items, old_size, new_size) : realloc(items, new_size);
+    }
+
+    return new_items;
+}
+
+void vector_core_release(void *items, Arena *arena)
+{
+    if (!arena)
+        free(items);
+}
@@ -0,0 +1,985 @@
+/**
+ * @file vm.c
+ * @author Derek Tan
+ * @brief Implements the bytecode interpreter.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "runtime/vm.h"
+
+/* Natives */
+
+typedef VMErrorCode (*NativeFn)(VM *vm, Value *args, uint32_t argc, Value *result);
+
+static VMErrorCode native_puts(VM *vm, Value *args, uint32_t argc, Value *result)
+{
+    (void)vm;
+    (void)argc;
+
+    if (!value_is_object_type(args[0], CASK_OBJ_STRING))
+        return CASK_VM_ERR_NATIVE;
+
+    value_print(args[0], stdout);
+    fputc('\n', stdout);
+    *result = value_nil();
+
+    return CASK_VM_ERR_NONE;
+}
+
+/**
+ * @brief Prints a format string, replacing `%i`, `%f`, `%s` and `%b` with the next argument of that type and `%%` with a percent sign.
+ */
+static VMErrorCode native_putf(VM *vm, Value *args, uint32_t argc, Value *result)
+{
+    (void)vm;
+
+    if (!value_is_object_type(args[0], CASK_OBJ_STRING))
+        return CASK_VM_ERR_NATIVE;
+
+    const StringObject *format = value_as_string(args[0]);
+    uint32_t next_arg = 1U;
+
+    for (uint32_t index = 0; index < format->length; index++)
+    {
+        char letter = format->chars[index];
+
+        if (letter != '%' || index + 1U == format->length)
+        {
+            fputc(letter, stdout);
+            continue;
+        }
+
+        char specifier = format->chars[++index];
+
+        if (specifier == '%')
+        {
+            fputc('%', stdout);
+            continue;
+        }
+
+        if (next_arg == argc)
+            return CASK_VM_ERR_NATIVE;
+
+        Value arg = args[next_arg++];
+        bool matches = (specifier == 'i' && value_is_int(arg)) || (specifier == 'f' && value_is_float(arg))
+            || (specifier == 's' && value_is_object_type(arg, CASK_OBJ_STRING)) || (specifier == 'b' && value_is_bool(arg));
+
+        if (!matches)
+            return CASK_VM_ERR_NATIVE;
+
+        value_print(arg, stdout);
+    }
+
+    *result = value_nil();
+
+    return (next_arg == argc) ? CASK_VM_ERR_NONE : CASK_VM_ERR_NATIVE;
+}
+
+static VMErrorCode native_length(VM *vm, Value *args, uint32_t argc, Value *result)
+{
+    (void)vm;
+    (void)argc;
+
+    if (value_is_object_type(args[0], CASK_OBJ_ARRAY))
+        *result = value_int((int32_t)value_as_array(args[0])->count);
+    else if (value_is_object_type(args[0], CASK_OBJ_STRING))
+        *result = value_int((int32_t)value_as_string(args[0])->length);
+    else
+        return CASK_VM_ERR_NATIVE;
+
+    return CASK_VM_ERR_NONE;
+}
+
+static const NativeFn vm_natives[CASK_NATIVE_COUNT] = {
+    [CASK_NATIVE_PUTS] = native_puts,
+    [CASK_NATIVE_PUTF] = native_putf,
+    [CASK_NATIVE_LENGTH] = native_length
+};
+
+/* VM helpers */
+
+static bool vm_load_constants(VM *vm)
+{
+    const Module *module = vm->module;
+
+    for (uint32_t index = 0; index < module->constants.count; index++)
+    {
+        Constant constant = vector_at_Constant(&module->constants, index);
+        uint32_t length = 0U;
+        const char *text = NULL;
+        StringObject *string = NULL;
+
+        switch (constant.type)
+        {
+        case CASK_CONST_INTEGER:
+            vm->constants[index] = value_int(constant.as.integer);
+            break;
+        case CASK_CONST_FLOAT:
+            vm->constants[index] = value_float(constant.as.realnum);
+            break;
+        default:
+            text = module_view_string(module, constant.as.string, &length);
+
+            if (!text || !(string = object_new_string(&vm->objects, text, length)))
+                return false;
+
+            vm->constants[index] = value_object(&string->base);
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Finds the start of the instruction that `ip` was executing in a frame.
+ */
+static void vm_locate_error(VM *vm, const CallFrame *frame)
+{
+    const uint8_t *code = vector_ref_Byte(&frame->function->code, 0);
+    uint32_t target = (uint32_t)(frame->ip - code);
+    uint32_t offset = 0U;
+
+    while (offset < frame->function->code.count)
+    {
+        uint32_t next = offset + bytecode_instr_length(code[offset]);
+
+        if (next >= target)
+            break;
+
+        offset = next;
+    }
+
+    vm->error_function = (uint32_t)(frame->function - vector_ref_CodeObject(&vm->module->functions, 0));
+    vm->error_offset = offset;
+}
+
+/* Interpreter */
+
+#define VM_READ_U8() (*ip++)
+#define VM_READ_U16() (ip += 2, bytecode_read_u16(ip - 2))
+#define VM_READ_I16() (ip += 2, bytecode_read_i16(ip - 2))
+#define VM_PUSH(value) (*sp++ = (value))
+#define VM_POP() (*--sp)
+#define VM_PEEK(depth) (sp[-1 - (depth)])
+#define VM_FAIL(code) do { error = (code); goto vm_fail; } while (0)
+#define VM_SPEND_STEP() do { if (vm->budget == 0U) VM_FAIL(CASK_VM_ERR_BUDGET); vm->budget--; } while (0)
+
+#define VM_ARITH(op) do { \
+    Value right = VM_POP(); \
+    Value left = VM_PEEK(0); \
+    if (value_both_int(left, right)) \
+        VM_PEEK(0) = value_int((int32_t)((uint32_t)value_as_int(left) op (uint32_t)value_as_int(right))); \
+    else if (value_both_float(left, right)) \
+        VM_PEEK(0) = value_float(value_as_float(left) op value_as_float(right)); \
+    else \
+        VM_FAIL(CASK_VM_ERR_TYPE); \
+} while (0)
+
+#define VM_COMPARE(op) do { \
+    Value right = VM_POP(); \
+    Value left = VM_PEEK(0); \
+    if (value_both_int(left, right)) \
+        VM_PEEK(0) = value_bool(value_as_int(left) op value_as_int(right)); \
+    else if (value_both_float(left, right)) \
+        VM_PEEK(0) = value_bool(value_as_float(left) op value_as_float(right)); \
+    else \
+        VM_FAIL(CASK_VM_ERR_TYPE); \
+} while (0)
+
+/// @note The typed forms trust the type checker and read operands without testing tags.
+#define VM_ARITH_I32(op) do { \
+    Value right = VM_POP(); \
+    VM_PEEK(0) = value_int((int32_t)((uint32_t)value_as_int(VM_PEEK(0)) op (uint32_t)value_as_int(right))); \
+} while (0)
+
+#define VM_ARITH_F32(op) do { \
+    Value right = VM_POP(); \
+    VM_PEEK(0) = value_float(value_as_float(VM_PEEK(0)) op value_as_float(right)); \
+} while (0)
+
+#define VM_COMPARE_I32(op) do { \
+    Value right = VM_POP(); \
+    VM_PEEK(0) = value_bool(value_as_int(VM_PEEK(0)) op value_as_int(right)); \
+} while (0)
+
+/// @note The fused compare-and-branch forms pop both ints and skip the jump only when the comparison holds.
+#define VM_JUMP_UNLESS_I32(op) do { \
+    int16_t offset = VM_READ_I16(); \
+    Value right = VM_POP(); \
+    Value left = VM_POP(); \
+    if (!(value_as_int(left) op value_as_int(right))) \
+        ip += offset; \
+} while (0)
+
+#define VM_COMPARE_F32(op) do { \
+    Value right = VM_POP(); \
+    VM_PEEK(0) = value_bool(value_as_float(VM_PEEK(0)) op value_as_float(right)); \
+} while (0)
+
+/// @note Returning from the entry frame ends the run.
+#define VM_RETURN(value) do { \
+    Value returned = (value); \
+    if (--vm->frame_count == 0U) \
+    { \
+        *result_out = returned; \
+        return CASK_VM_ERR_NONE; \
+    } \
+    sp = frame->slots; \
+    frame--; \
+    ip = frame->ip; \
+    slots = frame->slots; \
+    VM_PUSH(returned); \
+    VM_DISPATCH(); \
+} while (0)
+
+#ifdef CASK_VM_THREADED_DISPATCH
+    #define VM_DISPATCH() goto *dispatch_table[*ip++]
+    #define VM_SWITCH VM_DISPATCH();
+    #define VM_CASE(name) vm_op_##name:
+#else
+    #define VM_DISPATCH() goto vm_dispatch
+    #define VM_SWITCH vm_dispatch: switch (*ip++)
+    #define VM_CASE(name) case CASK_BC_##name:
+#endif
+
+/**
+ * @brief Runs from the top frame until the entry frame returns. The hot state (`ip`, `sp`, `slots`) lives in locals and is only written back to the frame on calls.
+ */
+static VMErrorCode vm_execute(VM *vm, Value *result_out)
+{
+#ifdef CASK_VM_THREADED_DISPATCH
+    static const void *const dispatch_table[CASK_BC_COUNT] = {
+        [CASK_BC_NOP] = &&vm_op_NOP,
+        [CASK_BC_PUSH_NIL] = &&vm_op_PUSH_NIL,
+        [CASK_BC_PUSH_TRUE] = &&vm_op_PUSH_TRUE,
+        [CASK_BC_PUSH_FALSE] = &&vm_op_PUSH_FALSE,
+        [CASK_BC_PUSH_INT16] = &&vm_op_PUSH_INT16,
+        [CASK_BC_PUSH_CONST] = &&vm_op_PUSH_CONST,
+        [CASK_BC_POP] = &&vm_op_POP,
+        [CASK_BC_LOAD_LOCAL] = &&vm_op_LOAD_LOCAL,
+        [CASK_BC_STORE_LOCAL] = &&vm_op_STORE_LOCAL,
+        [CASK_BC_TEE_LOCAL] = &&vm_op_TEE_LOCAL,
+        [CASK_BC_LOAD_LOCAL_PAIR] = &&vm_op_LOAD_LOCAL_PAIR,
+        [CASK_BC_INC_LOCAL_I32] = &&vm_op_INC_LOCAL_I32,
+        [CASK_BC_LOAD_GLOBAL] = &&vm_op_LOAD_GLOBAL,
+        [CASK_BC_STORE_GLOBAL] = &&vm_op_STORE_GLOBAL,
+        [CASK_BC_ADD] = &&vm_op_ADD,
+        [CASK_BC_SUB] = &&vm_op_SUB,
+        [CASK_BC_MUL] = &&vm_op_MUL,
+        [CASK_BC_DIV] = &&vm_op_DIV,
+        [CASK_BC_LT] = &&vm_op_LT,
+        [CASK_BC_LTE] = &&vm_op_LTE,
+        [CASK_BC_GT] = &&vm_op_GT,
+        [CASK_BC_GTE] = &&vm_op_GTE,
+        [CASK_BC_EQ] = &&vm_op_EQ,
+        [CASK_BC_NEQ] = &&vm_op_NEQ,
+        [CASK_BC_ADD_I32] = &&vm_op_ADD_I32,
+        [CASK_BC_SUB_I32] = &&vm_op_SUB_I32,
+        [CASK_BC_MUL_I32] = &&vm_op_MUL_I32,
+        [CASK_BC_DIV_I32] = &&vm_op_DIV_I32,
+        [CASK_BC_ADD_F32] = &&vm_op_ADD_F32,
+        [CASK_BC_SUB_F32] = &&vm_op_SUB_F32,
+        [CASK_BC_MUL_F32] = &&vm_op_MUL_F32,
+        [CASK_BC_DIV_F32] = &&vm_op_DIV_F32,
+        [CASK_BC_CONCAT_STR] = &&vm_op_CONCAT_STR,
+        [CASK_BC_LT_I32] = &&vm_op_LT_I32,
+        [CASK_BC_LTE_I32] = &&vm_op_LTE_I32,
+        [CASK_BC_GT_I32] = &&vm_op_GT_I32,
+        [CASK_BC_GTE_I32] = &&vm_op_GTE_I32,
+        [CASK_BC_LT_F32] = &&vm_op_LT_F32,
+        [CASK_BC_LTE_F32] = &&vm_op_LTE_F32,
+        [CASK_BC_GT_F32] = &&vm_op_GT_F32,
+        [CASK_BC_GTE_F32] = &&vm_op_GTE_F32,
+        [CASK_BC_EQ_I32] = &&vm_op_EQ_I32,
+        [CASK_BC_NEQ_I32] = &&vm_op_NEQ_I32,
+        [CASK_BC_EQ_F32] = &&vm_op_EQ_F32,
+        [CASK_BC_NEQ_F32] = &&vm_op_NEQ_F32,
+        [CASK_BC_EQ_STR] = &&vm_op_EQ_STR,
+        [CASK_BC_NEQ_STR] = &&vm_op_NEQ_STR,
+        [CASK_BC_SHL_I32] = &&vm_op_SHL_I32,
+        [CASK_BC_SHR_I32] = &&vm_op_SHR_I32,
+        [CASK_BC_JUMP] = &&vm_op_JUMP,
+        [CASK_BC_JUMP_IF_FALSE] = &&vm_op_JUMP_IF_FALSE,
+        [CASK_BC_JUMP_IF_FALSE_OR_POP] = &&vm_op_JUMP_IF_FALSE_OR_POP,
+        [CASK_BC_JUMP_IF_TRUE_OR_POP] = &&vm_op_JUMP_IF_TRUE_OR_POP,
+        [CASK_BC_JUMP_UNLESS_LT_I32] = &&vm_op_JUMP_UNLESS_LT_I32,
+        [CASK_BC_JUMP_UNLESS_LTE_I32] = &&vm_op_JUMP_UNLESS_LTE_I32,
+        [CASK_BC_JUMP_UNLESS_GT_I32] = &&vm_op_JUMP_UNLESS_GT_I32,
+        [CASK_BC_JUMP_UNLESS_GTE_I32] = &&vm_op_JUMP_UNLESS_GTE_I32,
+        [CASK_BC_JUMP_UNLESS_EQ_I32] = &&vm_op_JUMP_UNLESS_EQ_I32,
+        [CASK_BC_JUMP_UNLESS_NEQ_I32] = &&vm_op_JUMP_UNLESS_NEQ_I32,
+        [CASK_BC_MAKE_ARRAY] = &&vm_op_MAKE_ARRAY,
+        [CASK_BC_MAKE_AGGR] = &&vm_op_MAKE_AGGR,
+        [CASK_BC_INDEX] = &&vm_op_INDEX,
+        [CASK_BC_SET_INDEX] = &&vm_op_SET_INDEX,
+        [CASK_BC_INDEX_UNCHECKED] = &&vm_op_INDEX_UNCHECKED,
+        [CASK_BC_SET_INDEX_UNCHECKED] = &&vm_op_SET_INDEX_UNCHECKED,
+        [CASK_BC_GET_FIELD] = &&vm_op_GET_FIELD,
+        [CASK_BC_SET_FIELD] = &&vm_op_SET_FIELD,
+        [CASK_BC_CALL] = &&vm_op_CALL,
+        [CASK_BC_CALL_NATIVE] = &&vm_op_CALL_NATIVE,
+        [CASK_BC_RETURN] = &&vm_op_RETURN,
+        [CASK_BC_RETURN_NIL] = &&vm_op_RETURN_NIL
+    };
+#endif
+
+    const CodeObject *functions = vector_ref_CodeObject(&vm->module->functions, 0);
+    const Value *constants = vm->constants;
+    Value *globals = vm->globals;
+    CallFrame *frame = &vm->frames[vm->frame_count - 1U];
+    const uint8_t *ip = frame->ip;
+    Value *slots = frame->slots;
+    Value *sp = slots + frame->function->slot_count;
+    VMErrorCode error = CASK_VM_ERR_NONE;
+
+    VM_SWITCH
+    {
+        VM_CASE(NOP)
+        {
+            VM_DISPATCH();
+        }
+        VM_CASE(PUSH_NIL)
+        {
+            VM_PUSH(value_nil());
+            VM_DISPATCH();
+        }
+        VM_CASE(PUSH_TRUE)
+        {
+            VM_PUSH(value_bool(true));
+            VM_DISPATCH();
+        }
+        VM_CASE(PUSH_FALSE)
+        {
+            VM_PUSH(value_bool(false));
+            VM_DISPATCH();
+        }
+        VM_CASE(PUSH_INT16)
+        {
+            int16_t immediate = VM_READ_I16();
+            VM_PUSH(value_int(immediate));
+            VM_DISPATCH();
+        }
+        VM_CASE(PUSH_CONST)
+        {
+            uint16_t constant = VM_READ_U16();
+            VM_PUSH(constants[constant]);
+            VM_DISPATCH();
+        }
+        VM_CASE(POP)
+        {
+            sp--;
+            VM_DISPATCH();
+        }
+        VM_CASE(LOAD_LOCAL)
+        {
+            uint8_t slot = VM_READ_U8();
+            VM_PUSH(slots[slot]);
+            VM_DISPATCH();
+        }
+        VM_CASE(STORE_LOCAL)
+        {
+            uint8_t slot = VM_READ_U8();
+            slots[slot] = VM_POP();
+            VM_DISPATCH();
+        }
+        VM_CASE(TEE_LOCAL)
+        {
+            uint8_t slot = VM_READ_U8();
+            slots[slot] = VM_PEEK(0);
+            VM_DISPATCH();
+        }
+        VM_CASE(LOAD_LOCAL_PAIR)
+        {
+            uint8_t first = VM_READ_U8();
+            uint8_t second = VM_READ_U8();
+            VM_PUSH(slots[first]);
+            VM_PUSH(slots[second]);
+            VM_DISPATCH();
+        }
+        VM_CASE(INC_LOCAL_I32)
+        {
+            uint8_t slot = VM_READ_U8();
+            int8_t step = (int8_t)VM_READ_U8();
+            slots[slot] = value_int((int32_t)((uint32_t)value_as_int(slots[slot]) + (uint32_t)(int32_t)step));
+            VM_DISPATCH();
+        }
+        VM_CASE(LOAD_GLOBAL)
+        {
+            uint16_t global = VM_READ_U16();
+            VM_PUSH(globals[global]);
+            VM_DISPATCH();
+        }
+        VM_CASE(STORE_GLOBAL)
+        {
+            uint16_t global = VM_READ_U16();
+            globals[global] = VM_POP();
+            VM_DISPATCH();
+        }
+        VM_CASE(ADD)
+        {
+            Value right = VM_PEEK(0);
+            Value left = VM_PEEK(1);
+
+            if (value_is_object_type(left, CASK_OBJ_STRING) && value_is_object_type(right, CASK_OBJ_STRING))
+            {
+                StringObject *joined = object_concat_strings(&vm->objects, value_as_string(left), value_as_string(right));
+
+                if (!joined)
+                    VM_FAIL(CASK_VM_ERR_MEMORY);
+
+                sp--;
+                VM_PEEK(0) = value_object(&joined->base);
+                VM_DISPATCH();
+            }
+
+            VM_ARITH(+);
+            VM_DISPATCH();
+        }
+        VM_CASE(SUB)
+        {
+            VM_ARITH(-);
+            VM_DISPATCH();
+        }
+        VM_CASE(MUL)
+        {
+            VM_ARITH(*);
+            VM_DISPATCH();
+        }
+        VM_CASE(DIV)
+        {
+            Value right = VM_POP();
+            Value left = VM_PEEK(0);
+
+            if (value_both_int(left, right))
+            {
+                int32_t divisor = value_as_int(right);
+
+                if (divisor == 0)
+                    VM_FAIL(CASK_VM_ERR_DIVIDE);
+
+                // INT32_MIN / -1 wraps like the other integer ops instead of trapping.
+                VM_PEEK(0) = value_int((divisor == -1) ? (int32_t)(0U - (uint32_t)value_as_int(left)) : value_as_int(left) / divisor);
+            }
+            else if (value_both_float(left, right))
+            {
+                VM_PEEK(0) = value_float(value_as_float(left) / value_as_float(right));
+            }
+            else
+            {
+                VM_FAIL(CASK_VM_ERR_TYPE);
+            }
+
+            VM_DISPATCH();
+        }
+        VM_CASE(LT)
+        {
+            VM_COMPARE(<);
+            VM_DISPATCH();
+        }
+        VM_CASE(LTE)
+        {
+            VM_COMPARE(<=);
+            VM_DISPATCH();
+        }
+        VM_CASE(GT)
+        {
+            VM_COMPARE(>);
+            VM_DISPATCH();
+        }
+        VM_CASE(GTE)
+        {
+            VM_COMPARE(>=);
+            VM_DISPATCH();
+        }
+        VM_CASE(EQ)
+        {
+            Value right = VM_POP();
+            Value left = VM_PEEK(0);
+
+            // Boxed integers are equal exactly when their bits are.
+            VM_PEEK(0) = value_bool(value_both_int(left, right) ? left == right : value_equals(left, right));
+            VM_DISPATCH();
+        }
+        VM_CASE(NEQ)
+        {
+            Value right = VM_POP();
+            Value left = VM_PEEK(0);
+
+            VM_PEEK(0) = value_bool(value_both_int(left, right) ? left != right : !value_equals(left, right));
+            VM_DISPATCH();
+        }
+        VM_CASE(ADD_I32)
+        {
+            VM_ARITH_I32(+);
+            VM_DISPATCH();
+        }
+        VM_CASE(SUB_I32)
+        {
+            VM_ARITH_I32(-);
+            VM_DISPATCH();
+        }
+        VM_CASE(MUL_I32)
+        {
+            VM_ARITH_I32(*);
+            VM_DISPATCH();
+        }
+        VM_CASE(DIV_I32)
+        {
+            int32_t divisor = value_as_int(VM_POP());
+
+            if (divisor == 0)
+                VM_FAIL(CASK_VM_ERR_DIVIDE);
+
+            VM_PEEK(0) = value_int((divisor == -1) ? (int32_t)(0U - (uint32_t)value_as_int(VM_PEEK(0))) : value_as_int(VM_PEEK(0)) / divisor);
+            VM_DISPATCH();
+        }
+        VM_CASE(ADD_F32)
+        {
+            VM_ARITH_F32(+);
+            VM_DISPATCH();
+        }
+        VM_CASE(SUB_F32)
+        {
+            VM_ARITH_F32(-);
+            VM_DISPATCH();
+        }
+        VM_CASE(MUL_F32)
+        {
+            VM_ARITH_F32(*);
+            VM_DISPATCH();
+        }
+        VM_CASE(DIV_F32)
+        {
+            VM_ARITH_F32(/);
+            VM_DISPATCH();
+        }
+        VM_CASE(CONCAT_STR)
+        {
+            // A string typed value may still be nil, so this one typed form tests its tags.
+            if (!value_is_object_type(VM_PEEK(1), CASK_OBJ_STRING) || !value_is_object_type(VM_PEEK(0), CASK_OBJ_STRING))
+                VM_FAIL(CASK_VM_ERR_TYPE);
+
+            StringObject *joined = object_concat_strings(&vm->objects, value_as_string(VM_PEEK(1)), value_as_string(VM_PEEK(0)));
+
+            if (!joined)
+                VM_FAIL(CASK_VM_ERR_MEMORY);
+
+            sp--;
+            VM_PEEK(0) = value_object(&joined->base);
+            VM_DISPATCH();
+        }
+        VM_CASE(LT_I32)
+        {
+            VM_COMPARE_I32(<);
+            VM_DISPATCH();
+        }
+        VM_CASE(LTE_I32)
+        {
+            VM_COMPARE_I32(<=);
+            VM_DISPATCH();
+        }
+        VM_CASE(GT_I32)
+        {
+            VM_COMPARE_I32(>);
+            VM_DISPATCH();
+        }
+        VM_CASE(GTE_I32)
+        {
+            VM_COMPARE_I32(>=);
+            VM_DISPATCH();
+        }
+        VM_CASE(LT_F32)
+        {
+            VM_COMPARE_F32(<);
+            VM_DISPATCH();
+        }
+        VM_CASE(LTE_F32)
+        {
+            VM_COMPARE_F32(<=);
+            VM_DISPATCH();
+        }
+        VM_CASE(GT_F32)
+        {
+            VM_COMPARE_F32(>);
+            VM_DISPATCH();
+        }
+        VM_CASE(GTE_F32)
+        {
+            VM_COMPARE_F32(>=);
+            VM_DISPATCH();
+        }
+        VM_CASE(EQ_I32)
+        {
+            Value right = VM_POP();
+            VM_PEEK(0) = value_bool(VM_PEEK(0) == right);
+            VM_DISPATCH();
+        }
+        VM_CASE(NEQ_I32)
+        {
+            Value right = VM_POP();
+            VM_PEEK(0) = value_bool(VM_PEEK(0) != right);
+            VM_DISPATCH();
+        }
+        VM_CASE(EQ_F32)
+        {
+            VM_COMPARE_F32(==);
+            VM_DISPATCH();
+        }
+        VM_CASE(NEQ_F32)
+        {
+            VM_COMPARE_F32(!=);
+            VM_DISPATCH();
+        }
+        VM_CASE(EQ_STR)
+        {
+            Value right = VM_POP();
+            VM_PEEK(0) = value_bool(value_equals(VM_PEEK(0), right));
+            VM_DISPATCH();
+        }
+        VM_CASE(NEQ_STR)
+        {
+            Value right = VM_POP();
+            VM_PEEK(0) = value_bool(!value_equals(VM_PEEK(0), right));
+            VM_DISPATCH();
+        }
+        VM_CASE(SHL_I32)
+        {
+            uint8_t shift = VM_READ_U8();
+
+            VM_PEEK(0) = value_int((int32_t)((uint32_t)value_as_int(VM_PEEK(0)) << shift));
+            VM_DISPATCH();
+        }
+        VM_CASE(SHR_I32)
+        {
+            uint8_t shift = VM_READ_U8();
+            int32_t dividend = value_as_int(VM_PEEK(0));
+
+            // Biasing negative dividends by 2^shift - 1 makes the arithmetic shift round toward zero, as DIV_I32 does.
+            if (dividend < 0)
+                dividend += (int32_t)((1U << shift) - 1U);
+
+            VM_PEEK(0) = value_int(dividend >> shift);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP)
+        {
+            int16_t offset = VM_READ_I16();
+
+            // Backward jumps close loops, so spending on them bounds every run.
+            if (offset < 0)
+                VM_SPEND_STEP();
+
+            ip += offset;
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_IF_FALSE)
+        {
+            int16_t offset = VM_READ_I16();
+
+            if (value_is_falsy(VM_POP()))
+                ip += offset;
+
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_IF_FALSE_OR_POP)
+        {
+            int16_t offset = VM_READ_I16();
+
+            if (value_is_falsy(VM_PEEK(0)))
+                ip += offset;
+            else
+                sp--;
+
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_IF_TRUE_OR_POP)
+        {
+            int16_t offset = VM_READ_I16();
+
+            if (!value_is_falsy(VM_PEEK(0)))
+                ip += offset;
+            else
+                sp--;
+
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_LT_I32)
+        {
+            VM_JUMP_UNLESS_I32(<);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_LTE_I32)
+        {
+            VM_JUMP_UNLESS_I32(<=);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_GT_I32)
+        {
+            VM_JUMP_UNLESS_I32(>);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_GTE_I32)
+        {
+            VM_JUMP_UNLESS_I32(>=);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_EQ_I32)
+        {
+            VM_JUMP_UNLESS_I32(==);
+            VM_DISPATCH();
+        }
+        VM_CASE(JUMP_UNLESS_NEQ_I32)
+        {
+            VM_JUMP_UNLESS_I32(!=);
+            VM_DISPATCH();
+        }
+        VM_CASE(MAKE_ARRAY)
+        {
+            uint16_t count = VM_READ_U16();
+            ArrayObject *array = object_new_array(&vm->objects, CASK_OBJ_ARRAY, count);
+
+            if (!array)
+                VM_FAIL(CASK_VM_ERR_MEMORY);
+
+            sp -= count;
+            memcpy(array->items, sp, count * sizeof(Value));
+            VM_PUSH(value_object(&array->base));
+            VM_DISPATCH();
+        }
+        VM_CASE(MAKE_AGGR)
+        {
+            uint16_t count = VM_READ_U16();
+            ArrayObject *aggregate = object_new_array(&vm->objects, CASK_OBJ_AGGREGATE, count);
+
+            if (!aggregate)
+                VM_FAIL(CASK_VM_ERR_MEMORY);
+
+            sp -= count;
+            memcpy(aggregate->items, sp, count * sizeof(Value));
+            VM_PUSH(value_object(&aggregate->base));
+            VM_DISPATCH();
+        }
+        VM_CASE(INDEX)
+        {
+            Value key = VM_POP();
+            Value target = VM_PEEK(0);
+
+            if (!value_is_object_type(target, CASK_OBJ_ARRAY) || !value_is_int(key))
+                VM_FAIL(CASK_VM_ERR_TYPE);
+
+            const ArrayObject *array = value_as_array(target);
+
+            if ((uint32_t)value_as_int(key) >= array->count)
+                VM_FAIL(CASK_VM_ERR_BOUNDS);
+
+            VM_PEEK(0) = array->items[value_as_int(key)];
+            VM_DISPATCH();
+        }
+        VM_CASE(SET_INDEX)
+        {
+            Value item = VM_POP();
+            Value key = VM_POP();
+            Value target = VM_POP();
+
+            if (!value_is_object_type(target, CASK_OBJ_ARRAY) || !value_is_int(key))
+                VM_FAIL(CASK_VM_ERR_TYPE);
+
+            ArrayObject *array = value_as_array(target);
+
+            if ((uint32_t)value_as_int(key) >= array->count)
+                VM_FAIL(CASK_VM_ERR_BOUNDS);
+
+            array->items[value_as_int(key)] = item;
+            VM_DISPATCH();
+        }
+        VM_CASE(INDEX_UNCHECKED)
+        {
+            Value key = VM_POP();
+
+            VM_PEEK(0) = value_as_array(VM_PEEK(0))->items[value_as_int(key)];
+            VM_DISPATCH();
+        }
+        VM_CASE(SET_INDEX_UNCHECKED)
+        {
+            Value item = VM_POP();
+            Value key = VM_POP();
+            Value target = VM_POP();
+
+            value_as_array(target)->items[value_as_int(key)] = item;
+            VM_DISPATCH();
+        }
+        VM_CASE(GET_FIELD)
+        {
+            uint8_t field = VM_READ_U8();
+            Value target = VM_PEEK(0);
+
+            if (!value_is_object_type(target, CASK_OBJ_AGGREGATE))
+                VM_FAIL(CASK_VM_ERR_TYPE);
+
+            if (field >= value_as_array(target)->count)
+                VM_FAIL(CASK_VM_ERR_BOUNDS);
+
+            VM_PEEK(0) = value_as_array(target)->items[field];
+            VM_DISPATCH();
+        }
+        VM_CASE(SET_FIELD)
+        {
+            uint8_t field = VM_READ_U8();
+            Value item = VM_POP();
+            Value target = VM_POP();
+
+            if (!value_is_object_type(target, CASK_OBJ_AGGREGATE))
+                VM_FAIL(CASK_VM_ERR_TYPE);
+
+            if (field >= value_as_array(target)->count)
+                VM_FAIL(CASK_VM_ERR_BOUNDS);
+
+            value_as_array(target)->items[field] = item;
+            VM_DISPATCH();
+        }
+        VM_CASE(CALL)
+        {
+            uint16_t callee_index = VM_READ_U16();
+            uint8_t argc = VM_READ_U8();
+            const CodeObject *callee = functions + callee_index;
+            Value *callee_slots = sp - argc;
+
+            // One check covers the callee's slots and its whole operand stack.
+            if (vm->frame_count == CASK_VM_FRAME_LIMIT || (size_t)(vm->stack_end - callee_slots) < (size_t)callee->slot_count + callee->max_stack)
+                VM_FAIL(CASK_VM_ERR_OVERFLOW);
+
+            VM_SPEND_STEP();
+
+            frame->ip = ip;
+            frame = &vm->frames[vm->frame_count++];
+            frame->function = callee;
+            frame->slots = callee_slots;
+
+            for (; sp < callee_slots + callee->slot_count; sp++)
+                *sp = value_nil();
+
+            slots = callee_slots;
+            ip = vector_ref_Byte(&callee->code, 0);
+            VM_DISPATCH();
+        }
+        VM_CASE(CALL_NATIVE)
+        {
+            uint8_t native = VM_READ_U8();
+            uint8_t argc = VM_READ_U8();
+            Value *args = sp - argc;
+            Value result = value_nil();
+            VMErrorCode native_error = vm_natives[native](vm, args, argc, &result);
+
+            if (native_error != CASK_VM_ERR_NONE)
+                VM_FAIL(native_error);
+
+            sp = args;
+            VM_PUSH(result);
+            VM_DISPATCH();
+        }
+        VM_CASE(RETURN)
+        {
+            VM_RETURN(VM_POP());
+        }
+        VM_CASE(RETURN_NIL)
+        {
+            VM_RETURN(value_nil());
+        }
+#ifndef CASK_VM_THREADED_DISPATCH
+        default:
+            VM_FAIL(CASK_VM_ERR_BAD_OPCODE);
+#endif
+    }
+
+vm_fail:
+    frame->ip = ip;
+    vm->error = error;
+    vm_locate_error(vm, frame);
+    vm->frame_count = 0U;
+
+    return error;
+}
+
+/* VM impl. */
+
+bool vm_init(VM *vm, const Module *module)
+{
+    uint32_t global_count = (module->global_count > 0U) ? module->global_count : 1U;
+    uint32_t constant_count = (module->constants.count > 0U) ? module->constants.count : 1U;
+
+    vm->module = module;
+    vm->stack = malloc(CASK_VM_STACK_SLOTS * sizeof(Value));
+    vm->stack_end = (vm->stack != NULL) ? vm->stack + CASK_VM_STACK_SLOTS : NULL;
+    vm->frames = malloc(CASK_VM_FRAME_LIMIT * sizeof(CallFrame));
+    vm->frame_count = 0U;
+    vm->globals = malloc(global_count * sizeof(Value));
+    vm->constants = malloc(constant_count * sizeof(Value));
+    vm->objects = NULL;
+    vm->budget = UINT64_MAX;
+    vm->error = CASK_VM_ERR_NONE;
+    vm->error_function = 0U;
+    vm->error_offset = 0U;
+
+    if (!vm->stack || !vm->frames || !vm->globals || !vm->constants || !vm_load_constants(vm))
+    {
+        vm_dispose(vm);
+        return false;
+    }
+
+    for (uint32_t index = 0; index < module->global_count; index++)
+        vm->globals[index] = value_nil();
+
+    return true;
+}
+
+VMErrorCode vm_run(VM *vm, uint32_t function, Value *result_out)
+{
+    return vm_call(vm, function, NULL, 0U, result_out);
+}
+
+VMErrorCode vm_call(VM *vm, uint32_t function, const Value *args, uint32_t argc, Value *result_out)
+{
+    *result_out = value_nil();
+
+    if (function >= vm->module->functions.count)
+        return (vm->error = CASK_VM_ERR_CALL);
+
+    const CodeObject *entry = vector_ref_CodeObject(&vm->module->functions, function);
+
+    if (entry->arity != argc)
+        return (vm->error = CASK_VM_ERR_CALL);
+
+    if ((size_t)entry->slot_count + entry->max_stack > CASK_VM_STACK_SLOTS)
+        return (vm->error = CASK_VM_ERR_OVERFLOW);
+
+    vm->error = CASK_VM_ERR_NONE;
+    vm->frame_count = 1U;
+    vm->frames[0] = (CallFrame){.function = entry, .ip = vector_ref_Byte(&entry->code, 0), .slots = vm->stack};
+
+    for (uint32_t slot = 0; slot < entry->slot_count; slot++)
+        vm->stack[slot] = (slot < argc) ? args[slot] : value_nil();
+
+    return vm_execute(vm, result_out);
+}
+
+void vm_dispose(VM *vm)
+{
+    object_free_all(&vm->objects);
+    free(vm->stack);
+    free(vm->frames);
+    free(vm->globals);
+    free(vm->constants);
+    vm->stack = NULL;
+    vm->stack_end = NULL;
+    vm->frames = NULL;
+    vm->globals = NULL;
+    vm->constants = NULL;
+    vm->frame_count = 0U;
+    vm->module = NULL;
+}